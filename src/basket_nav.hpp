@@ -0,0 +1,303 @@
+#pragma once
+
+#include "common/symbol_map.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mmsim {
+
+// =============================================================================
+// Incremental ETF/basket fair value (--baskets)
+//
+// A basket file lists sparse constituent weights, in shares of each name per
+// share of the ETF, one row per (basket, constituent):
+//
+//   # basket,constituent,shares
+//   XLF,JPM,0.0412
+//   XLF,BAC,0.1150
+//   XLF,CASH,0.0031     cash per ETF share (optional)
+//
+// NAV per ETF share is sum(shares * mid) + cash. An inverted index maps each
+// constituent to the baskets holding it, so a mid change touches only those
+// baskets: each one gets the change in that name's contribution, never a
+// re-sum. Contributions are rounded to fixed point before they are added, so
+// the running NAV is the exact sum of the current rounded terms and does not
+// drift however many updates it absorbs.
+//
+// A basket has a NAV once every constituent has had a two-sided book; its
+// premium is then (ETF mid - NAV) / NAV in basis points, positive when the
+// ETF trades rich.
+//
+// Each symbol's mid is written only by the worker applying that symbol's
+// events; NAVs are relaxed atomic sums, so workers on different symbols
+// update shared baskets without a lock and readers never wait.
+// =============================================================================
+
+struct BasketComponent {
+  std::string ticker;
+  double shares = 0.0;
+};
+
+struct BasketDef {
+  std::string ticker;  // The ETF itself
+  double cash = 0.0;
+  std::vector<BasketComponent> components;
+};
+
+struct BasketFile {
+  std::vector<BasketDef> baskets;
+
+  [[nodiscard]] size_t num_components() const {
+    size_t n = 0;
+    for (const auto &b : baskets) n += b.components.size();
+    return n;
+  }
+
+  // Duplicate rows for one (basket, constituent) add up
+  [[nodiscard]] static bool load(const std::string &path, BasketFile &out, std::string &err) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+      err = "cannot open " + path;
+      return false;
+    }
+    std::unordered_map<std::string, size_t> basket_pos;
+    std::unordered_map<std::string, size_t> component_pos;  // "basket,ticker"
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+      ++line_no;
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (line.empty() || line[0] == '#') continue;
+      std::stringstream ss(line);
+      std::string basket, ticker, shares_str;
+      std::getline(ss, basket, ',');
+      std::getline(ss, ticker, ',');
+      std::getline(ss, shares_str, ',');
+      char *end = nullptr;
+      const double shares = std::strtod(shares_str.c_str(), &end);
+      if (basket.empty() || ticker.empty() || shares_str.empty() || *end != '\0' ||
+          !std::isfinite(shares)) {
+        if (line_no == 1) continue;  // Column header
+        err = path + ":" + std::to_string(line_no) + ": want basket,constituent,shares";
+        return false;
+      }
+      auto [bit, added] = basket_pos.emplace(basket, out.baskets.size());
+      if (added) out.baskets.push_back(BasketDef{basket, 0.0, {}});
+      BasketDef &def = out.baskets[bit->second];
+      if (ticker == "CASH") {
+        def.cash += shares;
+        continue;
+      }
+      auto [cit, new_component] =
+          component_pos.emplace(basket + ',' + ticker, def.components.size());
+      if (new_component) {
+        def.components.push_back({ticker, shares});
+      } else {
+        def.components[cit->second].shares += shares;
+      }
+    }
+    if (out.baskets.empty()) {
+      err = path + ": no baskets";
+      return false;
+    }
+    return true;
+  }
+};
+
+// NAV and premium of one basket at the time of reading
+struct BasketQuote {
+  double nav = 0.0;      // Per ETF share (0 until every constituent is priced)
+  double etf_mid = 0.0;  // 0 until the ETF has a two-sided book
+  uint32_t priced = 0;   // Constituents with a mid so far
+  uint32_t components = 0;
+
+  [[nodiscard]] bool valid() const { return nav > 0.0 && etf_mid > 0.0; }
+  [[nodiscard]] double premium_bps() const {
+    return valid() ? (etf_mid - nav) / nav * 1e4 : 0.0;
+  }
+};
+
+class BasketEngine {
+public:
+  static constexpr double NAV_SCALE = 1e9;  // Fixed-point units per dollar
+
+  // Resolves tickers through the global symbol map, so build it after the
+  // map is loaded. Unknown tickers stay unpriced and keep their baskets
+  // from ever getting a NAV; see unresolved().
+  BasketEngine(const BasketFile &file, size_t num_symbols)
+      : num_symbols_(num_symbols),
+        mids_(std::make_unique<std::atomic<double>[]>(num_symbols)),
+        etf_basket_(num_symbols, -1),
+        offsets_(num_symbols + 1, 0),
+        baskets_(std::make_unique<Basket[]>(file.baskets.size())),
+        num_baskets_(file.baskets.size()) {
+    const auto &map = xdp::get_global_symbol_map();
+    auto resolve = [&](const std::string &ticker) -> int64_t {
+      const auto idx = map.find_index(ticker);
+      return idx && *idx < num_symbols ? static_cast<int64_t>(*idx) : -1;
+    };
+
+    // Count postings per symbol, then lay them out by symbol (CSR)
+    std::vector<std::vector<int64_t>> component_symbols(num_baskets_);
+    for (size_t b = 0; b < num_baskets_; ++b) {
+      const BasketDef &def = file.baskets[b];
+      Basket &basket = baskets_[b];
+      basket.ticker = def.ticker;
+      basket.components = static_cast<uint32_t>(def.components.size());
+      basket.missing.store(static_cast<int32_t>(def.components.size()), std::memory_order_relaxed);
+      basket.nav.store(fixed(def.cash), std::memory_order_relaxed);
+      const int64_t etf = resolve(def.ticker);
+      basket.etf_symbol = etf;
+      if (etf >= 0) etf_basket_[static_cast<size_t>(etf)] = static_cast<int32_t>(b);
+      for (const auto &c : def.components) {
+        const int64_t sym = resolve(c.ticker);
+        component_symbols[b].push_back(sym);
+        if (sym >= 0) {
+          offsets_[static_cast<size_t>(sym) + 1]++;
+        } else {
+          basket.unresolved++;
+        }
+      }
+    }
+    for (size_t s = 0; s < num_symbols; ++s) offsets_[s + 1] += offsets_[s];
+    postings_.resize(offsets_[num_symbols]);
+    std::vector<uint32_t> fill(offsets_.begin(), offsets_.end() - 1);
+    for (size_t b = 0; b < num_baskets_; ++b) {
+      const BasketDef &def = file.baskets[b];
+      for (size_t i = 0; i < def.components.size(); ++i) {
+        const int64_t sym = component_symbols[b][i];
+        if (sym < 0) continue;
+        postings_[fill[static_cast<size_t>(sym)]++] = {static_cast<uint32_t>(b),
+                                                       def.components[i].shares};
+      }
+    }
+  }
+
+  BasketEngine(const BasketEngine &) = delete;
+  BasketEngine &operator=(const BasketEngine &) = delete;
+
+  // New mid for a symbol (constituent, ETF, both or neither). Only the
+  // worker applying the symbol's events may call this. O(baskets holding
+  // the symbol); a symbol in no basket returns after one lookup.
+  void on_mid(uint32_t symbol_index, double mid) {
+    if (symbol_index >= num_symbols_ || mid <= 0.0) return;
+    const uint32_t begin = offsets_[symbol_index];
+    const uint32_t end = offsets_[symbol_index + 1];
+    if (begin == end && etf_basket_[symbol_index] < 0) return;
+    std::atomic<double> &slot = mids_[symbol_index];
+    const double old = slot.load(std::memory_order_relaxed);
+    if (mid == old) return;
+    slot.store(mid, std::memory_order_relaxed);
+    for (uint32_t i = begin; i < end; ++i) {
+      const Posting &p = postings_[i];
+      Basket &b = baskets_[p.basket];
+      b.nav.fetch_add(fixed(p.shares * mid) - fixed(p.shares * old), std::memory_order_relaxed);
+      if (old == 0.0) b.missing.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] size_t size() const { return num_baskets_; }
+  [[nodiscard]] size_t num_postings() const { return postings_.size(); }
+
+  // Basket whose ETF is this symbol, or -1
+  [[nodiscard]] int32_t basket_of_etf(uint32_t symbol_index) const {
+    return symbol_index < num_symbols_ ? etf_basket_[symbol_index] : -1;
+  }
+
+  // Number of baskets holding this symbol
+  [[nodiscard]] uint32_t baskets_holding(uint32_t symbol_index) const {
+    return symbol_index < num_symbols_ ? offsets_[symbol_index + 1] - offsets_[symbol_index] : 0;
+  }
+
+  [[nodiscard]] const std::string &ticker(size_t basket) const { return baskets_[basket].ticker; }
+  [[nodiscard]] uint32_t unresolved(size_t basket) const { return baskets_[basket].unresolved; }
+
+  [[nodiscard]] BasketQuote quote(size_t basket) const {
+    const Basket &b = baskets_[basket];
+    BasketQuote q;
+    q.components = b.components;
+    const int32_t missing = b.missing.load(std::memory_order_relaxed);
+    q.priced = b.components - static_cast<uint32_t>(std::max(missing, 0));
+    if (missing == 0) {
+      q.nav = static_cast<double>(b.nav.load(std::memory_order_relaxed)) / NAV_SCALE;
+    }
+    if (b.etf_symbol >= 0) {
+      q.etf_mid = mids_[static_cast<size_t>(b.etf_symbol)].load(std::memory_order_relaxed);
+    }
+    return q;
+  }
+
+  // Premium of the basket this symbol is the ETF of; false until it has one
+  [[nodiscard]] bool etf_premium_bps(uint32_t symbol_index, double &out) const {
+    const int32_t basket = basket_of_etf(symbol_index);
+    if (basket < 0) return false;
+    const Basket &b = baskets_[static_cast<size_t>(basket)];
+    const double etf_mid = mids_[symbol_index].load(std::memory_order_relaxed);
+    if (etf_mid <= 0.0 || b.missing.load(std::memory_order_relaxed) != 0) return false;
+    const double nav = static_cast<double>(b.nav.load(std::memory_order_relaxed)) / NAV_SCALE;
+    if (nav <= 0.0) return false;
+    out = (etf_mid - nav) / nav * 1e4;
+    return true;
+  }
+
+private:
+  struct Posting {
+    uint32_t basket;
+    double shares;
+  };
+
+  struct alignas(64) Basket {
+    std::atomic<int64_t> nav{0};     // Fixed point, cash included
+    std::atomic<int32_t> missing{0}; // Constituents never priced
+    uint32_t components = 0;
+    uint32_t unresolved = 0;
+    int64_t etf_symbol = -1;
+    std::string ticker;
+  };
+
+  static int64_t fixed(double dollars) { return std::llround(dollars * NAV_SCALE); }
+
+  size_t num_symbols_;
+  std::unique_ptr<std::atomic<double>[]> mids_;  // Last mid per symbol (0 = none)
+  std::vector<int32_t> etf_basket_;
+  std::vector<uint32_t> offsets_;  // Symbol -> [offsets_[s], offsets_[s+1]) in postings_
+  std::vector<Posting> postings_;
+  std::unique_ptr<Basket[]> baskets_;
+  size_t num_baskets_;
+};
+
+// Final NAV and premium per basket
+inline void print_basket_summary(std::ostream &os, const BasketEngine &engine) {
+  os << "\n=== BASKETS (" << engine.size() << " baskets, " << engine.num_postings()
+     << " constituent weights) ===\n";
+  os << std::left << std::setw(10) << "Basket" << std::right << std::setw(14) << "Priced"
+     << std::setw(12) << "NAV" << std::setw(12) << "ETF mid" << std::setw(12) << "Prem bps"
+     << '\n';
+  for (size_t b = 0; b < engine.size(); ++b) {
+    const BasketQuote q = engine.quote(b);
+    os << std::left << std::setw(10) << engine.ticker(b) << std::right << std::setw(14)
+       << (std::to_string(q.priced) + "/" + std::to_string(q.components)) << std::fixed
+       << std::setprecision(4) << std::setw(12) << q.nav << std::setw(12) << q.etf_mid;
+    if (q.valid()) {
+      os << std::setprecision(2) << std::setw(12) << q.premium_bps();
+    } else {
+      os << std::setw(12) << "-";
+    }
+    if (engine.unresolved(b)) os << "  (" << engine.unresolved(b) << " unknown tickers)";
+    os << '\n';
+    os.unsetf(std::ios::floatfield);
+  }
+}
+
+} // namespace mmsim
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace mmsim {
+
+// =============================================================================
+// Cross-symbol top-of-book table
+//
+// One cache line per symbol index holding the latest BBO, last trade and a
+// few book features, published by whichever worker is applying that
+// symbol's events (it holds the symbol's shard lock, so there is one writer
+// per entry at a time) and readable by any strategy on any thread without
+// taking that lock.
+//
+// Each entry is a seqlock: the writer makes the sequence odd, stores the
+// payload words, then makes it even again. A reader copies the words between
+// two loads of the sequence and keeps the copy if both loads are the same
+// even value. try_read() makes one attempt and never waits; read() retries,
+// which only happens while the owner is mid-publish. Payload words are
+// relaxed atomics, so a torn copy is discarded, never undefined.
+//
+// Entries carry the feed time of the event that produced them. Workers run
+// at their own pace (and hybrid groups are separate processes, each with its
+// own table covering its own files), so a reader compares ts_ns with its
+// own feed time to decide whether another symbol's state is fresh enough.
+// =============================================================================
+
+struct BboQuote {
+  uint64_t ts_ns = 0;        // Feed time of the last published change
+  double bid = 0.0;          // 0 = side empty
+  double ask = 0.0;
+  double last_price = 0.0;   // Last execution (0 = none yet)
+  uint32_t bid_qty = 0;
+  uint32_t ask_qty = 0;
+  uint32_t last_qty = 0;
+  float imbalance = 0.0f;    // (bid depth - ask depth) / total depth, whole book
+  float bid_toxicity = 0.0f; // Toxicity score of the best level
+  float ask_toxicity = 0.0f;
+
+  [[nodiscard]] double mid() const {
+    return bid > 0.0 && ask > 0.0 ? (bid + ask) / 2.0 : 0.0;
+  }
+  [[nodiscard]] double spread() const {
+    return bid > 0.0 && ask > 0.0 ? ask - bid : 0.0;
+  }
+};
+static_assert(sizeof(BboQuote) == 56, "BboQuote must fill a cache line with its sequence");
+static_assert(std::is_trivially_copyable_v<BboQuote>);
+
+class BboTable {
+public:
+  explicit BboTable(size_t num_symbols)
+      : entries_(std::make_unique<Entry[]>(num_symbols)), size_(num_symbols) {}
+
+  BboTable(const BboTable &) = delete;
+  BboTable &operator=(const BboTable &) = delete;
+
+  [[nodiscard]] size_t size() const { return size_; }
+
+  // Owner only (the worker holding the symbol's shard lock)
+  void publish(uint32_t symbol_index, const BboQuote &q) {
+    if (symbol_index >= size_) return;
+    Entry &e = entries_[symbol_index];
+    uint64_t words[WORDS];
+    std::memcpy(words, &q, sizeof(words));
+    const uint32_t seq = e.seq.load(std::memory_order_relaxed);
+    e.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; ++i) e.words[i].store(words[i], std::memory_order_relaxed);
+    e.seq.store(seq + 2, std::memory_order_release);
+  }
+
+  // One attempt; false if the symbol was never published or the owner was
+  // mid-publish
+  [[nodiscard]] bool try_read(uint32_t symbol_index, BboQuote &out) const {
+    if (symbol_index >= size_) return false;
+    const Entry &e = entries_[symbol_index];
+    const uint32_t before = e.seq.load(std::memory_order_acquire);
+    if (before == 0 || (before & 1)) return false;
+    uint64_t words[WORDS];
+    for (size_t i = 0; i < WORDS; ++i) words[i] = e.words[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (e.seq.load(std::memory_order_relaxed) != before) return false;
+    std::memcpy(&out, words, sizeof(words));
+    return true;
+  }
+
+  // Latest consistent quote (all zero if never published)
+  [[nodiscard]] BboQuote read(uint32_t symbol_index) const {
+    BboQuote q;
+    if (symbol_index >= size_) return q;
+    const Entry &e = entries_[symbol_index];
+    while (e.seq.load(std::memory_order_relaxed) != 0 && !try_read(symbol_index, q)) {
+    }
+    return q;
+  }
+
+  // Publishes so far (changes when the entry does)
+  [[nodiscard]] uint32_t version(uint32_t symbol_index) const {
+    return symbol_index < size_ ? entries_[symbol_index].seq.load(std::memory_order_acquire) / 2 : 0;
+  }
+
+private:
+  static constexpr size_t WORDS = sizeof(BboQuote) / sizeof(uint64_t);
+
+  struct alignas(64) Entry {
+    std::atomic<uint32_t> seq{0};
+    std::atomic<uint64_t> words[WORDS] = {};
+  };
+  static_assert(sizeof(Entry) == 64, "BboTable entry must be one cache line");
+
+  std::unique_ptr<Entry[]> entries_;
+  size_t size_;
+};
+
+} // namespace mmsim
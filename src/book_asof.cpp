@@ -0,0 +1,394 @@
+// book_asof.cpp - As-of order book reconstruction
+// `build` replays a day's PCAP files once and writes an .asof store: every
+// symbol's book events regrouped by symbol with periodic checkpoints.
+// `query` maps a store and rebuilds any symbol's book at any feed time from
+// the nearest prior checkpoint plus a bounded tail of events, serving many
+// queries concurrently from the shared read-only mapping.
+
+#include "book_asof.hpp"
+
+#include "common/mmap_pcap_reader.hpp"
+#include "common/session_calendar.hpp"
+#include "common/symbol_map.hpp"
+#include "common/thread_pool.hpp"
+#include "common/xdp_book_messages.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Query {
+  std::string ticker;
+  std::string time_text;
+  uint64_t ts_ns = 0;
+};
+
+// "[YYYY-MM-DD[T]]HH:MM:SS[.fraction]" in exchange-local time (the store's
+// date when none is given), or epoch nanoseconds
+bool parse_query_time(const std::string &text, int32_t default_date, uint64_t &ns,
+                      std::string &err) {
+  if (!text.empty() && text.find_first_not_of("0123456789") == std::string::npos) {
+    ns = std::stoull(text);
+    return true;
+  }
+  std::string main = text;
+  uint64_t frac_ns = 0;
+  const size_t colon = text.rfind(':');
+  const size_t dot = text.find('.', colon == std::string::npos ? 0 : colon);
+  if (colon != std::string::npos && dot != std::string::npos) {
+    main = text.substr(0, dot);
+    const std::string frac = text.substr(dot + 1);
+    if (frac.empty() || frac.size() > 9 || frac.find_first_not_of("0123456789") != std::string::npos) {
+      err = "bad fractional seconds in '" + text + "'";
+      return false;
+    }
+    frac_ns = std::stoull(frac);
+    for (size_t i = frac.size(); i < 9; ++i) frac_ns *= 10;
+  }
+  xdp::SessionCalendar::Bound b;
+  if (!xdp::SessionCalendar::parse_bound(main, b, err)) return false;
+  if (b.sec < 0) {
+    err = "missing time of day in '" + text + "'";
+    return false;
+  }
+  ns = xdp::SessionCalendar::local_to_ns(b.date != 0 ? b.date : default_date, b.sec) + frac_ns;
+  return true;
+}
+
+std::string format_time(const xdp::SessionCalendar &cal, uint64_t ns) {
+  const xdp::TradingSession *s = cal.find(ns);
+  if (!s) return std::to_string(ns);
+  char frac[16];
+  std::snprintf(frac, sizeof(frac), ".%06llu",
+                static_cast<unsigned long long>((ns % 1000000000ULL) / 1000ULL));
+  return xdp::SessionCalendar::format_date(s->date) + " " +
+         xdp::SessionCalendar::format_local(*s, ns) + frac;
+}
+
+void print_usage(const char *program) {
+  std::cerr << "As-of order book reconstruction\n\n"
+            << "Usage:\n"
+            << "  " << program << " build <pcap_file(s)> -o FILE.asof [options]\n"
+            << "  " << program << " query FILE.asof -t TICKER --at TIME [--at TIME ...] [options]\n\n"
+            << "build replays the day's PCAP files once and writes a store of every\n"
+            << "symbol's book events with periodic checkpoints. query rebuilds a\n"
+            << "symbol's book at any feed time from the nearest prior checkpoint.\n\n"
+            << "Build options:\n"
+            << "  -o, --output FILE       Store to write (required)\n"
+            << "  -s, --symbols FILE      Symbol map file (default: data/symbol_nyse_parsed.csv)\n"
+            << "  --block-events N        Events per block (default: 1024)\n"
+            << "  --checkpoint-events N   Checkpoint after this many events (default: 16384)\n"
+            << "  --checkpoint-sec S      ... or this much feed time (default: 60)\n\n"
+            << "Query options:\n"
+            << "  -t TICKER               Symbol to query\n"
+            << "  --at TIME               [YYYY-MM-DDT]HH:MM:SS[.ffffff] exchange-local\n"
+            << "                          (store date by default) or epoch ns; repeatable\n"
+            << "  -q, --queries FILE      Lines of 'TICKER TIME' to answer in one run\n"
+            << "  --depth N               Price levels printed per side (default: 10)\n"
+            << "  --orders                Also list resting orders at the printed levels\n"
+            << "  --threads N             Query threads (default: auto-detect all cores)\n\n"
+            << "Examples:\n"
+            << "  " << program << " build data/day/*.pcap -o day.asof\n"
+            << "  " << program << " query day.asof -t AAPL --at 10:31:07.123456\n";
+}
+
+int run_build(int argc, char *argv[]) {
+  std::vector<std::string> pcap_files;
+  std::string output;
+  std::string symbol_file = "data/symbol_nyse_parsed.csv";
+  xdp::AsofWriter::Options opts;
+
+  for (int i = 2; i < argc; i++) {
+    const std::string arg = argv[i];
+    if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+      output = argv[++i];
+    } else if ((arg == "-s" || arg == "--symbols") && i + 1 < argc) {
+      symbol_file = argv[++i];
+    } else if (arg == "--block-events" && i + 1 < argc) {
+      opts.block_events = static_cast<uint32_t>(std::max<unsigned long>(1, std::stoul(argv[++i])));
+    } else if (arg == "--checkpoint-events" && i + 1 < argc) {
+      opts.checkpoint_events = static_cast<uint32_t>(std::stoul(argv[++i]));
+    } else if (arg == "--checkpoint-sec" && i + 1 < argc) {
+      opts.checkpoint_interval_ns = static_cast<uint64_t>(std::stod(argv[++i]) * 1e9);
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg[0] != '-') {
+      pcap_files.push_back(arg);
+    }
+  }
+  if (pcap_files.empty() || output.empty()) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  // Sort PCAP files by name to ensure chronological order
+  std::sort(pcap_files.begin(), pcap_files.end());
+
+  if (!xdp::load_symbol_map(symbol_file)) {
+    std::cerr << "Warning: Could not load symbol file: " << symbol_file << "\n";
+  }
+
+  std::cerr << "=== As-of Store Build ===\n"
+            << "PCAP files: " << pcap_files.size() << "\n"
+            << "Block: " << opts.block_events << " events, checkpoint every "
+            << opts.checkpoint_events << " events or "
+            << (opts.checkpoint_interval_ns / 1000000000.0) << " s\n"
+            << "Output: " << output << "\n"
+            << "=========================\n" << std::flush;
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+
+  xdp::AsofWriter writer;
+  std::string error;
+  if (!writer.open(output, opts, error)) {
+    std::cerr << "Error: " << error << "\n";
+    return 1;
+  }
+
+  uint64_t packets = 0;
+  xdp::BookMessage msg;
+  for (const auto &path : pcap_files) {
+    xdp::MmapPcapReader reader;
+    if (!reader.open(path)) {
+      std::cerr << reader.error() << "\n";
+      continue;
+    }
+    packets += reader.process_all(
+        [&](const uint8_t *data, size_t len, uint64_t, const xdp::NetworkPacketInfo &info) {
+          xdp::for_each_message(data, len, [&](const uint8_t *m, size_t msg_len, uint16_t msg_type) {
+            if (xdp::decode_book_message(m, msg_len, msg_type, msg)) {
+              writer.add(msg, info.timestamp_ns);
+            }
+          });
+        });
+  }
+
+  const uint64_t events = writer.header().total_events;
+  const uint64_t checkpoints = writer.checkpoints_written();
+  if (!writer.close([](uint32_t idx) { return xdp::get_symbol(idx); }, error)) {
+    std::cerr << "Error: " << output << ": " << error << "\n";
+    return 1;
+  }
+
+  auto end_time = std::chrono::high_resolution_clock::now();
+  double seconds = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() / 1000.0;
+
+  xdp::AsofStore store;
+  if (!store.open(output, error)) {
+    std::cerr << "Error: " << error << "\n";
+    return 1;
+  }
+  std::ifstream sized(output, std::ios::binary | std::ios::ate);
+  std::cout << "Packets: " << packets << "\n"
+            << "Symbols: " << store.symbol_count() << "\n"
+            << "Events: " << events << "\n"
+            << "Checkpoints: " << checkpoints << "\n"
+            << "Store size: " << std::fixed << std::setprecision(1)
+            << static_cast<double>(sized.tellg()) / (1024.0 * 1024.0) << " MB\n"
+            << "Total time: " << std::setprecision(2) << seconds << " seconds\n";
+  return 0;
+}
+
+std::string render_book(const OrderBook &book, size_t depth, bool orders) {
+  std::vector<std::pair<double, uint32_t>> bids, asks;
+  book.get_top_levels(depth, bids, asks);
+  const auto stats = book.get_stats();
+
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(4);
+  out << "  Best Bid: $" << stats.best_bid << " | Best Ask: $" << stats.best_ask
+      << " | Spread: $" << stats.spread << " | Levels: " << stats.bid_levels << "/"
+      << stats.ask_levels << " | Qty: " << stats.total_bid_qty << "/" << stats.total_ask_qty
+      << "\n";
+  out << "  " << std::setw(10) << "BID QTY" << std::setw(12) << "BID" << "  |  " << std::left
+      << std::setw(12) << "ASK" << std::right << std::setw(10) << "ASK QTY" << "\n";
+  for (size_t i = 0; i < std::max(bids.size(), asks.size()); ++i) {
+    out << "  ";
+    if (i < bids.size()) {
+      out << std::setw(10) << bids[i].second << std::setw(12) << bids[i].first;
+    } else {
+      out << std::setw(22) << "";
+    }
+    out << "  |  ";
+    if (i < asks.size()) {
+      out << std::left << std::setw(12) << asks[i].first << std::right << std::setw(10)
+          << asks[i].second;
+    }
+    out << "\n";
+  }
+
+  if (orders) {
+    const double bid_floor = bids.empty() ? 0.0 : bids.back().first;
+    const double ask_ceil = asks.empty() ? 0.0 : asks.back().first;
+    const auto snap = book.get_atomic_snapshot();
+    std::vector<Order> shown;
+    for (const auto &[id, o] : snap.active_orders) {
+      if ((o.side == 'B' && o.price >= bid_floor && !bids.empty()) ||
+          (o.side == 'S' && o.price <= ask_ceil && !asks.empty())) {
+        shown.push_back(o);
+      }
+    }
+    // Price priority, then time priority within a level
+    std::sort(shown.begin(), shown.end(), [](const Order &a, const Order &b) {
+      if (a.side != b.side) return a.side < b.side;
+      if (a.price != b.price) return a.side == 'B' ? a.price > b.price : a.price < b.price;
+      return a.timestamp_ns < b.timestamp_ns;
+    });
+    out << "  Resting orders (" << shown.size() << "):\n";
+    for (const auto &o : shown) {
+      out << "    " << o.side << " " << std::setw(12) << o.price << std::setw(10) << o.volume
+          << "  id " << o.order_id << "  since " << o.timestamp_ns << "\n";
+    }
+  }
+  return out.str();
+}
+
+int run_query(int argc, char *argv[]) {
+  std::string store_path;
+  std::string ticker;
+  std::vector<std::string> times;
+  std::string queries_file;
+  size_t depth = 10;
+  bool orders = false;
+  size_t num_threads = 0;
+
+  for (int i = 2; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "-t" && i + 1 < argc) {
+      ticker = argv[++i];
+    } else if (arg == "--at" && i + 1 < argc) {
+      times.push_back(argv[++i]);
+    } else if ((arg == "-q" || arg == "--queries") && i + 1 < argc) {
+      queries_file = argv[++i];
+    } else if (arg == "--depth" && i + 1 < argc) {
+      depth = std::max<size_t>(1, std::stoull(argv[++i]));
+    } else if (arg == "--orders") {
+      orders = true;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      num_threads = std::stoull(argv[++i]);
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg[0] != '-' && store_path.empty()) {
+      store_path = arg;
+    }
+  }
+
+  std::vector<Query> queries;
+  for (const auto &t : times) queries.push_back({ticker, t, 0});
+  if (!queries_file.empty()) {
+    std::ifstream in(queries_file);
+    if (!in.is_open()) {
+      std::cerr << "Error: Could not open " << queries_file << "\n";
+      return 1;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream ls(line);
+      Query q;
+      if (ls >> q.ticker >> q.time_text && q.ticker[0] != '#') queries.push_back(q);
+    }
+  }
+  if (store_path.empty() || queries.empty() ||
+      std::any_of(queries.begin(), queries.end(), [](const Query &q) { return q.ticker.empty(); })) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  auto open_start = std::chrono::high_resolution_clock::now();
+  xdp::AsofStore store;
+  std::string error;
+  if (!store.open(store_path, error)) {
+    std::cerr << "Error: " << error << "\n";
+    return 1;
+  }
+  // Query times are read on the store's date, so an empty store has none
+  if (store.header().total_events == 0 || store.header().first_ts_ns == 0) {
+    std::cerr << "Error: " << store_path << " holds no book events\n";
+    return 1;
+  }
+  xdp::SessionCalendar calendar;
+  calendar.build(store.header().first_ts_ns, store.header().last_ts_ns, {});
+  const xdp::TradingSession *first_session = calendar.find(store.header().first_ts_ns);
+  if (!first_session) {
+    std::cerr << "Error: " << store_path << ": no session date for its first event\n";
+    return 1;
+  }
+  const int32_t store_date = first_session->date;
+
+  for (auto &q : queries) {
+    if (!parse_query_time(q.time_text, store_date, q.ts_ns, error)) {
+      std::cerr << "Error: " << error << "\n";
+      return 1;
+    }
+  }
+
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 4;
+  }
+  num_threads = std::min(num_threads, queries.size());
+
+  // Each query owns its book; the store mapping is shared read-only
+  std::vector<std::string> answers(queries.size());
+  std::vector<double> query_ms(queries.size(), 0.0);
+  {
+    xdp::ThreadPool pool(num_threads);
+    std::vector<std::future<void>> futures;
+    for (size_t qi = 0; qi < queries.size(); ++qi) {
+      futures.push_back(pool.enqueue([&, qi] {
+        const Query &q = queries[qi];
+        auto t0 = std::chrono::high_resolution_clock::now();
+        const xdp::AsofSymbol *sym = store.find(q.ticker);
+        std::ostringstream out;
+        out << q.ticker << " @ " << format_time(calendar, q.ts_ns);
+        if (!sym) {
+          out << ": not in store\n";
+        } else {
+          OrderBook book;
+          const auto r = store.query(sym->symbol_index, q.ts_ns, book);
+          const std::string body = render_book(book, depth, orders);
+          query_ms[qi] = std::chrono::duration<double, std::milli>(
+                             std::chrono::high_resolution_clock::now() - t0).count();
+          out << " (checkpoint "
+              << (r.checkpoint_ts_ns != 0 ? format_time(calendar, r.checkpoint_ts_ns) : "empty book") << ", "
+              << r.events_replayed << " events replayed";
+          if (r.last_event_ts_ns != 0) out << ", last event " << format_time(calendar, r.last_event_ts_ns);
+          out << ", " << std::fixed << std::setprecision(2) << query_ms[qi] << " ms)\n" << body;
+        }
+        answers[qi] = out.str();
+      }));
+    }
+    for (auto &f : futures) f.get();
+  }
+
+  for (const auto &a : answers) std::cout << a << "\n";
+
+  double total_ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::high_resolution_clock::now() - open_start).count();
+  double worst_ms = *std::max_element(query_ms.begin(), query_ms.end());
+  std::cerr << "Queries: " << queries.size() << " on " << num_threads << " threads, "
+            << std::fixed << std::setprecision(2) << total_ms << " ms total, worst "
+            << worst_ms << " ms\n";
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::string mode = argc > 1 ? argv[1] : "";
+  if (mode == "build") return run_build(argc, argv);
+  if (mode == "query") return run_query(argc, argv);
+  print_usage(argv[0]);
+  return mode == "-h" || mode == "--help" ? 0 : 1;
+}
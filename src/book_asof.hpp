@@ -0,0 +1,553 @@
+#pragma once
+
+#include "order_book.hpp"
+
+#include "common/xdp_book_messages.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace xdp {
+
+// =============================================================================
+// As-of book store (.asof)
+//
+// One file per trading day holding every symbol's book events (types 100-104)
+// regrouped by symbol, plus periodic book checkpoints, so the book of any
+// symbol at any feed time is rebuilt from the nearest prior checkpoint and a
+// bounded tail of events instead of a replay from the top of the capture:
+//
+//   [AsofHeader]
+//   { [AsofCheckpoint][AsofLevel x bids+asks][AsofOrder x orders] |
+//     [AsofEvent x block] }*            interleaved in arrival order
+//   [AsofSymbol x symbol_count]         sorted by symbol_index
+//   [AsofBlock x ...]                   each symbol's blocks, in feed order
+//
+// A symbol's events are cut into blocks of up to block_events. A block may
+// start with a checkpoint of the book as it stood before the block's first
+// event; one is taken when checkpoint_events events or checkpoint_interval_ns
+// of feed time have passed since the previous one, and the first block always
+// has one. A query therefore replays at most checkpoint_events + block_events
+// events. All offsets are absolute file offsets.
+// =============================================================================
+
+struct AsofHeader {
+  char magic[8] = {'X', 'D', 'P', 'A', 'S', 'O', 'F', '1'};
+  uint32_t version = 1;
+  uint32_t symbol_count = 0;
+  uint64_t first_ts_ns = 0;
+  uint64_t last_ts_ns = 0;
+  uint64_t directory_offset = 0;      // Patched on close; 0 = incomplete file
+  uint64_t total_events = 0;
+  uint32_t block_events = 0;
+  uint32_t checkpoint_events = 0;
+  uint64_t checkpoint_interval_ns = 0;
+};
+static_assert(sizeof(AsofHeader) == 64, "AsofHeader layout changed");
+
+// One book message, prices in raw 1e-6 units
+struct AsofEvent {
+  uint64_t ts_ns;
+  uint64_t order_id;
+  uint64_t new_order_id; // REPLACE_ORDER only
+  uint32_t price_raw;
+  uint32_t volume;
+  uint8_t type;          // MessageType - ADD_ORDER (0..4)
+  char side;
+  uint8_t reserved[6];
+};
+static_assert(sizeof(AsofEvent) == 40, "AsofEvent layout changed");
+
+struct AsofCheckpoint {
+  uint64_t ts_ns;        // Feed time of the last event applied before it
+  uint32_t bid_levels;
+  uint32_t ask_levels;
+  uint64_t order_count;
+};
+static_assert(sizeof(AsofCheckpoint) == 24, "AsofCheckpoint layout changed");
+
+struct AsofLevel {
+  uint32_t price_raw;
+  uint32_t qty;
+};
+
+struct AsofOrder {
+  uint64_t order_id;
+  uint64_t ts_ns;
+  uint32_t price_raw;
+  uint32_t volume;
+  char side;
+  uint8_t reserved[7];
+};
+static_assert(sizeof(AsofOrder) == 32, "AsofOrder layout changed");
+
+struct AsofSymbol {
+  uint32_t symbol_index;
+  uint32_t block_count;
+  uint64_t block_offset;
+  uint64_t event_count;
+  char ticker[16];
+};
+static_assert(sizeof(AsofSymbol) == 40, "AsofSymbol layout changed");
+
+struct AsofBlock {
+  uint64_t first_ts_ns;
+  uint64_t last_ts_ns;
+  uint64_t event_offset;
+  uint64_t checkpoint_offset; // 0 = no checkpoint at this block
+  uint32_t event_count;
+  uint32_t reserved;
+};
+static_assert(sizeof(AsofBlock) == 40, "AsofBlock layout changed");
+
+inline uint32_t to_asof_price(double price) {
+  return static_cast<uint32_t>(std::llround(price * 1e6));
+}
+
+inline bool to_asof_event(const BookMessage &msg, uint64_t ts_ns, AsofEvent &ev) {
+  if (msg.msg_type < static_cast<uint16_t>(MessageType::ADD_ORDER) ||
+      msg.msg_type > static_cast<uint16_t>(MessageType::REPLACE_ORDER))
+    return false;
+  ev = AsofEvent{};
+  ev.ts_ns = ts_ns;
+  ev.order_id = msg.order_id;
+  ev.new_order_id = msg.new_order_id;
+  ev.price_raw = msg.price_raw;
+  ev.volume = msg.volume;
+  ev.type = static_cast<uint8_t>(msg.msg_type - static_cast<uint16_t>(MessageType::ADD_ORDER));
+  ev.side = msg.side;
+  return true;
+}
+
+// Apply one event with the same semantics as the live book handlers
+inline void apply_asof_event(OrderBook &book, const AsofEvent &ev) {
+  const double price = parse_price(ev.price_raw);
+  switch (static_cast<uint16_t>(ev.type) + static_cast<uint16_t>(MessageType::ADD_ORDER)) {
+  case static_cast<uint16_t>(MessageType::ADD_ORDER):
+    book.add_order(ev.order_id, price, ev.volume, ev.side, ev.ts_ns);
+    break;
+  case static_cast<uint16_t>(MessageType::MODIFY_ORDER):
+    book.modify_order(ev.order_id, price, ev.volume, ev.ts_ns);
+    break;
+  case static_cast<uint16_t>(MessageType::DELETE_ORDER):
+    book.delete_order(ev.order_id, ev.ts_ns);
+    break;
+  case static_cast<uint16_t>(MessageType::EXECUTE_ORDER):
+    book.execute_order(ev.order_id, ev.volume, price, ev.ts_ns);
+    break;
+  case static_cast<uint16_t>(MessageType::REPLACE_ORDER):
+    book.delete_order(ev.order_id, ev.ts_ns);
+    book.add_order(ev.new_order_id, price, ev.volume, ev.side, ev.ts_ns);
+    break;
+  default:
+    break;
+  }
+}
+
+// Single-pass store builder. Feed every book message of the day in capture
+// order, then close(). Keeps one live book per symbol to take checkpoints.
+class AsofWriter {
+public:
+  struct Options {
+    uint32_t block_events = 1024;
+    uint32_t checkpoint_events = 16384;
+    uint64_t checkpoint_interval_ns = 60ULL * 1000000000ULL;
+  };
+
+  AsofWriter() = default;
+  ~AsofWriter() { abort(); }
+
+  AsofWriter(const AsofWriter &) = delete;
+  AsofWriter &operator=(const AsofWriter &) = delete;
+
+  bool open(const std::string &path, const Options &opts, std::string &error) {
+    abort();
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+      error = "cannot create " + path;
+      return false;
+    }
+    opts_ = opts;
+    opts_.block_events = std::max<uint32_t>(1, opts_.block_events);
+    header_ = AsofHeader{};
+    header_.block_events = opts_.block_events;
+    header_.checkpoint_events = opts_.checkpoint_events;
+    header_.checkpoint_interval_ns = opts_.checkpoint_interval_ns;
+    offset_ = 0;
+    buffer_.clear();
+    buffer_.reserve(BUFFER_BYTES + 4096);
+    symbols_.clear();
+    symbols_.resize(MAX_SYMBOLS + 1);
+    active_.clear();
+    append(&header_, sizeof(header_));
+    return true;
+  }
+
+  [[nodiscard]] bool is_open() const { return fd_ >= 0; }
+
+  // Record one message and apply it to the symbol's book
+  void add(const BookMessage &msg, uint64_t ts_ns) {
+    if (fd_ < 0 || msg.symbol_index == 0 || msg.symbol_index > MAX_SYMBOLS)
+      return;
+    AsofEvent ev;
+    if (!to_asof_event(msg, ts_ns, ev))
+      return;
+
+    auto &slot = symbols_[msg.symbol_index];
+    if (!slot) {
+      slot = std::make_unique<SymbolState>();
+      active_.push_back(msg.symbol_index);
+    }
+    SymbolState &s = *slot;
+    // Keep each symbol's events in non-decreasing time so blocks can be
+    // binary searched even if capture timestamps step backwards
+    ev.ts_ns = ts_ns = std::max(ts_ns, s.last_ts);
+
+    if (s.pending.empty()) {
+      // Block start: checkpoint the book as it stands before this event
+      s.block = AsofBlock{};
+      s.block.first_ts_ns = ts_ns;
+      if (s.blocks.empty() || s.since_checkpoint >= opts_.checkpoint_events ||
+          ts_ns - s.checkpoint_ts >= opts_.checkpoint_interval_ns) {
+        s.block.checkpoint_offset = write_checkpoint(s.book, s.last_ts);
+        s.since_checkpoint = 0;
+        s.checkpoint_ts = ts_ns;
+      }
+    }
+    s.pending.push_back(ev);
+    s.since_checkpoint++;
+    s.event_count++;
+    s.last_ts = ts_ns;
+    apply_asof_event(s.book, ev);
+    if (s.pending.size() >= opts_.block_events)
+      flush_block(s);
+
+    if (header_.total_events++ == 0)
+      header_.first_ts_ns = ts_ns;
+    header_.last_ts_ns = std::max(header_.last_ts_ns, ts_ns);
+  }
+
+  // Flush partial blocks, write the directory and finalize the header.
+  // `ticker_of` names each symbol_index for the directory.
+  template <typename TickerFn> bool close(TickerFn &&ticker_of, std::string &error) {
+    if (fd_ < 0) {
+      error = "store not open";
+      return false;
+    }
+    std::sort(active_.begin(), active_.end());
+    for (uint32_t idx : active_) {
+      if (!symbols_[idx]->pending.empty())
+        flush_block(*symbols_[idx]);
+    }
+
+    header_.symbol_count = static_cast<uint32_t>(active_.size());
+    header_.directory_offset = offset_;
+    uint64_t block_offset = offset_ + active_.size() * sizeof(AsofSymbol);
+    for (uint32_t idx : active_) {
+      const SymbolState &s = *symbols_[idx];
+      AsofSymbol entry{};
+      entry.symbol_index = idx;
+      entry.block_count = static_cast<uint32_t>(s.blocks.size());
+      entry.block_offset = block_offset;
+      entry.event_count = s.event_count;
+      const std::string ticker = ticker_of(idx);
+      std::strncpy(entry.ticker, ticker.c_str(), sizeof(entry.ticker) - 1);
+      append(&entry, sizeof(entry));
+      block_offset += s.blocks.size() * sizeof(AsofBlock);
+    }
+    for (uint32_t idx : active_) {
+      const auto &blocks = symbols_[idx]->blocks;
+      if (!blocks.empty())
+        append(blocks.data(), blocks.size() * sizeof(AsofBlock));
+    }
+    flush();
+
+    bool ok = !write_failed_ &&
+              ::pwrite(fd_, &header_, sizeof(header_), 0) == static_cast<ssize_t>(sizeof(header_));
+    ::close(fd_);
+    fd_ = -1;
+    symbols_.clear();
+    active_.clear();
+    if (!ok)
+      error = "write failed";
+    return ok;
+  }
+
+  // Drop an unfinished store (the header keeps directory_offset = 0)
+  void abort() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+    symbols_.clear();
+    active_.clear();
+  }
+
+  [[nodiscard]] const AsofHeader &header() const { return header_; }
+  [[nodiscard]] uint64_t checkpoints_written() const { return checkpoints_; }
+  [[nodiscard]] uint64_t bytes_written() const { return offset_; }
+
+private:
+  static constexpr uint32_t MAX_SYMBOLS = 100000;
+  static constexpr size_t BUFFER_BYTES = 1 << 20;
+
+  struct SymbolState {
+    OrderBook book;
+    std::vector<AsofEvent> pending;
+    std::vector<AsofBlock> blocks;
+    AsofBlock block{};
+    uint64_t since_checkpoint = 0;
+    uint64_t checkpoint_ts = 0;
+    uint64_t last_ts = 0;
+    uint64_t event_count = 0;
+  };
+
+  uint64_t write_checkpoint(const OrderBook &book, uint64_t ts_ns) {
+    const auto snap = book.get_atomic_snapshot();
+    AsofCheckpoint cp{};
+    cp.ts_ns = ts_ns;
+    cp.bid_levels = static_cast<uint32_t>(snap.bids.size());
+    cp.ask_levels = static_cast<uint32_t>(snap.asks.size());
+    cp.order_count = snap.active_orders.size();
+    const uint64_t at = offset_;
+    append(&cp, sizeof(cp));
+    for (const auto &[p, q] : snap.bids) {
+      AsofLevel lv{to_asof_price(p), q};
+      append(&lv, sizeof(lv));
+    }
+    for (const auto &[p, q] : snap.asks) {
+      AsofLevel lv{to_asof_price(p), q};
+      append(&lv, sizeof(lv));
+    }
+    for (const auto &[id, order] : snap.active_orders) {
+      AsofOrder o{};
+      o.order_id = id;
+      o.ts_ns = order.timestamp_ns;
+      o.price_raw = to_asof_price(order.price);
+      o.volume = order.volume;
+      o.side = order.side;
+      append(&o, sizeof(o));
+    }
+    checkpoints_++;
+    return at;
+  }
+
+  void flush_block(SymbolState &s) {
+    s.block.event_offset = offset_;
+    s.block.event_count = static_cast<uint32_t>(s.pending.size());
+    s.block.last_ts_ns = s.pending.back().ts_ns;
+    append(s.pending.data(), s.pending.size() * sizeof(AsofEvent));
+    s.blocks.push_back(s.block);
+    s.pending.clear();
+  }
+
+  void append(const void *data, size_t len) {
+    const auto *p = static_cast<const uint8_t *>(data);
+    buffer_.insert(buffer_.end(), p, p + len);
+    offset_ += len;
+    if (buffer_.size() >= BUFFER_BYTES)
+      flush();
+  }
+
+  void flush() {
+    const uint8_t *data = buffer_.data();
+    size_t remaining = buffer_.size();
+    while (remaining > 0) {
+      ssize_t n = ::write(fd_, data, remaining);
+      if (n <= 0) {
+        write_failed_ = true;
+        break;
+      }
+      data += n;
+      remaining -= static_cast<size_t>(n);
+    }
+    buffer_.clear();
+  }
+
+  int fd_ = -1;
+  Options opts_;
+  AsofHeader header_;
+  uint64_t offset_ = 0;
+  uint64_t checkpoints_ = 0;
+  bool write_failed_ = false;
+  std::vector<uint8_t> buffer_;
+  std::vector<std::unique_ptr<SymbolState>> symbols_;
+  std::vector<uint32_t> active_;
+};
+
+// Read-only memory-mapped store. query() only reads the mapping, so any
+// number of threads may query one AsofStore concurrently, each into its
+// own OrderBook.
+class AsofStore {
+public:
+  struct QueryResult {
+    bool found = false;            // Symbol present in the store
+    uint64_t checkpoint_ts_ns = 0; // Feed time the replay started from
+    uint64_t last_event_ts_ns = 0; // Last event applied (0 if none)
+    uint64_t events_replayed = 0;
+  };
+
+  AsofStore() = default;
+  ~AsofStore() { close(); }
+
+  AsofStore(const AsofStore &) = delete;
+  AsofStore &operator=(const AsofStore &) = delete;
+
+  bool open(const std::string &path, std::string &error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      error = "cannot open " + path;
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(AsofHeader)) {
+      ::close(fd);
+      error = "not an as-of store: " + path;
+      return false;
+    }
+    map_size_ = static_cast<size_t>(st.st_size);
+    void *map = mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+      map_size_ = 0;
+      error = "mmap failed for " + path;
+      return false;
+    }
+    map_ = static_cast<const uint8_t *>(map);
+    std::memcpy(&header_, map_, sizeof(header_));
+    if (std::memcmp(header_.magic, AsofHeader{}.magic, sizeof(header_.magic)) != 0 ||
+        header_.version != 1) {
+      close();
+      error = "bad magic or version in " + path;
+      return false;
+    }
+    if (header_.directory_offset == 0 ||
+        header_.directory_offset + header_.symbol_count * sizeof(AsofSymbol) > map_size_) {
+      close();
+      error = "incomplete store (build did not finish): " + path;
+      return false;
+    }
+    symbols_ = reinterpret_cast<const AsofSymbol *>(map_ + header_.directory_offset);
+    for (uint32_t i = 0; i < header_.symbol_count; ++i) {
+      if (symbols_[i].block_offset + symbols_[i].block_count * sizeof(AsofBlock) > map_size_) {
+        close();
+        error = "corrupt symbol directory in " + path;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void close() {
+    if (map_)
+      munmap(const_cast<uint8_t *>(map_), map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    symbols_ = nullptr;
+    header_ = AsofHeader{};
+  }
+
+  [[nodiscard]] const AsofHeader &header() const { return header_; }
+  [[nodiscard]] size_t symbol_count() const { return map_ ? header_.symbol_count : 0; }
+  [[nodiscard]] const AsofSymbol &symbol_at(size_t i) const { return symbols_[i]; }
+
+  [[nodiscard]] const AsofSymbol *find(uint32_t symbol_index) const {
+    if (!map_)
+      return nullptr;
+    const AsofSymbol *end = symbols_ + header_.symbol_count;
+    const AsofSymbol *it = std::lower_bound(
+        symbols_, end, symbol_index,
+        [](const AsofSymbol &s, uint32_t idx) { return s.symbol_index < idx; });
+    return it != end && it->symbol_index == symbol_index ? it : nullptr;
+  }
+
+  [[nodiscard]] const AsofSymbol *find(const std::string &ticker) const {
+    for (size_t i = 0; i < symbol_count(); ++i) {
+      if (ticker == std::string(symbols_[i].ticker, strnlen(symbols_[i].ticker, sizeof(symbols_[i].ticker))))
+        return &symbols_[i];
+    }
+    return nullptr;
+  }
+
+  // Rebuild `book` as of feed time ts_ns (events stamped <= ts_ns applied).
+  // Event-history features (toxicity counters, order-age histograms) start
+  // from the checkpoint; levels and resting orders are exact.
+  QueryResult query(uint32_t symbol_index, uint64_t ts_ns, OrderBook &book) const {
+    QueryResult r;
+    book.clear();
+    const AsofSymbol *sym = find(symbol_index);
+    if (!sym)
+      return r;
+    r.found = true;
+    const AsofBlock *blocks = reinterpret_cast<const AsofBlock *>(map_ + sym->block_offset);
+    const AsofBlock *end = blocks + sym->block_count;
+    const AsofBlock *it = std::upper_bound(
+        blocks, end, ts_ns, [](uint64_t t, const AsofBlock &b) { return t < b.first_ts_ns; });
+    if (it == blocks)
+      return r; // Before the symbol's first event: empty book
+    const AsofBlock *last = it - 1;
+    const AsofBlock *cp = last;
+    while (cp > blocks && cp->checkpoint_offset == 0)
+      --cp;
+    if (cp->checkpoint_offset != 0)
+      r.checkpoint_ts_ns = restore(*cp, book);
+
+    for (const AsofBlock *b = cp; b <= last; ++b) {
+      const auto *ev = reinterpret_cast<const AsofEvent *>(map_ + b->event_offset);
+      for (uint32_t i = 0; i < b->event_count; ++i) {
+        if (ev[i].ts_ns > ts_ns)
+          return r;
+        apply_asof_event(book, ev[i]);
+        r.last_event_ts_ns = ev[i].ts_ns;
+        r.events_replayed++;
+      }
+    }
+    return r;
+  }
+
+private:
+  uint64_t restore(const AsofBlock &block, OrderBook &book) const {
+    const uint8_t *p = map_ + block.checkpoint_offset;
+    AsofCheckpoint cp;
+    std::memcpy(&cp, p, sizeof(cp));
+    p += sizeof(cp);
+    const auto *levels = reinterpret_cast<const AsofLevel *>(p);
+    const auto *orders = reinterpret_cast<const AsofOrder *>(levels + cp.bid_levels + cp.ask_levels);
+
+    std::map<double, uint32_t, std::greater<double>> bids;
+    std::map<double, uint32_t, std::less<double>> asks;
+    std::unordered_map<uint64_t, Order> active;
+    for (uint32_t i = 0; i < cp.bid_levels; ++i)
+      bids.emplace_hint(bids.end(), parse_price(levels[i].price_raw), levels[i].qty);
+    for (uint32_t i = 0; i < cp.ask_levels; ++i) {
+      const AsofLevel &lv = levels[cp.bid_levels + i];
+      asks.emplace_hint(asks.end(), parse_price(lv.price_raw), lv.qty);
+    }
+    active.reserve(cp.order_count);
+    for (uint64_t i = 0; i < cp.order_count; ++i) {
+      const AsofOrder &o = orders[i];
+      active.emplace(o.order_id, Order{o.order_id, parse_price(o.price_raw), o.volume, o.side, o.ts_ns});
+    }
+    book.restore_from_snapshot(bids, asks, active);
+    return cp.ts_ns;
+  }
+
+  const uint8_t *map_ = nullptr;
+  size_t map_size_ = 0;
+  const AsofSymbol *symbols_ = nullptr;
+  AsofHeader header_;
+};
+
+} // namespace xdp
@@ -0,0 +1,658 @@
+// book_heatmap.cpp - Headless order book depth heatmap exporter
+// Replays PCAP files and rasterizes depth-by-price-over-time heatmaps with
+// trade, BBO and toxicity overlays to PNG. No display or GPU required.
+//
+// A single reader streams and decodes every input file once and fans each
+// book message out over an SPSC ring to the worker thread that owns its
+// symbol, so packet parsing happens once however many workers rebuild books.
+
+#include "order_book.hpp"
+
+#include "common/mmap_pcap_reader.hpp"
+#include "common/png_writer.hpp"
+#include "common/spsc_ring.hpp"
+#include "common/symbol_map.hpp"
+#include "common/thread_pool.hpp"
+#include "common/xdp_book_messages.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t MAX_SYMBOLS = 100000;
+constexpr uint16_t NO_OWNER = 0xFFFF;
+constexpr size_t BATCH_MESSAGES = 512;  // Messages per ring slot
+constexpr size_t RING_BATCHES = 64;     // Slots per worker ring
+
+struct HeatmapConfig {
+  std::string output_dir = "heatmaps";
+  uint64_t bin_ns = 10ULL * 1000000000ULL; // Time column width
+  size_t depth_levels = 20;                // Price levels sampled per side
+  uint32_t height = 400;                   // Price rows
+  uint32_t toxicity_rows = 24;             // Toxicity strip below the heatmap
+  uint32_t max_width = 4096;               // Wider days merge columns per pixel
+  double min_row_price = 0.01;             // Never resolve finer than a cent
+};
+
+// Executions within one column, kept as totals so a full day of trades
+// costs a fixed few bytes per column
+struct TradeAgg {
+  uint32_t count = 0;
+  uint64_t volume = 0;
+  double notional = 0.0;
+
+  void add(double price, uint64_t qty) {
+    count++;
+    volume += qty;
+    notional += price * static_cast<double>(qty);
+  }
+  void merge(const TradeAgg &o) {
+    count += o.count;
+    volume += o.volume;
+    notional += o.notional;
+  }
+  [[nodiscard]] double vwap() const noexcept {
+    return volume ? notional / static_cast<double>(volume) : 0.0;
+  }
+};
+
+// One time column of the streaming accumulation buffer. Depth samples for
+// the column live in a shared flat buffer to keep per-column overhead small.
+struct Column {
+  float best_bid = 0.0f;
+  float best_ask = 0.0f;
+  float toxicity = 0.0f;
+  uint32_t level_begin = 0;
+  uint16_t num_bids = 0;
+  uint16_t num_asks = 0;
+  TradeAgg trades;
+};
+
+struct LevelSample {
+  float price;
+  uint32_t qty;
+};
+
+
+// RGB helpers
+struct Rgb {
+  uint8_t r, g, b;
+};
+
+inline void put_pixel(std::vector<uint8_t> &img, uint32_t width, uint32_t x,
+                      uint32_t y, Rgb c) {
+  size_t off = (static_cast<size_t>(y) * width + x) * 3;
+  img[off] = c.r;
+  img[off + 1] = c.g;
+  img[off + 2] = c.b;
+}
+
+// Per-symbol replay state: the live book plus the column buffer
+class SymbolHeatmap {
+public:
+  SymbolHeatmap(uint32_t symbol_index, const HeatmapConfig &config)
+      : symbol_index_(symbol_index), config_(config) {
+    bid_scratch_.reserve(config.depth_levels);
+    ask_scratch_.reserve(config.depth_levels);
+  }
+
+  void on_message(const xdp::BookMessage &msg, uint64_t ts_ns) {
+    advance_to(ts_ns);
+    messages_++;
+
+    switch (msg.msg_type) {
+    case static_cast<uint16_t>(xdp::MessageType::ADD_ORDER):
+      book_.add_order(msg.order_id, msg.price(), msg.volume, msg.side, ts_ns);
+      break;
+    case static_cast<uint16_t>(xdp::MessageType::MODIFY_ORDER):
+      book_.modify_order(msg.order_id, msg.price(), msg.volume, ts_ns);
+      break;
+    case static_cast<uint16_t>(xdp::MessageType::DELETE_ORDER):
+      book_.delete_order(msg.order_id, ts_ns);
+      break;
+    case static_cast<uint16_t>(xdp::MessageType::EXECUTE_ORDER):
+      open_trades_.add(msg.price(), msg.volume);
+      book_.execute_order(msg.order_id, msg.volume, msg.price(), ts_ns);
+      break;
+    case static_cast<uint16_t>(xdp::MessageType::REPLACE_ORDER):
+      book_.delete_order(msg.order_id, ts_ns);
+      book_.add_order(msg.new_order_id, msg.price(), msg.volume, msg.side, ts_ns);
+      break;
+    default:
+      break;
+    }
+  }
+
+  // Close the column that is still open at end of stream
+  void finish() {
+    if (started_) {
+      sample_column();
+      started_ = false;
+    }
+  }
+
+  [[nodiscard]] uint32_t symbol_index() const noexcept { return symbol_index_; }
+  [[nodiscard]] size_t num_columns() const noexcept { return columns_.size(); }
+  [[nodiscard]] uint64_t num_messages() const noexcept { return messages_; }
+
+  // Rasterize the accumulated columns and write <ticker>_heatmap.png plus a
+  // small JSON sidecar describing the axes.
+  [[nodiscard]] bool write(const std::string &ticker, std::string &error) const {
+    // Price axis: span of the touch over the day plus padding, so the
+    // image focuses on liquidity near the market rather than stale orders.
+    double lo = 0.0, hi = 0.0;
+    bool have_range = false;
+    for (const auto &col : columns_) {
+      if (col.best_bid <= 0.0f || col.best_ask <= 0.0f) continue;
+      if (!have_range) {
+        lo = col.best_bid;
+        hi = col.best_ask;
+        have_range = true;
+      } else {
+        lo = std::min(lo, static_cast<double>(col.best_bid));
+        hi = std::max(hi, static_cast<double>(col.best_ask));
+      }
+    }
+    if (!have_range) {
+      error = "no two-sided book observed";
+      return false;
+    }
+
+    const uint32_t rows = config_.height;
+    double pad = std::max((hi - lo) * 0.1, config_.min_row_price * rows * 0.05);
+    lo = std::max(0.0, lo - pad);
+    hi = hi + pad;
+    double row_price = std::max((hi - lo) / rows, config_.min_row_price);
+    hi = lo + row_price * rows;
+
+    // Days with more columns than max_width merge `per_px` adjacent columns
+    // into each pixel: depth and toxicity are averaged, trades summed
+    const size_t num_cols = columns_.size();
+    const size_t per_px = std::max<size_t>(1, (num_cols + config_.max_width - 1) / config_.max_width);
+    const uint32_t width = static_cast<uint32_t>((num_cols + per_px - 1) / per_px);
+    const uint32_t height = rows + config_.toxicity_rows;
+    auto cols_in = [&](uint32_t x) -> double {
+      return static_cast<double>(std::min(per_px, num_cols - x * per_px));
+    };
+
+    auto price_to_row = [&](double price) -> int {
+      // Row 0 is the top of the image (highest price)
+      double r = (hi - price) / row_price;
+      if (r < 0.0 || r >= rows) return -1;
+      return static_cast<int>(r);
+    };
+
+    // Accumulate depth per cell, then map log(mean qty) to intensity
+    std::vector<uint64_t> bid_qty(static_cast<size_t>(width) * rows, 0);
+    std::vector<uint64_t> ask_qty(static_cast<size_t>(width) * rows, 0);
+    std::vector<TradeAgg> trades(width);
+    std::vector<double> toxicity(width, 0.0);
+    for (size_t c = 0; c < num_cols; ++c) {
+      const Column &col = columns_[c];
+      const uint32_t x = static_cast<uint32_t>(c / per_px);
+      const LevelSample *lv = levels_.data() + col.level_begin;
+      for (uint16_t i = 0; i < col.num_bids; ++i) {
+        int row = price_to_row(lv[i].price);
+        if (row >= 0) bid_qty[static_cast<size_t>(row) * width + x] += lv[i].qty;
+      }
+      lv += col.num_bids;
+      for (uint16_t i = 0; i < col.num_asks; ++i) {
+        int row = price_to_row(lv[i].price);
+        if (row >= 0) ask_qty[static_cast<size_t>(row) * width + x] += lv[i].qty;
+      }
+      trades[x].merge(col.trades);
+      toxicity[x] += col.toxicity;
+    }
+
+    double max_qty = 1.0;
+    for (uint32_t y = 0; y < rows; ++y) {
+      for (uint32_t x = 0; x < width; ++x) {
+        size_t cell = static_cast<size_t>(y) * width + x;
+        max_qty = std::max(max_qty, std::max(bid_qty[cell], ask_qty[cell]) / cols_in(x));
+      }
+    }
+    const double log_max = std::log1p(max_qty);
+
+    std::vector<uint8_t> img(static_cast<size_t>(width) * height * 3, 0);
+    for (uint32_t y = 0; y < rows; ++y) {
+      for (uint32_t x = 0; x < width; ++x) {
+        size_t cell = static_cast<size_t>(y) * width + x;
+        double bid_i = bid_qty[cell] ? std::log1p(bid_qty[cell] / cols_in(x)) / log_max : 0.0;
+        double ask_i = ask_qty[cell] ? std::log1p(ask_qty[cell] / cols_in(x)) / log_max : 0.0;
+        if (bid_i == 0.0 && ask_i == 0.0) continue;
+        // Bids in blue/teal, asks in orange; crossed cells blend
+        Rgb c{static_cast<uint8_t>(std::min(255.0, 230.0 * ask_i)),
+              static_cast<uint8_t>(std::min(255.0, 140.0 * bid_i + 90.0 * ask_i)),
+              static_cast<uint8_t>(std::min(255.0, 230.0 * bid_i))};
+        put_pixel(img, width, x, y, c);
+      }
+    }
+
+    // BBO overlay: a merged pixel shows every touch price its columns held
+    for (size_t c = 0; c < num_cols; ++c) {
+      const Column &col = columns_[c];
+      const uint32_t x = static_cast<uint32_t>(c / per_px);
+      int bid_row = col.best_bid > 0.0f ? price_to_row(col.best_bid) : -1;
+      int ask_row = col.best_ask > 0.0f ? price_to_row(col.best_ask) : -1;
+      if (bid_row >= 0) put_pixel(img, width, x, static_cast<uint32_t>(bid_row), {80, 255, 80});
+      if (ask_row >= 0) put_pixel(img, width, x, static_cast<uint32_t>(ask_row), {255, 80, 80});
+    }
+
+    // Trade overlay: one dot at each pixel's VWAP, brighter with volume
+    uint64_t max_trade = 1;
+    for (const auto &t : trades) max_trade = std::max(max_trade, t.volume);
+    const double log_max_trade = std::log1p(static_cast<double>(max_trade));
+    for (uint32_t x = 0; x < width; ++x) {
+      if (trades[x].volume == 0) continue;
+      int row = price_to_row(trades[x].vwap());
+      if (row < 0) continue;
+      double v = 0.5 + 0.5 * std::log1p(static_cast<double>(trades[x].volume)) / log_max_trade;
+      put_pixel(img, width, x, static_cast<uint32_t>(row),
+                {static_cast<uint8_t>(255 * v), static_cast<uint8_t>(230 * v), 0});
+    }
+
+    // Toxicity strip: green (low) to red (high), same ramp as the visualizer
+    for (uint32_t x = 0; x < width; ++x) {
+      double tox = std::clamp(toxicity[x] / cols_in(x), 0.0, 1.0);
+      Rgb c{static_cast<uint8_t>(tox * 255), static_cast<uint8_t>((1.0 - tox) * 255), 0};
+      for (uint32_t y = rows + 1; y < height; ++y) {
+        put_pixel(img, width, x, y, c);
+      }
+    }
+
+    std::string base = config_.output_dir + "/" + ticker + "_heatmap";
+    if (!xdp::write_png_rgb(base + ".png", width, height, img)) {
+      error = "failed to write " + base + ".png";
+      return false;
+    }
+
+    std::ofstream meta(base + ".json");
+    if (!meta.is_open()) {
+      error = "failed to write " + base + ".json";
+      return false;
+    }
+    meta << std::fixed << std::setprecision(6)
+         << "{\n"
+         << "  \"symbol\": \"" << ticker << "\",\n"
+         << "  \"symbol_index\": " << symbol_index_ << ",\n"
+         << "  \"start_time_ns\": " << first_bin_ * config_.bin_ns << ",\n"
+         << "  \"bin_ns\": " << config_.bin_ns << ",\n"
+         << "  \"columns\": " << num_cols << ",\n"
+         << "  \"width\": " << width << ",\n"
+         << "  \"columns_per_pixel\": " << per_px << ",\n"
+         << "  \"price_top\": " << hi << ",\n"
+         << "  \"price_bottom\": " << lo << ",\n"
+         << "  \"price_rows\": " << rows << ",\n"
+         << "  \"toxicity_rows\": " << config_.toxicity_rows << ",\n"
+         << "  \"max_cell_qty\": " << max_qty << ",\n"
+         << "  \"trades\": " << total_trades_.count << ",\n"
+         << "  \"trade_volume\": " << total_trades_.volume << ",\n"
+         << "  \"messages\": " << messages_ << "\n"
+         << "}\n";
+    return true;
+  }
+
+private:
+  // Close every column that ends at or before ts_ns. Gaps with no messages
+  // repeat the (unchanged) book state.
+  void advance_to(uint64_t ts_ns) {
+    uint64_t bin = ts_ns / config_.bin_ns;
+    if (!started_) {
+      started_ = true;
+      first_bin_ = bin;
+      current_bin_ = bin;
+      return;
+    }
+    while (current_bin_ < bin) {
+      sample_column();
+      current_bin_++;
+    }
+  }
+
+  void sample_column() {
+    Column col;
+    auto snap = book_.get_snapshot();
+    col.best_bid = static_cast<float>(snap.stats.best_bid);
+    col.best_ask = static_cast<float>(snap.stats.best_ask);
+
+    double tox_sum = 0.0;
+    int tox_n = 0;
+    for (int i = 0; i < snap.num_bid_levels; ++i, ++tox_n) tox_sum += snap.bid_levels[i].toxicity_score;
+    for (int i = 0; i < snap.num_ask_levels; ++i, ++tox_n) tox_sum += snap.ask_levels[i].toxicity_score;
+    col.toxicity = tox_n > 0 ? static_cast<float>(tox_sum / tox_n) : 0.0f;
+
+    book_.get_top_levels(config_.depth_levels, bid_scratch_, ask_scratch_);
+    col.level_begin = static_cast<uint32_t>(levels_.size());
+    col.num_bids = static_cast<uint16_t>(bid_scratch_.size());
+    col.num_asks = static_cast<uint16_t>(ask_scratch_.size());
+    col.trades = open_trades_;
+    total_trades_.merge(open_trades_);
+    open_trades_ = {};
+    for (const auto &[price, qty] : bid_scratch_) levels_.push_back({static_cast<float>(price), qty});
+    for (const auto &[price, qty] : ask_scratch_) levels_.push_back({static_cast<float>(price), qty});
+
+    columns_.push_back(col);
+  }
+
+  uint32_t symbol_index_;
+  const HeatmapConfig &config_;
+  OrderBook book_;
+
+  bool started_ = false;
+  uint64_t first_bin_ = 0;
+  uint64_t current_bin_ = 0;
+  uint64_t messages_ = 0;
+
+  std::vector<Column> columns_;
+  std::vector<LevelSample> levels_;
+  TradeAgg open_trades_;   // Executions in the column still open
+  TradeAgg total_trades_;
+  std::vector<std::pair<double, uint32_t>> bid_scratch_;
+  std::vector<std::pair<double, uint32_t>> ask_scratch_;
+};
+
+struct WorkerResult {
+  size_t symbols_written = 0;
+  size_t symbols_skipped = 0;
+};
+
+struct TimedMessage {
+  xdp::BookMessage msg;
+  uint64_t ts_ns;
+};
+
+// One ring slot: a run of messages for one worker, in feed order
+struct MessageBatch {
+  std::vector<TimedMessage> messages;
+  bool last = false;  // No more batches follow
+};
+
+using BatchRing = xdp::SpscRing<MessageBatch>;
+
+// Stream and decode every file once, handing each book message to the
+// worker that owns its symbol (owner[symbol_index]). Ends every ring with a
+// `last` batch. Returns the number of packets read.
+uint64_t decode_files(const std::vector<std::string> &pcap_files,
+                      const std::vector<uint16_t> &owner,
+                      std::vector<std::unique_ptr<BatchRing>> &rings) {
+  uint64_t packets = 0;
+  std::vector<MessageBatch *> open(rings.size(), nullptr);
+  auto batch_for = [&](size_t w) -> MessageBatch & {
+    if (!open[w]) {
+      open[w] = &rings[w]->acquire();
+      open[w]->messages.clear();
+      open[w]->last = false;
+    }
+    return *open[w];
+  };
+
+  xdp::BookMessage msg;
+  for (const auto &path : pcap_files) {
+    xdp::MmapPcapReader reader;
+    if (!reader.open(path)) {
+      std::cerr << "[Reader] " << reader.error() << "\n";
+      continue;
+    }
+    packets += reader.process_all(
+        [&](const uint8_t *data, size_t len, uint64_t, const xdp::NetworkPacketInfo &info) {
+          xdp::for_each_message(data, len, [&](const uint8_t *m, size_t msg_len, uint16_t msg_type) {
+            if (msg_type < static_cast<uint16_t>(xdp::MessageType::ADD_ORDER) ||
+                msg_type > static_cast<uint16_t>(xdp::MessageType::REPLACE_ORDER) ||
+                msg_len < 12) {
+              return;
+            }
+            uint32_t symbol_index = xdp::read_le32(m + 8);
+            if (symbol_index == 0 || symbol_index > MAX_SYMBOLS) return;
+            const uint16_t w = owner[symbol_index];
+            if (w == NO_OWNER) return;
+            if (!xdp::decode_book_message(m, msg_len, msg_type, msg)) return;
+
+            MessageBatch &batch = batch_for(w);
+            batch.messages.push_back({msg, info.timestamp_ns});
+            if (batch.messages.size() >= BATCH_MESSAGES) {
+              rings[w]->commit();
+              open[w] = nullptr;
+            }
+          });
+        });
+  }
+
+  for (size_t w = 0; w < rings.size(); ++w) {
+    batch_for(w).last = true;
+    rings[w]->commit();
+  }
+  return packets;
+}
+
+// Build heatmaps for the symbols whose messages arrive on `ring`, then
+// write them once the reader signals the end of the stream
+WorkerResult run_worker(size_t worker_idx, BatchRing &ring, const HeatmapConfig &config,
+                        size_t min_columns) {
+  WorkerResult result;
+  std::vector<std::unique_ptr<SymbolHeatmap>> maps(MAX_SYMBOLS + 1);
+  std::vector<uint32_t> active;
+
+  for (;;) {
+    MessageBatch &batch = ring.front();
+    for (const auto &tm : batch.messages) {
+      auto &slot = maps[tm.msg.symbol_index];
+      if (!slot) {
+        slot = std::make_unique<SymbolHeatmap>(tm.msg.symbol_index, config);
+        active.push_back(tm.msg.symbol_index);
+      }
+      slot->on_message(tm.msg, tm.ts_ns);
+    }
+    const bool last = batch.last;
+    ring.pop();
+    if (last) break;
+  }
+
+  std::sort(active.begin(), active.end());
+  for (uint32_t idx : active) {
+    auto &hm = maps[idx];
+    hm->finish();
+    std::string ticker = xdp::get_symbol(idx);
+    if (hm->num_columns() < min_columns) {
+      result.symbols_skipped++;
+    } else {
+      std::string error;
+      if (hm->write(ticker, error)) {
+        result.symbols_written++;
+      } else {
+        std::cerr << "[Worker " << (worker_idx + 1) << "] " << ticker << ": " << error << "\n";
+        result.symbols_skipped++;
+      }
+    }
+    hm.reset();  // Release column buffers as soon as the image is written
+  }
+  return result;
+}
+
+void print_usage(const char *program) {
+  std::cerr << "Headless order book heatmap exporter\n\n"
+            << "Usage: " << program << " <pcap_file(s)> [options]\n\n"
+            << "Replays PCAP files and writes <TICKER>_heatmap.png (depth by price\n"
+            << "over time with BBO, trade and toxicity overlays) plus a JSON sidecar\n"
+            << "with the axis ranges.\n\n"
+            << "Options:\n"
+            << "  -t TICKER[,TICKER]  Symbols to render (repeatable)\n"
+            << "  --all               Render every symbol seen in the files\n"
+            << "  -s, --symbols FILE  Symbol map file (default: data/symbol_nyse_parsed.csv)\n"
+            << "  -o, --output-dir DIR  Output directory (default: heatmaps)\n"
+            << "  --bin-ms N          Time column width in milliseconds (default: 10000)\n"
+            << "  --height N          Price rows (default: 400)\n"
+            << "  --max-width N       Widest image in pixels; longer days merge columns\n"
+            << "                      per pixel (default: 4096)\n"
+            << "  --depth-levels N    Price levels sampled per side (default: 20)\n"
+            << "  --min-columns N     Skip symbols with fewer columns (default: 2)\n"
+            << "  --threads N         Worker threads (default: auto-detect all cores)\n\n"
+            << "Examples:\n"
+            << "  " << program << " data/day/*.pcap -t AAPL,MSFT\n"
+            << "  " << program << " data/day/*.pcap --all --bin-ms 30000 -o heatmaps/day\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> pcap_files;
+  std::vector<std::string> tickers;
+  std::string symbol_file = "data/symbol_nyse_parsed.csv";
+  HeatmapConfig config;
+  bool all_symbols = false;
+  size_t num_threads = 0;
+  size_t min_columns = 2;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    try {
+      if (arg == "-t" && i + 1 < argc) {
+        std::stringstream ss(argv[++i]);
+        std::string t;
+        while (std::getline(ss, t, ',')) {
+          if (!t.empty()) tickers.push_back(t);
+        }
+      } else if (arg == "--all") {
+        all_symbols = true;
+      } else if ((arg == "-s" || arg == "--symbols") && i + 1 < argc) {
+        symbol_file = argv[++i];
+      } else if ((arg == "-o" || arg == "--output-dir") && i + 1 < argc) {
+        config.output_dir = argv[++i];
+      } else if (arg == "--bin-ms" && i + 1 < argc) {
+        config.bin_ns = std::max<uint64_t>(1, xdp::parse_count(argv[++i])) * 1000000ULL;
+      } else if (arg == "--height" && i + 1 < argc) {
+        config.height = static_cast<uint32_t>(std::clamp<uint64_t>(xdp::parse_count(argv[++i]), 16, 65535));
+      } else if (arg == "--max-width" && i + 1 < argc) {
+        config.max_width = static_cast<uint32_t>(std::clamp<uint64_t>(xdp::parse_count(argv[++i]), 16, 65535));
+      } else if (arg == "--depth-levels" && i + 1 < argc) {
+        config.depth_levels = std::clamp<size_t>(xdp::parse_count(argv[++i]), 1, 65535);
+      } else if (arg == "--min-columns" && i + 1 < argc) {
+        min_columns = xdp::parse_count(argv[++i]);
+      } else if (arg == "--threads" && i + 1 < argc) {
+        num_threads = std::min<size_t>(xdp::parse_count(argv[++i]), NO_OWNER);
+      } else if (arg == "-h" || arg == "--help") {
+        print_usage(argv[0]);
+        return 0;
+      } else if (arg[0] != '-') {
+        pcap_files.push_back(arg);
+      } else {
+        std::cerr << "Error: unknown option " << arg << "\n";
+        print_usage(argv[0]);
+        return 1;
+      }
+    } catch (const std::exception &) {
+      std::cerr << "Error: bad value for " << arg << ": '" << argv[i] << "'\n";
+      return 1;
+    }
+  }
+
+  if (pcap_files.empty() || (tickers.empty() && !all_symbols)) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  // Sort PCAP files by name to ensure chronological order
+  std::sort(pcap_files.begin(), pcap_files.end());
+
+  if (!xdp::load_symbol_map(symbol_file)) {
+    std::cerr << "Warning: Could not load symbol file: " << symbol_file << "\n";
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(config.output_dir, ec);
+  if (ec) {
+    std::cerr << "Error: Could not create output directory " << config.output_dir
+              << ": " << ec.message() << "\n";
+    return 1;
+  }
+
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 4;
+    num_threads = std::min<size_t>(num_threads, NO_OWNER);
+  }
+
+  // Owning worker per symbol index: explicit tickers round-robin, otherwise
+  // symbol_index % threads
+  std::vector<uint16_t> owner(MAX_SYMBOLS + 1, NO_OWNER);
+  if (all_symbols) {
+    for (uint32_t idx = 1; idx <= MAX_SYMBOLS; ++idx) {
+      owner[idx] = static_cast<uint16_t>(idx % num_threads);
+    }
+  } else {
+    std::vector<uint32_t> indices;
+    for (const auto &t : tickers) {
+      auto idx = xdp::get_global_symbol_map().find_index(t);
+      if (!idx || *idx > MAX_SYMBOLS) {
+        std::cerr << "Warning: Unknown ticker " << t << ", skipping\n";
+        continue;
+      }
+      indices.push_back(*idx);
+    }
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    if (indices.empty()) {
+      std::cerr << "Error: No known tickers to render\n";
+      return 1;
+    }
+    num_threads = std::min(num_threads, indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+      owner[indices[i]] = static_cast<uint16_t>(i % num_threads);
+    }
+  }
+
+  std::cerr << "=== Book Heatmap ===\n"
+            << "PCAP files: " << pcap_files.size() << "\n"
+            << "Symbols: " << (all_symbols ? std::string("all") : std::to_string(tickers.size())) << "\n"
+            << "Bin: " << (config.bin_ns / 1000000ULL) << " ms, rows: " << config.height
+            << ", depth levels: " << config.depth_levels << "\n"
+            << "Threads: " << num_threads << " workers + 1 reader\n"
+            << "Output dir: " << config.output_dir << "\n"
+            << "====================\n" << std::flush;
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::unique_ptr<BatchRing>> rings;
+  for (size_t w = 0; w < num_threads; ++w) rings.push_back(std::make_unique<BatchRing>(RING_BATCHES));
+
+  std::vector<WorkerResult> results(num_threads);
+  uint64_t packets = 0;
+  {
+    xdp::ThreadPool pool(num_threads);
+    std::vector<std::future<void>> futures;
+    for (size_t w = 0; w < num_threads; ++w) {
+      futures.push_back(pool.enqueue([&, w] {
+        results[w] = run_worker(w, *rings[w], config, min_columns);
+        std::cerr << "[Worker " << (w + 1) << "/" << num_threads << "] Wrote "
+                  << results[w].symbols_written << " heatmaps\n" << std::flush;
+      }));
+    }
+    packets = decode_files(pcap_files, owner, rings);
+    for (auto &f : futures) f.get();
+  }
+
+  size_t written = 0, skipped = 0;
+  for (const auto &r : results) {
+    written += r.symbols_written;
+    skipped += r.symbols_skipped;
+  }
+
+  auto end_time = std::chrono::high_resolution_clock::now();
+  double seconds = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() / 1000.0;
+
+  std::cout << "Packets: " << packets << "\n"
+            << "Heatmaps written: " << written << " (skipped: " << skipped << ")\n"
+            << "Total time: " << std::fixed << std::setprecision(2) << seconds << " seconds\n";
+  return written > 0 ? 0 : 1;
+}
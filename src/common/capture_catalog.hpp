@@ -0,0 +1,208 @@
+#pragma once
+
+#include "common/mmap_pcap_reader.hpp"
+#include "common/session_calendar.hpp"
+#include "common/xdp_book_messages.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace xdp {
+
+// =============================================================================
+// Capture catalog (captures.csv)
+//
+// One row per PCAP with what a multi-day study needs to pick and balance its
+// files without opening them: the exchange-local trading date, the venue,
+// the UDP channels, the capture time range, and the size, packet and XDP
+// message counts. xdp_catalog builds it by scanning storage once (and
+// rescans only new or changed files on --update); market_maker_sim
+// --catalog selects date ranges from it.
+//
+// The venue is the first NYSE-family MIC found among the file name's and
+// then its directories' '-', '_' and '.' separated tokens ("xnys" in
+// test-xnys-20230822T130000.pcap), empty if there is none.
+// =============================================================================
+
+struct CaptureInfo {
+  std::string path;
+  int32_t date = 0;        // YYYYMMDD of the first packet, exchange local
+  std::string venue;       // Lowercase MIC, or empty
+  std::string channels;    // UDP destination ports seen, ';'-separated
+  uint64_t first_ns = 0;
+  uint64_t last_ns = 0;
+  uint64_t bytes = 0;
+  uint64_t packets = 0;
+  uint64_t messages = 0;
+  int64_t mtime = 0;       // Seconds, for --update change detection
+};
+
+inline std::string venue_from_path(const std::string &path) {
+  static const char *const MICS[] = {"xnys", "xnyx", "xase", "arcx", "xchi", "xcis"};
+  auto lower = [](std::string s) {
+    for (char &c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+  };
+  // File name first, then each parent directory from the innermost
+  std::string rest = path;
+  while (!rest.empty()) {
+    const size_t slash = rest.find_last_of('/');
+    const std::string part = lower(slash == std::string::npos ? rest : rest.substr(slash + 1));
+    size_t pos = 0;
+    while (pos <= part.size()) {
+      size_t end = part.find_first_of("-_.", pos);
+      if (end == std::string::npos) end = part.size();
+      const std::string tok = part.substr(pos, end - pos);
+      for (const char *mic : MICS) {
+        if (tok == mic) return tok;
+      }
+      pos = end + 1;
+    }
+    if (slash == std::string::npos) break;
+    rest.resize(slash);
+  }
+  return {};
+}
+
+// Read a whole capture for its catalog row
+inline bool scan_capture(const std::string &path, CaptureInfo &out, std::string &err) {
+  MmapPcapReader reader;
+  if (!reader.open(path)) {
+    err = path + ": " + reader.error();
+    return false;
+  }
+  out.path = path;
+  out.bytes = reader.file_size();
+  out.venue = venue_from_path(path);
+  out.first_ns = UINT64_MAX;
+  out.last_ns = 0;
+  out.packets = 0;
+  out.messages = 0;
+  std::set<uint16_t> ports;
+  reader.process_all([&](const uint8_t *data, size_t len, size_t, const NetworkPacketInfo &info) {
+    out.packets++;
+    out.first_ns = std::min(out.first_ns, info.timestamp_ns);
+    out.last_ns = std::max(out.last_ns, info.timestamp_ns);
+    ports.insert(info.dst_port);
+    for_each_message(data, len, [&](const uint8_t *, size_t, uint16_t) { out.messages++; });
+  });
+  if (out.packets == 0) out.first_ns = 0;
+  out.date = out.packets ? SessionCalendar::local_date(out.first_ns) : 0;
+  out.channels.clear();
+  for (uint16_t port : ports) {
+    if (!out.channels.empty()) out.channels += ';';
+    out.channels += std::to_string(port);
+  }
+  return true;
+}
+
+class CaptureCatalog {
+public:
+  static constexpr const char *HEADER =
+      "path,date,venue,channels,first_ns,last_ns,bytes,packets,messages,mtime";
+
+  std::vector<CaptureInfo> entries;
+
+  // Rows are unquoted CSV, so a path with ',' or a newline cannot be stored
+  static bool storable(const std::string &path) {
+    return path.find_first_of(",\n") == std::string::npos;
+  }
+
+  static bool load(const std::string &path, CaptureCatalog &out, std::string &err) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+      err = "cannot open " + path;
+      return false;
+    }
+    out.entries.clear();
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+      ++line_no;
+      if (line.empty() || (line_no == 1 && line.rfind("path,", 0) == 0)) continue;
+      std::vector<std::string> f;
+      std::stringstream ss(line);
+      std::string tok;
+      while (std::getline(ss, tok, ',')) f.push_back(tok);
+      if (f.size() < 10) {
+        err = path + ":" + std::to_string(line_no) + ": expected 10 fields";
+        return false;
+      }
+      CaptureInfo c;
+      try {
+        c.path = f[0];
+        c.date = std::stoi(f[1]);
+        c.venue = f[2];
+        c.channels = f[3];
+        c.first_ns = std::stoull(f[4]);
+        c.last_ns = std::stoull(f[5]);
+        c.bytes = std::stoull(f[6]);
+        c.packets = std::stoull(f[7]);
+        c.messages = std::stoull(f[8]);
+        c.mtime = std::stoll(f[9]);
+      } catch (const std::exception &) {
+        err = path + ":" + std::to_string(line_no) + ": bad number";
+        return false;
+      }
+      out.entries.push_back(std::move(c));
+    }
+    return true;
+  }
+
+  // Rows are written in (date, venue, first_ns, path) order
+  bool save(const std::string &path, std::string &err) {
+    for (const auto &c : entries) {
+      if (!storable(c.path)) {
+        err = "file path with ',' cannot go in a catalog: " + c.path;
+        return false;
+      }
+    }
+    std::sort(entries.begin(), entries.end(), [](const CaptureInfo &a, const CaptureInfo &b) {
+      if (a.date != b.date) return a.date < b.date;
+      if (a.venue != b.venue) return a.venue < b.venue;
+      if (a.first_ns != b.first_ns) return a.first_ns < b.first_ns;
+      return a.path < b.path;
+    });
+    std::ofstream out(path);
+    if (!out.is_open()) {
+      err = "cannot write " + path;
+      return false;
+    }
+    out << HEADER << '\n';
+    for (const auto &c : entries) {
+      out << c.path << ',' << c.date << ',' << c.venue << ',' << c.channels << ',' << c.first_ns
+          << ',' << c.last_ns << ',' << c.bytes << ',' << c.packets << ',' << c.messages << ','
+          << c.mtime << '\n';
+    }
+    return static_cast<bool>(out);
+  }
+
+  // Captures per date in [from, to] (0 = open), optionally of one venue,
+  // each date's files in capture-time order
+  [[nodiscard]] std::map<int32_t, std::vector<const CaptureInfo *>>
+  by_date(int32_t from, int32_t to, const std::string &venue) const {
+    std::map<int32_t, std::vector<const CaptureInfo *>> days;
+    for (const auto &c : entries) {
+      if (c.packets == 0) continue;
+      if ((from && c.date < from) || (to && c.date > to)) continue;
+      if (!venue.empty() && c.venue != venue) continue;
+      days[c.date].push_back(&c);
+    }
+    for (auto &[date, files] : days) {
+      std::sort(files.begin(), files.end(), [](const CaptureInfo *a, const CaptureInfo *b) {
+        return a->first_ns != b->first_ns ? a->first_ns < b->first_ns : a->path < b->path;
+      });
+    }
+    return days;
+  }
+};
+
+} // namespace xdp
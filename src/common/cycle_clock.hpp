@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace xdp {
+
+// Cheapest available monotonic cycle counter. On x86 this is the invariant
+// TSC (rdtsc, ~20 cycles, not serializing); on AArch64 the virtual counter.
+// Elsewhere it falls back to steady_clock nanoseconds, in which case
+// cycles_per_ns() calibrates to ~1.0.
+inline uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t v;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+  return v;
+#else
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+// Measure counter ticks per nanosecond against steady_clock. Takes about
+// `window_ms` of wall time; call once at startup.
+inline double cycles_per_ns(int window_ms = 20) {
+  auto t0 = std::chrono::steady_clock::now();
+  uint64_t c0 = read_cycles();
+  std::this_thread::sleep_for(std::chrono::milliseconds(window_ms));
+  uint64_t c1 = read_cycles();
+  auto t1 = std::chrono::steady_clock::now();
+  double ns = static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  return ns > 0 ? static_cast<double>(c1 - c0) / ns : 1.0;
+}
+
+} // namespace xdp
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace xdp {
+
+// Fenwick (binary indexed) tree over tick-indexed price levels for one side
+// of a book, holding resting volume and notional per tick.
+//
+// Positions are numbered away from the touch -- ascending ticks for asks,
+// descending for bids -- so "cumulative depth from the best price outward"
+// is a prefix-sum difference and "how far out do Q shares reach" is a single
+// Fenwick descent. Updates and queries are O(log N) for a window of N ticks.
+//
+// The window is finite and sized by the owner around the touch. add()
+// reports a tick outside it: past the far end the owner keeps the level in
+// its level map only and reads it there on the rare query that reaches that
+// far; on the touch side it rebuilds the ladder from its level map (reset()
+// + add() per level). Notional is kept in integer price units x shares, so
+// sums stay exact under any sequence of adds and removes.
+class DepthLadder {
+public:
+  explicit DepthLadder(bool descending) : descending_(descending) {}
+
+  // Empty window of at least `min_size` ticks covering [lo_tick, hi_tick]
+  // with room to grow on both sides
+  void reset(int64_t lo_tick, int64_t hi_tick, size_t min_size = 256) {
+    const int64_t span = hi_tick - lo_tick + 1;
+    size_t n = 1;
+    while (n < min_size || static_cast<int64_t>(n) < 2 * span) n <<= 1;
+    const int64_t margin = (static_cast<int64_t>(n) - span) / 2;
+    lo_ = lo_tick - margin;
+    hi_ = lo_ + static_cast<int64_t>(n) - 1;
+    vol_tree_.assign(n + 1, 0);
+    not_tree_.assign(n + 1, 0);
+    vol_.assign(n, 0);
+    not_.assign(n, 0);
+  }
+
+  [[nodiscard]] bool empty_window() const noexcept { return vol_.empty(); }
+  [[nodiscard]] bool covers(int64_t tick) const noexcept {
+    return !vol_.empty() && tick >= lo_ && tick <= hi_;
+  }
+
+  // Furthest tick from the touch in the window, and whether a tick lies
+  // beyond it
+  [[nodiscard]] int64_t far_tick() const noexcept { return descending_ ? lo_ : hi_; }
+  [[nodiscard]] bool past_far_end(int64_t tick) const noexcept {
+    return descending_ ? tick < lo_ : tick > hi_;
+  }
+
+  // Add (or with negative values remove) volume at a tick. Returns false,
+  // changing nothing, when the tick is outside the window.
+  bool add(int64_t tick, int64_t volume, int64_t notional) {
+    if (!covers(tick)) return false;
+    const size_t p = pos(tick);
+    vol_[p] += volume;
+    not_[p] += notional;
+    for (size_t i = p + 1; i < vol_tree_.size(); i += i & (~i + 1)) {
+      vol_tree_[i] += volume;
+      not_tree_[i] += notional;
+    }
+    return true;
+  }
+
+  // Volume on ticks from `from_tick` (inclusive) `n_ticks` further away from
+  // the touch; ticks outside the window hold nothing
+  [[nodiscard]] int64_t volume_out(int64_t from_tick, int64_t n_ticks) const {
+    if (vol_.empty() || n_ticks < 0) return 0;
+    int64_t a = rel(from_tick);
+    int64_t b = a + n_ticks;
+    const int64_t last = static_cast<int64_t>(vol_.size()) - 1;
+    if (b < 0 || a > last) return 0;
+    if (a < 0) a = 0;
+    if (b > last) b = last;
+    return prefix(vol_tree_, b) - prefix(vol_tree_, a - 1);
+  }
+
+  struct Walk {
+    int64_t filled = 0;    // Shares available up to qty
+    int64_t notional = 0;  // Their cost in price units x shares
+    int64_t last_tick = 0; // Furthest tick touched (valid if filled > 0)
+  };
+
+  // Consume up to qty shares starting at from_tick and moving away from the
+  // touch. The last level is taken partially at its average price.
+  [[nodiscard]] Walk walk(int64_t from_tick, int64_t qty) const {
+    Walk w;
+    if (vol_.empty() || qty <= 0) return w;
+    int64_t a = rel(from_tick);
+    if (a < 0) a = 0;
+    if (a >= static_cast<int64_t>(vol_.size())) return w;
+    const int64_t base_v = prefix(vol_tree_, a - 1);
+    const int64_t base_n = prefix(not_tree_, a - 1);
+    const int64_t total = prefix(vol_tree_, static_cast<int64_t>(vol_.size()) - 1);
+    const int64_t target = std::min(base_v + qty, total);
+    if (target <= base_v) return w;
+    const int64_t p = lower_bound(target);
+    const int64_t before_v = prefix(vol_tree_, p - 1);
+    const int64_t before_n = prefix(not_tree_, p - 1);
+    const int64_t take = target - before_v;
+    w.filled = target - base_v;
+    w.notional = before_n - base_n +
+                 (take == vol_[p] ? not_[p]
+                                  : static_cast<int64_t>(static_cast<double>(not_[p]) * take / vol_[p]));
+    w.last_tick = descending_ ? hi_ - p : lo_ + p;
+    return w;
+  }
+
+private:
+  bool descending_;
+  int64_t lo_ = 0, hi_ = -1;
+  std::vector<int64_t> vol_tree_, not_tree_; // 1-based Fenwick arrays
+  std::vector<int64_t> vol_, not_;           // Raw per-position values
+
+  int64_t rel(int64_t tick) const noexcept { return descending_ ? hi_ - tick : tick - lo_; }
+  size_t pos(int64_t tick) const noexcept { return static_cast<size_t>(rel(tick)); }
+
+  // Sum of positions [0, p]; 0 for p < 0
+  static int64_t prefix(const std::vector<int64_t>& tree, int64_t p) {
+    int64_t s = 0;
+    for (size_t i = static_cast<size_t>(p + 1); i > 0; i -= i & (~i + 1)) s += tree[i];
+    return p < 0 ? 0 : s;
+  }
+
+  // Smallest position whose volume prefix reaches target (target <= total)
+  int64_t lower_bound(int64_t target) const {
+    size_t p = 0;
+    size_t step = 1;
+    while (step * 2 < vol_tree_.size()) step <<= 1;
+    for (; step; step >>= 1) {
+      if (p + step < vol_tree_.size() && vol_tree_[p + step] < target) {
+        p += step;
+        target -= vol_tree_[p];
+      }
+    }
+    return static_cast<int64_t>(p);
+  }
+};
+
+} // namespace xdp
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xdp {
+
+// Comma-separated durations with an ns/us/ms/s suffix, e.g. "100us,1ms,10s",
+// as nanoseconds in the order given. Callers check count and ordering.
+inline bool parse_duration_list(const std::string &s, std::vector<uint64_t> &out,
+                                std::string &err) {
+  out.clear();
+  size_t pos = 0;
+  while (pos <= s.size()) {
+    size_t comma = s.find(',', pos);
+    std::string tok = s.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+    size_t digits = 0;
+    while (digits < tok.size() && tok[digits] >= '0' && tok[digits] <= '9') ++digits;
+    std::string unit = tok.substr(digits);
+    uint64_t mult = unit == "ns" ? 1ULL : unit == "us" ? 1000ULL : unit == "ms" ? 1000000ULL
+                  : unit == "s" ? 1000000000ULL : 0;
+    if (digits == 0 || mult == 0) {
+      err = "bad duration '" + tok + "' (want e.g. 100us, 1ms, 10s)";
+      return false;
+    }
+    out.push_back(std::stoull(tok.substr(0, digits)) * mult);
+    if (comma == std::string::npos) break;
+    pos = comma + 1;
+  }
+  return true;
+}
+
+} // namespace xdp
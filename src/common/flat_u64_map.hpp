@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace xdp {
+
+// Open-addressing hash map from uint64_t keys (order IDs) to small values.
+//
+// Slots hold key and value inline in one array with linear probing, so a
+// lookup is usually a single cache line and its address is computable from
+// the key alone -- prefetch(key) lets the packet loop pull the line in before
+// the message that needs it is processed. Deletion uses backward shifting,
+// so there are no tombstones and probe chains stay short under the constant
+// add/delete churn of an order book.
+//
+// Key 0 marks an empty slot and is stored out of line. Pointers returned by
+// find()/operator[] are invalidated by any insertion.
+template <typename V> class FlatU64Map {
+public:
+  FlatU64Map() = default;
+
+  FlatU64Map(const FlatU64Map &other) { *this = other; }
+  FlatU64Map &operator=(const FlatU64Map &other) {
+    if (this == &other)
+      return *this;
+    allocate(other.capacity_);
+    for (size_t i = 0; i < capacity_; ++i)
+      slots_[i] = other.slots_[i];
+    size_ = other.size_;
+    has_zero_ = other.has_zero_;
+    zero_value_ = other.zero_value_;
+    return *this;
+  }
+  FlatU64Map(FlatU64Map &&other) noexcept { *this = std::move(other); }
+  FlatU64Map &operator=(FlatU64Map &&other) noexcept {
+    if (this == &other)
+      return *this;
+    slots_ = std::move(other.slots_);
+    capacity_ = std::exchange(other.capacity_, 0);
+    mask_ = std::exchange(other.mask_, 0);
+    shift_ = std::exchange(other.shift_, 64);
+    size_ = std::exchange(other.size_, 0);
+    has_zero_ = std::exchange(other.has_zero_, false);
+    zero_value_ = std::move(other.zero_value_);
+    return *this;
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return size_ + (has_zero_ ? 1 : 0); }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  void clear() {
+    for (size_t i = 0; i < capacity_; ++i)
+      slots_[i].key = 0;
+    size_ = 0;
+    has_zero_ = false;
+  }
+
+  void reserve(size_t n) {
+    size_t cap = MIN_CAPACITY;
+    while (cap * MAX_LOAD_NUM < n * MAX_LOAD_DEN)
+      cap *= 2;
+    if (cap > capacity_)
+      rehash(cap);
+  }
+
+  [[nodiscard]] V *find(uint64_t key) {
+    if (key == 0)
+      return has_zero_ ? &zero_value_ : nullptr;
+    if (capacity_ == 0)
+      return nullptr;
+    for (size_t i = home(key);; i = (i + 1) & mask_) {
+      if (slots_[i].key == key)
+        return &slots_[i].value;
+      if (slots_[i].key == 0)
+        return nullptr;
+    }
+  }
+  [[nodiscard]] const V *find(uint64_t key) const {
+    return const_cast<FlatU64Map *>(this)->find(key);
+  }
+
+  // Insert a value-initialized entry if absent
+  V &operator[](uint64_t key) {
+    if (key == 0) {
+      if (!has_zero_) {
+        has_zero_ = true;
+        zero_value_ = V();
+      }
+      return zero_value_;
+    }
+    if ((size_ + 1) * MAX_LOAD_DEN > capacity_ * MAX_LOAD_NUM)
+      rehash(capacity_ ? capacity_ * 2 : MIN_CAPACITY);
+    size_t i = home(key);
+    while (slots_[i].key != 0) {
+      if (slots_[i].key == key)
+        return slots_[i].value;
+      i = (i + 1) & mask_;
+    }
+    slots_[i].key = key;
+    slots_[i].value = V();
+    ++size_;
+    return slots_[i].value;
+  }
+
+  bool erase(uint64_t key) {
+    if (key == 0) {
+      bool had = has_zero_;
+      has_zero_ = false;
+      return had;
+    }
+    if (capacity_ == 0)
+      return false;
+    size_t i = home(key);
+    while (slots_[i].key != key) {
+      if (slots_[i].key == 0)
+        return false;
+      i = (i + 1) & mask_;
+    }
+    // Backward-shift the rest of the cluster into the hole
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask_; slots_[j].key != 0; j = (j + 1) & mask_) {
+      size_t h = home(slots_[j].key);
+      // Move j into the hole unless its home lies cyclically in (hole, j]
+      bool stays = (hole < j) ? (hole < h && h <= j) : (hole < h || h <= j);
+      if (!stays) {
+        slots_[hole] = std::move(slots_[j]);
+        hole = j;
+      }
+    }
+    slots_[hole].key = 0;
+    --size_;
+    return true;
+  }
+
+  // Remove every entry for which pred(key, value) is true
+  template <typename Pred> size_t erase_if(Pred pred) {
+    size_t removed = 0;
+    if (has_zero_ && pred(uint64_t{0}, zero_value_)) {
+      has_zero_ = false;
+      ++removed;
+    }
+    for (size_t i = 0; i < capacity_;) {
+      if (slots_[i].key != 0 && pred(slots_[i].key, slots_[i].value)) {
+        erase(slots_[i].key);
+        ++removed;
+        // A shifted entry may now occupy slot i; re-examine it
+      } else {
+        ++i;
+      }
+    }
+    return removed;
+  }
+
+  template <typename F> void for_each(F f) const {
+    if (has_zero_)
+      f(uint64_t{0}, zero_value_);
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (slots_[i].key != 0)
+        f(slots_[i].key, slots_[i].value);
+    }
+  }
+
+  // Hint the slot `key` hashes to into cache. Never faults.
+  void prefetch(uint64_t key) const noexcept {
+    if (capacity_ != 0)
+      __builtin_prefetch(&slots_[home(key)], 1, 3);
+  }
+
+private:
+  struct Slot {
+    uint64_t key = 0;
+    V value{};
+  };
+
+  static constexpr size_t MIN_CAPACITY = 16;
+  static constexpr size_t MAX_LOAD_NUM = 3; // Grow beyond 3/4 full
+  static constexpr size_t MAX_LOAD_DEN = 4;
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t capacity_ = 0; // Power of two (or 0)
+  size_t mask_ = 0;
+  unsigned shift_ = 64;
+  size_t size_ = 0; // Excludes the out-of-line zero key
+  bool has_zero_ = false;
+  V zero_value_{};
+
+  // Fibonacci hashing: spreads sequential order IDs across the table
+  size_t home(uint64_t key) const noexcept {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_);
+  }
+
+  void allocate(size_t cap) {
+    slots_ = cap ? std::make_unique<Slot[]>(cap) : nullptr;
+    capacity_ = cap;
+    mask_ = cap ? cap - 1 : 0;
+    shift_ = 64;
+    for (size_t c = cap; c > 1; c >>= 1)
+      --shift_;
+    size_ = 0;
+  }
+
+  void rehash(size_t new_cap) {
+    std::unique_ptr<Slot[]> old = std::move(slots_);
+    size_t old_cap = capacity_;
+    allocate(new_cap);
+    for (size_t i = 0; i < old_cap; ++i) {
+      if (old[i].key == 0)
+        continue;
+      size_t j = home(old[i].key);
+      while (slots_[j].key != 0)
+        j = (j + 1) & mask_;
+      slots_[j] = std::move(old[i]);
+      ++size_;
+    }
+  }
+};
+
+} // namespace xdp
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace xdp {
+
+// =============================================================================
+// Log-linear (HDR-style) histogram of unsigned integer samples
+//
+// Values below 2^SUB_BITS are counted exactly. Above that every power of two
+// is split into 2^(SUB_BITS-1) equal sub-buckets, so any recorded value is
+// known to within 1/64 of itself at SUB_BITS = 7 (two significant digits).
+// Values past 2^MAX_BITS land in the last bucket. Recording is a bit scan
+// and an increment; histograms with the same shape merge by addition.
+// =============================================================================
+
+class HdrHistogram {
+public:
+  static constexpr int SUB_BITS = 7;
+  static constexpr int MAX_BITS = 40;
+  static constexpr uint64_t SUB_COUNT = 1ULL << SUB_BITS;
+  static constexpr uint64_t HALF_COUNT = SUB_COUNT / 2;
+  static constexpr size_t NUM_BUCKETS = SUB_COUNT + (MAX_BITS - SUB_BITS) * HALF_COUNT;
+
+  HdrHistogram() : counts_(NUM_BUCKETS, 0) {}
+
+  static size_t bucket_of(uint64_t v) {
+    if (v < SUB_COUNT) return static_cast<size_t>(v);
+    const int msb = 63 - __builtin_clzll(v);
+    const int shift = msb - (SUB_BITS - 1);
+    const size_t idx = SUB_COUNT + static_cast<size_t>(shift - 1) * HALF_COUNT +
+                       static_cast<size_t>((v >> shift) - HALF_COUNT);
+    return std::min(idx, NUM_BUCKETS - 1);
+  }
+
+  // Largest value that maps to bucket `idx`
+  static uint64_t bucket_high(size_t idx) {
+    if (idx < SUB_COUNT) return idx;
+    const size_t rel = idx - SUB_COUNT;
+    const int shift = static_cast<int>(rel / HALF_COUNT) + 1;
+    const uint64_t sub = rel % HALF_COUNT + HALF_COUNT;
+    return ((sub + 1) << shift) - 1;
+  }
+
+  void record(uint64_t v) {
+    counts_[bucket_of(v)]++;
+    total_++;
+    sum_ += v;
+    if (v > max_) max_ = v;
+  }
+
+  void add_bucket(size_t idx, uint64_t count) {
+    if (idx >= NUM_BUCKETS || count == 0) return;
+    counts_[idx] += count;
+    total_ += count;
+    // Bucket midpoint stands in for the samples' sum and max
+    const uint64_t hi = bucket_high(idx);
+    const uint64_t lo = idx == 0 ? 0 : bucket_high(idx - 1) + 1;
+    sum_ += count * (lo + (hi - lo) / 2);
+    max_ = std::max(max_, hi);
+  }
+
+  void merge(const HdrHistogram &o) {
+    if (o.total_ == 0) return;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) counts_[i] += o.counts_[i];
+    total_ += o.total_;
+    sum_ += o.sum_;
+    max_ = std::max(max_, o.max_);
+  }
+
+  void reset() {
+    if (total_ == 0) return;
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_ = 0;
+    sum_ = 0;
+    max_ = 0;
+  }
+
+  [[nodiscard]] uint64_t count() const { return total_; }
+  [[nodiscard]] uint64_t max() const { return max_; }
+  [[nodiscard]] double mean() const {
+    return total_ ? static_cast<double>(sum_) / static_cast<double>(total_) : 0.0;
+  }
+  [[nodiscard]] uint64_t bucket_count(size_t idx) const { return counts_[idx]; }
+
+  // Smallest bucket bound covering `pct` percent of the samples, capped at
+  // the largest sample (0 when empty)
+  [[nodiscard]] uint64_t percentile(double pct) const {
+    if (total_ == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(pct / 100.0 * static_cast<double>(total_) + 0.5);
+    target = std::clamp<uint64_t>(target, 1, total_);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      seen += counts_[i];
+      if (seen >= target) return std::min(bucket_high(i), max_);
+    }
+    return max_;
+  }
+
+private:
+  std::vector<uint64_t> counts_;
+  uint64_t total_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t max_ = 0;
+};
+
+} // namespace xdp
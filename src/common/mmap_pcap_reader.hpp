@@ -132,6 +132,24 @@ public:
   [[nodiscard]] bool is_open() const noexcept { return data_ != nullptr; }
   [[nodiscard]] const std::string& error() const noexcept { return error_; }
   [[nodiscard]] size_t file_size() const noexcept { return size_; }
+  [[nodiscard]] const uint8_t* data() const noexcept { return data_; }
+
+  // Capture timestamp of the first packet (0 if the file has none). Used to
+  // order a set of files without reading them.
+  [[nodiscard]] uint64_t first_timestamp_ns() const {
+    size_t offset = sizeof(PcapFileHeader);
+    if (!data_ || offset + sizeof(PcapPacketHeader) > size_) return 0;
+    const auto* pkt_header =
+        reinterpret_cast<const PcapPacketHeader*>(data_ + offset);
+    uint64_t frac = is_nanosec_ ? pkt_header->ts_usec
+                                : static_cast<uint64_t>(pkt_header->ts_usec) * 1000ULL;
+    return static_cast<uint64_t>(pkt_header->ts_sec) * 1000000000ULL + frac;
+  }
+
+  // Ask the kernel to start reading the whole file in the background
+  void prefetch() const {
+    if (data_) madvise(data_, size_, MADV_WILLNEED);
+  }
 
   // Process all packets with callback
   // Returns total number of packets processed
@@ -0,0 +1,360 @@
+#pragma once
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+namespace xdp {
+
+// =============================================================================
+// Order entry protocol spoken by xdp_exchange_sim (OUCH-style)
+//
+// A byte stream over TCP or a Unix socket. Each message is a little-endian
+// uint16 body length followed by the body, whose first byte is the message
+// type. Bodies are the packed structs below, written in host order (the tree
+// only targets little-endian hosts, as with the XDP feed). Prices are integer
+// 1e-6 dollars like the feed; timestamps are exchange (feed) time in epoch ns.
+//
+// Client -> exchange: 'O' EnterOrder, 'X' CancelOrder, 'U' ReplaceOrder
+// Exchange -> client: 'S' SystemEvent, 'A' Accepted, 'J' Rejected,
+//                     'C' Canceled, 'U' Replaced, 'E' Executed
+//
+// Tokens are chosen by the client and must be unique per connection.
+// =============================================================================
+
+namespace oe {
+
+constexpr size_t SYMBOL_LEN = 12;
+
+#pragma pack(push, 1)
+
+struct EnterOrder {
+  char type = 'O';
+  uint64_t token = 0;
+  char symbol[SYMBOL_LEN] = {};
+  char side = 'B';   // 'B' or 'S'
+  char tif = 'D';    // 'D' day (rests), 'I' immediate-or-cancel
+  uint32_t qty = 0;
+  uint32_t price_raw = 0;
+};
+
+struct CancelOrder {
+  char type = 'X';
+  uint64_t token = 0;
+};
+
+// Same price and a smaller or equal quantity keeps queue priority; any other
+// change is a cancel and a new order at the back of the queue
+struct ReplaceOrder {
+  char type = 'U';
+  uint64_t token = 0;
+  uint64_t new_token = 0;
+  uint32_t qty = 0;
+  uint32_t price_raw = 0;
+};
+
+struct SystemEvent {
+  char type = 'S';
+  uint64_t ts_ns = 0;
+  char event = 'S'; // 'S' replay started, 'E' replay ended
+};
+
+struct Accepted {
+  char type = 'A';
+  uint64_t ts_ns = 0;
+  uint64_t token = 0;
+  uint64_t order_ref = 0; // Exchange-assigned order number
+  char symbol[SYMBOL_LEN] = {};
+  char side = 'B';
+  char tif = 'D';
+  uint32_t qty = 0;
+  uint32_t price_raw = 0;
+};
+
+struct Rejected {
+  char type = 'J';
+  uint64_t ts_ns = 0;
+  uint64_t token = 0;
+  char reason = '?'; // 'S' symbol, 'P' price/qty/side/tif, 'D' duplicate token,
+                     // 'T' unknown token, 'C' replay ended
+};
+
+struct Canceled {
+  char type = 'C';
+  uint64_t ts_ns = 0;
+  uint64_t token = 0;
+  uint32_t qty = 0;  // Quantity removed from the book
+  char reason = 'U'; // 'U' user, 'I' IOC remainder, 'E' end of replay, 'D' disconnect
+};
+
+struct Replaced {
+  char type = 'U';
+  uint64_t ts_ns = 0;
+  uint64_t token = 0;     // New token
+  uint64_t old_token = 0;
+  uint64_t order_ref = 0;
+  uint32_t qty = 0;       // Open quantity after the replace
+  uint32_t price_raw = 0;
+};
+
+struct Executed {
+  char type = 'E';
+  uint64_t ts_ns = 0;
+  uint64_t token = 0;
+  uint32_t qty = 0;
+  uint32_t price_raw = 0;
+  uint64_t match_number = 0;
+  char liquidity = 'A'; // 'A' added (resting), 'R' removed (aggressive)
+};
+
+#pragma pack(pop)
+
+inline void set_symbol(char (&dst)[SYMBOL_LEN], std::string_view symbol) {
+  std::memset(dst, 0, SYMBOL_LEN);
+  std::memcpy(dst, symbol.data(), std::min(symbol.size(), SYMBOL_LEN));
+}
+
+inline std::string symbol_of(const char (&src)[SYMBOL_LEN]) {
+  return std::string(src, strnlen(src, SYMBOL_LEN));
+}
+
+template <typename Msg> inline void append_message(std::vector<uint8_t> &out, const Msg &msg) {
+  const uint16_t len = sizeof(Msg);
+  out.push_back(static_cast<uint8_t>(len & 0xFF));
+  out.push_back(static_cast<uint8_t>(len >> 8));
+  const auto *p = reinterpret_cast<const uint8_t *>(&msg);
+  out.insert(out.end(), p, p + sizeof(Msg));
+}
+
+// Copy a body into its struct; false if the body is too short
+template <typename Msg> inline bool read_message(const uint8_t *body, size_t len, Msg &msg) {
+  if (len < sizeof(Msg))
+    return false;
+  std::memcpy(&msg, body, sizeof(Msg));
+  return true;
+}
+
+// Call fn(body, body_len) for every complete frame at the front of `buf`
+// and erase them; a partial frame stays for the next read
+template <typename Fn> inline void drain_frames(std::vector<uint8_t> &buf, Fn &&fn) {
+  size_t off = 0;
+  while (buf.size() - off >= 2) {
+    const size_t len = static_cast<size_t>(buf[off]) | (static_cast<size_t>(buf[off + 1]) << 8);
+    if (buf.size() - off - 2 < len)
+      break;
+    if (len > 0)
+      fn(buf.data() + off + 2, len);
+    off += 2 + len;
+  }
+  buf.erase(buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(off));
+}
+
+// "tcp:HOST:PORT" or "unix:PATH"
+struct Endpoint {
+  bool is_unix = false;
+  std::string host = "127.0.0.1";
+  uint16_t port = 0;
+  std::string path;
+
+  static bool parse(const std::string &text, Endpoint &out, std::string &err) {
+    out = Endpoint{};
+    if (text.rfind("unix:", 0) == 0) {
+      out.is_unix = true;
+      out.path = text.substr(5);
+      if (out.path.empty() || out.path.size() >= sizeof(sockaddr_un{}.sun_path)) {
+        err = "bad unix socket path in '" + text + "'";
+        return false;
+      }
+      return true;
+    }
+    std::string rest = text.rfind("tcp:", 0) == 0 ? text.substr(4) : text;
+    const size_t colon = rest.rfind(':');
+    if (colon == std::string::npos || colon + 1 >= rest.size()) {
+      err = "expected tcp:HOST:PORT or unix:PATH, got '" + text + "'";
+      return false;
+    }
+    if (colon > 0)
+      out.host = rest.substr(0, colon);
+    const unsigned long port = std::strtoul(rest.c_str() + colon + 1, nullptr, 10);
+    if (port == 0 || port > 65535) {
+      err = "bad port in '" + text + "'";
+      return false;
+    }
+    out.port = static_cast<uint16_t>(port);
+    return true;
+  }
+
+  [[nodiscard]] std::string to_string() const {
+    return is_unix ? "unix:" + path : "tcp:" + host + ":" + std::to_string(port);
+  }
+};
+
+namespace detail {
+inline bool fill_inet(const Endpoint &ep, sockaddr_in &addr, std::string &err) {
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(ep.port);
+  if (inet_pton(AF_INET, ep.host.c_str(), &addr.sin_addr) == 1)
+    return true;
+  addrinfo hints{}, *res = nullptr;
+  hints.ai_family = AF_INET;
+  if (getaddrinfo(ep.host.c_str(), nullptr, &hints, &res) != 0 || !res) {
+    err = "cannot resolve " + ep.host;
+    return false;
+  }
+  addr.sin_addr = reinterpret_cast<sockaddr_in *>(res->ai_addr)->sin_addr;
+  freeaddrinfo(res);
+  return true;
+}
+} // namespace detail
+
+// Non-blocking listening socket; -1 with err set on failure
+inline int listen_endpoint(const Endpoint &ep, std::string &err) {
+  int fd = ::socket(ep.is_unix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    err = std::string("socket: ") + std::strerror(errno);
+    return -1;
+  }
+  int rc;
+  if (ep.is_unix) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, ep.path.c_str(), sizeof(addr.sun_path) - 1);
+    ::unlink(ep.path.c_str());
+    rc = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+  } else {
+    int one = 1;
+    (void)::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr;
+    if (!detail::fill_inet(ep, addr, err)) {
+      ::close(fd);
+      return -1;
+    }
+    rc = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+  }
+  if (rc != 0 || ::listen(fd, 16) != 0) {
+    err = "cannot listen on " + ep.to_string() + ": " + std::strerror(errno);
+    ::close(fd);
+    return -1;
+  }
+  (void)::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+  return fd;
+}
+
+// Blocking connected socket (TCP_NODELAY for TCP); -1 with err set on failure
+inline int connect_endpoint(const Endpoint &ep, std::string &err) {
+  int fd = ::socket(ep.is_unix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    err = std::string("socket: ") + std::strerror(errno);
+    return -1;
+  }
+  int rc;
+  if (ep.is_unix) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, ep.path.c_str(), sizeof(addr.sun_path) - 1);
+    rc = ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+  } else {
+    sockaddr_in addr;
+    if (!detail::fill_inet(ep, addr, err)) {
+      ::close(fd);
+      return -1;
+    }
+    rc = ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    int one = 1;
+    (void)::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  if (rc != 0) {
+    err = "cannot connect to " + ep.to_string() + ": " + std::strerror(errno);
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Minimal blocking client for strategy processes
+class Client {
+public:
+  Client() = default;
+  ~Client() { close(); }
+
+  Client(const Client &) = delete;
+  Client &operator=(const Client &) = delete;
+
+  bool connect(const std::string &endpoint, std::string &err) {
+    close();
+    Endpoint ep;
+    if (!Endpoint::parse(endpoint, ep, err))
+      return false;
+    fd_ = connect_endpoint(ep, err);
+    return fd_ >= 0;
+  }
+
+  void close() {
+    if (fd_ >= 0)
+      ::close(fd_);
+    fd_ = -1;
+    rx_.clear();
+  }
+
+  [[nodiscard]] bool is_open() const { return fd_ >= 0; }
+
+  template <typename Msg> bool send(const Msg &msg) {
+    tx_.clear();
+    append_message(tx_, msg);
+    size_t off = 0;
+    while (off < tx_.size()) {
+      ssize_t n = ::send(fd_, tx_.data() + off, tx_.size() - off, MSG_NOSIGNAL);
+      if (n <= 0) {
+        if (n < 0 && errno == EINTR)
+          continue;
+        return false;
+      }
+      off += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  // Wait up to timeout_ms (-1 = forever) for data and call fn(body, len) for
+  // every complete message. Returns false once the exchange has disconnected.
+  template <typename Fn> bool poll(int timeout_ms, Fn &&fn) {
+    if (fd_ < 0)
+      return false;
+    pollfd p{fd_, POLLIN, 0};
+    int rc = ::poll(&p, 1, timeout_ms);
+    if (rc <= 0)
+      return rc == 0 || errno == EINTR;
+    uint8_t buf[65536];
+    ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+    if (n <= 0) {
+      close();
+      return false;
+    }
+    rx_.insert(rx_.end(), buf, buf + n);
+    drain_frames(rx_, fn);
+    return true;
+  }
+
+private:
+  int fd_ = -1;
+  std::vector<uint8_t> rx_;
+  std::vector<uint8_t> tx_;
+};
+
+} // namespace oe
+
+} // namespace xdp
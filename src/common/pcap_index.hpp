@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <unistd.h>
+
+namespace xdp {
+
+// =============================================================================
+// Sparse PCAP index sidecar (<file>.pcap.idx)
+//
+//   [uint32 magic "PIDX", version, stride, reserved][PcapIndexEntry ...]
+//
+// One entry for the first packet and then every stride-th packet: its
+// capture time and the file offset of its record header. Entries are only
+// appended, so xdp_record writes the sidecar while the capture is still
+// running.
+// =============================================================================
+
+constexpr uint32_t PCAP_INDEX_MAGIC = 0x58444950u; // "PIDX"
+constexpr uint32_t PCAP_INDEX_VERSION = 1;
+constexpr uint32_t PCAP_INDEX_STRIDE = 4096;
+
+struct PcapIndexEntry {
+  uint64_t ts_ns;
+  uint64_t offset;
+};
+static_assert(sizeof(PcapIndexEntry) == 16, "PcapIndexEntry layout changed");
+
+// Write the sidecar header to a freshly created index file
+inline bool write_pcap_index_header(int fd, uint32_t stride) {
+  const uint32_t header[4] = {PCAP_INDEX_MAGIC, PCAP_INDEX_VERSION, stride, 0};
+  return ::write(fd, header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+}
+
+} // namespace xdp
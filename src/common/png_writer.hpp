@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace xdp {
+
+// Minimal dependency-free PNG encoder for 8-bit RGB images.
+// Compression is a single fixed-Huffman deflate block whose only match
+// candidates are the previous pixel and the pixel directly above. That is
+// enough to shrink flat backgrounds and horizontal price bands by an order
+// of magnitude without pulling in zlib.
+namespace png_detail {
+
+inline uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      t[n] = c;
+    }
+    return t;
+  }();
+  for (size_t i = 0; i < len; ++i) {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+inline uint32_t adler32(const uint8_t *data, size_t len) {
+  uint32_t a = 1, b = 0;
+  for (size_t i = 0; i < len; ++i) {
+    a = (a + data[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  return (b << 16) | a;
+}
+
+class BitWriter {
+public:
+  explicit BitWriter(std::vector<uint8_t> &out) : out_(out) {}
+
+  // Write `count` bits LSB-first (deflate header fields and extra bits)
+  void put_bits(uint32_t value, int count) {
+    bit_buf_ |= static_cast<uint64_t>(value) << bit_count_;
+    bit_count_ += count;
+    while (bit_count_ >= 8) {
+      out_.push_back(static_cast<uint8_t>(bit_buf_ & 0xFF));
+      bit_buf_ >>= 8;
+      bit_count_ -= 8;
+    }
+  }
+
+  // Write a Huffman code (codes are defined MSB-first)
+  void put_code(uint32_t code, int length) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < length; ++i) {
+      reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    put_bits(reversed, length);
+  }
+
+  void flush() {
+    if (bit_count_ > 0) {
+      out_.push_back(static_cast<uint8_t>(bit_buf_ & 0xFF));
+    }
+    bit_buf_ = 0;
+    bit_count_ = 0;
+  }
+
+private:
+  std::vector<uint8_t> &out_;
+  uint64_t bit_buf_ = 0;
+  int bit_count_ = 0;
+};
+
+// Fixed literal/length code from RFC 1951 section 3.2.6
+inline void put_fixed_symbol(BitWriter &bw, uint32_t sym) {
+  if (sym < 144) {
+    bw.put_code(0x30 + sym, 8);
+  } else if (sym < 256) {
+    bw.put_code(0x190 + (sym - 144), 9);
+  } else if (sym < 280) {
+    bw.put_code(sym - 256, 7);
+  } else {
+    bw.put_code(0xC0 + (sym - 280), 8);
+  }
+}
+
+inline void put_match(BitWriter &bw, uint32_t length, uint32_t distance) {
+  static constexpr uint16_t LEN_BASE[29] = {3,  4,  5,  6,   7,   8,   9,   10,
+                                            11, 13, 15, 17,  19,  23,  27,  31,
+                                            35, 43, 51, 59,  67,  83,  99,  115,
+                                            131, 163, 195, 227, 258};
+  static constexpr uint8_t LEN_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                            1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                            4, 4, 4, 4, 5, 5, 5, 5, 0};
+  static constexpr uint16_t DIST_BASE[30] = {
+      1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+      33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+      1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+  static constexpr uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3,
+                                             4, 4, 5, 5, 6, 6, 7, 7, 8, 8,
+                                             9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+  int li = 28;
+  while (LEN_BASE[li] > length) --li;
+  put_fixed_symbol(bw, 257 + li);
+  bw.put_bits(length - LEN_BASE[li], LEN_EXTRA[li]);
+
+  int di = 29;
+  while (DIST_BASE[di] > distance) --di;
+  bw.put_code(static_cast<uint32_t>(di), 5);
+  bw.put_bits(distance - DIST_BASE[di], DIST_EXTRA[di]);
+}
+
+inline uint32_t match_length(const std::vector<uint8_t> &raw, size_t pos,
+                             size_t distance) {
+  size_t max_len = std::min<size_t>(258, raw.size() - pos);
+  size_t len = 0;
+  while (len < max_len && raw[pos + len] == raw[pos + len - distance]) {
+    ++len;
+  }
+  return static_cast<uint32_t>(len);
+}
+
+// zlib stream (RFC 1950) wrapping one fixed-Huffman deflate block
+inline std::vector<uint8_t> zlib_compress(const std::vector<uint8_t> &raw,
+                                          size_t stride) {
+  std::vector<uint8_t> out;
+  out.reserve(raw.size() / 4 + 64);
+  out.push_back(0x78);
+  out.push_back(0x01);
+
+  BitWriter bw(out);
+  bw.put_bits(1, 1);  // BFINAL
+  bw.put_bits(1, 2);  // BTYPE = fixed Huffman
+
+  size_t pos = 0;
+  while (pos < raw.size()) {
+    uint32_t best_len = 0;
+    size_t best_dist = 0;
+    if (pos >= 3) {
+      best_len = match_length(raw, pos, 3);
+      best_dist = 3;
+    }
+    if (stride <= 32768 && pos >= stride) {
+      uint32_t up_len = match_length(raw, pos, stride);
+      if (up_len > best_len) {
+        best_len = up_len;
+        best_dist = stride;
+      }
+    }
+
+    if (best_len >= 3) {
+      put_match(bw, best_len, static_cast<uint32_t>(best_dist));
+      pos += best_len;
+    } else {
+      put_fixed_symbol(bw, raw[pos]);
+      ++pos;
+    }
+  }
+  put_fixed_symbol(bw, 256);  // End of block
+  bw.flush();
+
+  uint32_t adler = adler32(raw.data(), raw.size());
+  out.push_back(static_cast<uint8_t>(adler >> 24));
+  out.push_back(static_cast<uint8_t>(adler >> 16));
+  out.push_back(static_cast<uint8_t>(adler >> 8));
+  out.push_back(static_cast<uint8_t>(adler));
+  return out;
+}
+
+inline void write_chunk(FILE *f, const char type[4],
+                        const std::vector<uint8_t> &data) {
+  uint8_t len_be[4] = {static_cast<uint8_t>(data.size() >> 24),
+                       static_cast<uint8_t>(data.size() >> 16),
+                       static_cast<uint8_t>(data.size() >> 8),
+                       static_cast<uint8_t>(data.size())};
+  fwrite(len_be, 1, 4, f);
+  fwrite(type, 1, 4, f);
+  if (!data.empty()) {
+    fwrite(data.data(), 1, data.size(), f);
+  }
+  uint32_t crc = crc32_update(0xFFFFFFFFu,
+                              reinterpret_cast<const uint8_t *>(type), 4);
+  crc = crc32_update(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+  uint8_t crc_be[4] = {static_cast<uint8_t>(crc >> 24),
+                       static_cast<uint8_t>(crc >> 16),
+                       static_cast<uint8_t>(crc >> 8),
+                       static_cast<uint8_t>(crc)};
+  fwrite(crc_be, 1, 4, f);
+}
+
+} // namespace png_detail
+
+// Write an 8-bit RGB image (row-major, 3 bytes per pixel) as PNG.
+// Returns false if the file could not be written.
+[[nodiscard]] inline bool write_png_rgb(const std::string &filename,
+                                        uint32_t width, uint32_t height,
+                                        const std::vector<uint8_t> &rgb) {
+  if (width == 0 || height == 0 ||
+      rgb.size() != static_cast<size_t>(width) * height * 3) {
+    return false;
+  }
+
+  // Filter type 0 (None) for every scanline
+  size_t stride = static_cast<size_t>(width) * 3 + 1;
+  std::vector<uint8_t> raw(stride * height);
+  for (uint32_t y = 0; y < height; ++y) {
+    raw[y * stride] = 0;
+    std::copy(rgb.begin() + static_cast<size_t>(y) * width * 3,
+              rgb.begin() + static_cast<size_t>(y + 1) * width * 3,
+              raw.begin() + y * stride + 1);
+  }
+
+  FILE *f = fopen(filename.c_str(), "wb");
+  if (!f) {
+    return false;
+  }
+
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  fwrite(signature, 1, sizeof(signature), f);
+
+  std::vector<uint8_t> ihdr = {
+      static_cast<uint8_t>(width >> 24),  static_cast<uint8_t>(width >> 16),
+      static_cast<uint8_t>(width >> 8),   static_cast<uint8_t>(width),
+      static_cast<uint8_t>(height >> 24), static_cast<uint8_t>(height >> 16),
+      static_cast<uint8_t>(height >> 8),  static_cast<uint8_t>(height),
+      8,  // Bit depth
+      2,  // Color type: RGB
+      0,  // Compression: deflate
+      0,  // Filter method
+      0}; // No interlace
+  png_detail::write_chunk(f, "IHDR", ihdr);
+  png_detail::write_chunk(f, "IDAT", png_detail::zlib_compress(raw, stride));
+  png_detail::write_chunk(f, "IEND", {});
+
+  bool ok = !ferror(f);
+  ok = (fclose(f) == 0) && ok;
+  return ok;
+}
+
+} // namespace xdp
@@ -0,0 +1,356 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace xdp {
+
+// NYSE trading-session calendar in America/New_York.
+//
+// Everything that depends on wall-clock time -- the trading date, the
+// EST/EDT offset (US rules since 2007), exchange holidays, 13:00 early
+// closes, and the open/close auction times -- is resolved once per run by
+// build(), which lays out one TradingSession per local calendar date with
+// all boundaries as Unix-epoch nanoseconds. Per-event code then only
+// compares integers against a cached session and calls find() when an
+// event crosses the session's day_end_ns.
+//
+// A date's session exists even when the calendar says the exchange is
+// closed (weekend, holiday); `trading_day` records the calendar's view and
+// callers decide what to do with captures from such days.
+
+struct TradingSession {
+  int32_t date = 0;             // YYYYMMDD, exchange local
+  int32_t utc_offset_s = 0;     // -14400 (EDT) or -18000 (EST)
+  bool trading_day = false;     // Weekday and not an exchange holiday
+  bool early_close = false;     // 13:00 close
+  uint32_t ordinal = 0;         // Index within the calendar
+
+  uint64_t day_start_ns = 0;    // Local midnight
+  uint64_t open_auction_ns = 0; // 09:30 opening auction
+  uint64_t close_auction_ns = 0;// 16:00 (13:00 early close) closing auction
+  uint64_t eod_ns = 0;          // Liquidation cutoff: close minus the EOD lead
+  uint64_t trade_start_ns = 0;  // Strategy window start (--from, else day start)
+  uint64_t trade_end_ns = 0;    // Strategy window end: min(eod, --to)
+  uint64_t day_end_ns = 0;      // Next local midnight (== next day_start_ns)
+};
+
+class SessionCalendar {
+public:
+  static constexpr uint64_t NS_PER_SEC = 1000000000ULL;
+  static constexpr int32_t OPEN_SEC = 9 * 3600 + 30 * 60;
+  static constexpr int32_t CLOSE_SEC = 16 * 3600;
+  static constexpr int32_t EARLY_CLOSE_SEC = 13 * 3600;
+
+  // A --from/--to bound: exchange-local time of day, optionally pinned to a
+  // date. Without a date it applies to every session; with one it selects
+  // that point in a multi-day run (date-only bounds cover the whole date).
+  struct Bound {
+    int32_t date = 0;   // YYYYMMDD, 0 = every session
+    int32_t sec = -1;   // Seconds after local midnight, -1 = date only
+    bool set = false;
+  };
+
+  struct Options {
+    Bound from;
+    Bound to;
+    int32_t eod_lead_sec = 10 * 60; // Liquidate this long before the close
+  };
+
+  SessionCalendar() = default;
+
+  // Lay out sessions for every local date from the one containing first_ns
+  // through the one containing last_ns, plus a day of margin either side.
+  void build(uint64_t first_ns, uint64_t last_ns, const Options& opts) {
+    opts_ = opts;
+    sessions_.clear();
+    if (last_ns < first_ns) std::swap(first_ns, last_ns);
+    int64_t d0 = local_days(first_ns) - 1;
+    int64_t d1 = local_days(last_ns) + 1;
+    for (int64_t d = d0; d <= d1; ++d) {
+      sessions_.push_back(make_session(d, static_cast<uint32_t>(d - d0)));
+    }
+    first_data_ordinal_ = 1;  // The session of first_ns, after the margin day
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return sessions_.empty(); }
+  [[nodiscard]] const std::vector<TradingSession>& sessions() const noexcept { return sessions_; }
+  [[nodiscard]] const Options& options() const noexcept { return opts_; }
+
+  // Session whose [day_start_ns, day_end_ns) contains ns. Timestamps outside
+  // the built range clamp to the first/last session; nullptr if empty.
+  [[nodiscard]] const TradingSession* find(uint64_t ns) const {
+    if (sessions_.empty()) return nullptr;
+    auto it = std::upper_bound(sessions_.begin(), sessions_.end(), ns,
+                               [](uint64_t t, const TradingSession& s) { return t < s.day_end_ns; });
+    if (it == sessions_.end()) --it;
+    return &*it;
+  }
+
+  // Walk-forward window / time-bin index for ns. Bins are anchored at each
+  // session's opening auction (pre-open time falls in the first bin) and
+  // numbered continuously across sessions from 0 in the first session with
+  // data, so the same timestamp maps to the same bin in every process of a
+  // multi-day run. Time before that session falls in bin 0.
+  [[nodiscard]] int bin_index(uint64_t ns, uint64_t bin_ns) const {
+    const TradingSession* s = find(ns);
+    if (!s || bin_ns == 0 || s->ordinal < first_data_ordinal_) return 0;
+    return static_cast<int>(s->ordinal - first_data_ordinal_) * bins_per_session(bin_ns) +
+           bin_in_session(*s, ns, bin_ns);
+  }
+
+  // First timestamp of the bin after the one containing ns
+  [[nodiscard]] uint64_t next_bin_ns(uint64_t ns, uint64_t bin_ns) const {
+    const TradingSession* s = find(ns);
+    if (!s || bin_ns == 0) return UINT64_MAX;
+    uint64_t next = s->open_auction_ns +
+                    static_cast<uint64_t>(bin_in_session(*s, ns, bin_ns) + 1) * bin_ns;
+    return std::min(next, s->day_end_ns);
+  }
+
+  [[nodiscard]] int bins_per_session(uint64_t bin_ns) const {
+    // Opening auction to local midnight
+    uint64_t span = static_cast<uint64_t>(24 * 3600 - OPEN_SEC) * NS_PER_SEC;
+    return static_cast<int>((span + bin_ns - 1) / bin_ns);
+  }
+
+  // ---------------------------------------------------------------------------
+  // Parsing / formatting helpers
+  // ---------------------------------------------------------------------------
+
+  // Parse "HH:MM[:SS]", "YYYY-MM-DD" or "YYYY-MM-DDTHH:MM[:SS]"
+  static bool parse_bound(const std::string& s, Bound& out, std::string& err) {
+    out = Bound{};
+    std::string time_part = s;
+    int y = 0, mo = 0, d = 0;
+    if (s.size() >= 10 && s[4] == '-' && s[7] == '-') {
+      if (std::sscanf(s.c_str(), "%4d-%2d-%2d", &y, &mo, &d) != 3 || mo < 1 || mo > 12 ||
+          d < 1 || d > days_in_month(y, mo)) {
+        err = "bad date in '" + s + "'";
+        return false;
+      }
+      out.date = y * 10000 + mo * 100 + d;
+      if (s.size() == 10) {
+        out.set = true;
+        return true;
+      }
+      if (s[10] != 'T' && s[10] != ' ') {
+        err = "expected 'T' between date and time in '" + s + "'";
+        return false;
+      }
+      time_part = s.substr(11);
+    }
+    int hh = 0, mm = 0, ss = 0;
+    int n = std::sscanf(time_part.c_str(), "%2d:%2d:%2d", &hh, &mm, &ss);
+    if (n < 2 || hh < 0 || hh > 24 || mm < 0 || mm > 59 || ss < 0 || ss > 59 ||
+        hh * 3600 + mm * 60 + ss > 24 * 3600) {
+      err = "bad time in '" + s + "' (want HH:MM[:SS])";
+      return false;
+    }
+    out.sec = hh * 3600 + mm * 60 + ss;
+    out.set = true;
+    return true;
+  }
+
+  // "2023-08-22"
+  static std::string format_date(int32_t yyyymmdd) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d", yyyymmdd / 10000,
+                  (yyyymmdd / 100) % 100, yyyymmdd % 100);
+    return buf;
+  }
+
+  // Exchange-local "HH:MM:SS" of an epoch timestamp within session s
+  static std::string format_local(const TradingSession& s, uint64_t ns) {
+    int64_t sec = (static_cast<int64_t>(ns) - static_cast<int64_t>(at_local(s, 0))) /
+                  static_cast<int64_t>(NS_PER_SEC);
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d", static_cast<int>(sec / 3600),
+                  static_cast<int>((sec / 60) % 60), static_cast<int>(sec % 60));
+    return buf;
+  }
+
+  // Exchange-local YYYYMMDD date containing an epoch timestamp, in the
+  // offset in force at the time: a capture rotated at 04:00 UTC in summer
+  // (00:00 EDT) starts on the new date. Used to catalog and batch files.
+  static int32_t local_date(uint64_t ns) {
+    int y, m, d;
+    civil_from_days(local_days(ns), y, m, d);
+    return y * 10000 + m * 100 + d;
+  }
+
+  // Epoch ns of an exchange-local wall-clock time on a YYYYMMDD date
+  static uint64_t local_to_ns(int32_t yyyymmdd, int32_t sec_of_day) {
+    int64_t days = days_from_civil(yyyymmdd / 10000, (yyyymmdd / 100) % 100, yyyymmdd % 100);
+    return static_cast<uint64_t>(days * 86400 - utc_offset(days) + sec_of_day) * NS_PER_SEC;
+  }
+
+  // ---------------------------------------------------------------------------
+  // Civil-date arithmetic (proleptic Gregorian, days since 1970-01-01)
+  // ---------------------------------------------------------------------------
+
+  static int64_t days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+  }
+
+  static void civil_from_days(int64_t z, int& y, int& m, int& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = static_cast<int>(yoe + era * 400 + (m <= 2));
+  }
+
+  // 0 = Sunday
+  static int weekday(int64_t days) { return static_cast<int>(((days % 7) + 11) % 7); }
+
+private:
+  static int days_in_month(int y, int m) {
+    static const int dim[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return (m == 2 && leap) ? 29 : dim[m - 1];
+  }
+
+  // Day of the n-th (1-based) given weekday in a month; n = -1 for the last
+  static int64_t nth_weekday(int y, int m, int wday, int n) {
+    if (n > 0) {
+      int64_t first = days_from_civil(y, m, 1);
+      return first + (wday - weekday(first) + 7) % 7 + 7 * (n - 1);
+    }
+    int64_t last = days_from_civil(y, m, days_in_month(y, m));
+    return last - (weekday(last) - wday + 7) % 7;
+  }
+
+  // EDT from the second Sunday of March through the day before the first
+  // Sunday of November (the switch itself happens at 02:00 local)
+  static bool is_dst(int64_t days) {
+    int y, m, d;
+    civil_from_days(days, y, m, d);
+    return days >= nth_weekday(y, 3, 0, 2) && days < nth_weekday(y, 11, 0, 1);
+  }
+
+  static int32_t utc_offset(int64_t days) { return is_dst(days) ? -4 * 3600 : -5 * 3600; }
+
+  // Local date containing ns. Each local day starts at midnight in the
+  // previous day's offset, as in day_start_ns, so EDT and EST days both get
+  // their own midnight (the switch is treated as happening at midnight
+  // rather than 02:00, when nothing trades). The local date is the UTC date
+  // or the day before.
+  static int64_t local_days(uint64_t ns) {
+    const int64_t sec = static_cast<int64_t>(ns / NS_PER_SEC);
+    int64_t days = (sec >= 0 ? sec / 86400 : (sec - 86399) / 86400) - 1;
+    while (sec >= (days + 1) * 86400 - utc_offset(days)) ++days;
+    return days;
+  }
+
+  static int64_t easter_sunday(int y) {
+    int a = y % 19, b = y / 100, c = y % 100, d = b / 4, e = b % 4;
+    int f = (b + 8) / 25, g = (b - f + 1) / 3, h = (19 * a + b - d - g + 15) % 30;
+    int i = c / 4, k = c % 4, l = (32 + 2 * e + 2 * i - h - k) % 7;
+    int m = (a + 11 * h + 22 * l) / 451;
+    int month = (h + l - 7 * m + 114) / 31, day = ((h + l - 7 * m + 114) % 31) + 1;
+    return days_from_civil(y, month, day);
+  }
+
+  // Fixed-date holiday observed on Friday when it falls on Saturday and on
+  // Monday when it falls on Sunday
+  static bool observed_fixed(int64_t days, int y, int m, int d) {
+    int64_t h = days_from_civil(y, m, d);
+    int wd = weekday(h);
+    if (wd == 6) h -= 1;
+    else if (wd == 0) h += 1;
+    return days == h;
+  }
+
+  static bool is_holiday(int64_t days) {
+    int y, m, d;
+    civil_from_days(days, y, m, d);
+    // New Year's Day: a Saturday holiday is not moved back into December
+    int64_t ny = days_from_civil(y, 1, 1);
+    if (days == ny || (weekday(ny) == 0 && days == ny + 1)) return true;
+    if (days == nth_weekday(y, 1, 1, 3)) return true;  // Martin Luther King Jr. Day
+    if (days == nth_weekday(y, 2, 1, 3)) return true;  // Washington's Birthday
+    if (days == easter_sunday(y) - 2) return true;     // Good Friday
+    if (days == nth_weekday(y, 5, 1, -1)) return true; // Memorial Day
+    if (y >= 2022 && observed_fixed(days, y, 6, 19)) return true; // Juneteenth
+    if (observed_fixed(days, y, 7, 4)) return true;    // Independence Day
+    if (days == nth_weekday(y, 9, 1, 1)) return true;  // Labor Day
+    if (days == nth_weekday(y, 11, 4, 4)) return true; // Thanksgiving
+    if (observed_fixed(days, y, 12, 25)) return true;  // Christmas
+    return false;
+  }
+
+  // 13:00 closes: July 3 and December 24 when they fall Monday-Thursday,
+  // and the day after Thanksgiving
+  static bool is_early_close(int64_t days) {
+    int y, m, d;
+    civil_from_days(days, y, m, d);
+    int wd = weekday(days);
+    if (((m == 7 && d == 3) || (m == 12 && d == 24)) && wd >= 1 && wd <= 4) return true;
+    return days == nth_weekday(y, 11, 4, 4) + 1;
+  }
+
+  uint64_t bound_lower(const Bound& b, const TradingSession& s) const {
+    if (!b.set) return s.day_start_ns;
+    if (b.date != 0 && s.date < b.date) return s.day_end_ns;
+    if (b.date != 0 && s.date > b.date) return s.day_start_ns;
+    return at_local(s, b.sec < 0 ? 0 : b.sec);
+  }
+
+  uint64_t bound_upper(const Bound& b, const TradingSession& s) const {
+    if (!b.set) return s.day_end_ns;
+    if (b.date != 0 && s.date < b.date) return s.day_end_ns;
+    if (b.date != 0 && s.date > b.date) return s.day_start_ns;
+    return b.sec < 0 ? s.day_end_ns : at_local(s, b.sec);
+  }
+
+  // Epoch ns of a local wall-clock time on the session's date
+  static uint64_t at_local(const TradingSession& s, int32_t sec_of_day) {
+    int64_t days = days_from_civil(s.date / 10000, (s.date / 100) % 100, s.date % 100);
+    return static_cast<uint64_t>(days * 86400 - s.utc_offset_s + sec_of_day) * NS_PER_SEC;
+  }
+
+  TradingSession make_session(int64_t days, uint32_t ordinal) const {
+    int y, m, d;
+    civil_from_days(days, y, m, d);
+    TradingSession s;
+    s.date = y * 10000 + m * 100 + d;
+    s.ordinal = ordinal;
+    s.utc_offset_s = utc_offset(days);
+    s.early_close = is_early_close(days);
+    int wd = weekday(days);
+    s.trading_day = wd != 0 && wd != 6 && !is_holiday(days);
+    // Midnight still runs on the previous day's offset (switches are at 02:00)
+    s.day_start_ns = static_cast<uint64_t>(days * 86400 - utc_offset(days - 1)) * NS_PER_SEC;
+    s.day_end_ns = static_cast<uint64_t>((days + 1) * 86400 - s.utc_offset_s) * NS_PER_SEC;
+    s.open_auction_ns = at_local(s, OPEN_SEC);
+    s.close_auction_ns = at_local(s, s.early_close ? EARLY_CLOSE_SEC : CLOSE_SEC);
+    s.eod_ns = s.close_auction_ns - static_cast<uint64_t>(opts_.eod_lead_sec) * NS_PER_SEC;
+    s.trade_start_ns = bound_lower(opts_.from, s);
+    s.trade_end_ns = std::min(s.eod_ns, bound_upper(opts_.to, s));
+    return s;
+  }
+
+  static int bin_in_session(const TradingSession& s, uint64_t ns, uint64_t bin_ns) {
+    if (ns <= s.open_auction_ns) return 0;
+    return static_cast<int>((ns - s.open_auction_ns) / bin_ns);
+  }
+
+  Options opts_;
+  std::vector<TradingSession> sessions_;
+  uint32_t first_data_ordinal_ = 0;  // Ordinal of the first session with data
+};
+
+} // namespace xdp
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace xdp {
+
+// Bounded single-producer / single-consumer ring.
+//
+// Slots are written in place: the producer fills the slot returned by
+// acquire() and publishes it with commit(), the consumer reads the slot
+// returned by front() and frees it with pop(). Large slots therefore cost
+// only the bytes actually written. Head and tail live on separate cache
+// lines and each side caches the other's index, so the shared lines are
+// touched only when the cached view says the ring looks full or empty.
+//
+// A waiting side spins briefly, then yields, then naps in short sleeps so an
+// idle consumer does not hold a core.
+template <typename T> class SpscRing {
+public:
+  // Capacity is rounded up to a power of two
+  explicit SpscRing(size_t capacity) {
+    size_t cap = 2;
+    while (cap < capacity)
+      cap *= 2;
+    slots_ = std::make_unique<T[]>(cap);
+    mask_ = cap - 1;
+  }
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+  // Producer: slot for the next element, waiting while the ring is full
+  T &acquire() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_cache_ > mask_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head - tail_cache_ > mask_) {
+        ++full_waits_;
+        for (unsigned spins = 0; head - tail_cache_ > mask_; ++spins) {
+          backoff(spins);
+          tail_cache_ = tail_.load(std::memory_order_acquire);
+        }
+      }
+    }
+    return slots_[head & mask_];
+  }
+
+  // Producer: publish the slot returned by acquire()
+  void commit() noexcept {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // Consumer: oldest element, waiting while the ring is empty
+  T &front() {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_cache_) {
+      for (unsigned spins = 0;; ++spins) {
+        head_cache_ = head_.load(std::memory_order_acquire);
+        if (tail != head_cache_)
+          break;
+        backoff(spins);
+      }
+    }
+    return slots_[tail & mask_];
+  }
+
+  // Consumer: release the slot returned by front()
+  void pop() noexcept {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // Times the producer found the ring full (consumer is the bottleneck)
+  [[nodiscard]] uint64_t full_waits() const noexcept { return full_waits_; }
+
+private:
+  static void backoff(unsigned spins) {
+    if (spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    } else if (spins < 4096) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+  }
+
+  std::unique_ptr<T[]> slots_;
+  size_t mask_ = 0;
+
+  // Producer side
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t tail_cache_ = 0;
+  uint64_t full_waits_ = 0;
+
+  // Consumer side
+  alignas(64) std::atomic<size_t> tail_{0};
+  size_t head_cache_ = 0;
+};
+
+} // namespace xdp
@@ -154,6 +154,15 @@ bool SymbolMap::contains(uint32_t index) const {
   return symbols_.find(index) != symbols_.end();
 }
 
+std::optional<uint32_t> SymbolMap::find_index(std::string_view symbol) const {
+  for (const auto &[index, info] : symbols_) {
+    if (info.symbol == symbol) {
+      return index;
+    }
+  }
+  return std::nullopt;
+}
+
 // Global symbol map instance
 SymbolMap &get_global_symbol_map() {
   static SymbolMap instance;
@@ -50,6 +50,10 @@ public:
   // Check if a symbol index exists
   [[nodiscard]] bool contains(uint32_t index) const;
 
+  // Reverse lookup: symbol index for a ticker (linear scan, startup use only)
+  // Returns nullopt if the ticker is not in the map
+  [[nodiscard]] std::optional<uint32_t> find_index(std::string_view symbol) const;
+
   // Get the number of loaded symbols
   [[nodiscard]] size_t size() const noexcept { return symbols_.size(); }
 
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "xdp_types.hpp"
+#include "xdp_utils.hpp"
+#include <cstdint>
+
+namespace xdp {
+
+// Decoded order book message (types 100-104).
+// Shared by the offline tools that only need to rebuild books and do not
+// care about the remaining XDP message types.
+struct BookMessage {
+  uint16_t msg_type = 0;
+  uint32_t symbol_index = 0;
+  uint64_t order_id = 0;
+  uint64_t new_order_id = 0;  // REPLACE_ORDER only
+  uint32_t price_raw = 0;     // Not set for DELETE_ORDER
+  uint32_t volume = 0;        // Not set for DELETE_ORDER
+  char side = '?';            // ADD_ORDER / REPLACE_ORDER only
+
+  [[nodiscard]] double price() const noexcept { return parse_price(price_raw); }
+};
+
+// Decode an order book message at `data` (message header included).
+// Returns false for non-book message types or truncated messages.
+[[nodiscard]] inline bool decode_book_message(const uint8_t *data,
+                                              size_t max_len,
+                                              uint16_t msg_type,
+                                              BookMessage &msg) noexcept {
+  msg.msg_type = msg_type;
+  switch (msg_type) {
+  case static_cast<uint16_t>(MessageType::ADD_ORDER):
+    if (max_len < MessageSize::ADD_ORDER)
+      return false;
+    msg.order_id = read_le64(data + 16);
+    msg.price_raw = read_le32(data + 24);
+    msg.volume = read_le32(data + 28);
+    msg.side = side_to_char(parse_side(data[32]));
+    break;
+
+  case static_cast<uint16_t>(MessageType::MODIFY_ORDER):
+    if (max_len < MessageSize::MODIFY_ORDER)
+      return false;
+    msg.order_id = read_le64(data + 16);
+    msg.price_raw = read_le32(data + 24);
+    msg.volume = read_le32(data + 28);
+    break;
+
+  case static_cast<uint16_t>(MessageType::DELETE_ORDER):
+    if (max_len < MessageSize::DELETE_ORDER)
+      return false;
+    msg.order_id = read_le64(data + 16);
+    break;
+
+  case static_cast<uint16_t>(MessageType::EXECUTE_ORDER):
+    if (max_len < MessageSize::EXECUTE_ORDER)
+      return false;
+    msg.order_id = read_le64(data + 16);
+    msg.price_raw = read_le32(data + 28);
+    msg.volume = read_le32(data + 32);
+    break;
+
+  case static_cast<uint16_t>(MessageType::REPLACE_ORDER):
+    if (max_len < MessageSize::REPLACE_ORDER)
+      return false;
+    msg.order_id = read_le64(data + 16);
+    msg.new_order_id = read_le64(data + 24);
+    msg.price_raw = read_le32(data + 32);
+    msg.volume = read_le32(data + 36);
+    msg.side = side_to_char(parse_side(data[40]));
+    break;
+
+  default:
+    return false;
+  }
+
+  msg.symbol_index = read_le32(data + 8);
+  return true;
+}
+
+// Iterate over the messages of one XDP packet payload.
+// The callback receives (message pointer, message size, message type).
+template <typename Callback>
+inline void for_each_message(const uint8_t *data, size_t length,
+                             Callback &&callback) {
+  if (length < PACKET_HEADER_SIZE)
+    return;
+
+  PacketHeader pkt_header;
+  if (!parse_packet_header(data, length, pkt_header))
+    return;
+
+  size_t offset = PACKET_HEADER_SIZE;
+  for (uint8_t i = 0; i < pkt_header.num_messages && offset < length; i++) {
+    if (offset + MESSAGE_HEADER_SIZE > length)
+      break;
+    uint16_t msg_size = read_le16(data + offset);
+    if (msg_size < MESSAGE_HEADER_SIZE || offset + msg_size > length)
+      break;
+    uint16_t msg_type = read_le16(data + offset + 2);
+    callback(data + offset, static_cast<size_t>(msg_size), msg_type);
+    offset += msg_size;
+  }
+}
+
+} // namespace xdp
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstring>
 #include <ctime>
+#include <stdexcept>
 #include <string>
 
 namespace xdp {
@@ -121,4 +122,22 @@ namespace xdp {
   return msg_size >= MESSAGE_HEADER_SIZE && msg_size <= remaining;
 }
 
+// Whole-argument unsigned decimal for command-line counts. Throws like
+// std::stoull on anything else, including the sign and trailing junk
+// std::stoull would accept.
+[[nodiscard]] inline uint64_t parse_count(const std::string &text) {
+  if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+    throw std::invalid_argument(text);
+  }
+  return std::stoull(text);
+}
+
+// parse_count() that also throws std::out_of_range above `max`, for counts
+// that get scaled or narrowed afterwards
+[[nodiscard]] inline uint64_t parse_count(const std::string &text, uint64_t max) {
+  const uint64_t value = parse_count(text);
+  if (value > max) throw std::out_of_range(text);
+  return value;
+}
+
 } // namespace xdp
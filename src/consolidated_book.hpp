@@ -0,0 +1,253 @@
+#pragma once
+
+#include "common/flat_u64_map.hpp"
+#include "common/xdp_book_messages.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xdp {
+
+// =============================================================================
+// Multi-venue consolidated book for xdp_consolidate
+//
+// Each venue's feed rebuilds its own order table and reduces every book
+// message to level updates: the venue's new total at each price level the
+// message touched. Level updates from all venues, merged by feed time, are
+// all a consolidated book needs. It keeps one row per price level with each
+// venue's shares, so it holds the per-venue books and their sum at once.
+// The consolidated BBO is the best level of the sum, together with the
+// venues quoting there.
+//
+// Venues are identified by their position on the command line (at most
+// MAX_VENUES). Securities are identified by a unified id shared by all
+// venues, assigned by ticker from each venue's own symbol map. Prices are
+// raw 1e-6 units, as in every NYSE-family XDP feed.
+// =============================================================================
+
+constexpr size_t MAX_VENUES = 8;
+
+struct LevelUpdate {
+  uint64_t ts_ns;
+  uint32_t security;  // Unified id
+  uint32_t price_raw;
+  uint32_t qty;       // Venue's shares at the level after the message (0 = gone)
+  uint8_t venue;
+  char side;          // 'B' or 'S'
+  uint8_t last;       // Last update of its message: the book is consistent
+  uint8_t reserved = 0;
+};
+static_assert(sizeof(LevelUpdate) == 24, "LevelUpdate layout changed");
+
+// Unified security ids by ticker
+class SecurityMaster {
+public:
+  uint32_t intern(const std::string &ticker) {
+    auto [it, added] = ids_.emplace(ticker, static_cast<uint32_t>(tickers_.size()));
+    if (added) tickers_.push_back(ticker);
+    return it->second;
+  }
+  [[nodiscard]] size_t size() const { return tickers_.size(); }
+  [[nodiscard]] const std::string &ticker(uint32_t id) const { return tickers_[id]; }
+  [[nodiscard]] const uint32_t *find(const std::string &ticker) const {
+    auto it = ids_.find(ticker);
+    return it == ids_.end() ? nullptr : &it->second;
+  }
+
+private:
+  std::unordered_map<std::string, uint32_t> ids_;
+  std::vector<std::string> tickers_;
+};
+
+// One venue's price-level totals, maintained from its order messages with the
+// same semantics as OrderBook. apply() calls emit(security, side, price, qty)
+// for every level the message changed.
+class VenueLevels {
+public:
+  template <typename Emit>
+  void apply(const BookMessage &m, uint32_t security, Emit &&emit) {
+    switch (m.msg_type) {
+    case static_cast<uint16_t>(MessageType::ADD_ORDER):
+      add(m.order_id, security, m.side, m.price_raw, m.volume, emit);
+      break;
+    case static_cast<uint16_t>(MessageType::MODIFY_ORDER):
+      if (Order *o = orders_.find(m.order_id)) {
+        // A modify keeps the side; price and size both change
+        const Order old = *o;
+        o->price = m.price_raw;
+        o->qty = m.volume;
+        change(old.security, old.side, old.price, -static_cast<int64_t>(old.qty), emit);
+        change(old.security, old.side, m.price_raw, m.volume, emit);
+      }
+      break;
+    case static_cast<uint16_t>(MessageType::DELETE_ORDER):
+      remove(m.order_id, emit);
+      break;
+    case static_cast<uint16_t>(MessageType::EXECUTE_ORDER):
+      if (Order *o = orders_.find(m.order_id)) {
+        const Order cur = *o;
+        if (cur.qty > m.volume) {
+          o->qty -= m.volume;
+          change(cur.security, cur.side, cur.price, -static_cast<int64_t>(m.volume), emit);
+        } else {
+          orders_.erase(m.order_id);
+          change(cur.security, cur.side, cur.price, -static_cast<int64_t>(cur.qty), emit);
+        }
+      }
+      break;
+    case static_cast<uint16_t>(MessageType::REPLACE_ORDER):
+      remove(m.order_id, emit);
+      add(m.new_order_id, security, m.side, m.price_raw, m.volume, emit);
+      break;
+    default:
+      break;
+    }
+  }
+
+  [[nodiscard]] size_t orders() const { return orders_.size(); }
+  [[nodiscard]] size_t levels() const { return levels_.size(); }
+
+private:
+  struct Order {
+    uint32_t security;
+    uint32_t price;
+    uint32_t qty;
+    char side;
+  };
+
+  static uint64_t key(uint32_t security, char side, uint32_t price) {
+    return (static_cast<uint64_t>(security) << 33) |
+           (static_cast<uint64_t>(side == 'S') << 32) | price;
+  }
+
+  template <typename Emit>
+  void add(uint64_t id, uint32_t security, char side, uint32_t price, uint32_t qty, Emit &emit) {
+    remove(id, emit);  // A reused id replaces the old order
+    orders_[id] = {security, price, qty, side};
+    change(security, side, price, qty, emit);
+  }
+
+  template <typename Emit> void remove(uint64_t id, Emit &emit) {
+    const Order *o = orders_.find(id);
+    if (!o) return;
+    const Order cur = *o;
+    orders_.erase(id);
+    change(cur.security, cur.side, cur.price, -static_cast<int64_t>(cur.qty), emit);
+  }
+
+  template <typename Emit>
+  void change(uint32_t security, char side, uint32_t price, int64_t delta, Emit &emit) {
+    if (delta == 0) return;
+    const uint64_t k = key(security, side, price);
+    uint32_t &level = levels_[k];
+    const int64_t qty = std::max<int64_t>(0, static_cast<int64_t>(level) + delta);
+    level = static_cast<uint32_t>(qty);
+    if (qty == 0) levels_.erase(k);
+    emit(security, side, price, static_cast<uint32_t>(qty));
+  }
+
+  FlatU64Map<Order> orders_;
+  FlatU64Map<uint32_t> levels_;  // (security, side, price) -> shares
+};
+
+struct ConsolidatedBbo {
+  uint32_t bid = 0;  // 0 = side empty
+  uint32_t ask = 0;
+  uint32_t bid_qty = 0;
+  uint32_t ask_qty = 0;
+  uint8_t bid_venues = 0;  // Bit per venue quoting at the best price
+  uint8_t ask_venues = 0;
+
+  [[nodiscard]] bool two_sided() const { return bid != 0 && ask != 0; }
+  [[nodiscard]] bool locked() const { return two_sided() && bid == ask; }
+  [[nodiscard]] bool crossed() const { return two_sided() && bid > ask; }
+  bool operator==(const ConsolidatedBbo &o) const {
+    return bid == o.bid && ask == o.ask && bid_qty == o.bid_qty && ask_qty == o.ask_qty &&
+           bid_venues == o.bid_venues && ask_venues == o.ask_venues;
+  }
+  bool operator!=(const ConsolidatedBbo &o) const { return !(*this == o); }
+};
+
+// Every venue's levels for one security, and their sum
+class ConsolidatedBook {
+public:
+  struct Level {
+    uint32_t total = 0;
+    uint32_t venue_qty[MAX_VENUES] = {};
+  };
+
+  void apply(const LevelUpdate &u) {
+    if (u.side == 'B') {
+      set(bids_, u);
+    } else {
+      set(asks_, u);
+    }
+  }
+
+  [[nodiscard]] ConsolidatedBbo bbo() const {
+    ConsolidatedBbo b;
+    if (!bids_.empty()) {
+      const auto &[price, level] = *bids_.begin();
+      b.bid = price;
+      b.bid_qty = level.total;
+      b.bid_venues = venue_mask(level);
+    }
+    if (!asks_.empty()) {
+      const auto &[price, level] = *asks_.begin();
+      b.ask = price;
+      b.ask_qty = level.total;
+      b.ask_venues = venue_mask(level);
+    }
+    return b;
+  }
+
+  // Best `depth` consolidated levels per side, best first
+  void top_levels(size_t depth, std::vector<std::pair<uint32_t, Level>> &bids,
+                  std::vector<std::pair<uint32_t, Level>> &asks) const {
+    for (auto it = bids_.begin(); it != bids_.end() && bids.size() < depth; ++it) bids.push_back(*it);
+    for (auto it = asks_.begin(); it != asks_.end() && asks.size() < depth; ++it) asks.push_back(*it);
+  }
+
+  // One venue's own best price on a side (0 = none)
+  [[nodiscard]] uint32_t venue_best(size_t venue, char side) const {
+    auto scan = [venue](const auto &levels) -> uint32_t {
+      for (const auto &[price, level] : levels) {
+        if (level.venue_qty[venue]) return price;
+      }
+      return 0;
+    };
+    return side == 'B' ? scan(bids_) : scan(asks_);
+  }
+
+private:
+  template <typename Levels> static void set(Levels &levels, const LevelUpdate &u) {
+    if (u.venue >= MAX_VENUES) return;
+    auto it = levels.find(u.price_raw);
+    if (it == levels.end()) {
+      if (u.qty == 0) return;
+      it = levels.emplace(u.price_raw, Level{}).first;
+    }
+    Level &level = it->second;
+    level.total = level.total - level.venue_qty[u.venue] + u.qty;
+    level.venue_qty[u.venue] = u.qty;
+    if (level.total == 0) levels.erase(it);
+  }
+
+  static uint8_t venue_mask(const Level &level) {
+    uint8_t mask = 0;
+    for (size_t v = 0; v < MAX_VENUES; ++v) {
+      if (level.venue_qty[v]) mask |= static_cast<uint8_t>(1u << v);
+    }
+    return mask;
+  }
+
+  std::map<uint32_t, Level, std::greater<uint32_t>> bids_;
+  std::map<uint32_t, Level> asks_;
+};
+
+} // namespace xdp
@@ -0,0 +1,302 @@
+#pragma once
+
+#include "common/cycle_clock.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mmsim {
+
+// =============================================================================
+// Per-symbol CPU cost accounting
+//
+// One message in every `cost_sample_interval` per symbol is timed with the
+// cycle counter. Time is attributed exclusively to the innermost open
+// CostScope, so nested scopes (e.g. feature work inside a strategy update)
+// are not double counted. Messages that are not sampled pay one branch per
+// scope.
+// =============================================================================
+
+enum class CostBucket : uint8_t {
+  BOOK = 0,     // Order book and order tracking mutations
+  FEATURE = 1,  // Feature trackers and toxicity model evaluation
+  STRATEGY = 2, // Quoting, fills, adverse-selection measurement
+  OTHER = 3,    // Dispatch, decoding and everything not in a scope above
+  COUNT = 4
+};
+
+inline const char *cost_bucket_name(CostBucket b) {
+  switch (b) {
+  case CostBucket::BOOK: return "book";
+  case CostBucket::FEATURE: return "feature";
+  case CostBucket::STRATEGY: return "strategy";
+  case CostBucket::OTHER: return "other";
+  case CostBucket::COUNT: break;
+  }
+  return "?";
+}
+
+constexpr size_t NUM_COST_BUCKETS = static_cast<size_t>(CostBucket::COUNT);
+
+struct SymbolCost {
+  uint64_t messages = 0;       // All messages dispatched to this symbol
+  uint64_t samples = 0;        // Messages that were timed
+  uint64_t cycles[NUM_COST_BUCKETS] = {};
+  uint32_t since_sample = 0;
+
+  // Innermost open scope while a sampled message is in flight
+  int current = -1;
+  uint64_t mark = 0;
+
+  uint64_t sampled_cycles() const {
+    uint64_t t = 0;
+    for (uint64_t c : cycles) t += c;
+    return t;
+  }
+
+  // Sampled cycles scaled up to every message of the symbol
+  double estimated_cycles() const {
+    return samples > 0 ? static_cast<double>(sampled_cycles()) *
+                             static_cast<double>(messages) /
+                             static_cast<double>(samples)
+                       : 0.0;
+  }
+
+  void merge(const SymbolCost &o) {
+    messages += o.messages;
+    samples += o.samples;
+    for (size_t i = 0; i < NUM_COST_BUCKETS; ++i) cycles[i] += o.cycles[i];
+  }
+};
+
+// RAII attribution of elapsed cycles to a bucket. `cost` is null for
+// messages that are not being sampled.
+class CostScope {
+public:
+  CostScope(SymbolCost *cost, CostBucket bucket) : cost_(cost) {
+    if (!cost_) return;
+    uint64_t now = xdp::read_cycles();
+    if (cost_->current >= 0) {
+      cost_->cycles[cost_->current] += now - cost_->mark;
+    }
+    prev_ = cost_->current;
+    cost_->current = static_cast<int>(bucket);
+    cost_->mark = now;
+  }
+
+  ~CostScope() { end(); }
+
+  // Close the scope before the end of the enclosing block
+  void end() {
+    if (!cost_) return;
+    uint64_t now = xdp::read_cycles();
+    cost_->cycles[cost_->current] += now - cost_->mark;
+    cost_->current = prev_;
+    cost_->mark = now;
+    cost_ = nullptr;
+  }
+
+  CostScope(const CostScope &) = delete;
+  CostScope &operator=(const CostScope &) = delete;
+
+private:
+  SymbolCost *cost_;
+  int prev_ = -1;
+};
+
+// =============================================================================
+// Cost profile file (CSV)
+//
+//   # mmsim cost profile v1 cycles_per_ns=<f> sample_interval=<n>
+//   ticker,symbol_index,messages,samples,book_cycles,feature_cycles,
+//   strategy_cycles,other_cycles,est_cycles,est_ms,share
+//
+// Raw sampled sums are stored so partial profiles (one per hybrid group)
+// merge by addition; est_* and share are derived for humans and for
+// partitioners that only need a relative weight per symbol.
+// =============================================================================
+
+struct CostProfileEntry {
+  std::string ticker;
+  uint32_t symbol_index = 0;
+  SymbolCost cost;
+};
+
+struct CostProfile {
+  double cycles_per_ns = 1.0;
+  uint32_t sample_interval = 0;
+  std::vector<CostProfileEntry> entries;
+
+  double total_estimated_cycles() const {
+    double t = 0.0;
+    for (const auto &e : entries) t += e.cost.estimated_cycles();
+    return t;
+  }
+
+  // Add another profile's counts, matching symbols by ticker
+  void merge(const CostProfile &o) {
+    std::unordered_map<std::string, size_t> pos;
+    for (size_t i = 0; i < entries.size(); ++i) pos[entries[i].ticker] = i;
+    for (const auto &e : o.entries) {
+      auto it = pos.find(e.ticker);
+      if (it == pos.end()) {
+        pos[e.ticker] = entries.size();
+        entries.push_back(e);
+      } else {
+        entries[it->second].cost.merge(e.cost);
+      }
+    }
+    if (sample_interval == 0) sample_interval = o.sample_interval;
+  }
+
+  // Most expensive first
+  void sort_by_cost() {
+    std::sort(entries.begin(), entries.end(),
+              [](const CostProfileEntry &a, const CostProfileEntry &b) {
+                return a.cost.estimated_cycles() > b.cost.estimated_cycles();
+              });
+  }
+
+  // Relative cost per ticker (sums to 1), for balancing partitions
+  std::unordered_map<std::string, double> weights() const {
+    std::unordered_map<std::string, double> w;
+    double total = total_estimated_cycles();
+    for (const auto &e : entries) {
+      w[e.ticker] = total > 0 ? e.cost.estimated_cycles() / total : 0.0;
+    }
+    return w;
+  }
+};
+
+[[nodiscard]] inline bool write_cost_profile(const std::string &path,
+                                             const CostProfile &profile) {
+  std::ofstream out(path);
+  if (!out.is_open()) return false;
+  double total = profile.total_estimated_cycles();
+  out << "# mmsim cost profile v1 cycles_per_ns=" << std::setprecision(6)
+      << profile.cycles_per_ns << " sample_interval=" << profile.sample_interval
+      << "\n";
+  out << "ticker,symbol_index,messages,samples,book_cycles,feature_cycles,"
+      << "strategy_cycles,other_cycles,est_cycles,est_ms,share\n";
+  for (const auto &e : profile.entries) {
+    const SymbolCost &c = e.cost;
+    double est = c.estimated_cycles();
+    out << e.ticker << ',' << e.symbol_index << ',' << c.messages << ','
+        << c.samples;
+    for (uint64_t cy : c.cycles) out << ',' << cy;
+    out << ',' << std::fixed << std::setprecision(0) << est << ','
+        << std::setprecision(3) << est / profile.cycles_per_ns / 1e6 << ','
+        << std::setprecision(6) << (total > 0 ? est / total : 0.0) << '\n';
+    out.unsetf(std::ios::floatfield);
+  }
+  return static_cast<bool>(out);
+}
+
+[[nodiscard]] inline bool load_cost_profile(const std::string &path,
+                                            CostProfile &profile,
+                                            std::string &err) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    err = "cannot open " + path;
+    return false;
+  }
+  profile = CostProfile{};
+  std::string line;
+  size_t line_no = 0;
+  while (std::getline(in, line)) {
+    ++line_no;
+    if (line.empty()) continue;
+    if (line[0] == '#') {
+      auto read_kv = [&](const char *key, auto &dst) {
+        size_t p = line.find(key);
+        if (p != std::string::npos) {
+          std::istringstream(line.substr(p + std::char_traits<char>::length(key))) >> dst;
+        }
+      };
+      read_kv("cycles_per_ns=", profile.cycles_per_ns);
+      read_kv("sample_interval=", profile.sample_interval);
+      continue;
+    }
+    if (line.rfind("ticker,", 0) == 0) continue;
+
+    std::istringstream ss(line);
+    std::string field;
+    std::vector<std::string> f;
+    while (std::getline(ss, field, ',')) f.push_back(field);
+    if (f.size() < 4 + NUM_COST_BUCKETS) {
+      err = path + ":" + std::to_string(line_no) + ": expected at least " +
+            std::to_string(4 + NUM_COST_BUCKETS) + " columns";
+      return false;
+    }
+    try {
+      CostProfileEntry e;
+      e.ticker = f[0];
+      e.symbol_index = static_cast<uint32_t>(std::stoul(f[1]));
+      e.cost.messages = std::stoull(f[2]);
+      e.cost.samples = std::stoull(f[3]);
+      for (size_t i = 0; i < NUM_COST_BUCKETS; ++i) {
+        e.cost.cycles[i] = std::stoull(f[4 + i]);
+      }
+      profile.entries.push_back(std::move(e));
+    } catch (const std::exception &) {
+      err = path + ":" + std::to_string(line_no) + ": malformed number";
+      return false;
+    }
+  }
+  if (profile.cycles_per_ns <= 0) profile.cycles_per_ns = 1.0;
+  return true;
+}
+
+// Per-symbol cost table, most expensive first
+inline void print_cost_table(std::ostream &os, CostProfile profile,
+                             size_t top_n = 20) {
+  profile.sort_by_cost();
+  double total = profile.total_estimated_cycles();
+  uint64_t total_msgs = 0;
+  for (const auto &e : profile.entries) total_msgs += e.cost.messages;
+
+  os << "\n=== PER-SYMBOL CPU COST (sampled 1/" << profile.sample_interval
+     << ", " << std::fixed << std::setprecision(2) << profile.cycles_per_ns
+     << " cycles/ns) ===\n";
+  os << "Estimated symbol CPU: " << std::setprecision(2)
+     << total / profile.cycles_per_ns / 1e9 << " s over " << total_msgs
+     << " msgs across " << profile.entries.size() << " symbols\n";
+  os << std::left << std::setw(8) << "Ticker" << std::right << std::setw(12)
+     << "Msgs" << std::setw(10) << "ns/msg" << std::setw(10) << "Est ms"
+     << std::setw(8) << "Share" << std::setw(8) << "Cum" << std::setw(8)
+     << "Book" << std::setw(9) << "Feature" << std::setw(10) << "Strategy"
+     << std::setw(8) << "Other" << '\n';
+  double cum = 0.0;
+  size_t n = std::min(top_n, profile.entries.size());
+  for (size_t i = 0; i < n; ++i) {
+    const auto &e = profile.entries[i];
+    const SymbolCost &c = e.cost;
+    double est = c.estimated_cycles();
+    double share = total > 0 ? est / total : 0.0;
+    cum += share;
+    double sampled = static_cast<double>(c.sampled_cycles());
+    double ns_per_msg = c.samples > 0
+        ? sampled / static_cast<double>(c.samples) / profile.cycles_per_ns : 0.0;
+    auto pct = [&](CostBucket b) {
+      return sampled > 0 ? 100.0 * c.cycles[static_cast<size_t>(b)] / sampled : 0.0;
+    };
+    os << std::left << std::setw(8) << e.ticker << std::right << std::setw(12)
+       << c.messages << std::setw(10) << std::setprecision(0) << ns_per_msg
+       << std::setw(10) << std::setprecision(1)
+       << est / profile.cycles_per_ns / 1e6 << std::setw(7)
+       << 100.0 * share << '%' << std::setw(7) << 100.0 * cum << '%'
+       << std::setw(7) << pct(CostBucket::BOOK) << '%' << std::setw(8)
+       << pct(CostBucket::FEATURE) << '%' << std::setw(9)
+       << pct(CostBucket::STRATEGY) << '%' << std::setw(7)
+       << pct(CostBucket::OTHER) << "%\n";
+  }
+}
+
+} // namespace mmsim
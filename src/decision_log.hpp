@@ -0,0 +1,406 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace mmsim {
+
+// =============================================================================
+// Per-symbol strategy decision log (.mmlog)
+//
+// Fixed-size binary records in feed-time order, written by market_maker_sim
+// and replayed by visualizer_pcap on top of the real book:
+//
+//   [DecisionLogHeader][DecisionRecord x record_count]
+//
+// A sparse index sidecar (<file>.idx) holds (ts_ns, record number) for every
+// DECISION_INDEX_STRIDE-th record so a reader can seek to any feed time
+// without touching the whole file. Records are only appended, except that a
+// FILL record is patched in place once its adverse outcome is measured.
+// =============================================================================
+
+enum class DecisionType : uint8_t {
+  QUOTE = 1,    // Quoted prices/sizes changed
+  SUPPRESS = 2, // Quoting suppressed (logged on the transition only)
+  FILL = 3      // Virtual order filled
+};
+
+// Why the toxicity strategy stopped quoting (SUPPRESS flags)
+enum class SuppressReason : uint8_t {
+  TOXICITY_THRESHOLD = 1, // Average toxicity above quote threshold
+  EXPECTED_PNL = 2        // E[PnL] below epsilon_min
+};
+
+// FILL flags
+constexpr uint8_t FILL_FLAG_MEASURED = 0x01; // Adverse outcome known
+constexpr uint8_t FILL_FLAG_ADVERSE = 0x02;  // Mid moved against the fill
+
+constexpr double DECISION_PRICE_SCALE = 10000.0; // Prices in 1/10000 dollars
+constexpr uint32_t DECISION_INDEX_STRIDE = 1024;
+
+struct DecisionRecord {
+  uint64_t ts_ns = 0;      // Feed time of the decision / fill
+  uint8_t type = 0;        // DecisionType
+  char side = 0;           // FILL: 'B' or 'S'
+  uint8_t flags = 0;       // SUPPRESS: SuppressReason, FILL: FILL_FLAG_*
+  uint8_t reserved = 0;
+  uint32_t qty_a = 0;      // QUOTE: bid size, FILL: fill qty
+  uint32_t qty_b = 0;      // QUOTE: ask size
+  int32_t px_a = 0;        // QUOTE: bid, FILL: fill price
+  int32_t px_b = 0;        // QUOTE: ask, FILL: mid at fill
+  float f0 = 0.0f;         // Toxicity at decision / fill
+  float f1 = 0.0f;         // SUPPRESS: E[PnL], FILL: adverse PnL ($)
+  int32_t inventory = 0;   // Strategy inventory at decision time
+
+  [[nodiscard]] DecisionType kind() const noexcept {
+    return static_cast<DecisionType>(type);
+  }
+  [[nodiscard]] double price_a() const noexcept { return px_a / DECISION_PRICE_SCALE; }
+  [[nodiscard]] double price_b() const noexcept { return px_b / DECISION_PRICE_SCALE; }
+};
+static_assert(sizeof(DecisionRecord) == 40, "DecisionRecord layout changed");
+
+struct DecisionLogHeader {
+  char magic[8] = {'M', 'M', 'D', 'L', 'O', 'G', '1', '\0'};
+  uint32_t version = 1;
+  uint32_t symbol_index = 0;
+  uint64_t record_count = 0; // Patched on close; 0 = derive from file size
+  char ticker[16] = {};
+  uint32_t group = 0;        // Hybrid process group (0 = single process)
+  uint32_t reserved = 0;
+};
+static_assert(sizeof(DecisionLogHeader) == 48, "DecisionLogHeader layout changed");
+
+struct DecisionIndexEntry {
+  uint64_t ts_ns;
+  uint64_t record;
+};
+
+inline int32_t to_decision_price(double price) {
+  return static_cast<int32_t>(std::llround(price * DECISION_PRICE_SCALE));
+}
+
+// Buffered single-writer. Not thread-safe: callers hold the symbol's lock.
+class DecisionLogWriter {
+public:
+  DecisionLogWriter() = default;
+  ~DecisionLogWriter() { close(); }
+
+  DecisionLogWriter(const DecisionLogWriter &) = delete;
+  DecisionLogWriter &operator=(const DecisionLogWriter &) = delete;
+
+  bool open(const std::string &path, uint32_t symbol_index,
+            const std::string &ticker, uint32_t group) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+      return false;
+    path_ = path;
+    header_ = DecisionLogHeader{};
+    header_.symbol_index = symbol_index;
+    header_.group = group;
+    std::strncpy(header_.ticker, ticker.c_str(), sizeof(header_.ticker) - 1);
+    if (!write_header()) {
+      ::close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    (void)::lseek(fd_, sizeof(header_), SEEK_SET);
+    buffer_.reserve(BUFFER_RECORDS);
+    return true;
+  }
+
+  [[nodiscard]] bool is_open() const { return fd_ >= 0; }
+
+  // Log a quote only if it differs from the last logged quote
+  void log_quote(uint64_t ts_ns, double bid, double ask, uint32_t bid_size,
+                 uint32_t ask_size, double toxicity, double inventory) {
+    DecisionRecord r;
+    r.ts_ns = ts_ns;
+    r.type = static_cast<uint8_t>(DecisionType::QUOTE);
+    r.qty_a = bid_size;
+    r.qty_b = ask_size;
+    r.px_a = to_decision_price(bid);
+    r.px_b = to_decision_price(ask);
+    if (!suppressed_ && has_quote_ && r.px_a == last_quote_.px_a &&
+        r.px_b == last_quote_.px_b && r.qty_a == last_quote_.qty_a &&
+        r.qty_b == last_quote_.qty_b) {
+      return;
+    }
+    r.f0 = static_cast<float>(toxicity);
+    r.inventory = static_cast<int32_t>(inventory);
+    last_quote_ = r;
+    has_quote_ = true;
+    suppressed_ = false;
+    append(r);
+  }
+
+  // Log a suppression on the quoting -> suppressed transition
+  void log_suppress(uint64_t ts_ns, SuppressReason reason, double expected_pnl,
+                    double toxicity, double inventory) {
+    if (suppressed_)
+      return;
+    suppressed_ = true;
+    DecisionRecord r;
+    r.ts_ns = ts_ns;
+    r.type = static_cast<uint8_t>(DecisionType::SUPPRESS);
+    r.flags = static_cast<uint8_t>(reason);
+    r.f0 = static_cast<float>(toxicity);
+    r.f1 = static_cast<float>(expected_pnl);
+    r.inventory = static_cast<int32_t>(inventory);
+    append(r);
+  }
+
+  // Log a fill; returns its record number for a later mark_fill_measured()
+  uint64_t log_fill(uint64_t ts_ns, bool is_buy, double price, uint32_t qty,
+                    double mid, double toxicity, double inventory) {
+    DecisionRecord r;
+    r.ts_ns = ts_ns;
+    r.type = static_cast<uint8_t>(DecisionType::FILL);
+    r.side = is_buy ? 'B' : 'S';
+    r.qty_a = qty;
+    r.px_a = to_decision_price(price);
+    r.px_b = to_decision_price(mid);
+    r.f0 = static_cast<float>(toxicity);
+    r.inventory = static_cast<int32_t>(inventory);
+    return append(r);
+  }
+
+  // Record the adverse outcome of an earlier fill (patched in place)
+  void mark_fill_measured(uint64_t record, double adverse_pnl) {
+    if (fd_ < 0 || record >= next_record_)
+      return;
+    if (record >= flushed_records_) {
+      DecisionRecord &r = buffer_[record - flushed_records_];
+      r.flags |= FILL_FLAG_MEASURED | (adverse_pnl < 0.0 ? FILL_FLAG_ADVERSE : 0);
+      r.f1 = static_cast<float>(adverse_pnl);
+      return;
+    }
+    DecisionRecord r;
+    off_t offset = static_cast<off_t>(sizeof(DecisionLogHeader) +
+                                      record * sizeof(DecisionRecord));
+    if (::pread(fd_, &r, sizeof(r), offset) != static_cast<ssize_t>(sizeof(r)))
+      return;
+    r.flags |= FILL_FLAG_MEASURED | (adverse_pnl < 0.0 ? FILL_FLAG_ADVERSE : 0);
+    r.f1 = static_cast<float>(adverse_pnl);
+    (void)::pwrite(fd_, &r, sizeof(r), offset);
+  }
+
+  // Flush records, write the index sidecar and finalize the header.
+  // Must be called explicitly before _exit() in forked workers.
+  void close() {
+    if (fd_ < 0)
+      return;
+    flush();
+    header_.record_count = next_record_;
+    (void)write_header();
+    ::close(fd_);
+    fd_ = -1;
+
+    int idx_fd = ::open((path_ + ".idx").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (idx_fd >= 0) {
+      uint32_t idx_header[4] = {0x5844494Du /* "MIDX" */, 1, DECISION_INDEX_STRIDE, 0};
+      (void)::write(idx_fd, idx_header, sizeof(idx_header));
+      if (!index_.empty()) {
+        (void)::write(idx_fd, index_.data(), index_.size() * sizeof(DecisionIndexEntry));
+      }
+      ::close(idx_fd);
+    }
+  }
+
+  [[nodiscard]] uint64_t records_written() const { return next_record_; }
+
+private:
+  static constexpr size_t BUFFER_RECORDS = 4096;
+
+  uint64_t append(const DecisionRecord &r) {
+    if (fd_ < 0)
+      return UINT64_MAX;
+    if (next_record_ % DECISION_INDEX_STRIDE == 0) {
+      index_.push_back({r.ts_ns, next_record_});
+    }
+    buffer_.push_back(r);
+    uint64_t record = next_record_++;
+    if (buffer_.size() >= BUFFER_RECORDS)
+      flush();
+    return record;
+  }
+
+  bool write_header() {
+    uint8_t raw[sizeof(DecisionLogHeader)];
+    std::memcpy(raw, &header_, sizeof(raw));
+    return ::pwrite(fd_, raw, sizeof(raw), 0) == static_cast<ssize_t>(sizeof(raw));
+  }
+
+  void flush() {
+    if (fd_ < 0 || buffer_.empty())
+      return;
+    const char *data = reinterpret_cast<const char *>(buffer_.data());
+    size_t remaining = buffer_.size() * sizeof(DecisionRecord);
+    while (remaining > 0) {
+      ssize_t n = ::write(fd_, data, remaining);
+      if (n <= 0)
+        break;
+      data += n;
+      remaining -= static_cast<size_t>(n);
+    }
+    flushed_records_ += buffer_.size();
+    buffer_.clear();
+  }
+
+  int fd_ = -1;
+  std::string path_;
+  DecisionLogHeader header_;
+  std::vector<DecisionRecord> buffer_;
+  std::vector<DecisionIndexEntry> index_;
+  uint64_t next_record_ = 0;
+  uint64_t flushed_records_ = 0;
+
+  // Change detection so unchanged quotes cost nothing on disk
+  DecisionRecord last_quote_;
+  bool has_quote_ = false;
+  bool suppressed_ = false;
+};
+
+// Read-only memory-mapped view of a decision log plus its sparse index
+class DecisionLogReader {
+public:
+  DecisionLogReader() = default;
+  ~DecisionLogReader() { close(); }
+
+  DecisionLogReader(const DecisionLogReader &) = delete;
+  DecisionLogReader &operator=(const DecisionLogReader &) = delete;
+  DecisionLogReader(DecisionLogReader &&other) noexcept { *this = std::move(other); }
+  DecisionLogReader &operator=(DecisionLogReader &&other) noexcept {
+    if (this != &other) {
+      close();
+      map_ = other.map_;
+      map_size_ = other.map_size_;
+      records_ = other.records_;
+      count_ = other.count_;
+      header_ = other.header_;
+      index_ = std::move(other.index_);
+      other.map_ = nullptr;
+      other.map_size_ = 0;
+      other.records_ = nullptr;
+      other.count_ = 0;
+    }
+    return *this;
+  }
+
+  bool open(const std::string &path, std::string &error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      error = "cannot open " + path;
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(DecisionLogHeader)) {
+      ::close(fd);
+      error = "not a decision log: " + path;
+      return false;
+    }
+    map_size_ = static_cast<size_t>(st.st_size);
+    void *map = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+      map_size_ = 0;
+      error = "mmap failed for " + path;
+      return false;
+    }
+    map_ = static_cast<const uint8_t *>(map);
+    std::memcpy(&header_, map_, sizeof(header_));
+    if (std::memcmp(header_.magic, DecisionLogHeader{}.magic, sizeof(header_.magic)) != 0) {
+      close();
+      error = "bad magic in " + path;
+      return false;
+    }
+
+    records_ = reinterpret_cast<const DecisionRecord *>(map_ + sizeof(DecisionLogHeader));
+    uint64_t in_file = (map_size_ - sizeof(DecisionLogHeader)) / sizeof(DecisionRecord);
+    count_ = header_.record_count > 0 ? std::min(header_.record_count, in_file) : in_file;
+
+    if (!load_index(path + ".idx")) {
+      // Missing sidecar (e.g. the run was killed): sample the records instead
+      index_.clear();
+      for (uint64_t i = 0; i < count_; i += DECISION_INDEX_STRIDE) {
+        index_.push_back({records_[i].ts_ns, i});
+      }
+    }
+    return true;
+  }
+
+  void close() {
+    if (map_) {
+      munmap(const_cast<uint8_t *>(map_), map_size_);
+    }
+    map_ = nullptr;
+    map_size_ = 0;
+    records_ = nullptr;
+    count_ = 0;
+    index_.clear();
+  }
+
+  [[nodiscard]] size_t size() const { return count_; }
+  [[nodiscard]] const DecisionRecord &operator[](size_t i) const { return records_[i]; }
+  [[nodiscard]] const DecisionLogHeader &header() const { return header_; }
+  [[nodiscard]] uint64_t first_ts() const { return count_ ? records_[0].ts_ns : 0; }
+  [[nodiscard]] uint64_t last_ts() const { return count_ ? records_[count_ - 1].ts_ns : 0; }
+
+  // First record with ts_ns >= ts (size() if none). Binary search over the
+  // sparse index, then a scan of at most one stride of records.
+  [[nodiscard]] size_t lower_bound(uint64_t ts) const {
+    if (count_ == 0)
+      return 0;
+    auto it = std::lower_bound(
+        index_.begin(), index_.end(), ts,
+        [](const DecisionIndexEntry &e, uint64_t t) { return e.ts_ns < t; });
+    uint64_t start = (it == index_.begin()) ? 0 : std::prev(it)->record;
+    uint64_t end = (it == index_.end()) ? count_ : std::min<uint64_t>(it->record + 1, count_);
+    const DecisionRecord *first = records_ + start;
+    const DecisionRecord *last = records_ + end;
+    const DecisionRecord *pos = std::lower_bound(
+        first, last, ts,
+        [](const DecisionRecord &r, uint64_t t) { return r.ts_ns < t; });
+    return static_cast<size_t>(pos - records_);
+  }
+
+private:
+  bool load_index(const std::string &idx_path) {
+    int fd = ::open(idx_path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    uint32_t idx_header[4];
+    bool ok = ::read(fd, idx_header, sizeof(idx_header)) ==
+                  static_cast<ssize_t>(sizeof(idx_header)) &&
+              idx_header[0] == 0x5844494Du && idx_header[2] > 0;
+    if (ok) {
+      DecisionIndexEntry entry;
+      while (::read(fd, &entry, sizeof(entry)) == static_cast<ssize_t>(sizeof(entry))) {
+        if (entry.record < count_)
+          index_.push_back(entry);
+      }
+    }
+    ::close(fd);
+    return ok && (count_ == 0 || !index_.empty());
+  }
+
+  const uint8_t *map_ = nullptr;
+  size_t map_size_ = 0;
+  const DecisionRecord *records_ = nullptr;
+  uint64_t count_ = 0;
+  DecisionLogHeader header_;
+  std::vector<DecisionIndexEntry> index_;
+};
+
+} // namespace mmsim
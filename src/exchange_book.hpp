@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace xdp {
+
+// =============================================================================
+// Price-time priority book for xdp_exchange_sim
+//
+// Holds the replayed feed's orders and our own orders in one FIFO per price
+// level, so our orders queue behind whatever was resting when they arrived
+// and move up as the feed cancels and executes ahead of them. The feed is
+// history and cannot react to us, so matching is one-sided:
+//
+// - Our aggressive orders take displayed feed liquidity at its resting
+//   prices. What we take is remembered per feed order, so the same shares
+//   cannot be taken twice, but the feed order itself stays in the book until
+//   the feed removes it.
+// - Our resting orders fill when the feed shows they would have traded:
+//   * an execution at our level against an order queued behind us;
+//   * an execution at a worse price on our side, which swept through us;
+//   * a feed order arriving or repricing through our price.
+//   Each fill is capped by the size of the feed event. Fills happen at our
+//   price and never change the feed orders.
+//
+// Our orders never match each other. Prices are raw 1e-6 units.
+// =============================================================================
+
+struct ExchangeFill {
+  uint64_t ref;       // Our order ref
+  uint32_t qty;
+  uint32_t price_raw;
+  char liquidity;     // 'A' resting, 'R' aggressive
+  bool done;          // Order fully filled and removed
+};
+
+class ExchangeBook {
+public:
+  // --- Feed events ---
+
+  void feed_add(uint64_t id, char side, uint32_t price, uint32_t qty,
+                std::vector<ExchangeFill> &fills) {
+    feed_delete(id); // A reused id replaces the old order
+    const uint32_t matched = cross_own(side, price, qty, fills);
+    Level &level = side_levels(side)[key(side, price)];
+    level.queue.push_back({id, qty, matched, false});
+    feed_[id] = {side, price, std::prev(level.queue.end())};
+  }
+
+  // A modify loses queue priority, as in OrderBook::modify_order
+  void feed_modify(uint64_t id, uint32_t price, uint32_t qty, std::vector<ExchangeFill> &fills) {
+    auto it = feed_.find(id);
+    if (it == feed_.end())
+      return;
+    const char side = it->second.side;
+    erase(it->second);
+    feed_.erase(it);
+    feed_add(id, side, price, qty, fills);
+  }
+
+  void feed_delete(uint64_t id) {
+    auto it = feed_.find(id);
+    if (it == feed_.end())
+      return;
+    erase(it->second);
+    feed_.erase(it);
+  }
+
+  void feed_execute(uint64_t id, uint32_t qty, std::vector<ExchangeFill> &fills) {
+    auto it = feed_.find(id);
+    if (it == feed_.end())
+      return;
+    Loc loc = it->second;
+    Levels &levels = side_levels(loc.side);
+    const int64_t k = key(loc.side, loc.price);
+
+    // The aggressor reached this order, so it passed everything queued in
+    // front of it: our orders at better prices, then ours ahead at this level
+    uint32_t budget = qty;
+    for (auto lv = levels.begin(); lv != levels.end() && lv->first < k && budget > 0;) {
+      auto next = std::next(lv);
+      fill_own_in(lv, lv->first, budget, lv->second.queue.end(), fills);
+      lv = next;
+    }
+    auto lv = levels.find(k);
+    if (budget > 0 && lv != levels.end())
+      fill_own_in(lv, k, budget, loc.it, fills);
+
+    Entry &e = *loc.it;
+    if (e.qty > qty) {
+      e.qty -= qty;
+      e.taken = std::min(e.taken, e.qty);
+    } else {
+      erase(loc);
+      feed_.erase(id);
+    }
+  }
+
+  // --- Our orders ---
+
+  // Match against the feed, then rest any remainder unless IOC. Returns the
+  // quantity left resting.
+  uint32_t enter(uint64_t ref, char side, uint32_t price, uint32_t qty, bool ioc,
+                 std::vector<ExchangeFill> &fills) {
+    const char opp = side == 'B' ? 'S' : 'B';
+    Levels &levels = side_levels(opp);
+    const int64_t limit = key(opp, price);
+    uint32_t remaining = qty;
+    for (auto lv = levels.begin(); lv != levels.end() && lv->first <= limit && remaining > 0;
+         ++lv) {
+      const uint32_t level_price = price_of(opp, lv->first);
+      for (Entry &e : lv->second.queue) {
+        if (e.ours || e.qty <= e.taken)
+          continue;
+        const uint32_t take = std::min(remaining, e.qty - e.taken);
+        e.taken += take;
+        remaining -= take;
+        fills.push_back({ref, take, level_price, 'R', remaining == 0});
+        if (remaining == 0)
+          break;
+      }
+    }
+    if (remaining == 0 || ioc)
+      return 0;
+    Level &level = side_levels(side)[key(side, price)];
+    level.queue.push_back({ref, remaining, 0, true});
+    own_[ref] = {side, price, std::prev(level.queue.end())};
+    return remaining;
+  }
+
+  // Remove a resting order; returns its open quantity (0 if not resting)
+  uint32_t cancel(uint64_t ref) {
+    auto it = own_.find(ref);
+    if (it == own_.end())
+      return 0;
+    const uint32_t open = it->second.it->qty;
+    erase(it->second);
+    own_.erase(it);
+    return open;
+  }
+
+  // Shrink a resting order in place, keeping its queue position and moving
+  // it to a new ref. False if the order is not resting or would grow.
+  bool reduce(uint64_t ref, uint64_t new_ref, uint32_t qty) {
+    auto it = own_.find(ref);
+    if (it == own_.end() || qty == 0 || qty > it->second.it->qty)
+      return false;
+    Loc loc = it->second;
+    loc.it->qty = qty;
+    loc.it->id = new_ref;
+    own_.erase(it);
+    own_[new_ref] = loc;
+    return true;
+  }
+
+  [[nodiscard]] bool resting(uint64_t ref, char &side, uint32_t &price, uint32_t &qty) const {
+    auto it = own_.find(ref);
+    if (it == own_.end())
+      return false;
+    side = it->second.side;
+    price = it->second.price;
+    qty = it->second.it->qty;
+    return true;
+  }
+
+  [[nodiscard]] std::vector<uint64_t> own_refs() const {
+    std::vector<uint64_t> refs;
+    refs.reserve(own_.size());
+    for (const auto &[ref, loc] : own_) refs.push_back(ref);
+    return refs;
+  }
+
+  [[nodiscard]] size_t feed_orders() const { return feed_.size(); }
+
+private:
+  struct Entry {
+    uint64_t id;     // Feed order id or our ref
+    uint32_t qty;    // Open quantity
+    uint32_t taken;  // Feed orders: shares our aggressive orders already took
+    bool ours;
+  };
+  using Queue = std::list<Entry>;
+  struct Level {
+    Queue queue;
+  };
+  // Keyed best-first on both sides: -price for bids, price for asks
+  using Levels = std::map<int64_t, Level>;
+  struct Loc {
+    char side;
+    uint32_t price;
+    Queue::iterator it;
+  };
+
+  static int64_t key(char side, uint32_t price) {
+    return side == 'B' ? -static_cast<int64_t>(price) : static_cast<int64_t>(price);
+  }
+  static uint32_t price_of(char side, int64_t k) {
+    return static_cast<uint32_t>(side == 'B' ? -k : k);
+  }
+
+  Levels &side_levels(char side) { return side == 'B' ? bids_ : asks_; }
+
+  void erase(const Loc &loc) {
+    Levels &levels = side_levels(loc.side);
+    auto lv = levels.find(key(loc.side, loc.price));
+    lv->second.queue.erase(loc.it);
+    if (lv->second.queue.empty())
+      levels.erase(lv);
+  }
+
+  // Fill our orders in one level, front to back up to `stop`, within budget
+  void fill_own_in(Levels::iterator lv, int64_t k, uint32_t &budget, Queue::iterator stop,
+                   std::vector<ExchangeFill> &fills) {
+    const char side = k < 0 ? 'B' : 'S';
+    const uint32_t price = price_of(side, k);
+    Queue &q = lv->second.queue;
+    for (auto e = q.begin(); e != stop && budget > 0;) {
+      if (!e->ours) {
+        ++e;
+        continue;
+      }
+      const uint32_t take = std::min(budget, e->qty);
+      budget -= take;
+      e->qty -= take;
+      const bool done = e->qty == 0;
+      fills.push_back({e->id, take, price, 'A', done});
+      if (done) {
+        own_.erase(e->id);
+        e = q.erase(e);
+      } else {
+        ++e;
+      }
+    }
+    if (q.empty())
+      side_levels(side).erase(lv);
+  }
+
+  // A feed order on `side` at `price` trades with our resting orders on the
+  // other side that it crosses. Returns the quantity it gave us.
+  uint32_t cross_own(char side, uint32_t price, uint32_t qty, std::vector<ExchangeFill> &fills) {
+    const char opp = side == 'B' ? 'S' : 'B';
+    Levels &levels = side_levels(opp);
+    const int64_t limit = key(opp, price);
+    uint32_t budget = qty;
+    for (auto lv = levels.begin(); lv != levels.end() && lv->first <= limit && budget > 0;) {
+      auto next = std::next(lv);
+      fill_own_in(lv, lv->first, budget, lv->second.queue.end(), fills);
+      lv = next;
+    }
+    return qty - budget;
+  }
+
+  Levels bids_, asks_;
+  std::unordered_map<uint64_t, Loc> feed_;
+  std::unordered_map<uint64_t, Loc> own_;
+};
+
+} // namespace xdp
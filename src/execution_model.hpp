@@ -1,5 +1,12 @@
 #pragma once
 
+#include "basket_nav.hpp"
+#include "bbo_table.hpp"
+#include "common/session_calendar.hpp"
+#include "markout.hpp"
+#include "overload_control.hpp"
+#include "strategy_plugin.hpp"
+
 #include <cstdint>
 #include <string>
 
@@ -70,6 +77,10 @@ struct ExecutionModelConfig {
 struct SimConfig {
   ExecutionModelConfig exec;
   std::string output_dir;       // Output directory for CSV files (empty = no CSV)
+  std::string decision_log_dir; // Per-symbol decision logs (empty = disabled)
+  uint32_t decision_log_group = 0; // Hybrid group id for log file names (0 = none)
+  uint32_t cost_sample_interval = 0; // Time 1 in N messages per symbol (0 = off)
+  std::string cost_profile_path;     // Per-symbol cost profile CSV (empty = none)
   bool online_learning = false; // Enable online SGD toxicity model
   double learning_rate = 0.05;  // Base learning rate for SGD
   int warmup_fills = 2;         // Fills before SGD kicks in
@@ -92,6 +103,30 @@ struct SimConfig {
   // learn weights in window N-1, freeze and apply in window N.
   bool walk_forward = false;
   int wf_window_minutes = 30;  // Window size in minutes (default: 13 x 30-min windows)
+
+  // Session boundaries (EOD liquidation, --from/--to, walk-forward windows),
+  // built once in main from the capture time range before any sim runs.
+  xdp::SessionCalendar calendar;
+
+  // Markout horizons (--markouts; count 0 = off). Per-fill markouts are
+  // kept for CSV output only when output_dir is set.
+  MarkoutHorizons markout_horizons;
+
+  // Paced replay and overload shedding (--replay-speed; off by default)
+  OverloadConfig overload;
+
+  // Cross-symbol top-of-book table the workers publish into (null = off)
+  BboTable* bbo_table = nullptr;
+
+  // ETF/basket NAV engine fed by the same publishes (--baskets; null = off).
+  // The toxicity strategy of an ETF leans its quotes toward NAV by
+  // basket_skew times its premium.
+  BasketEngine* baskets = nullptr;
+  double basket_skew = 0.5;
+
+  // Shared-object strategy quoting in place of the toxicity strategy
+  // (--strategy-plugin; null = built-in)
+  StrategyPlugin* plugin = nullptr;
 };
 
 } // namespace mmsim
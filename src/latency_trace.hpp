@@ -0,0 +1,266 @@
+#pragma once
+
+#include "common/hdr_histogram.hpp"
+#include "common/symbol_map.hpp"
+#include "cost_profile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mmsim {
+
+// =============================================================================
+// Tick-to-quote latency tracing (--latency-hist)
+//
+// Every message of a traced symbol is stamped with the cycle counter when
+// its packet is received (replay: handed to the packet callback), when the
+// dispatcher starts on it, and when it is done. In between, the CostScope
+// buckets split the handler into book, feature and strategy time exactly as
+// for cost sampling. A message whose execution produced new quotes also
+// gets a tick-to-quote sample, stamped after the virtual orders are sent.
+// For pipelined symbols (--pipeline-heavy) tick_to_done ends with the book
+// stage, and feature, strategy and tick-to-quote samples come from the
+// strategy thread, so tick_to_quote includes the hop between the two.
+//
+// Samples are in counter cycles; reports convert with the calibrated
+// cycles_per_ns stored alongside them.
+// =============================================================================
+
+enum class LatencyStage : uint8_t {
+  DECODE = 0,        // Packet receipt to dispatch: header decode, symbol lookup,
+                     // lock, and earlier messages of the same packet
+  BOOK = 1,          // Order book and order tracking
+  FEATURE = 2,       // Feature trackers and toxicity model
+  STRATEGY = 3,      // update_market_data, quote decision and order send
+  DISPATCH = 4,      // Message decoding and bookkeeping outside the above
+  TICK_TO_QUOTE = 5, // Packet receipt to quotes sent (quoting messages only)
+  TICK_TO_DONE = 6,  // Packet receipt to message fully processed
+  COUNT = 7
+};
+
+constexpr size_t NUM_LATENCY_STAGES = static_cast<size_t>(LatencyStage::COUNT);
+constexpr size_t MAX_LATENCY_TIERS = 4;
+
+inline const char *latency_stage_name(LatencyStage s) {
+  switch (s) {
+  case LatencyStage::DECODE: return "decode";
+  case LatencyStage::BOOK: return "book";
+  case LatencyStage::FEATURE: return "feature";
+  case LatencyStage::STRATEGY: return "strategy";
+  case LatencyStage::DISPATCH: return "dispatch";
+  case LatencyStage::TICK_TO_QUOTE: return "tick_to_quote";
+  case LatencyStage::TICK_TO_DONE: return "tick_to_done";
+  case LatencyStage::COUNT: break;
+  }
+  return "?";
+}
+
+// Stamps of the message in flight. The per-symbol sim holds a pointer to it
+// while the message is traced and null otherwise.
+struct LatencyTrace {
+  uint64_t origin = 0;  // Packet receipt
+  uint64_t quoted = 0;  // Quotes sent (0 = message did not quote)
+};
+
+// One histogram per symbol tier and stage
+struct LatencyTable {
+  xdp::HdrHistogram hist[MAX_LATENCY_TIERS][NUM_LATENCY_STAGES];
+
+  xdp::HdrHistogram &at(size_t tier, LatencyStage s) {
+    return hist[tier][static_cast<size_t>(s)];
+  }
+  const xdp::HdrHistogram &at(size_t tier, LatencyStage s) const {
+    return hist[tier][static_cast<size_t>(s)];
+  }
+
+  // Record one finished message. `cost` holds its exclusive bucket cycles.
+  void record(size_t tier, const LatencyTrace &trace, uint64_t dispatched,
+              uint64_t done, const SymbolCost &cost) {
+    at(tier, LatencyStage::DECODE).record(dispatched - trace.origin);
+    at(tier, LatencyStage::BOOK).record(cost.cycles[static_cast<size_t>(CostBucket::BOOK)]);
+    at(tier, LatencyStage::DISPATCH).record(cost.cycles[static_cast<size_t>(CostBucket::OTHER)]);
+    const uint64_t feature = cost.cycles[static_cast<size_t>(CostBucket::FEATURE)];
+    const uint64_t strategy = cost.cycles[static_cast<size_t>(CostBucket::STRATEGY)];
+    if (feature) at(tier, LatencyStage::FEATURE).record(feature);
+    if (strategy) at(tier, LatencyStage::STRATEGY).record(strategy);
+    if (trace.quoted) at(tier, LatencyStage::TICK_TO_QUOTE).record(trace.quoted - trace.origin);
+    at(tier, LatencyStage::TICK_TO_DONE).record(done - trace.origin);
+  }
+
+  // Record the strategy-thread part of a pipelined symbol's message; its
+  // book stage is recorded by record() with no feature or strategy time
+  void record_strategy(size_t tier, const LatencyTrace &trace, const SymbolCost &cost) {
+    const uint64_t feature = cost.cycles[static_cast<size_t>(CostBucket::FEATURE)];
+    const uint64_t strategy = cost.cycles[static_cast<size_t>(CostBucket::STRATEGY)];
+    if (feature) at(tier, LatencyStage::FEATURE).record(feature);
+    if (strategy) at(tier, LatencyStage::STRATEGY).record(strategy);
+    if (trace.quoted) at(tier, LatencyStage::TICK_TO_QUOTE).record(trace.quoted - trace.origin);
+  }
+
+  void merge(const LatencyTable &o) {
+    for (size_t t = 0; t < MAX_LATENCY_TIERS; ++t) {
+      for (size_t s = 0; s < NUM_LATENCY_STAGES; ++s) hist[t][s].merge(o.hist[t][s]);
+    }
+  }
+
+  void reset() {
+    for (auto &tier : hist) {
+      for (auto &h : tier) h.reset();
+    }
+  }
+};
+
+// Symbol tiers by activity: ranked by message count in a cost profile
+// (--cost-profile), top 10 / next 90 / next 900 / rest. Without a profile
+// every symbol is in tier "all".
+struct LatencyTiers {
+  std::vector<std::string> names = {"all"};
+  std::vector<uint8_t> by_symbol;  // Symbol index -> tier (empty = all tier 0)
+
+  [[nodiscard]] size_t tier_of(uint32_t symbol_index) const {
+    return symbol_index < by_symbol.size() ? by_symbol[symbol_index] : names.size() - 1;
+  }
+
+  void from_profile(CostProfile profile, uint32_t max_symbols) {
+    std::sort(profile.entries.begin(), profile.entries.end(),
+              [](const CostProfileEntry &a, const CostProfileEntry &b) {
+                return a.cost.messages > b.cost.messages;
+              });
+    names = {"top10", "top100", "top1000", "rest"};
+    by_symbol.assign(max_symbols, 3);
+    for (size_t rank = 0; rank < profile.entries.size() && rank < 1000; ++rank) {
+      const auto idx = xdp::get_global_symbol_map().find_index(profile.entries[rank].ticker);
+      if (!idx || *idx >= max_symbols) continue;
+      by_symbol[*idx] = rank < 10 ? 0 : rank < 100 ? 1 : 2;
+    }
+  }
+};
+
+// =============================================================================
+// Latency file (CSV)
+//
+//   # mmsim latency v1 cycles_per_ns=<f> tiers=<a,b,...>
+//   kind,elapsed_s,group,tier,stage,count,p50_us,p99_us,p999_us,max_us
+//   window,...   one row per tier and stage every --latency-interval
+//   total,...    whole run
+//   # hist <tier> <stage> <bucket>:<count> ...
+//
+// The raw buckets let partial files (one per hybrid group) merge exactly.
+// =============================================================================
+
+inline void write_latency_header(std::ostream &out, double cycles_per_ns,
+                                 const LatencyTiers &tiers) {
+  out << "# mmsim latency v1 cycles_per_ns=" << std::setprecision(6) << cycles_per_ns
+      << " tiers=";
+  for (size_t i = 0; i < tiers.names.size(); ++i) out << (i ? "," : "") << tiers.names[i];
+  out << "\nkind,elapsed_s,group,tier,stage,count,p50_us,p99_us,p999_us,max_us\n";
+}
+
+inline void write_latency_rows(std::ostream &out, const char *kind, double elapsed_s,
+                               size_t group, const LatencyTable &table,
+                               const LatencyTiers &tiers, double cycles_per_ns) {
+  const double us = 1.0 / (cycles_per_ns * 1000.0);
+  for (size_t t = 0; t < tiers.names.size(); ++t) {
+    for (size_t s = 0; s < NUM_LATENCY_STAGES; ++s) {
+      const xdp::HdrHistogram &h = table.hist[t][s];
+      if (h.count() == 0) continue;
+      out << kind << ',' << std::fixed << std::setprecision(1) << elapsed_s << ',' << group
+          << ',' << tiers.names[t] << ',' << latency_stage_name(static_cast<LatencyStage>(s))
+          << ',' << h.count() << std::setprecision(3) << ',' << h.percentile(50.0) * us << ','
+          << h.percentile(99.0) * us << ',' << h.percentile(99.9) * us << ',' << h.max() * us
+          << '\n';
+      out.unsetf(std::ios::floatfield);
+    }
+  }
+}
+
+inline void write_latency_hists(std::ostream &out, const LatencyTable &table,
+                                const LatencyTiers &tiers) {
+  for (size_t t = 0; t < tiers.names.size(); ++t) {
+    for (size_t s = 0; s < NUM_LATENCY_STAGES; ++s) {
+      const xdp::HdrHistogram &h = table.hist[t][s];
+      if (h.count() == 0) continue;
+      out << "# hist " << t << ' ' << s;
+      for (size_t i = 0; i < xdp::HdrHistogram::NUM_BUCKETS; ++i) {
+        if (h.bucket_count(i)) out << ' ' << i << ':' << h.bucket_count(i);
+      }
+      out << '\n';
+    }
+  }
+}
+
+// Read a latency file back: window rows verbatim, histograms merged into
+// `table`. Tier names come from the header.
+[[nodiscard]] inline bool load_latency_file(const std::string &path, double &cycles_per_ns,
+                                            LatencyTiers &tiers, LatencyTable &table,
+                                            std::vector<std::string> &window_rows,
+                                            std::string &err) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    err = "cannot open " + path;
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.rfind("# mmsim latency", 0) == 0) {
+      size_t p = line.find("cycles_per_ns=");
+      if (p != std::string::npos) std::istringstream(line.substr(p + 14)) >> cycles_per_ns;
+      p = line.find("tiers=");
+      if (p != std::string::npos) {
+        tiers.names.clear();
+        std::stringstream ss(line.substr(p + 6));
+        std::string name;
+        while (std::getline(ss, name, ',')) tiers.names.push_back(name);
+      }
+    } else if (line.rfind("# hist ", 0) == 0) {
+      std::istringstream ss(line.substr(7));
+      size_t t = 0, s = 0;
+      ss >> t >> s;
+      if (t >= MAX_LATENCY_TIERS || s >= NUM_LATENCY_STAGES) {
+        err = path + ": bad histogram line";
+        return false;
+      }
+      std::string pair;
+      while (ss >> pair) {
+        const size_t colon = pair.find(':');
+        if (colon == std::string::npos) continue;
+        table.hist[t][s].add_bucket(std::stoull(pair.substr(0, colon)),
+                                    std::stoull(pair.substr(colon + 1)));
+      }
+    } else if (line.rfind("window,", 0) == 0) {
+      window_rows.push_back(line);
+    }
+  }
+  if (cycles_per_ns <= 0) cycles_per_ns = 1.0;
+  return true;
+}
+
+// Per tier and stage percentiles in microseconds
+inline void print_latency_table(std::ostream &os, const LatencyTable &table,
+                                const LatencyTiers &tiers, double cycles_per_ns) {
+  const double us = 1.0 / (cycles_per_ns * 1000.0);
+  os << "\n=== TICK-TO-QUOTE LATENCY (us, " << std::fixed << std::setprecision(2)
+     << cycles_per_ns << " cycles/ns) ===\n";
+  os << std::left << std::setw(9) << "Tier" << std::setw(15) << "Stage" << std::right
+     << std::setw(12) << "Count" << std::setw(10) << "p50" << std::setw(10) << "p99"
+     << std::setw(10) << "p99.9" << std::setw(11) << "Max" << '\n';
+  for (size_t t = 0; t < tiers.names.size(); ++t) {
+    for (size_t s = 0; s < NUM_LATENCY_STAGES; ++s) {
+      const xdp::HdrHistogram &h = table.hist[t][s];
+      if (h.count() == 0) continue;
+      os << std::left << std::setw(9) << tiers.names[t] << std::setw(15)
+         << latency_stage_name(static_cast<LatencyStage>(s)) << std::right << std::setw(12)
+         << h.count() << std::setprecision(3) << std::setw(10) << h.percentile(50.0) * us
+         << std::setw(10) << h.percentile(99.0) * us << std::setw(10)
+         << h.percentile(99.9) * us << std::setw(11) << h.max() * us << '\n';
+    }
+  }
+}
+
+} // namespace mmsim
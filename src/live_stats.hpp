@@ -0,0 +1,321 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace mmsim {
+
+// =============================================================================
+// Live introspection segment (POSIX shared memory, /dev/shm/mmsim.<pid>)
+//
+// A running market_maker_sim publishes progress, throughput inputs, fill
+// pipeline counters and a fixed-size per-symbol table here so that `mmtop`
+// can watch it without touching the simulation:
+//
+//   [LiveStatsHeader][LiveSlot x num_slots][LiveSymbol x symbol_capacity]
+//
+// One slot per worker (hybrid process group, pool thread, or the single
+// sequential loop). Every field a reader looks at is an atomic written with
+// relaxed stores by exactly one writer at a time; readers tolerate torn
+// snapshots across fields since everything is a monotonic counter or a
+// latest value. Rates are derived by the reader from successive snapshots.
+// =============================================================================
+
+constexpr char LIVE_STATS_MAGIC[8] = {'M', 'M', 'L', 'I', 'V', 'E', '1', '\0'};
+constexpr uint32_t LIVE_STATS_VERSION = 1;
+constexpr uint32_t LIVE_SYMBOL_CAPACITY = 4096;
+constexpr uint32_t LIVE_MAX_SLOTS = 1024;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<double>::is_always_lock_free,
+              "live stats segment requires address-free atomics");
+
+enum class LiveRunState : uint32_t {
+  STARTING = 0,
+  RUNNING = 1,
+  AGGREGATING = 2, // Inputs consumed, building final report
+  DONE = 3
+};
+
+enum class LiveSlotState : uint32_t {
+  IDLE = 0,
+  RUNNING = 1,
+  DONE = 2,
+  FAILED = 3 // Hybrid child exited abnormally (set by the parent)
+};
+
+// LiveSymbol::flags
+constexpr uint32_t LIVE_SYM_ELIGIBLE = 0x01;
+constexpr uint32_t LIVE_SYM_HALTED = 0x02;
+constexpr uint32_t LIVE_SYM_BLACKLISTED = 0x04;
+constexpr uint32_t LIVE_SYM_EOD = 0x08;
+
+struct LiveStatsHeader {
+  char magic[8];             // Written last by the creator
+  uint32_t version;
+  uint32_t num_slots;
+  uint32_t symbol_capacity;
+  int32_t pid;               // Creating (parent) process
+  uint64_t start_wall_ns;    // CLOCK_REALTIME at creation
+  uint64_t files_total;      // Whole run
+  uint64_t bytes_total;
+  char mode[24];             // "HYBRID MULTI-PROCESS", "THREADED", ...
+  char ticker_filter[16];    // -t value, empty if none
+  std::atomic<uint32_t> run_state;       // LiveRunState
+  std::atomic<uint32_t> symbols_dropped; // Table full, symbol not shown
+  std::atomic<uint64_t> heartbeat_ns;    // Last parent-side update
+};
+
+struct alignas(64) LiveSlot {
+  std::atomic<uint32_t> state;  // LiveSlotState
+  std::atomic<int32_t> pid;
+  std::atomic<uint64_t> files_total; // 0 when files are handed out dynamically
+  std::atomic<uint64_t> files_done;
+  std::atomic<uint64_t> bytes_total;
+  std::atomic<uint64_t> bytes_done;
+  std::atomic<uint64_t> feed_first_ns; // First packet timestamp seen
+  std::atomic<uint64_t> feed_ns;       // Latest packet timestamp
+  std::atomic<uint64_t> packets;
+  std::atomic<uint64_t> messages;      // Messages dispatched to a symbol sim
+  std::atomic<uint64_t> heartbeat_ns;  // CLOCK_REALTIME of last publish
+
+  // Fill pipeline diagnostics for the toxicity strategy (see FillDiagnostics)
+  std::atomic<uint64_t> exec_total;
+  std::atomic<uint64_t> exec_no_order_info;
+  std::atomic<uint64_t> exec_not_eligible;
+  std::atomic<uint64_t> try_fill_calls;
+  std::atomic<uint64_t> rejected_halted;
+  std::atomic<uint64_t> rejected_not_live;
+  std::atomic<uint64_t> rejected_latency;
+  std::atomic<uint64_t> rejected_price;
+  std::atomic<uint64_t> rejected_queue;
+  std::atomic<uint64_t> fill_succeeded;
+  std::atomic<uint64_t> quote_resets;
+};
+
+struct alignas(64) LiveSymbol {
+  std::atomic<uint64_t> key;     // live_symbol_key(group, index), 0 = empty
+  std::atomic<uint32_t> ready;   // ticker valid
+  std::atomic<uint32_t> flags;   // LIVE_SYM_*
+  char ticker[16];
+  std::atomic<uint64_t> messages;
+  std::atomic<int64_t> toxicity_fills;
+  std::atomic<int64_t> baseline_fills;
+  std::atomic<int64_t> quotes_suppressed;
+  std::atomic<double> inventory;      // Toxicity strategy, shares
+  std::atomic<double> toxicity_pnl;   // Realized + unrealized + adverse
+  std::atomic<double> baseline_pnl;
+  std::atomic<double> adverse_pnl;    // Toxicity strategy
+};
+
+// Symbols are keyed per hybrid group because each group runs its own
+// independent sim for the same ticker; group 0 is used by in-process modes.
+inline uint64_t live_symbol_key(uint32_t group, uint32_t symbol_index) {
+  return (static_cast<uint64_t>(group + 1) << 32) | symbol_index;
+}
+
+inline uint64_t live_wall_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+inline std::string live_stats_default_name(pid_t pid) {
+  return "/mmsim." + std::to_string(pid);
+}
+
+class LiveStatsSegment {
+public:
+  LiveStatsSegment() = default;
+  ~LiveStatsSegment() { close(); }
+
+  LiveStatsSegment(const LiveStatsSegment &) = delete;
+  LiveStatsSegment &operator=(const LiveStatsSegment &) = delete;
+
+  static size_t segment_size(uint32_t num_slots, uint32_t symbol_capacity) {
+    return slots_offset() + sizeof(LiveSlot) * num_slots +
+           sizeof(LiveSymbol) * symbol_capacity;
+  }
+
+  // Create (or replace) the named segment. Mapped MAP_SHARED, so forked
+  // children inherit the mapping and publish into their own slot.
+  [[nodiscard]] bool create(const std::string &name, uint32_t num_slots,
+                            std::string &err) {
+    close();
+    if (num_slots == 0 || num_slots > LIVE_MAX_SLOTS) {
+      err = "invalid slot count " + std::to_string(num_slots);
+      return false;
+    }
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+      err = "shm_open " + name + ": " + strerror(errno);
+      return false;
+    }
+    size_t size = segment_size(num_slots, LIVE_SYMBOL_CAPACITY);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      err = "ftruncate " + name + ": " + strerror(errno);
+      ::close(fd);
+      shm_unlink(name.c_str());
+      return false;
+    }
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+      err = "mmap " + name + ": " + strerror(errno);
+      shm_unlink(name.c_str());
+      return false;
+    }
+    base_ = static_cast<uint8_t *>(p);
+    size_ = size;
+    name_ = name;
+    owner_ = true;
+
+    // ftruncate zero-fills, which is a valid initial state for every field
+    LiveStatsHeader &h = header();
+    h.version = LIVE_STATS_VERSION;
+    h.num_slots = num_slots;
+    h.symbol_capacity = LIVE_SYMBOL_CAPACITY;
+    h.pid = static_cast<int32_t>(getpid());
+    h.start_wall_ns = live_wall_ns();
+    h.heartbeat_ns.store(h.start_wall_ns, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(h.magic, LIVE_STATS_MAGIC, sizeof(h.magic));
+    return true;
+  }
+
+  // Map an existing segment read-only (mmtop)
+  [[nodiscard]] bool attach(const std::string &name, std::string &err) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      err = "shm_open " + name + ": " + strerror(errno);
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < slots_offset()) {
+      err = name + ": segment too small";
+      ::close(fd);
+      return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void *p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+      err = "mmap " + name + ": " + strerror(errno);
+      return false;
+    }
+    base_ = static_cast<uint8_t *>(p);
+    size_ = size;
+    name_ = name;
+    owner_ = false;
+
+    const LiveStatsHeader &h = header();
+    if (std::memcmp(h.magic, LIVE_STATS_MAGIC, sizeof(h.magic)) != 0) {
+      err = name + ": not a market_maker_sim stats segment";
+      close();
+      return false;
+    }
+    if (h.version != LIVE_STATS_VERSION) {
+      err = name + ": unsupported version " + std::to_string(h.version);
+      close();
+      return false;
+    }
+    if (segment_size(h.num_slots, h.symbol_capacity) > size_) {
+      err = name + ": truncated segment";
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  // Remove the name; existing mappings (including mmtop's) stay valid
+  void unlink() {
+    if (owner_ && !name_.empty()) {
+      shm_unlink(name_.c_str());
+      owner_ = false;
+    }
+  }
+
+  void close() {
+    if (base_) {
+      munmap(base_, size_);
+      base_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  [[nodiscard]] bool is_open() const noexcept { return base_ != nullptr; }
+  [[nodiscard]] const std::string &name() const noexcept { return name_; }
+
+  LiveStatsHeader &header() {
+    return *reinterpret_cast<LiveStatsHeader *>(base_);
+  }
+  const LiveStatsHeader &header() const {
+    return *reinterpret_cast<const LiveStatsHeader *>(base_);
+  }
+
+  LiveSlot &slot(uint32_t i) {
+    return reinterpret_cast<LiveSlot *>(base_ + slots_offset())[i];
+  }
+  const LiveSlot &slot(uint32_t i) const {
+    return reinterpret_cast<const LiveSlot *>(base_ + slots_offset())[i];
+  }
+
+  LiveSymbol &symbol(uint32_t i) {
+    return reinterpret_cast<LiveSymbol *>(base_ + symbols_offset())[i];
+  }
+  const LiveSymbol &symbol(uint32_t i) const {
+    return reinterpret_cast<const LiveSymbol *>(base_ + symbols_offset())[i];
+  }
+
+  // Find or insert the table entry for (group, symbol_index). Open
+  // addressing with linear probing; entries are never removed. Returns
+  // nullptr once the table is full.
+  LiveSymbol *claim_symbol(uint32_t group, uint32_t symbol_index,
+                           const std::string &ticker) {
+    LiveStatsHeader &h = header();
+    uint64_t key = live_symbol_key(group, symbol_index);
+    uint32_t cap = h.symbol_capacity;
+    uint32_t pos = static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ULL) >> 40) % cap;
+    for (uint32_t probe = 0; probe < cap; ++probe) {
+      LiveSymbol &e = symbol((pos + probe) % cap);
+      uint64_t cur = e.key.load(std::memory_order_acquire);
+      if (cur == 0 &&
+          e.key.compare_exchange_strong(cur, key, std::memory_order_acq_rel)) {
+        std::strncpy(e.ticker, ticker.c_str(), sizeof(e.ticker) - 1);
+        e.ready.store(1, std::memory_order_release);
+        return &e;
+      }
+      if (cur == key) {
+        return &e;
+      }
+    }
+    h.symbols_dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+private:
+  static constexpr size_t align64(size_t n) { return (n + 63) & ~size_t(63); }
+  static constexpr size_t slots_offset() { return align64(sizeof(LiveStatsHeader)); }
+  size_t symbols_offset() const {
+    return slots_offset() + sizeof(LiveSlot) * header().num_slots;
+  }
+
+  uint8_t *base_ = nullptr;
+  size_t size_ = 0;
+  std::string name_;
+  bool owner_ = false;
+};
+
+} // namespace mmsim
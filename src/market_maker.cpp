@@ -1,4 +1,5 @@
 #include "market_maker.hpp"
+#include "decision_log.hpp"
 #include <algorithm>
 #include <cmath>
 
@@ -169,6 +170,40 @@ void MarketMakerStrategy::clear_override_toxicity() {
   override_toxicity_ = 0.0;
 }
 
+void MarketMakerStrategy::set_basket_skew(double skew) {
+  std::lock_guard<std::mutex> lock(strategy_mutex_);
+  basket_skew_ = skew;
+}
+
+void MarketMakerStrategy::set_basket_premium(double premium_bps) {
+  std::lock_guard<std::mutex> lock(strategy_mutex_);
+  has_basket_premium_ = true;
+  basket_premium_bps_ = premium_bps;
+}
+
+void MarketMakerStrategy::clear_basket_premium() {
+  std::lock_guard<std::mutex> lock(strategy_mutex_);
+  has_basket_premium_ = false;
+  basket_premium_bps_ = 0.0;
+}
+
+void MarketMakerStrategy::set_external_quoting(bool on) {
+  std::lock_guard<std::mutex> lock(strategy_mutex_);
+  external_quoting_ = on;
+}
+
+void MarketMakerStrategy::set_external_quotes(const MarketMakerQuote& quotes) {
+  std::lock_guard<std::mutex> lock(strategy_mutex_);
+  current_quotes_ = quotes;
+  current_quotes_.is_quoted = quotes.bid_size > 0 || quotes.ask_size > 0;
+}
+
+bool MarketMakerStrategy::get_basket_premium(double& premium_bps) const {
+  std::lock_guard<std::mutex> lock(strategy_mutex_);
+  premium_bps = basket_premium_bps_;
+  return has_basket_premium_;
+}
+
 // Snapshot-based helpers: operate on pre-fetched data (no additional lock acquisitions)
 
 double MarketMakerStrategy::get_average_toxicity_snap(const OrderBook::BookSnapshot& snap) const {
@@ -211,7 +246,7 @@ double MarketMakerStrategy::calculate_obi_snap(const OrderBook::BookSnapshot& sn
 
 void MarketMakerStrategy::update_market_data() {
   // Single lock acquisition: capture all needed book state at once
-  auto snap = order_book_.get_snapshot();
+  auto snap = book_snapshot();
 
   // Calculate OBI and toxicity from snapshot (no further lock acquisitions)
   double avg_toxicity = 0.0;
@@ -224,6 +259,9 @@ void MarketMakerStrategy::update_market_data() {
 
   std::lock_guard<std::mutex> lock(strategy_mutex_);
 
+  last_decision_ = QuoteDecision{};
+  last_decision_.toxicity = avg_toxicity;
+
   if (snap.stats.best_bid == 0.0 || snap.stats.best_ask == 0.0) {
     current_quotes_.is_quoted = false;
     return;
@@ -231,6 +269,12 @@ void MarketMakerStrategy::update_market_data() {
 
   double mid_price = snap.stats.mid_price;
 
+  if (external_quoting_) {
+    last_decision_.quoted = true;
+    mark_position(snap);
+    return;
+  }
+
   // Spread widening: active in FULL and SPREAD_ONLY modes
   const bool apply_spread =
       use_toxicity_screen_ &&
@@ -242,6 +286,11 @@ void MarketMakerStrategy::update_market_data() {
 
   double half_spread = spread / 2.0;
   double inventory_skew = calculate_inventory_skew();
+  // An ETF trading rich to its basket NAV is worth less than its mid: move
+  // the quote center toward NAV along with the inventory skew
+  if (use_toxicity_screen_ && has_basket_premium_) {
+    inventory_skew -= basket_skew_ * basket_premium_bps_ * 1e-4 * mid_price;
+  }
 
   // PnL filter: active in FULL and PNL_FILTER_ONLY modes
   const bool apply_pnl_filter =
@@ -254,23 +303,28 @@ void MarketMakerStrategy::update_market_data() {
   }
 
   if (apply_pnl_filter) {
+    // Calculate expected PnL using BASE spread (not toxicity-adjusted).
+    // Fills near NBBO capture approximately base spread, regardless of our wider quote.
+    // The wider spread reduces fill rate but doesn't increase per-fill income proportionally.
+    double inventory_risk = gamma_risk_ * inventory_ * inventory_;
+    double expected_pnl = calculate_expected_pnl(base_spread_, avg_toxicity, inventory_risk);
+    last_decision_.expected_pnl = expected_pnl;
+
     // Skip quoting entirely if toxicity is too high
     if (avg_toxicity > toxicity_quote_threshold_) {
       stats_.quotes_suppressed++;
+      last_decision_.suppressed = true;
+      last_decision_.reason = static_cast<uint8_t>(mmsim::SuppressReason::TOXICITY_THRESHOLD);
       current_quotes_.is_quoted = false;
       current_quotes_.bid_size = 0;
       current_quotes_.ask_size = 0;
       return;
     }
 
-    // Calculate expected PnL using BASE spread (not toxicity-adjusted).
-    // Fills near NBBO capture approximately base spread, regardless of our wider quote.
-    // The wider spread reduces fill rate but doesn't increase per-fill income proportionally.
-    double inventory_risk = gamma_risk_ * inventory_ * inventory_;
-    double expected_pnl = calculate_expected_pnl(base_spread_, avg_toxicity, inventory_risk);
-
     if (!should_quote(expected_pnl)) {
       stats_.quotes_suppressed++;
+      last_decision_.suppressed = true;
+      last_decision_.reason = static_cast<uint8_t>(mmsim::SuppressReason::EXPECTED_PNL);
       current_quotes_.is_quoted = false;
       current_quotes_.bid_size = 0;
       current_quotes_.ask_size = 0;
@@ -336,9 +390,14 @@ void MarketMakerStrategy::update_market_data() {
   }
 
   current_quotes_.is_quoted = (current_quotes_.bid_size > 0 || current_quotes_.ask_size > 0);
+  last_decision_.quoted = true;
 
-  // Update unrealized PnL
-  const double mark = (snap.last_traded_price > 0.0) ? snap.last_traded_price : mid_price;
+  mark_position(snap);
+}
+
+// Update unrealized PnL (caller holds strategy_mutex_)
+void MarketMakerStrategy::mark_position(const OrderBook::BookSnapshot& snap) {
+  const double mark = (snap.last_traded_price > 0.0) ? snap.last_traded_price : snap.stats.mid_price;
 
   if (inventory_ > 0) {
     unrealized_pnl_ = (mark - avg_entry_price_) * static_cast<double>(inventory_);
@@ -354,6 +413,11 @@ MarketMakerQuote MarketMakerStrategy::get_current_quotes() const {
   return current_quotes_;
 }
 
+QuoteDecision MarketMakerStrategy::get_last_decision() const {
+  std::lock_guard<std::mutex> lock(strategy_mutex_);
+  return last_decision_;
+}
+
 void MarketMakerStrategy::on_order_filled(bool is_buy, double price,
                                           uint32_t size) {
   std::lock_guard<std::mutex> lock(strategy_mutex_);
@@ -453,7 +517,7 @@ void MarketMakerStrategy::try_unwind_inventory() {
   // 2. Safety unwind: |inventory| exceeds unwind_threshold_
 
   // Get snapshot without holding strategy_mutex_ (order_book has its own lock)
-  auto snap = order_book_.get_snapshot();
+  auto snap = book_snapshot();
   if (snap.stats.best_bid <= 0 || snap.stats.best_ask <= 0) return;
 
   std::lock_guard<std::mutex> lock(strategy_mutex_);
@@ -517,7 +581,7 @@ void MarketMakerStrategy::try_unwind_inventory() {
 }
 
 void MarketMakerStrategy::force_close_position() {
-  auto snap = order_book_.get_snapshot();
+  auto snap = book_snapshot();
   if (snap.stats.best_bid <= 0 || snap.stats.best_ask <= 0) return;
 
   std::lock_guard<std::mutex> lock(strategy_mutex_);
@@ -595,6 +659,7 @@ void MarketMakerStrategy::set_toxicity_threshold(double threshold) {
 }
 
 double MarketMakerStrategy::get_current_toxicity() const {
+  if (book_view_) return get_average_toxicity_snap(*book_view_);
   return get_average_toxicity();
 }
 
@@ -606,6 +671,7 @@ void MarketMakerStrategy::reset() {
   fee_per_share_ = 0.0;
   avg_entry_price_ = 0.0;
   current_quotes_ = MarketMakerQuote();
+  last_decision_ = QuoteDecision();
   our_order_ids_.clear();
   stats_ = MarketMakerStats();
   stats_.start_time = std::chrono::steady_clock::now();
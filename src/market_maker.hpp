@@ -138,6 +138,15 @@ struct MarketMakerStats {
   double unwind_cost = 0.0;        // Total cost of unwind crosses
 };
 
+// Outcome of the most recent update_market_data() call (for decision logging)
+struct QuoteDecision {
+  bool quoted = false;        // Quotes were (re)decided; false without a two-sided BBO
+  bool suppressed = false;
+  uint8_t reason = 0;         // mmsim::SuppressReason when suppressed
+  double expected_pnl = 0.0;  // E[PnL] per share (PnL filter active only)
+  double toxicity = 0.0;      // Average toxicity used for the decision
+};
+
 struct MarketMakerQuote {
   double bid_price = 0.0;
   double ask_price = 0.0;
@@ -161,6 +170,7 @@ public:
 
   // Get current quotes (thread-safe)
   [[nodiscard]] MarketMakerQuote get_current_quotes() const;
+  [[nodiscard]] QuoteDecision get_last_decision() const;
 
   // Handle order fill events
   void on_order_filled(bool is_buy, double price, uint32_t size);
@@ -180,6 +190,20 @@ public:
   void clear_override_toxicity();
   void set_ablation_mode(mmsim::AblationMode mode);
   void set_epsilon_min(double eps);
+  // ETF premium to its basket NAV in bps (basket_nav.hpp). The toxicity
+  // strategy shifts its quote center by -skew * premium, toward NAV.
+  void set_basket_skew(double skew);
+  void set_basket_premium(double premium_bps);
+  void clear_basket_premium();
+  // Externally decided quotes (strategy plugins): update_market_data() then
+  // only marks the position, and the quotes are whatever was last set here
+  void set_external_quoting(bool on);
+  void set_external_quotes(const MarketMakerQuote& quotes);
+
+  // Read book state from a published snapshot instead of the live book
+  // (pipelined symbols, where another thread owns the book). nullptr
+  // restores live reads. The snapshot must outlive its use.
+  void set_book_view(const OrderBook::BookSnapshot* snap) noexcept { book_view_ = snap; }
 
   // Active inventory management: cross the spread to unwind excess inventory
   void try_unwind_inventory();
@@ -190,6 +214,7 @@ public:
   [[nodiscard]] MarketMakerStats get_stats() const;
   [[nodiscard]] double get_inventory() const;
   [[nodiscard]] double get_current_toxicity() const;
+  [[nodiscard]] bool get_basket_premium(double& premium_bps) const;
 
   // Reset strategy state
   void reset();
@@ -200,6 +225,7 @@ public:
 
 private:
   OrderBook &order_book_;
+  const OrderBook::BookSnapshot* book_view_ = nullptr;
   bool use_toxicity_screen_;
 
   int64_t inventory_ = 0;
@@ -209,6 +235,7 @@ private:
   double avg_entry_price_ = 0.0;
 
   MarketMakerQuote current_quotes_;
+  QuoteDecision last_decision_;
   std::unordered_map<uint64_t, bool> our_order_ids_;
   mutable std::mutex strategy_mutex_;
 
@@ -246,10 +273,22 @@ private:
   bool use_override_toxicity_ = false;
   double override_toxicity_ = 0.0;
 
+  // ETF premium to basket NAV (bps) and the share of it to lean quotes by
+  bool has_basket_premium_ = false;
+  double basket_premium_bps_ = 0.0;
+  double basket_skew_ = 0.0;
+
+  // Quotes set from outside (set_external_quotes) instead of computed
+  bool external_quoting_ = false;
+
   // Ablation mode: which toxicity components are active
   mmsim::AblationMode ablation_mode_ = mmsim::AblationMode::FULL;
 
   // Helper methods
+  [[nodiscard]] OrderBook::BookSnapshot book_snapshot() const {
+    return book_view_ ? *book_view_ : order_book_.get_snapshot();
+  }
+  void mark_position(const OrderBook::BookSnapshot& snap);
   [[nodiscard]] double round_to_tick(double price) const noexcept;
   [[nodiscard]] double calculate_toxicity_adjusted_spread(double base_spread_val) const;
   [[nodiscard]] double calculate_inventory_skew() const noexcept;
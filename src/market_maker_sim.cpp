@@ -2,8 +2,15 @@
 // Simulates market making strategies on historical XDP data
 // PARALLELIZED VERSION - Uses all available CPU cores for maximum throughput
 
+#include "latency_trace.hpp"
+#include "live_stats.hpp"
 #include "per_symbol_sim.hpp"
+#include "run_results.hpp"
+#include "shard_plan.hpp"
+#include "symbol_pipeline.hpp"
 
+#include "common/capture_catalog.hpp"
+#include "common/cycle_clock.hpp"
 #include "common/mmap_pcap_reader.hpp"
 #include "common/pcap_reader.hpp"
 #include "common/symbol_map.hpp"
@@ -15,17 +22,21 @@
 #include <atomic>
 #include <cerrno>
 #include <chrono>
+#include <cmath>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <thread>
+#include <tuple>
 #include <unistd.h>
 #include <vector>
 
@@ -43,8 +54,16 @@ bool g_use_parallel = true;  // Enable parallel processing by default
 bool g_use_hybrid = true;    // Enable hybrid multi-process mode by default
 size_t g_num_threads = 0;    // 0 = auto-detect (use all cores)
 size_t g_files_per_group = 0; // 0 = auto (num_files / num_threads)
+size_t g_prefetch_distance = 4; // Messages of look-ahead in the packet loop (0 = off)
+bool g_prefetch_orders = true;  // Also prefetch order tables (single owner per symbol)
 
 SimConfig g_config;  // Runtime simulation configuration
+double g_cycles_per_ns = 1.0;  // Calibrated when cost sampling is enabled
+
+// Heavy symbols split into book and strategy stages (--pipeline-heavy)
+size_t g_pipeline_heavy = 0;
+std::string g_pipeline_profile;
+std::vector<std::string> g_pipeline_tickers;  // Chosen from the cost profile
 
 // =============================================================================
 // Thread-safe symbol simulation storage
@@ -65,6 +84,172 @@ std::atomic<uint64_t> g_total_messages{0};
 std::atomic<size_t> g_files_completed{0};
 std::atomic<size_t> g_active_symbols{0};
 
+// Pipelines of heavy symbols seen by this process, created with their sims
+std::vector<uint8_t> g_symbol_pipelined;  // By symbol index (init_symbol_filter)
+std::mutex g_pipelines_mutex;
+std::vector<std::unique_ptr<SymbolPipeline>> g_pipelines;
+PipelineHooks g_pipeline_hooks;  // Set by init_symbol_filter; context per pipeline
+
+// =============================================================================
+// Live introspection segment (--live-stats, watched with mmtop)
+// Workers publish into their own LiveSlot; per-symbol entries are refreshed
+// every LIVE_SYMBOL_PUBLISH_INTERVAL messages of that symbol or on a fill.
+// =============================================================================
+
+constexpr uint32_t LIVE_SYMBOL_PUBLISH_INTERVAL = 256;
+constexpr uint64_t LIVE_SLOT_PUBLISH_INTERVAL = 1024;  // Packets
+
+bool g_live_stats = false;
+std::string g_live_stats_name;
+LiveStatsSegment g_live;
+uint32_t g_live_group = 0;  // Hybrid group of this process (symbol table key)
+std::atomic<uint32_t> g_live_next_slot{0};
+
+struct LiveSymbolCursor {
+  LiveSymbol* entry = nullptr;
+  bool claimed = false;
+  uint32_t pending = 0;  // Messages since last publish
+  int64_t fills_published = 0;
+  PerSymbolSim::FillDiagnostics diag_published;
+};
+std::unique_ptr<LiveSymbolCursor[]> g_live_cursors;
+
+// Per-thread progress, flushed to the worker's slot in batches
+struct LiveWorker {
+  LiveSlot* slot = nullptr;
+  const uint8_t* file_base = nullptr;
+  uint64_t bytes_base = 0;  // Bytes of files already completed
+  uint64_t packets = 0;
+  uint64_t messages = 0;
+  uint64_t feed_first_ns = 0;
+  uint64_t feed_ns = 0;
+  uint64_t since_publish = 0;
+};
+thread_local LiveWorker t_live;
+
+// =============================================================================
+// Tick-to-quote latency tracing (--latency-hist, latency_trace.hpp)
+// Each thread records into its own table and folds it into the process-wide
+// window and total every LATENCY_FLUSH_PACKETS packets once a quarter of the
+// export interval has passed. Whoever folds in after the interval expires
+// writes the window's percentile rows.
+// =============================================================================
+
+constexpr uint32_t LATENCY_FLUSH_PACKETS = 1024;
+
+std::string g_latency_path;
+double g_latency_interval_s = 10.0;
+std::string g_latency_tiers_path;
+CostProfile g_latency_tier_profile;
+LatencyTiers g_latency_tiers;
+
+std::mutex g_latency_mutex;
+std::ofstream g_latency_out;
+size_t g_latency_group = 0;  // Hybrid group (1-based), 0 in-process
+uint64_t g_latency_start = 0;
+uint64_t g_latency_interval_cycles = 0;
+uint64_t g_latency_next_export = 0;
+std::unique_ptr<LatencyTable> g_latency_window;
+std::unique_ptr<LatencyTable> g_latency_total;
+std::vector<std::unique_ptr<LatencyTable>> g_latency_tables;  // One per thread
+
+struct LatencyWorker {
+  LatencyTable* table = nullptr;
+  LatencyTrace trace;
+  SymbolCost scratch;  // Bucket cycles of the message in flight
+  uint64_t next_flush = 0;
+  uint32_t since_check = 0;
+};
+thread_local LatencyWorker t_latency;
+
+// =============================================================================
+// Paced replay and overload control (--replay-speed, overload_control.hpp)
+// Every worker thread is a shard with its own controller; the level it
+// returns for a packet applies to all of that packet's messages.
+// =============================================================================
+
+std::string g_overload_log;
+std::mutex g_overload_mutex;
+std::vector<std::unique_ptr<OverloadController>> g_overload_shards;
+thread_local OverloadController* t_overload = nullptr;
+thread_local DegradeLevel t_degrade = DegradeLevel::NORMAL;
+
+OverloadController& overload_shard() {
+  if (!t_overload) {
+    std::lock_guard<std::mutex> lock(g_overload_mutex);
+    g_overload_shards.push_back(std::make_unique<OverloadController>(g_config.overload));
+    t_overload = g_overload_shards.back().get();
+  }
+  return *t_overload;
+}
+
+// Latest top of book of every symbol, readable from any thread (bbo_table.hpp)
+std::unique_ptr<BboTable> g_bbo_table;
+
+// ETF/basket NAVs (--baskets, basket_nav.hpp). The file is read while
+// parsing arguments; the engine is built per process once the symbol map is
+// loaded, since hybrid groups each cover their own time range.
+std::string g_baskets_path;
+BasketFile g_basket_file;
+std::unique_ptr<BasketEngine> g_baskets;
+
+void init_baskets() {
+  if (g_baskets_path.empty()) return;
+  g_baskets = std::make_unique<BasketEngine>(g_basket_file, MAX_SYMBOLS);
+  g_config.baskets = g_baskets.get();
+}
+
+// Shared-object strategy (--strategy-plugin, strategy_plugin.hpp). The
+// library is opened while parsing arguments; each process creates its own
+// instance, since hybrid groups fork after parsing.
+std::string g_plugin_path;
+std::string g_plugin_args;
+std::unique_ptr<StrategyPlugin> g_plugin;
+
+// Multi-day batches (--catalog, --batch; capture_catalog.hpp, run_results.hpp)
+std::string g_catalog_path;
+std::string g_batch_dir;
+size_t g_batch_jobs = 0;  // 0 = one per process (--threads)
+
+// Sharded runs (--plan, --shard; shard_plan.hpp). A shard simulates only its
+// symbol partition or only the packets of its channel.
+std::string g_plan_path;
+uint32_t g_shard_id = 0;          // 1-based, 0 = not running a shard
+uint32_t g_shard_partition = 0;   // Symbols with index % partitions == partition
+uint32_t g_shard_partitions = 1;
+uint16_t g_shard_channel = 0;     // UDP destination port, 0 = every packet
+
+// Cross-symbol reads for plugins (mmsim_host, MMSIM_PLUGIN_READS_TOPS)
+uint32_t plugin_symbol_index(const char* ticker) {
+  if (!ticker) return 0;
+  auto idx = xdp::get_global_symbol_map().find_index(ticker);
+  return idx ? *idx : 0;
+}
+
+int plugin_read_top(uint32_t symbol_index, mmsim_top* out) {
+  if (!g_bbo_table || !out || g_bbo_table->version(symbol_index) == 0) return 0;
+  const BboQuote q = g_bbo_table->read(symbol_index);
+  *out = mmsim_top{};
+  out->ts_ns = q.ts_ns;
+  out->bid = q.bid;
+  out->ask = q.ask;
+  out->last_price = q.last_price;
+  out->bid_qty = q.bid_qty;
+  out->ask_qty = q.ask_qty;
+  out->last_qty = q.last_qty;
+  return 1;
+}
+
+const mmsim_host g_plugin_host = {plugin_symbol_index, plugin_read_top};
+
+bool init_strategy_plugin(std::string& err) {
+  if (!g_plugin) return true;
+  if (!g_plugin->create(g_plugin_args, err)) return false;
+  g_plugin->set_host(&g_plugin_host);
+  g_config.plugin = g_plugin.get();
+  return true;
+}
+
 // Initialize pre-allocated storage (call once at startup)
 void init_symbol_storage() {
   g_sims_array = std::make_unique<PerSymbolSim*[]>(MAX_SYMBOLS);
@@ -73,6 +258,15 @@ void init_symbol_storage() {
     g_sims_array[i] = nullptr;
     g_sims_initialized[i].store(false, std::memory_order_relaxed);
   }
+  if (g_live.is_open()) {
+    g_live_cursors = std::make_unique<LiveSymbolCursor[]>(MAX_SYMBOLS);
+  }
+  // Only kept when something reads it: publishing takes the book lock on
+  // every message
+  if (g_plugin && g_plugin->reads_tops()) {
+    g_bbo_table = std::make_unique<BboTable>(MAX_SYMBOLS);
+    g_config.bbo_table = g_bbo_table.get();
+  }
 }
 
 // Clean up allocated PerSymbolSim objects
@@ -86,6 +280,39 @@ void cleanup_symbol_storage() {
   }
 }
 
+// Flush and close every per-symbol decision log
+void close_decision_logs() {
+  if (g_config.decision_log_dir.empty() || !g_sims_array) return;
+  for (size_t i = 0; i < MAX_SYMBOLS; ++i) {
+    if (g_sims_initialized[i].load(std::memory_order_relaxed) && g_sims_array[i]) {
+      g_sims_array[i]->close_decision_log();
+    }
+  }
+}
+
+// Release every symbol's plugin state and the plugin instance, and report
+// the batches delivered
+void close_strategy_plugin(const std::string& prefix) {
+  if (!g_config.plugin || !g_sims_array) return;
+  uint64_t symbols = 0, batches = 0, events = 0, intents = 0, rejected = 0;
+  for (size_t i = 0; i < MAX_SYMBOLS; ++i) {
+    if (!g_sims_initialized[i].load(std::memory_order_relaxed) || !g_sims_array[i]) continue;
+    PerSymbolSim& sim = *g_sims_array[i];
+    if (!sim.plugin.open) continue;
+    sim.close_plugin();
+    symbols++;
+    batches += sim.plugin.batches;
+    events += sim.plugin.events_delivered;
+    intents += sim.plugin.intents;
+    rejected += sim.plugin.intents_rejected;
+  }
+  std::cerr << prefix << "Strategy plugin " << g_plugin->name() << ": " << symbols << " symbols, "
+            << batches << " batches, " << events << " events, " << intents << " quote intents ("
+            << rejected << " crossed)\n";
+  g_plugin->destroy();
+  g_config.plugin = nullptr;
+}
+
 // Get shard mutex for a symbol (distributes lock contention)
 inline std::mutex& get_shard_mutex(uint32_t symbol_index) {
   return g_shard_mutexes[symbol_index % NUM_LOCK_SHARDS];
@@ -109,55 +336,466 @@ inline PerSymbolSim* get_or_create_sim_fast(uint32_t symbol_index) {
   }
 
   g_sims_array[symbol_index] = new PerSymbolSim();
+  if (symbol_index < g_symbol_pipelined.size() && g_symbol_pipelined[symbol_index]) {
+    std::lock_guard<std::mutex> plock(g_pipelines_mutex);
+    PipelineHooks hooks = g_pipeline_hooks;
+    hooks.context = t_live.slot;  // Strategy thread adds fill counters to our slot
+    g_pipelines.push_back(std::make_unique<SymbolPipeline>(*g_sims_array[symbol_index], hooks));
+  }
   g_sims_initialized[symbol_index].store(true, std::memory_order_release);
   g_active_symbols.fetch_add(1, std::memory_order_relaxed);
 
   return g_sims_array[symbol_index];
 }
 
-// Periodically report memory stats (lock-free read of atomics)
-void report_memory_stats() {
-  std::cout << " [syms: " << g_active_symbols.load() << "]" << std::flush;
+// Get file size in bytes
+size_t get_file_size(const std::string& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) == 0) {
+    return static_cast<size_t>(st.st_size);
+  }
+  return 0;
 }
 
-// =============================================================================
-// XDP Message Dispatch
-// =============================================================================
+// Bind the calling thread to a live stats slot
+void live_attach_worker(uint32_t slot_idx, uint64_t files_total,
+                        uint64_t bytes_total) {
+  t_live = LiveWorker{};
+  LiveSlot& slot = g_live.slot(slot_idx);
+  t_live.slot = &slot;
+  slot.pid.store(static_cast<int32_t>(getpid()), std::memory_order_relaxed);
+  slot.files_total.store(files_total, std::memory_order_relaxed);
+  slot.bytes_total.store(bytes_total, std::memory_order_relaxed);
+  slot.heartbeat_ns.store(live_wall_ns(), std::memory_order_relaxed);
+  slot.state.store(static_cast<uint32_t>(LiveSlotState::RUNNING),
+                   std::memory_order_relaxed);
+}
 
-void process_xdp_message(const uint8_t *data, size_t max_len, uint16_t msg_type,
-                         uint64_t now_ns) {
-  if (max_len < xdp::MESSAGE_HEADER_SIZE)
-    return;
+// Publish this thread's counters; `pos` is the current read position inside
+// the mmapped file (nullptr between files)
+void live_flush_worker(const uint8_t* pos) {
+  LiveSlot& slot = *t_live.slot;
+  uint64_t in_file = (pos && t_live.file_base) ? static_cast<uint64_t>(pos - t_live.file_base) : 0;
+  slot.packets.store(t_live.packets, std::memory_order_relaxed);
+  slot.messages.store(t_live.messages, std::memory_order_relaxed);
+  slot.feed_first_ns.store(t_live.feed_first_ns, std::memory_order_relaxed);
+  slot.feed_ns.store(t_live.feed_ns, std::memory_order_relaxed);
+  slot.bytes_done.store(t_live.bytes_base + in_file, std::memory_order_relaxed);
+  slot.heartbeat_ns.store(live_wall_ns(), std::memory_order_relaxed);
+  t_live.since_publish = 0;
+}
 
-  uint32_t symbol_index = xdp::read_symbol_index(msg_type, data, max_len);
-  if (symbol_index == 0)
-    return;
+void live_begin_file(const xdp::MmapPcapReader& reader) {
+  if (t_live.slot) t_live.file_base = reader.data();
+}
 
-  // Bounds check: NYSE has ~8000 symbols, anything > 100k is invalid
-  constexpr uint32_t MAX_VALID_SYMBOL_INDEX = 100000;
-  if (symbol_index > MAX_VALID_SYMBOL_INDEX)
+void live_end_file(const xdp::MmapPcapReader& reader) {
+  if (!t_live.slot) return;
+  t_live.bytes_base += reader.file_size();
+  t_live.file_base = nullptr;
+  t_live.slot->files_done.fetch_add(1, std::memory_order_relaxed);
+  live_flush_worker(nullptr);
+}
+
+// Refresh a symbol's table entry and move its fill pipeline counters into
+// the current worker's slot after `messages` more messages. Called under the
+// symbol's shard lock, or on the strategy thread of a pipelined symbol.
+void live_publish_symbol(PerSymbolSim& sim, uint32_t symbol_index, uint32_t messages = 1) {
+  LiveSymbolCursor& c = g_live_cursors[symbol_index];
+  c.pending += messages;
+  if (c.pending < LIVE_SYMBOL_PUBLISH_INTERVAL &&
+      sim.toxicity_risk.total_fills == c.fills_published) {
     return;
+  }
+  if (!c.claimed) {
+    c.entry = g_live.claim_symbol(g_live_group, symbol_index, sim.cached_ticker);
+    c.claimed = true;
+  }
 
-  std::string ticker = xdp::get_symbol(symbol_index);
-  if (!g_filter_ticker.empty() && ticker != g_filter_ticker)
+  const auto& d = sim.diag_toxicity;
+  auto& p = c.diag_published;
+  if (t_live.slot) {
+    LiveSlot& slot = *t_live.slot;
+    auto add = [](std::atomic<uint64_t>& dst, uint64_t now, uint64_t& prev) {
+      if (now != prev) dst.fetch_add(now - prev, std::memory_order_relaxed);
+      prev = now;
+    };
+    add(slot.exec_total, d.exec_total, p.exec_total);
+    add(slot.exec_no_order_info, d.exec_no_order_info, p.exec_no_order_info);
+    add(slot.exec_not_eligible, d.exec_not_eligible, p.exec_not_eligible);
+    add(slot.try_fill_calls, d.try_fill_calls, p.try_fill_calls);
+    add(slot.rejected_halted, d.rejected_halted, p.rejected_halted);
+    add(slot.rejected_not_live, d.rejected_not_live, p.rejected_not_live);
+    add(slot.rejected_latency, d.rejected_latency, p.rejected_latency);
+    add(slot.rejected_price, d.rejected_price, p.rejected_price);
+    add(slot.rejected_queue, d.rejected_queue, p.rejected_queue);
+    add(slot.fill_succeeded, d.fill_succeeded, p.fill_succeeded);
+    add(slot.quote_resets, d.quote_resets, p.quote_resets);
+  }
+
+  if (LiveSymbol* e = c.entry) {
+    const auto ts = sim.mm_toxicity.get_stats();
+    const auto bs = sim.mm_baseline.get_stats();
+    uint32_t flags = (sim.eligible_to_trade ? LIVE_SYM_ELIGIBLE : 0) |
+                     (sim.toxicity_risk.halted ? LIVE_SYM_HALTED : 0) |
+                     (sim.blacklisted ? LIVE_SYM_BLACKLISTED : 0) |
+                     (sim.eod_liquidated ? LIVE_SYM_EOD : 0);
+    e->flags.store(flags, std::memory_order_relaxed);
+    e->messages.store(e->messages.load(std::memory_order_relaxed) + c.pending,
+                      std::memory_order_relaxed);
+    e->toxicity_fills.store(sim.toxicity_risk.total_fills, std::memory_order_relaxed);
+    e->baseline_fills.store(sim.baseline_risk.total_fills, std::memory_order_relaxed);
+    e->quotes_suppressed.store(ts.quotes_suppressed, std::memory_order_relaxed);
+    e->inventory.store(sim.mm_toxicity.get_inventory(), std::memory_order_relaxed);
+    e->toxicity_pnl.store(ts.realized_pnl + ts.unrealized_pnl + sim.toxicity_risk.total_adverse_pnl,
+                          std::memory_order_relaxed);
+    e->baseline_pnl.store(bs.realized_pnl + bs.unrealized_pnl + sim.baseline_risk.total_adverse_pnl,
+                          std::memory_order_relaxed);
+    e->adverse_pnl.store(sim.toxicity_risk.total_adverse_pnl, std::memory_order_relaxed);
+  }
+  c.pending = 0;
+  c.fills_published = sim.toxicity_risk.total_fills;
+}
+
+// Create the segment for this run; failure only disables live stats
+void open_live_stats(uint32_t num_slots, const std::string& mode,
+                     const std::vector<std::string>& files) {
+  if (g_live_stats_name.empty()) {
+    g_live_stats_name = live_stats_default_name(getpid());
+  } else if (g_live_stats_name[0] != '/') {
+    g_live_stats_name = "/" + g_live_stats_name;
+  }
+  std::string err;
+  if (!g_live.create(g_live_stats_name, num_slots, err)) {
+    std::cerr << "Warning: live stats disabled: " << err << "\n";
     return;
+  }
+  LiveStatsHeader& h = g_live.header();
+  h.files_total = files.size();
+  for (const auto& f : files) h.bytes_total += get_file_size(f);
+  std::strncpy(h.mode, mode.c_str(), sizeof(h.mode) - 1);
+  std::strncpy(h.ticker_filter, g_filter_ticker.c_str(), sizeof(h.ticker_filter) - 1);
+  h.run_state.store(static_cast<uint32_t>(LiveRunState::RUNNING), std::memory_order_relaxed);
+  std::cerr << "Live stats: " << g_live_stats_name << " (watch with: mmtop "
+            << g_live_stats_name.substr(1) << ")\n" << std::flush;
+}
+
+void set_live_run_state(LiveRunState state) {
+  if (!g_live.is_open()) return;
+  LiveStatsHeader& h = g_live.header();
+  h.run_state.store(static_cast<uint32_t>(state), std::memory_order_relaxed);
+  h.heartbeat_ns.store(live_wall_ns(), std::memory_order_relaxed);
+}
+
+// Mark the run finished and drop the name (mmtop keeps its mapping)
+void close_live_stats() {
+  if (!g_live.is_open()) return;
+  set_live_run_state(LiveRunState::DONE);
+  g_live.unlink();
+  g_live.close();
+}
+
+// Drain and stop every symbol pipeline so strategy state can be read
+void finish_pipelines() {
+  std::lock_guard<std::mutex> lock(g_pipelines_mutex);
+  for (auto& p : g_pipelines) {
+    p->finish();
+    const PerSymbolSim& sim = p->sim();
+    std::cerr << "Pipeline " << sim.cached_ticker << ": " << p->events()
+              << " events (" << p->executions() << " executions), "
+              << p->producer_waits() << " producer waits, "
+              << sim.view_depth_misses << " queue lookups past view depth\n";
+  }
+  g_pipelines.clear();
+}
+
+// Symbol tiers need the symbol map, so each process builds its own
+void init_latency_tiers() {
+  if (g_latency_path.empty() || g_latency_tiers_path.empty()) return;
+  g_latency_tiers.from_profile(g_latency_tier_profile, MAX_SYMBOLS);
+}
+
+// Start the latency file of this process (`path`, or a hybrid group part)
+bool open_latency_trace(const std::string& path, size_t group) {
+  g_latency_out.open(path);
+  if (!g_latency_out.is_open()) return false;
+  write_latency_header(g_latency_out, g_cycles_per_ns, g_latency_tiers);
+  g_latency_group = group;
+  g_latency_window = std::make_unique<LatencyTable>();
+  g_latency_total = std::make_unique<LatencyTable>();
+  g_latency_interval_cycles = static_cast<uint64_t>(g_latency_interval_s * 1e9 * g_cycles_per_ns);
+  g_latency_start = xdp::read_cycles();
+  g_latency_next_export = g_latency_start + g_latency_interval_cycles;
+  return true;
+}
+
+LatencyWorker& latency_worker() {
+  if (!t_latency.table) {
+    std::lock_guard<std::mutex> lock(g_latency_mutex);
+    g_latency_tables.push_back(std::make_unique<LatencyTable>());
+    t_latency.table = g_latency_tables.back().get();
+  }
+  return t_latency;
+}
+
+double latency_elapsed_s(uint64_t now) {
+  return static_cast<double>(now - g_latency_start) / g_cycles_per_ns / 1e9;
+}
+
+// Fold this thread's samples into the window and total. Caller holds
+// g_latency_mutex.
+void latency_fold_locked(LatencyTable& table) {
+  g_latency_window->merge(table);
+  g_latency_total->merge(table);
+  table.reset();
+}
 
-  // Only create simulation state for known symbols
-  if (ticker.empty())
+void latency_maybe_flush() {
+  LatencyWorker& w = latency_worker();
+  uint64_t now = xdp::read_cycles();
+  if (now < w.next_flush) return;
+  w.next_flush = now + g_latency_interval_cycles / 4;
+  std::lock_guard<std::mutex> lock(g_latency_mutex);
+  latency_fold_locked(*w.table);
+  if (now >= g_latency_next_export) {
+    write_latency_rows(g_latency_out, "window", latency_elapsed_s(now), g_latency_group,
+                       *g_latency_window, g_latency_tiers, g_cycles_per_ns);
+    g_latency_out.flush();
+    g_latency_window->reset();
+    g_latency_next_export = now + g_latency_interval_cycles;
+  }
+}
+
+// Fold every thread's leftovers (workers must be idle), write the last
+// window, the totals and the raw histograms. Returns the run's totals.
+std::unique_ptr<LatencyTable> close_latency_trace() {
+  std::lock_guard<std::mutex> lock(g_latency_mutex);
+  for (auto& table : g_latency_tables) latency_fold_locked(*table);
+  const double elapsed = latency_elapsed_s(xdp::read_cycles());
+  write_latency_rows(g_latency_out, "window", elapsed, g_latency_group, *g_latency_window,
+                     g_latency_tiers, g_cycles_per_ns);
+  write_latency_rows(g_latency_out, "total", elapsed, g_latency_group, *g_latency_total,
+                     g_latency_tiers, g_cycles_per_ns);
+  write_latency_hists(g_latency_out, *g_latency_total, g_latency_tiers);
+  g_latency_out.close();
+  return std::move(g_latency_total);
+}
+
+// Strategy-thread half of dispatch_message for pipelined symbols: the same
+// cost, latency and live accounting, driven by the stamps each event carries
+// from the message that produced it. `start` adopts the creating worker's
+// live slot, whose fill counters are atomics.
+void pipeline_hook_start(void* live_slot) {
+  t_live = LiveWorker{};
+  t_live.slot = static_cast<LiveSlot*>(live_slot);
+}
+
+void pipeline_hook_begin(PerSymbolSim& sim, const PipelineEvent& ev) {
+  SymbolCost* scopes = ev.sampled ? &sim.pipeline->strategy_cost : nullptr;
+  if (ev.origin) {
+    LatencyWorker& lat = latency_worker();
+    lat.trace.origin = ev.origin;
+    lat.trace.quoted = 0;
+    lat.scratch = SymbolCost{};
+    scopes = &lat.scratch;
+    sim.latency = &lat.trace;
+  }
+  sim.cost_sampling = scopes;
+}
+
+void pipeline_hook_end(PerSymbolSim& sim, const PipelineEvent& ev) {
+  sim.cost_sampling = nullptr;
+  if (sim.latency) {
+    sim.latency = nullptr;
+    LatencyWorker& lat = latency_worker();
+    lat.table->record_strategy(g_latency_tiers.tier_of(sim.symbol_index), lat.trace, lat.scratch);
+    if (ev.sampled) {
+      SymbolCost& cost = sim.pipeline->strategy_cost;
+      for (size_t i = 0; i < NUM_COST_BUCKETS; ++i) cost.cycles[i] += lat.scratch.cycles[i];
+    }
+    if (++lat.since_check >= LATENCY_FLUSH_PACKETS) {
+      lat.since_check = 0;
+      latency_maybe_flush();
+    }
+  }
+  if (g_live_cursors && ev.messages) live_publish_symbol(sim, sim.symbol_index, ev.messages);
+}
+
+// Per-shard overload summary on stderr and, with --overload-log, every mode
+// change as CSV (`path`, or a hybrid group part). Workers must be idle.
+void report_overload(const std::string& path, const std::string& prefix) {
+  std::lock_guard<std::mutex> lock(g_overload_mutex);
+  for (size_t i = 0; i < g_overload_shards.size(); ++i) {
+    std::cerr << "Overload shard " << prefix << i << ":\n";
+    print_overload_summary(std::cerr, *g_overload_shards[i]);
+  }
+  if (path.empty()) return;
+  std::ofstream out(path);
+  if (!out.is_open()) {
+    std::cerr << "Failed to write overload log: " << path << "\n";
     return;
+  }
+  out << "shard,wall_s,feed_ns,lag_us,from,to\n";
+  for (size_t i = 0; i < g_overload_shards.size(); ++i) {
+    write_overload_changes(out, prefix + std::to_string(i), *g_overload_shards[i]);
+  }
+}
+
+// Snapshot per-symbol cost counters of this process
+CostProfile collect_cost_profile() {
+  CostProfile profile;
+  profile.cycles_per_ns = g_cycles_per_ns;
+  profile.sample_interval = g_config.cost_sample_interval;
+  if (!g_sims_array) return profile;
+  for (uint32_t idx = 0; idx < MAX_SYMBOLS; ++idx) {
+    if (!g_sims_initialized[idx].load(std::memory_order_relaxed)) continue;
+    PerSymbolSim* sim = g_sims_array[idx];
+    if (!sim || sim->cost.messages == 0) continue;
+    profile.entries.push_back({sim->cached_ticker, idx, sim->cost});
+  }
+  return profile;
+}
+
+// Merged markout curves of every symbol in this process
+MarkoutCurves collect_markouts() {
+  MarkoutCurves curves;
+  if (!g_sims_array) return curves;
+  for (uint32_t idx = 0; idx < MAX_SYMBOLS; ++idx) {
+    if (!g_sims_initialized[idx].load(std::memory_order_relaxed)) continue;
+    PerSymbolSim* sim = g_sims_array[idx];
+    if (sim) curves.merge(sim->markouts.curves());
+  }
+  return curves;
+}
+
+// Per-fill markout CSV (both strategies, every symbol of this process)
+bool write_markout_fills(const std::string& path, size_t group) {
+  std::ofstream out(path);
+  if (!out.is_open()) return false;
+  write_markout_csv_header(out, g_config.markout_horizons);
+  for (uint32_t idx = 0; idx < MAX_SYMBOLS; ++idx) {
+    if (!g_sims_initialized[idx].load(std::memory_order_relaxed)) continue;
+    PerSymbolSim* sim = g_sims_array[idx];
+    if (!sim) continue;
+    sim->markouts.for_each_fill([&](const MarkoutFill& f) {
+      write_markout_csv_row(out, group, idx, sim->cached_ticker, f, g_config.markout_horizons);
+    });
+  }
+  return true;
+}
+
+// Lay out the session calendar over the captures' time range (from each
+// file's first packet). Returns the distinct local dates the captures start
+// on, for the parameter log.
+std::vector<int32_t> build_session_calendar(const std::vector<std::string>& pcap_files,
+                                            const xdp::SessionCalendar::Options& opts) {
+  uint64_t first_ns = UINT64_MAX, last_ns = 0;
+  std::vector<uint64_t> starts;
+  for (const auto& path : pcap_files) {
+    xdp::MmapPcapReader reader;
+    if (!reader.open(path)) continue;
+    uint64_t ts = reader.first_timestamp_ns();
+    if (ts == 0) continue;
+    starts.push_back(ts);
+    first_ns = std::min(first_ns, ts);
+    last_ns = std::max(last_ns, ts);
+  }
+  std::vector<int32_t> dates;
+  if (starts.empty()) return dates;
+  g_config.calendar.build(first_ns, last_ns, opts);
+  for (uint64_t ts : starts) {
+    int32_t date = g_config.calendar.find(ts)->date;
+    if (std::find(dates.begin(), dates.end(), date) == dates.end()) dates.push_back(date);
+  }
+  std::sort(dates.begin(), dates.end());
+  return dates;
+}
+
+// Periodically report memory stats (lock-free read of atomics)
+void report_memory_stats() {
+  std::cout << " [syms: " << g_active_symbols.load() << "]" << std::flush;
+}
+
+// =============================================================================
+// XDP Message Dispatch
+// =============================================================================
 
-  g_total_messages.fetch_add(1, std::memory_order_relaxed);
+// Bounds check: NYSE has ~8000 symbols, anything > 100k is invalid
+constexpr uint32_t MAX_VALID_SYMBOL_INDEX = 100000;
 
-  // Lock-free fast path for symbol lookup, sharded lock for updates
-  PerSymbolSim* sim_ptr = get_or_create_sim_fast(symbol_index);
-  if (!sim_ptr) return;
+// Symbol indices the run simulates (-t filter applied once at startup, so the
+// packet loop does not build a ticker string per message)
+std::vector<uint8_t> g_symbol_simulated;
 
-  PerSymbolSim& sim = *sim_ptr;
+void init_symbol_filter() {
+  g_pipeline_hooks = {pipeline_hook_start, pipeline_hook_begin, pipeline_hook_end, nullptr};
+  g_symbol_pipelined.assign(g_pipeline_tickers.empty() ? 0 : MAX_SYMBOLS, 0);
+  for (const auto& ticker : g_pipeline_tickers) {
+    auto idx = xdp::get_global_symbol_map().find_index(ticker);
+    if (idx && *idx < MAX_SYMBOLS) g_symbol_pipelined[*idx] = 1;
+  }
+
+  g_symbol_simulated.assign(MAX_VALID_SYMBOL_INDEX + 1, 1);
+  g_symbol_simulated[0] = 0;
+  if (g_shard_partitions > 1) {
+    for (uint32_t idx = 1; idx <= MAX_VALID_SYMBOL_INDEX; ++idx) {
+      g_symbol_simulated[idx] = idx % g_shard_partitions == g_shard_partition;
+    }
+  }
+  if (g_filter_ticker.empty()) return;
+  for (uint32_t idx = 1; idx <= MAX_VALID_SYMBOL_INDEX; ++idx) {
+    g_symbol_simulated[idx] = g_symbol_simulated[idx] && xdp::get_symbol(idx) == g_filter_ticker;
+  }
+}
+
+inline bool symbol_simulated(uint32_t symbol_index) {
+  return symbol_index <= MAX_VALID_SYMBOL_INDEX && g_symbol_simulated[symbol_index];
+}
 
-  // Use sharded lock for this symbol's updates
-  std::lock_guard<std::mutex> sym_lock(get_shard_mutex(symbol_index));
+// Apply one message to its symbol. Caller holds the symbol's shard lock.
+void dispatch_message(PerSymbolSim& sim, uint32_t symbol_index,
+                      const uint8_t *data, size_t max_len, uint16_t msg_type,
+                      uint64_t now_ns) {
+  SymbolPipeline* pipe = sim.pipeline;
+
+  // Sampled cost accounting: time 1 in N messages of each symbol
+  SymbolCost* cost = nullptr;
+  if (g_config.cost_sample_interval) {
+    sim.cost.messages++;
+    if (++sim.cost.since_sample >= g_config.cost_sample_interval) {
+      sim.cost.since_sample = 0;
+      sim.cost.samples++;
+      cost = &sim.cost;
+    }
+  }
 
-  sim.ensure_init(symbol_index, g_config);
+  // Latency tracing times every message of the symbol, so the scopes write
+  // into a per-message scratch record that sampled messages add to sim.cost
+  LatencyWorker* lat = nullptr;
+  uint64_t dispatched = 0;
+  SymbolCost* scopes = cost;
+  if (!g_latency_path.empty()) {
+    lat = &latency_worker();
+    dispatched = xdp::read_cycles();
+    lat->scratch = SymbolCost{};
+    lat->trace.quoted = 0;
+    scopes = &lat->scratch;
+  }
+  sim.book_cost_sampling = scopes;
+  CostScope dispatch_scope(scopes, CostBucket::OTHER);
+
+  if (pipe) {
+    // Strategy state belongs to the strategy thread: the overload level,
+    // sample flag and trace origin travel with the message's events, and
+    // pipeline_hook_begin/end account them there
+    pipe->begin_message(now_ns, t_degrade, cost != nullptr, lat ? lat->trace.origin : 0);
+  } else {
+    sim.cost_sampling = scopes;
+    if (lat) sim.latency = &lat->trace;
+    if (g_config.overload.enabled()) sim.set_degrade(t_degrade);
+    // Markouts see the book as it stood before this event
+    sim.advance_markouts(now_ns);
+  }
 
   switch (msg_type) {
   case static_cast<uint16_t>(xdp::MessageType::ADD_ORDER): {
@@ -179,7 +817,7 @@ void process_xdp_message(const uint8_t *data, size_t max_len, uint16_t msg_type,
       uint32_t price_raw = xdp::read_le32(data + 24);
       uint32_t volume = xdp::read_le32(data + 28);
       double price = xdp::parse_price(price_raw);
-      sim.on_modify(order_id, price, volume);
+      sim.on_modify(order_id, price, volume, now_ns);
     }
     break;
   }
@@ -187,7 +825,7 @@ void process_xdp_message(const uint8_t *data, size_t max_len, uint16_t msg_type,
   case static_cast<uint16_t>(xdp::MessageType::DELETE_ORDER): {
     if (max_len >= xdp::MessageSize::DELETE_ORDER) {
       uint64_t order_id = xdp::read_le64(data + 16);
-      sim.on_delete(order_id);
+      sim.on_delete(order_id, now_ns);
     }
     break;
   }
@@ -220,6 +858,25 @@ void process_xdp_message(const uint8_t *data, size_t max_len, uint16_t msg_type,
   default:
     break;
   }
+
+  if (g_config.bbo_table || g_config.baskets) sim.publish_top(now_ns);
+  if (pipe) pipe->end_message();
+
+  dispatch_scope.end();
+  sim.book_cost_sampling = nullptr;
+  if (!pipe) {
+    sim.cost_sampling = nullptr;
+    sim.latency = nullptr;
+  }
+  if (lat) {
+    lat->table->record(g_latency_tiers.tier_of(symbol_index), lat->trace, dispatched,
+                       xdp::read_cycles(), lat->scratch);
+    if (cost) {
+      for (size_t i = 0; i < NUM_COST_BUCKETS; ++i) cost->cycles[i] += lat->scratch.cycles[i];
+    }
+  }
+
+  if (g_live_cursors && !pipe) live_publish_symbol(sim, symbol_index);
 }
 
 // =============================================================================
@@ -227,24 +884,178 @@ void process_xdp_message(const uint8_t *data, size_t max_len, uint16_t msg_type,
 // Used by all execution modes (hybrid, threaded, sequential)
 // =============================================================================
 
+// Message decoded by the first pass of the packet loop
+struct PendingMessage {
+  const uint8_t* data;
+  uint16_t size;
+  uint16_t type;
+  uint32_t symbol_index;
+  uint64_t order_id;      // 0 for messages that do not reference an order
+  uint64_t new_order_id;  // REPLACE only
+};
+
+// Stage 1 (2*distance ahead): the symbol's PerSymbolSim. Its slot in
+// g_sims_array was already prefetched while decoding.
+inline void prefetch_symbol_state(const PendingMessage& m) {
+  if (m.symbol_index >= MAX_SYMBOLS) return;
+  if (!g_sims_initialized[m.symbol_index].load(std::memory_order_acquire)) return;
+  const PerSymbolSim* sim = g_sims_array[m.symbol_index];
+  __builtin_prefetch(sim, 1, 3);
+  __builtin_prefetch(&sim->order_info, 0, 3);
+}
+
+// Stage 2 (distance ahead): the order-table slots the message will touch
+inline void prefetch_order_slots(const PendingMessage& m) {
+  if (m.order_id == 0 || m.symbol_index >= MAX_SYMBOLS) return;
+  if (!g_sims_initialized[m.symbol_index].load(std::memory_order_acquire)) return;
+  const PerSymbolSim* sim = g_sims_array[m.symbol_index];
+  sim->prefetch_order(m.order_id);
+  if (m.new_order_id) sim->prefetch_order(m.new_order_id);
+}
+
 void process_packet_callback(const uint8_t *data, size_t length,
                              uint64_t /*packet_num*/,
                              const xdp::NetworkPacketInfo &info) {
+  // Channel shards see only their own channel's packets
+  if (g_shard_channel && info.dst_port != g_shard_channel) return;
   g_total_packets.fetch_add(1, std::memory_order_relaxed);
 
+  if (g_config.overload.enabled()) {
+    t_degrade = overload_shard().on_packet(info.timestamp_ns);
+  }
+
+  if (!g_latency_path.empty()) {
+    t_latency.trace.origin = xdp::read_cycles();
+    if (++t_latency.since_check >= LATENCY_FLUSH_PACKETS) {
+      t_latency.since_check = 0;
+      latency_maybe_flush();
+    }
+  }
+
+  if (t_live.slot) {
+    t_live.packets++;
+    t_live.feed_ns = info.timestamp_ns;
+    if (t_live.feed_first_ns == 0) t_live.feed_first_ns = info.timestamp_ns;
+    if (++t_live.since_publish >= LIVE_SLOT_PUBLISH_INTERVAL) live_flush_worker(data);
+  }
+
   if (length < xdp::PACKET_HEADER_SIZE) return;
 
   xdp::PacketHeader pkt_header;
   if (!xdp::parse_packet_header(data, length, pkt_header)) return;
 
+  // Pass 1: decode every message header, drop symbols we do not simulate,
+  // and chain messages of the same symbol together in arrival order
+  PendingMessage msgs[256];
+  uint8_t next_in_group[256];
+  uint8_t group_head[256];
+  uint8_t group_tail[256];
+  size_t n = 0;
+  size_t num_groups = 0;
   size_t offset = xdp::PACKET_HEADER_SIZE;
   for (uint8_t i = 0; i < pkt_header.num_messages && offset < length; i++) {
     if (offset + xdp::MESSAGE_HEADER_SIZE > length) break;
     uint16_t msg_size = xdp::read_le16(data + offset);
     if (msg_size < xdp::MESSAGE_HEADER_SIZE || offset + msg_size > length) break;
-    uint16_t msg_type = xdp::read_le16(data + offset + 2);
-    process_xdp_message(data + offset, msg_size, msg_type, info.timestamp_ns);
+    const uint8_t* msg = data + offset;
     offset += msg_size;
+
+    uint16_t msg_type = xdp::read_le16(msg + 2);
+    uint32_t symbol_index = xdp::read_symbol_index(msg_type, msg, msg_size);
+    if (!symbol_simulated(symbol_index)) continue;
+
+    PendingMessage& m = msgs[n];
+    m.data = msg;
+    m.size = msg_size;
+    m.type = msg_type;
+    m.symbol_index = symbol_index;
+    m.order_id = 0;
+    m.new_order_id = 0;
+    switch (msg_type) {
+    case static_cast<uint16_t>(xdp::MessageType::ADD_ORDER):
+    case static_cast<uint16_t>(xdp::MessageType::MODIFY_ORDER):
+    case static_cast<uint16_t>(xdp::MessageType::DELETE_ORDER):
+    case static_cast<uint16_t>(xdp::MessageType::EXECUTE_ORDER):
+      if (msg_size >= 24) m.order_id = xdp::read_le64(msg + 16);
+      break;
+    case static_cast<uint16_t>(xdp::MessageType::REPLACE_ORDER):
+      if (msg_size >= 32) {
+        m.order_id = xdp::read_le64(msg + 16);
+        m.new_order_id = xdp::read_le64(msg + 24);
+      }
+      break;
+    default:
+      break;
+    }
+
+    // Packets rarely carry more than a handful of symbols: linear search
+    size_t g = 0;
+    while (g < num_groups && msgs[group_head[g]].symbol_index != symbol_index) ++g;
+    if (g == num_groups) {
+      group_head[num_groups++] = static_cast<uint8_t>(n);
+      if (symbol_index < MAX_SYMBOLS) __builtin_prefetch(&g_sims_array[symbol_index], 0, 3);
+    } else {
+      next_in_group[group_tail[g]] = static_cast<uint8_t>(n);
+    }
+    group_tail[g] = static_cast<uint8_t>(n);
+    next_in_group[n] = 0xFF;
+    n++;
+  }
+  if (n == 0) return;
+
+  // Processing order: symbol groups by first appearance, each group in
+  // arrival order. Per-symbol state is independent, but basket NAVs and
+  // plugins reading the BBO table see several symbols, so with either the
+  // packet is replayed in feed order.
+  uint8_t order[256];
+  if (g_baskets || g_bbo_table) {
+    for (size_t j = 0; j < n; ++j) order[j] = static_cast<uint8_t>(j);
+  } else {
+    size_t pos = 0;
+    for (size_t g = 0; g < num_groups; ++g) {
+      for (uint8_t j = group_head[g]; j != 0xFF; j = next_in_group[j]) order[pos++] = j;
+    }
+  }
+
+  // Software pipeline over that order: symbol state 2*d messages ahead and
+  // order-table slots d messages ahead, so the dependent misses of later
+  // messages overlap the work on the current one
+  const size_t d = g_prefetch_distance;
+  const bool orders = g_prefetch_orders;
+  if (d) {
+    for (size_t j = 0; j < n && j < 2 * d; ++j) prefetch_symbol_state(msgs[order[j]]);
+    if (orders) {
+      for (size_t j = 0; j < n && j < d; ++j) prefetch_order_slots(msgs[order[j]]);
+    }
+  }
+
+  // Pass 2: one state lookup, lock acquisition and ensure_init per run of
+  // one symbol's messages
+  for (size_t b = 0; b < n;) {
+    const uint32_t symbol_index = msgs[order[b]].symbol_index;
+    size_t e = b + 1;
+    while (e < n && msgs[order[e]].symbol_index == symbol_index) ++e;
+
+    g_total_messages.fetch_add(e - b, std::memory_order_relaxed);
+    t_live.messages += e - b;
+
+    // Lock-free fast path for symbol lookup, sharded lock for updates
+    PerSymbolSim* sim_ptr = get_or_create_sim_fast(symbol_index);
+    if (sim_ptr) {
+      PerSymbolSim& sim = *sim_ptr;
+      std::lock_guard<std::mutex> sym_lock(get_shard_mutex(symbol_index));
+      sim.ensure_init(symbol_index, g_config);
+      for (size_t p = b; p < e; ++p) {
+        if (d) {
+          if (p + 2 * d < n) prefetch_symbol_state(msgs[order[p + 2 * d]]);
+          if (orders && p + d < n) prefetch_order_slots(msgs[order[p + d]]);
+        }
+        const PendingMessage& m = msgs[order[p]];
+        dispatch_message(sim, symbol_index, m.data, m.size, m.type,
+                         info.timestamp_ns);
+      }
+    }
+    b = e;
   }
 }
 
@@ -477,6 +1288,17 @@ void print_usage(const char *program) {
             << "  --toxicity-multiplier K  Toxicity spread multiplier (default: 1.0)\n"
             << "  --epsilon-min E     Minimum expected PnL per share to quote (default: 0.0003)\n"
             << "  --output-dir DIR    Output directory for per-fill/per-symbol CSV files\n"
+            << "  --markouts          Mark every fill to the mid at 100us, 1ms, 10ms, 100ms, 1s, 10s\n"
+            << "                      (per-fill rows in markouts*.csv when --output-dir is set)\n"
+            << "  --markout-horizons L  Custom horizons, e.g. 500us,5ms,1s (implies --markouts)\n"
+            << "  --decision-log DIR  Write the toxicity strategy's quote/suppress/fill log\n"
+            << "                      (<ticker>[.gN].mmlog, requires -t; view in visualizer_pcap)\n"
+            << "  --baskets FILE      ETF constituent weights (basket,constituent,shares CSV):\n"
+            << "                      track each basket's NAV and the ETF's premium to it\n"
+            << "  --basket-skew W     Lean ETF quotes toward NAV by W x premium (default: 0.5)\n"
+            << "  --strategy-plugin SO  Quote with a shared-object strategy (strategy_plugin.h)\n"
+            << "                      in place of the toxicity strategy\n"
+            << "  --plugin-args STR   Argument string passed to the plugin's create()\n"
             << "\nFilter Type Options:\n"
             << "  --filter-type TYPE  Toxicity filter: logistic or ewma (default: logistic)\n"
             << "  --ewma-alpha A      EWMA decay factor (default: 0.05)\n"
@@ -489,15 +1311,61 @@ void print_usage(const char *program) {
             << "\nWalk-Forward Analysis:\n"
             << "  --walk-forward      Enable walk-forward out-of-sample evaluation\n"
             << "  --wf-window-minutes N  Window size in minutes (default: 30)\n"
+            << "\nSession Options (times are exchange-local, America/New_York):\n"
+            << "  --from T            Start quoting at T in every session: HH:MM[:SS],\n"
+            << "                      YYYY-MM-DD or YYYY-MM-DDTHH:MM[:SS] (book is always replayed)\n"
+            << "  --to T              Liquidate and stop quoting at T (same formats; capped at EOD)\n"
+            << "  --eod-minutes N     Liquidate N minutes before the closing auction (default: 10)\n"
             << "\nParallel Processing Options:\n"
             << "  --threads N         Number of processes (default: auto-detect all cores)\n"
             << "  --files-per-group N Files per process group (default: auto)\n"
             << "  --no-hybrid         Disable hybrid mode (use threaded mode instead)\n"
-            << "  --sequential        Disable all parallelism (single-threaded)\n\n"
+            << "  --sequential        Disable all parallelism (single-threaded)\n"
+            << "  --prefetch-distance N  Messages of prefetch look-ahead in the packet loop (default: 4, 0 = off)\n"
+            << "  --pipeline-heavy N  Run the N costliest symbols as a book stage plus a\n"
+            << "                      strategy thread each (needs --pipeline-profile)\n"
+            << "  --pipeline-profile FILE  Cost profile (from --cost-profile) ranking the symbols\n"
+            << "\nMonitoring:\n"
+            << "  --cost-sample N     Time 1 in N messages per symbol and print a per-symbol CPU table\n"
+            << "  --cost-profile FILE Write the per-symbol cost profile CSV (implies --cost-sample 64)\n"
+            << "  --latency-hist FILE Trace tick-to-quote latency of every message: per-stage\n"
+            << "                      HDR histograms, p50/p99/p99.9 rows every interval\n"
+            << "  --latency-interval S  Seconds between latency rows (default: 10)\n"
+            << "  --latency-tiers FILE  Cost profile ranking symbols into top10/top100/top1000/rest\n"
+            << "  --live-stats        Publish live progress/PnL to /dev/shm/mmsim.<pid> (view with mmtop)\n"
+            << "  --live-stats-name NAME  Shared memory name to use instead of mmsim.<pid>\n"
+            << "\nPaced replay:\n"
+            << "  --replay-speed X    Replay at X times feed time and shed analytics when a\n"
+            << "                      worker falls behind (0 = as fast as possible, default)\n"
+            << "  --overload-lags L   Lag entering skip_features,conflate,throttle,halt\n"
+            << "                      (default: 1ms,5ms,20ms,100ms)\n"
+            << "  --overload-exit R   Leave a level below R x its entry lag (default: 0.5)\n"
+            << "  --overload-throttle N  Quote interval multiplier while throttled (default: 10)\n"
+            << "  --overload-log FILE Write every mode change as CSV\n"
+            << "\nMulti-Day Batch Options:\n"
+            << "  --catalog FILE      Take PCAP files from a capture catalog (xdp_catalog)\n"
+            << "  --dates FROM[:TO]   Catalog dates to run, YYYY-MM-DD (default: all)\n"
+            << "  --venue MIC         Catalog venue to run, e.g. xnys (default: all)\n"
+            << "  --batch DIR         Run each trading date as its own job; per-day results,\n"
+            << "                      summary.csv and a cross-day summary in DIR\n"
+            << "  --batch-jobs N      Days run at once (default: --threads or all cores)\n"
+            << "\nSharded Run Options:\n"
+            << "  --plan FILE         Write a shard manifest for the selected captures and exit\n"
+            << "  --plan-by KIND      symbols (date x symbol partition, default) or channels\n"
+            << "                      (date x UDP channel; needs --catalog)\n"
+            << "  --partitions N      Symbol partitions per date (default: 1)\n"
+            << "  --shard K           With --plan FILE: run shard K and write its partial result\n"
+            << "  --partial FILE      Partial result file (default: <plan>.<K>.part)\n"
+            << "  merge [--plan FILE] [-o DIR] [PART...]\n"
+            << "                      Combine partial results (all of the plan's by default)\n\n"
             << "Examples:\n"
             << "  " << program << "                           # full day using default data dir\n"
             << "  " << program << " --data-dir path/to/pcaps  # full day from custom dir\n"
-            << "  " << program << " file1.pcap file2.pcap     # specific files\n";
+            << "  " << program << " file1.pcap file2.pcap     # specific files\n"
+            << "  " << program << " --catalog captures.csv --dates 2023-08-01:2023-08-31 --batch aug\n"
+            << "  " << program << " --catalog captures.csv --plan aug.plan --partitions 4\n"
+            << "  " << program << " --plan aug.plan --shard 3          # on any node\n"
+            << "  " << program << " merge --plan aug.plan -o aug\n";
 }
 
 // =============================================================================
@@ -505,67 +1373,6 @@ void print_usage(const char *program) {
 // Groups files by time window, spawns process per group, aggregates results
 // =============================================================================
 
-// Shared memory structure for inter-process result aggregation
-struct ProcessResults {
-  double baseline_pnl;
-  double toxicity_pnl;
-  double adverse_pnl;
-  double baseline_adverse_pnl;  // For hypothesis testing H2
-  double baseline_inv_variance; // For hypothesis testing H3
-  double toxicity_inv_variance; // For hypothesis testing H3
-  int64_t baseline_fills;
-  int64_t toxicity_fills;
-  int64_t quotes_suppressed;
-  int64_t adverse_fills;
-  int64_t baseline_adverse_fills;  // For hypothesis testing H2
-  uint64_t packets_processed;
-  uint64_t messages_processed;
-  uint64_t symbols_active;
-  // Unwind stats
-  int64_t baseline_unwind_crosses;
-  int64_t toxicity_unwind_crosses;
-  double baseline_unwind_cost;
-  double toxicity_unwind_cost;
-  // PnL decomposition
-  double toxicity_realized_pnl;
-  double toxicity_unrealized_pnl;
-  double baseline_realized_pnl;
-  double baseline_unrealized_pnl;
-  // Symbol-level diagnostics
-  int64_t symbols_eod_liquidated;
-  int64_t symbols_blacklisted;
-  int64_t symbols_one_sided;         // Only buys or only sells
-  int64_t symbols_with_fills;
-  int64_t toxicity_buy_fills;
-  int64_t toxicity_sell_fills;
-  int64_t baseline_buy_fills;
-  int64_t baseline_sell_fills;
-  double avg_final_abs_inventory;
-  // Fill pipeline diagnostics (toxicity strategy)
-  uint64_t diag_exec_total;
-  uint64_t diag_exec_no_order_info;
-  uint64_t diag_exec_not_eligible;
-  uint64_t diag_try_fill_calls;
-  uint64_t diag_rejected_halted;
-  uint64_t diag_rejected_not_live;
-  uint64_t diag_rejected_latency;
-  uint64_t diag_rejected_price;
-  uint64_t diag_rejected_queue;
-  uint64_t diag_fill_succeeded;
-  uint64_t diag_quote_resets;
-  bool completed;
-  char padding[7];  // Align to 8 bytes
-};
-
-// Get file size in bytes
-size_t get_file_size(const std::string& path) {
-  struct stat st;
-  if (stat(path.c_str(), &st) == 0) {
-    return static_cast<size_t>(st.st_size);
-  }
-  return 0;
-}
-
 // Group files by total size for balanced load distribution
 // Uses greedy algorithm: assign each file to the group with smallest total size
 std::vector<std::vector<std::string>> group_files(
@@ -616,11 +1423,37 @@ void process_file_group(const std::vector<std::string>& files,
   // Debug: confirm child started
   std::cerr << "[Group " << (group_idx+1) << "] Starting with " << files.size() << " files\n" << std::flush;
 
-  // Re-initialize symbol storage in child process
+  // Re-initialize symbol storage in child process (batch jobs inherit the
+  // parent's symbol map)
   init_symbol_storage();
-  if (!xdp::load_symbol_map(symbol_file)) {
+  if (xdp::get_global_symbol_map().empty() && !xdp::load_symbol_map(symbol_file)) {
     std::cerr << "[Group " << (group_idx+1) << "] WARNING: Failed to load symbol map\n";
   }
+  init_symbol_filter();
+  init_latency_tiers();
+  init_baskets();
+  std::string plugin_err;
+  if (!init_strategy_plugin(plugin_err)) {
+    std::cerr << "[Group " << (group_idx+1) << "] Error: --strategy-plugin: " << plugin_err << "\n";
+    _exit(1);
+  }
+  if (!g_latency_path.empty()) {
+    std::string part = g_latency_path + ".g" + std::to_string(group_idx + 1);
+    if (!open_latency_trace(part, group_idx + 1)) {
+      std::cerr << "[Group " << (group_idx+1) << "] Failed to open latency file: " << part << "\n";
+      g_latency_path.clear();
+    }
+  }
+
+  // Decision logs from this group are named <ticker>.g<N>.mmlog
+  g_config.decision_log_group = static_cast<uint32_t>(group_idx + 1);
+
+  if (g_live.is_open()) {
+    uint64_t group_bytes = 0;
+    for (const auto& f : files) group_bytes += get_file_size(f);
+    g_live_group = static_cast<uint32_t>(group_idx);
+    live_attach_worker(static_cast<uint32_t>(group_idx), files.size(), group_bytes);
+  }
 
   // Reset counters for this process
   g_total_packets.store(0);
@@ -639,7 +1472,9 @@ void process_file_group(const std::vector<std::string>& files,
     reader.preload();
 
     uint64_t pkts_before = g_total_packets.load();
+    live_begin_file(reader);
     reader.process_all(process_packet_callback);
+    live_end_file(reader);
     uint64_t pkts_in_file = g_total_packets.load() - pkts_before;
 
     // Progress every 10 files or at the end
@@ -649,6 +1484,22 @@ void process_file_group(const std::vector<std::string>& files,
     }
   }
 
+  finish_pipelines();
+  if (!g_latency_path.empty()) close_latency_trace();
+  if (g_config.overload.enabled()) {
+    report_overload(g_overload_log.empty() ? "" : g_overload_log + ".g" + std::to_string(group_idx + 1),
+                    "g" + std::to_string(group_idx + 1) + ".");
+  }
+  if (g_baskets) {
+    std::cerr << "[Group " << (group_idx+1) << "] Baskets at end of group:";
+    print_basket_summary(std::cerr, *g_baskets);
+  }
+
+  // Children leave via _exit(), so decision logs and the plugin must be
+  // closed explicitly
+  close_decision_logs();
+  close_strategy_plugin("[Group " + std::to_string(group_idx + 1) + "] ");
+
   // Aggregate results from this process
   double baseline_pnl = 0.0, toxicity_pnl = 0.0, adverse_pnl = 0.0, baseline_adverse_pnl = 0.0;
   double tox_realized = 0.0, tox_unrealized = 0.0;
@@ -661,6 +1512,8 @@ void process_file_group(const std::vector<std::string>& files,
   double baseline_unwind_cost = 0.0, toxicity_unwind_cost = 0.0;
   int64_t n_eod_liquidated = 0, n_blacklisted = 0, n_one_sided = 0, n_with_fills = 0;
   double total_abs_final_inv = 0.0;
+  InventoryMoments base_inventory, tox_inventory;
+  FillTimeBins base_fill_bins, tox_fill_bins;
 
   // For worst-symbol dump
   struct SymDiag {
@@ -723,6 +1576,13 @@ void process_file_group(const std::vector<std::string>& files,
                          ts.buy_fills, ts.sell_fills, ts.unwind_crosses,
                          ts.unwind_cost, tox_inv, sim->eod_liquidated, sim->blacklisted});
 
+    base_inventory.merge(sim->baseline_risk.inv_count, sim->baseline_risk.inv_mean,
+                         sim->baseline_risk.inv_m2);
+    tox_inventory.merge(sim->toxicity_risk.inv_count, sim->toxicity_risk.inv_mean,
+                        sim->toxicity_risk.inv_m2);
+    base_fill_bins.merge(sim->baseline_risk.fill_bins);
+    tox_fill_bins.merge(sim->toxicity_risk.fill_bins);
+
     // Aggregate inventory variance (weighted sum by sample count)
     if (sim->baseline_risk.inv_count > 1 && sim->toxicity_risk.inv_count > 1) {
       baseline_inv_variance_sum += sim->baseline_risk.get_inventory_variance();
@@ -944,12 +1804,44 @@ void process_file_group(const std::vector<std::string>& files,
   results->diag_rejected_queue = diag_agg.rejected_queue;
   results->diag_fill_succeeded = diag_agg.fill_succeeded;
   results->diag_quote_resets = diag_agg.quote_resets;
+  results->inv_variance_symbols = symbols_with_inv_data;
+  results->baseline_inventory = base_inventory;
+  results->toxicity_inventory = tox_inventory;
+  results->baseline_fill_bins = base_fill_bins;
+  results->toxicity_fill_bins = tox_fill_bins;
+  results->markout_horizons = g_config.markout_horizons;
+  results->markouts = collect_markouts();
   results->completed = true;
+  if (t_live.slot) {
+    t_live.slot->state.store(static_cast<uint32_t>(LiveSlotState::DONE), std::memory_order_relaxed);
+  }
 
   std::cerr << "[Group " << (group_idx+1) << "] Results written to shared memory\n" << std::flush;
 
+  // Per-symbol cost: partial profile for the parent to merge, or a table
+  if (g_config.cost_sample_interval) {
+    CostProfile profile = collect_cost_profile();
+    if (!g_config.cost_profile_path.empty()) {
+      std::string part = g_config.cost_profile_path + ".g" + std::to_string(group_idx + 1);
+      if (!write_cost_profile(part, profile)) {
+        std::cerr << "[Group " << (group_idx+1) << "] Failed to write cost profile: " << part << "\n";
+      }
+    } else {
+      std::cerr << "[Group " << (group_idx+1) << "]";
+      print_cost_table(std::cerr, std::move(profile));
+      std::cerr << std::flush;
+    }
+  }
+
   // Write per-fill and per-symbol CSV output if output directory specified
   if (!g_config.output_dir.empty()) {
+    if (g_config.markout_horizons.count > 0) {
+      std::string mo_path = g_config.output_dir + "/markouts_group_" + std::to_string(group_idx + 1) + ".csv";
+      if (write_markout_fills(mo_path, group_idx + 1)) {
+        std::cerr << "[Group " << (group_idx+1) << "] Wrote markout CSV: " << mo_path << "\n" << std::flush;
+      }
+    }
+
     // Per-fill CSV: toxicity score at fill time + realized adverse movement
     {
       std::string fill_path = g_config.output_dir + "/fills_group_" + std::to_string(group_idx + 1) + ".csv";
@@ -982,8 +1874,7 @@ void process_file_group(const std::vector<std::string>& files,
             // Walk-forward window assignment
             int wf_win = -1;
             if (g_config.walk_forward && sim->wf_initialized && sim->wf_window_duration_ns > 0) {
-              uint64_t fill_elapsed = fill.fill_time_ns - sim->wf_window_start_ns;
-              wf_win = static_cast<int>(fill_elapsed / sim->wf_window_duration_ns);
+              wf_win = g_config.calendar.bin_index(fill.fill_time_ns, sim->wf_window_duration_ns);
             }
             fout << ',' << wf_win << '\n';
           };
@@ -1073,16 +1964,498 @@ void process_file_group(const std::vector<std::string>& files,
   }
 }
 
+// =============================================================================
+// MULTI-DAY BATCH (--batch)
+// One job per trading date, run in a forked process exactly like a hybrid
+// group over that day's files. Jobs inherit the parsed configuration, loaded
+// libraries and the symbol map from the parent, so each only builds its own
+// per-symbol state; days start largest first so the pool drains evenly.
+// =============================================================================
+
+// Per-day table and cross-day aggregate of a --batch run or merged shards;
+// with out_dir, also summary.csv (one row per day plus the total) and
+// total.result. Days whose results are not `completed` are listed as failed.
+void report_days(const std::map<int32_t, ProcessResults>& days, const std::string& out_dir) {
+  std::ofstream csv;
+  if (!out_dir.empty()) {
+    csv.open(out_dir + "/summary.csv");
+    csv << "date,messages,baseline_pnl,toxicity_pnl,improvement,baseline_fills,toxicity_fills,"
+        << "adverse_fills,quotes_suppressed,baseline_inv_variance,toxicity_inv_variance\n";
+  }
+  auto csv_row = [&csv](const std::string& label, const ProcessResults& r) {
+    if (!csv.is_open()) return;
+    csv << label << ',' << r.messages_processed << ',' << std::fixed << std::setprecision(4)
+        << r.baseline_pnl << ',' << r.toxicity_pnl << ',' << (r.toxicity_pnl - r.baseline_pnl)
+        << ',' << r.baseline_fills << ',' << r.toxicity_fills << ',' << r.adverse_fills << ','
+        << r.quotes_suppressed << ',' << r.baseline_inv_variance << ','
+        << r.toxicity_inv_variance << '\n';
+  };
+
+  std::cout << "\n=== RESULTS BY DAY ===\n"
+            << std::left << std::setw(12) << "Date" << std::right << std::setw(12) << "Messages"
+            << std::setw(14) << "Baseline $" << std::setw(14) << "Toxicity $" << std::setw(14)
+            << "Improvement" << std::setw(11) << "Base fills" << std::setw(10) << "Tox fills"
+            << "\n";
+  ProcessResults total{};
+  std::vector<double> daily_improvement;
+  for (const auto& [date, r] : days) {
+    const std::string day = xdp::SessionCalendar::format_date(date);
+    if (!r.completed) {
+      std::cout << std::left << std::setw(12) << day << std::right << std::setw(12) << "FAILED\n";
+      continue;
+    }
+    merge_results(total, r);
+    daily_improvement.push_back(r.toxicity_pnl - r.baseline_pnl);
+    csv_row(day, r);
+    std::cout << std::left << std::setw(12) << day << std::right << std::setw(12)
+              << r.messages_processed << std::fixed << std::setprecision(2) << std::setw(14)
+              << r.baseline_pnl << std::setw(14) << r.toxicity_pnl << std::setw(14)
+              << daily_improvement.back() << std::setw(11) << r.baseline_fills << std::setw(10)
+              << r.toxicity_fills << '\n';
+  }
+  const double n = static_cast<double>(daily_improvement.size());
+  if (!daily_improvement.empty()) csv_row("total", total);
+  csv.close();
+  if (!out_dir.empty() && !daily_improvement.empty() &&
+      !write_results(out_dir + "/total.result", total, "# total of " +
+                     std::to_string(daily_improvement.size()) + " days\n")) {
+    std::cerr << "Failed to write " << out_dir << "/total.result\n";
+  }
+
+  double mean = 0.0, var = 0.0;
+  for (double d : daily_improvement) mean += d;
+  if (n > 0) mean /= n;
+  for (double d : daily_improvement) var += (d - mean) * (d - mean);
+  const double sd = n > 1 ? std::sqrt(var / (n - 1)) : 0.0;
+  const size_t days_improved = static_cast<size_t>(std::count_if(
+      daily_improvement.begin(), daily_improvement.end(), [](double d) { return d > 0; }));
+  const double improvement = total.toxicity_pnl - total.baseline_pnl;
+
+  std::cout << "\n=== CROSS-DAY AGGREGATE ===\n";
+  std::cout << "Days completed: " << daily_improvement.size() << "/" << days.size() << '\n';
+  std::cout << "Baseline Total PnL: $" << std::fixed << std::setprecision(2) << total.baseline_pnl << '\n';
+  std::cout << "Toxicity Total PnL: $" << total.toxicity_pnl << '\n';
+  std::cout << "PnL Improvement: $" << improvement << " ("
+            << (total.baseline_pnl != 0.0 ? improvement / std::abs(total.baseline_pnl) * 100.0 : 0.0)
+            << "%)\n";
+  std::cout << "Daily improvement: mean $" << mean << ", std $" << sd << ", t-stat "
+            << (sd > 0 ? mean / (sd / std::sqrt(n)) : 0.0) << '\n';
+  std::cout << "Days improved: " << days_improved << "/" << daily_improvement.size() << '\n';
+  std::cout << "Baseline fills: " << total.baseline_fills << '\n';
+  std::cout << "Toxicity fills: " << total.toxicity_fills << " (buy: " << total.toxicity_buy_fills
+            << ", sell: " << total.toxicity_sell_fills << ")\n";
+  std::cout << "Adverse fills: " << total.adverse_fills << '\n';
+  std::cout << "Average Baseline Inventory Variance: " << total.baseline_inv_variance << '\n';
+  std::cout << "Average Toxicity Inventory Variance: " << total.toxicity_inv_variance << '\n';
+  std::cout << "Pooled inventory std (shares): baseline " << std::sqrt(total.baseline_inventory.variance())
+            << ", toxicity " << std::sqrt(total.toxicity_inventory.variance()) << '\n';
+
+  if (total.baseline_fills > 0 || total.toxicity_fills > 0) {
+    std::cout << "\n=== FILLS BY HALF HOUR ===\n"
+              << std::left << std::setw(8) << "From" << std::right << std::setw(12) << "Base fills"
+              << std::setw(13) << "Base shares" << std::setw(11) << "Tox fills" << std::setw(12)
+              << "Tox shares" << '\n';
+    for (int b = 0; b < FillTimeBins::COUNT; ++b) {
+      const int minute = 9 * 60 + 30 + b * 30;
+      char label[8];
+      std::snprintf(label, sizeof(label), "%02d:%02d", minute / 60, minute % 60);
+      std::cout << std::left << std::setw(8) << label << std::right << std::setw(12)
+                << total.baseline_fill_bins.fills[b] << std::setw(13)
+                << total.baseline_fill_bins.shares[b] << std::setw(11)
+                << total.toxicity_fill_bins.fills[b] << std::setw(12)
+                << total.toxicity_fill_bins.shares[b] << '\n';
+    }
+  }
+  if (total.markout_horizons.count > 0) {
+    print_markout_table(std::cout, total.markouts, total.markout_horizons);
+  }
+}
+
+int run_batch(const std::map<int32_t, std::vector<std::string>>& days,
+              const std::string& symbol_file, size_t max_jobs,
+              std::chrono::high_resolution_clock::time_point start_time) {
+  namespace fs = std::filesystem;
+  struct BatchDay {
+    int32_t date;
+    const std::vector<std::string>* files;
+    uint64_t bytes;
+  };
+  std::vector<BatchDay> order;
+  for (const auto& [date, files] : days) {
+    uint64_t bytes = 0;
+    for (const auto& f : files) bytes += get_file_size(f);
+    order.push_back({date, &files, bytes});
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [](const BatchDay& a, const BatchDay& b) { return a.bytes > b.bytes; });
+  const size_t num_days = order.size();
+  max_jobs = std::max<size_t>(1, std::min(max_jobs, num_days));
+
+  std::error_code ec;
+  fs::create_directories(g_batch_dir, ec);
+  if (ec) {
+    std::cerr << "Error: cannot create batch directory " << g_batch_dir << ": " << ec.message() << "\n";
+    return 1;
+  }
+
+  // Loaded once here and inherited by every job
+  if (!xdp::load_symbol_map(symbol_file)) {
+    std::cerr << "WARNING: Failed to load symbol map " << symbol_file << "\n";
+  }
+
+  size_t shm_size = sizeof(ProcessResults) * num_days;
+  ProcessResults* results = static_cast<ProcessResults*>(
+      mmap(nullptr, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  if (results == MAP_FAILED) {
+    std::cerr << "Failed to allocate shared memory\n";
+    return 1;
+  }
+  std::uninitialized_value_construct_n(results, num_days);
+
+  std::cout << "=== HFT Market Maker Simulation (BATCH) ===\n";
+  std::cout << "Trading days: " << num_days << '\n';
+  std::cout << "Concurrent jobs: " << max_jobs << '\n';
+  std::cout << "Results dir: " << g_batch_dir << '\n' << std::flush;
+
+  std::map<pid_t, size_t> running;
+  size_t next = 0, completed = 0, failed = 0;
+  while (next < num_days || !running.empty()) {
+    while (next < num_days && running.size() < max_jobs) {
+      const size_t j = next++;
+      const std::string day = xdp::SessionCalendar::format_date(order[j].date);
+      pid_t pid = fork();
+      if (pid < 0) {
+        std::cerr << "Fork failed for " << day << "\n";
+        failed++;
+        continue;
+      }
+      if (pid == 0) {
+        // Optional per-fill/per-symbol outputs and decision logs go in a
+        // subdirectory per day
+        for (std::string* dir : {&g_config.output_dir, &g_config.decision_log_dir}) {
+          if (dir->empty()) continue;
+          *dir += "/" + day;
+          std::error_code dir_ec;
+          fs::create_directories(*dir, dir_ec);
+        }
+        process_file_group(*order[j].files, &results[j], symbol_file, j);
+        _exit(0);
+      }
+      running[pid] = j;
+      std::cerr << "[Batch] " << day << " started as group " << (j + 1) << ": "
+                << order[j].files->size() << " files, " << std::fixed << std::setprecision(1)
+                << order[j].bytes / 1e6 << " MB\n" << std::flush;
+      std::cerr.unsetf(std::ios::floatfield);
+    }
+    if (running.empty()) break;
+
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      if (errno == EINTR) continue;
+      std::cerr << "waitpid failed: " << strerror(errno) << "\n";
+      break;
+    }
+    auto it = running.find(pid);
+    if (it == running.end()) continue;
+    const size_t j = it->second;
+    running.erase(it);
+
+    const std::string day = xdp::SessionCalendar::format_date(order[j].date);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !results[j].completed) {
+      std::cerr << "[Batch] " << day << " failed";
+      if (WIFSIGNALED(status)) std::cerr << " (signal " << WTERMSIG(status) << ")";
+      else if (WIFEXITED(status)) std::cerr << " (exit code " << WEXITSTATUS(status) << ")";
+      std::cerr << "\n";
+      results[j].completed = false;
+      failed++;
+      continue;
+    }
+    completed++;
+    const std::string path = g_batch_dir + "/" + day + ".result";
+    const std::string header = "# date " + day + "\n# files " +
+                               std::to_string(order[j].files->size()) + "\n";
+    if (!write_results(path, results[j], header)) {
+      std::cerr << "Failed to write " << path << "\n";
+    }
+    std::cerr << "[Batch] " << day << " done (" << completed + failed << "/" << num_days << ")\n"
+              << std::flush;
+  }
+
+  std::map<int32_t, ProcessResults> by_date;
+  uint64_t total_messages = 0;
+  for (size_t j = 0; j < num_days; ++j) {
+    by_date[order[j].date] = results[j];
+    if (results[j].completed) total_messages += results[j].messages_processed;
+  }
+  report_days(by_date, g_batch_dir);
+
+  auto end_time = std::chrono::high_resolution_clock::now();
+  double seconds = std::chrono::duration<double>(end_time - start_time).count();
+  std::cout << "\nTotal processing time: " << std::setprecision(2) << seconds << " seconds ("
+            << total_messages << " messages)\n";
+  std::cout << "Per-day results: " << g_batch_dir << "/<date>.result, summary: " << g_batch_dir
+            << "/summary.csv\n";
+
+  munmap(results, shm_size);
+  return failed ? 1 : 0;
+}
+
+// =============================================================================
+// SHARDED RUNS (--plan, --shard, merge)
+// A plan (shard_plan.hpp) cuts the selected captures into shards that share
+// no state: a date times a symbol partition or a UDP channel. Each shard runs
+// in its own process, possibly on another node, like one batch day with a
+// symbol or channel filter, and saves a partial result. merge combines the
+// partials in shard order, so the totals do not depend on when or where the
+// shards ran.
+// =============================================================================
+
+// Whether an option can change results. File selection, parallelism and
+// shard options cannot, so they are left out of the "# args" a plan and its
+// shards are compared by.
+bool is_simulation_option(const std::string& arg) {
+  static const std::set<std::string> other = {
+      "--data-dir", "--threads", "--sequential", "--no-hybrid", "--mmap",
+      "--catalog",  "--dates",   "--venue",      "--batch",     "--batch-jobs",
+      "--plan",     "--plan-by", "--partitions", "--shard",     "--partial",
+      "--live-stats", "--live-stats-name", "-h", "--help"};
+  return arg[0] == '-' && !other.count(arg);
+}
+
+// Runs shard `spec` of the plan in this process and writes its partial
+int run_shard(const ShardSpec& spec, size_t num_shards, const std::string& args,
+              const std::string& partial_path, const std::string& symbol_file,
+              std::chrono::high_resolution_clock::time_point start_time) {
+  namespace fs = std::filesystem;
+  const std::string name = "shard" + std::to_string(spec.id);
+  std::cout << "=== HFT Market Maker Simulation (SHARD " << spec.id << "/" << num_shards
+            << ") ===\n";
+  std::cout << "Shard: " << ShardPlan::describe(spec) << ", " << spec.files.size() << " files\n" << std::flush;
+
+  // Per-fill/per-symbol outputs go in a subdirectory per shard; decision
+  // logs are already named by group (.g<K>)
+  if (!g_config.output_dir.empty()) {
+    g_config.output_dir += "/" + name;
+    std::error_code ec;
+    fs::create_directories(g_config.output_dir, ec);
+  }
+
+  ProcessResults results{};
+  process_file_group(spec.files, &results, symbol_file, spec.id - 1);
+  // Every symbol partition reads the whole capture; only the first one
+  // reports its packets so merged totals count each packet once
+  if (spec.partition != 0) results.packets_processed = 0;
+
+  if (!write_partial(partial_path, spec, num_shards, args, results)) {
+    std::cerr << "Error: cannot write partial result " << partial_path << "\n";
+    return 1;
+  }
+  const double seconds = std::chrono::duration<double>(
+      std::chrono::high_resolution_clock::now() - start_time).count();
+  std::cout << "Messages: " << results.messages_processed << '\n'
+            << "Baseline PnL: $" << std::fixed << std::setprecision(2) << results.baseline_pnl
+            << ", Toxicity PnL: $" << results.toxicity_pnl << '\n'
+            << "Fills: baseline " << results.baseline_fills << ", toxicity "
+            << results.toxicity_fills << '\n'
+            << "Processing time: " << seconds << " seconds\n"
+            << "Partial result: " << partial_path << '\n';
+  return 0;
+}
+
+void print_merge_usage(const char* program) {
+  std::cerr << "Usage: " << program << " merge [--plan FILE] [-o DIR] [PART...]\n\n"
+            << "Combines shard partial results into per-day and cross-day totals.\n\n"
+            << "  --plan FILE   Check the partials against this plan; with no PART\n"
+            << "                arguments, read every shard's default partial\n"
+            << "                (<plan>.<K>.part). Without it every shard of the\n"
+            << "                run must be given\n"
+            << "  -o DIR        Also write <date>.result, summary.csv and total.result\n";
+}
+
+// `market_maker_sim merge`: partials are combined per date in shard order.
+// Days with a shard missing from the plan are reported as failed; without
+// --plan, an incomplete or duplicated set of partials is refused.
+int run_merge(int argc, char* argv[]) {
+  std::string plan_path, out_dir;
+  std::vector<std::string> parts;
+  for (int i = 2; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--plan" && i + 1 < argc) {
+      plan_path = argv[++i];
+    } else if (arg == "-o" && i + 1 < argc) {
+      out_dir = argv[++i];
+    } else if (arg == "-h" || arg == "--help") {
+      print_merge_usage(argv[0]);
+      return 0;
+    } else if (arg[0] != '-') {
+      parts.push_back(arg);
+    } else {
+      std::cerr << "Error: unknown merge option " << arg << "\n";
+      return 1;
+    }
+  }
+
+  ShardPlan plan;
+  std::string err;
+  if (!plan_path.empty() && !ShardPlan::load(plan_path, plan, err)) {
+    std::cerr << "Error: --plan: " << err << "\n";
+    return 1;
+  }
+  if (parts.empty()) {
+    if (plan_path.empty()) {
+      print_merge_usage(argv[0]);
+      return 1;
+    }
+    for (const auto& s : plan.shards) parts.push_back(ShardPlan::partial_path(plan_path, s.id));
+  }
+
+  struct Partial {
+    ShardSpec spec;
+    size_t num_shards = 0;
+    std::string args;
+    std::string path;
+    ProcessResults results;
+  };
+  std::map<uint32_t, Partial> by_shard;
+  size_t unreadable = 0;
+  for (const auto& path : parts) {
+    Partial p;
+    p.path = path;
+    if (!read_partial(path, p.spec, p.num_shards, p.args, p.results, err)) {
+      std::cerr << "Warning: skipping " << err << "\n";
+      unreadable++;
+      continue;
+    }
+    if (!by_shard.emplace(p.spec.id, p).second) {
+      std::cerr << "Error: shard " << p.spec.id << " in both " << by_shard[p.spec.id].path
+                << " and " << path << "\n";
+      return 1;
+    }
+  }
+  if (by_shard.empty()) {
+    std::cerr << "Error: no partial results to merge\n";
+    return 1;
+  }
+
+  // Every partial must come from the same plan: the plan's size, or with no
+  // --plan the size the first partial records
+  const size_t num_shards =
+      plan_path.empty() ? by_shard.begin()->second.num_shards : plan.shards.size();
+  if (num_shards == 0) {
+    std::cerr << "Error: " << by_shard.begin()->second.path
+              << " does not record its shard count; merge it with --plan\n";
+    return 1;
+  }
+  for (const auto& [id, p] : by_shard) {
+    if (id > num_shards || (p.num_shards != 0 && p.num_shards != num_shards) ||
+        (p.num_shards == 0 && plan_path.empty())) {
+      std::cerr << "Error: " << p.path << " is shard " << id << "/" << p.num_shards
+                << ", not one of " << num_shards << " shards\n";
+      return 1;
+    }
+  }
+  if (plan_path.empty()) {
+    // Without the plan a missing shard would silently drop part of a day
+    // from the totals, so the set must be complete
+    std::set<std::tuple<int32_t, uint32_t, uint16_t>> specs;
+    for (const auto& [id, p] : by_shard) {
+      if (!specs.emplace(p.spec.date, p.spec.partition, p.spec.channel).second) {
+        std::cerr << "Error: " << p.path << " duplicates " << ShardPlan::describe(p.spec) << "\n";
+        return 1;
+      }
+    }
+    if (by_shard.size() < num_shards) {
+      for (uint32_t id = 1; id <= num_shards; id++) {
+        if (!by_shard.count(id)) std::cerr << "Missing shard " << id << "\n";
+      }
+      std::cerr << "Error: " << by_shard.size() << " of " << num_shards
+                << " partial results; pass --plan to merge the complete days\n";
+      return 1;
+    }
+  }
+
+  const std::string& args = plan_path.empty() ? by_shard.begin()->second.args : plan.args;
+  std::map<int32_t, ProcessResults> days;
+  std::map<int32_t, bool> day_complete;
+  std::map<int32_t, size_t> day_shards;
+  for (const auto& [id, p] : by_shard) {
+    if (p.args != args) {
+      std::cerr << "Warning: shard " << id << " ran with different options: " << p.args << "\n";
+    }
+    if (!plan_path.empty()) {
+      if (id > plan.shards.size() || plan.shards[id - 1].date != p.spec.date ||
+          plan.shards[id - 1].partition != p.spec.partition ||
+          plan.shards[id - 1].channel != p.spec.channel) {
+        std::cerr << "Error: " << p.path << " is not shard " << id << " of " << plan_path << "\n";
+        return 1;
+      }
+    }
+    merge_results(days[p.spec.date], p.results);
+    day_complete.emplace(p.spec.date, true);
+    day_shards[p.spec.date]++;
+  }
+  size_t missing = 0;
+  for (const auto& s : plan.shards) {
+    if (by_shard.count(s.id)) continue;
+    std::cerr << "Missing shard " << s.id << " (" << ShardPlan::describe(s) << ")\n";
+    day_complete[s.date] = false;
+    days.emplace(s.date, ProcessResults{});
+    missing++;
+  }
+
+  namespace fs = std::filesystem;
+  if (!out_dir.empty()) {
+    std::error_code ec;
+    fs::create_directories(out_dir, ec);
+    if (ec) {
+      std::cerr << "Error: cannot create " << out_dir << ": " << ec.message() << "\n";
+      return 1;
+    }
+  }
+  for (auto& [date, r] : days) {
+    r.completed = day_complete[date];
+    if (out_dir.empty() || !r.completed) continue;
+    const std::string day = xdp::SessionCalendar::format_date(date);
+    const std::string path = out_dir + "/" + day + ".result";
+    const std::string header = "# date " + day + "\n# shards " +
+                               std::to_string(day_shards[date]) + "\n";
+    if (!write_results(path, r, header)) std::cerr << "Failed to write " << path << "\n";
+  }
+
+  std::cout << "=== HFT Market Maker Simulation (MERGE) ===\n";
+  std::cout << "Partial results: " << by_shard.size();
+  if (!plan_path.empty()) std::cout << "/" << plan.shards.size() << " shards of " << plan_path;
+  std::cout << '\n';
+  if (!args.empty()) std::cout << "Options: " << args << '\n';
+  report_days(days, out_dir);
+  if (!out_dir.empty()) {
+    std::cout << "\nPer-day results: " << out_dir << "/<date>.result, summary: " << out_dir
+              << "/summary.csv\n";
+  }
+  return missing || unreadable ? 1 : 0;
+}
+
 } // namespace
 
 int main(int argc, char *argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "merge") return run_merge(argc, argv);
+
   std::vector<std::string> pcap_files;
   std::string symbol_file = "data/symbol_nyse_parsed.csv";
   std::string data_dir;
+  xdp::SessionCalendar::Options session_opts;
+  int32_t dates_from = 0, dates_to = 0;  // --dates, YYYYMMDD
+  std::string venue;
+  std::string plan_by = "symbols";    // --plan-by
+  uint32_t plan_partitions = 1;       // --partitions
+  std::string partial_path;           // --partial
 
   // Parse arguments - collect PCAP files and options
+  std::string sim_args;  // Options that can change results, as given
   for (int i = 1; i < argc; i++) {
     const std::string arg = argv[i];
+    const int arg_begin = i;
     if (arg == "-t" && i + 1 < argc) {
       g_filter_ticker = argv[++i];
     } else if ((arg == "-s" || arg == "--symbols") && i + 1 < argc) {
@@ -1126,6 +2499,8 @@ int main(int argc, char *argv[]) {
       g_config.epsilon_min = std::stod(argv[++i]);
     } else if (arg == "--output-dir" && i + 1 < argc) {
       g_config.output_dir = argv[++i];
+    } else if (arg == "--decision-log" && i + 1 < argc) {
+      g_config.decision_log_dir = argv[++i];
     } else if (arg == "--filter-type" && i + 1 < argc) {
       const std::string ft = argv[++i];
       if (ft == "ewma") {
@@ -1160,13 +2535,110 @@ int main(int argc, char *argv[]) {
       g_config.walk_forward = true;
     } else if (arg == "--wf-window-minutes" && i + 1 < argc) {
       g_config.wf_window_minutes = std::stoi(argv[++i]);
+    } else if ((arg == "--from" || arg == "--to") && i + 1 < argc) {
+      auto& bound = arg == "--from" ? session_opts.from : session_opts.to;
+      std::string err;
+      if (!xdp::SessionCalendar::parse_bound(argv[++i], bound, err)) {
+        std::cerr << "Error: " << arg << ": " << err << "\n";
+        return 1;
+      }
+    } else if (arg == "--markouts") {
+      g_config.markout_horizons = MarkoutHorizons::defaults();
+    } else if (arg == "--markout-horizons" && i + 1 < argc) {
+      std::string err;
+      if (!MarkoutHorizons::parse(argv[++i], g_config.markout_horizons, err)) {
+        std::cerr << "Error: --markout-horizons: " << err << "\n";
+        return 1;
+      }
+    } else if (arg == "--eod-minutes" && i + 1 < argc) {
+      session_opts.eod_lead_sec = std::stoi(argv[++i]) * 60;
     } else if (arg == "--sequential") {
       g_use_parallel = false;
       g_use_hybrid = false;
     } else if (arg == "--no-hybrid") {
       g_use_hybrid = false;
+    } else if (arg == "--prefetch-distance" && i + 1 < argc) {
+      g_prefetch_distance = std::stoull(argv[++i]);
+    } else if (arg == "--pipeline-heavy" && i + 1 < argc) {
+      g_pipeline_heavy = std::stoull(argv[++i]);
+    } else if (arg == "--pipeline-profile" && i + 1 < argc) {
+      g_pipeline_profile = argv[++i];
     } else if (arg == "--data-dir" && i + 1 < argc) {
       data_dir = argv[++i];
+    } else if (arg == "--cost-sample" && i + 1 < argc) {
+      g_config.cost_sample_interval = static_cast<uint32_t>(std::stoul(argv[++i]));
+    } else if (arg == "--cost-profile" && i + 1 < argc) {
+      g_config.cost_profile_path = argv[++i];
+    } else if (arg == "--latency-hist" && i + 1 < argc) {
+      g_latency_path = argv[++i];
+    } else if (arg == "--latency-interval" && i + 1 < argc) {
+      g_latency_interval_s = std::stod(argv[++i]);
+    } else if (arg == "--latency-tiers" && i + 1 < argc) {
+      g_latency_tiers_path = argv[++i];
+    } else if (arg == "--replay-speed" && i + 1 < argc) {
+      g_config.overload.replay_speed = std::stod(argv[++i]);
+    } else if (arg == "--overload-lags" && i + 1 < argc) {
+      std::string err;
+      if (!OverloadConfig::parse_lags(argv[++i], g_config.overload, err)) {
+        std::cerr << "Error: --overload-lags: " << err << "\n";
+        return 1;
+      }
+    } else if (arg == "--overload-exit" && i + 1 < argc) {
+      g_config.overload.exit_ratio = std::stod(argv[++i]);
+    } else if (arg == "--overload-throttle" && i + 1 < argc) {
+      g_config.overload.throttle_factor = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+    } else if (arg == "--overload-log" && i + 1 < argc) {
+      g_overload_log = argv[++i];
+    } else if (arg == "--baskets" && i + 1 < argc) {
+      g_baskets_path = argv[++i];
+    } else if (arg == "--basket-skew" && i + 1 < argc) {
+      g_config.basket_skew = std::stod(argv[++i]);
+    } else if (arg == "--strategy-plugin" && i + 1 < argc) {
+      g_plugin_path = argv[++i];
+    } else if (arg == "--plugin-args" && i + 1 < argc) {
+      g_plugin_args = argv[++i];
+    } else if (arg == "--catalog" && i + 1 < argc) {
+      g_catalog_path = argv[++i];
+    } else if (arg == "--dates" && i + 1 < argc) {
+      const std::string range = argv[++i];
+      const size_t colon = range.find(':');
+      xdp::SessionCalendar::Bound from, to;
+      std::string err;
+      if (!xdp::SessionCalendar::parse_bound(range.substr(0, colon), from, err) ||
+          (colon != std::string::npos &&
+           !xdp::SessionCalendar::parse_bound(range.substr(colon + 1), to, err)) ||
+          from.date == 0 || from.sec >= 0 || to.sec >= 0 ||
+          (colon != std::string::npos && to.date == 0)) {
+        std::cerr << "Error: --dates: want YYYY-MM-DD[:YYYY-MM-DD], got '" << range << "'\n";
+        return 1;
+      }
+      dates_from = from.date;
+      dates_to = colon == std::string::npos ? from.date : to.date;
+    } else if (arg == "--venue" && i + 1 < argc) {
+      venue = argv[++i];
+    } else if (arg == "--batch" && i + 1 < argc) {
+      g_batch_dir = argv[++i];
+    } else if (arg == "--batch-jobs" && i + 1 < argc) {
+      g_batch_jobs = std::stoull(argv[++i]);
+    } else if (arg == "--plan" && i + 1 < argc) {
+      g_plan_path = argv[++i];
+    } else if (arg == "--plan-by" && i + 1 < argc) {
+      plan_by = argv[++i];
+      if (plan_by != "symbols" && plan_by != "channels") {
+        std::cerr << "Error: --plan-by: want symbols or channels, got '" << plan_by << "'\n";
+        return 1;
+      }
+    } else if (arg == "--partitions" && i + 1 < argc) {
+      plan_partitions = static_cast<uint32_t>(std::stoul(argv[++i]));
+    } else if (arg == "--shard" && i + 1 < argc) {
+      g_shard_id = static_cast<uint32_t>(std::stoul(argv[++i]));
+    } else if (arg == "--partial" && i + 1 < argc) {
+      partial_path = argv[++i];
+    } else if (arg == "--live-stats") {
+      g_live_stats = true;
+    } else if (arg == "--live-stats-name" && i + 1 < argc) {
+      g_live_stats = true;
+      g_live_stats_name = argv[++i];
     } else if (arg == "--mmap") {
       // mmap is now default, this flag is kept for compatibility
     } else if (arg == "-h" || arg == "--help") {
@@ -1176,6 +2648,173 @@ int main(int argc, char *argv[]) {
       // Assume it's a PCAP file
       pcap_files.push_back(arg);
     }
+    if (is_simulation_option(arg)) {
+      for (int j = arg_begin; j <= i; ++j) {
+        if (!sim_args.empty()) sim_args += ' ';
+        sim_args += argv[j];
+      }
+    }
+  }
+
+  if (!g_config.decision_log_dir.empty()) {
+    if (g_filter_ticker.empty()) {
+      std::cerr << "Error: --decision-log requires -t TICKER\n";
+      return 1;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(g_config.decision_log_dir, ec);
+    if (ec) {
+      std::cerr << "Error: cannot create decision log directory "
+                << g_config.decision_log_dir << ": " << ec.message() << "\n";
+      return 1;
+    }
+  }
+
+  if (!g_batch_dir.empty()) {
+    // Outputs that the hybrid parent merges from per-group parts
+    const char* unsupported = !g_latency_path.empty() ? "--latency-hist"
+                            : !g_config.cost_profile_path.empty() ? "--cost-profile"
+                            : g_live_stats ? "--live-stats"
+                            : !g_overload_log.empty() ? "--overload-log" : nullptr;
+    if (unsupported) {
+      std::cerr << "Error: " << unsupported << " is not supported with --batch\n";
+      return 1;
+    }
+  }
+
+  // Sharded runs: checks shared by --plan and --shard
+  if (!g_plan_path.empty() || g_shard_id) {
+    const char* unsupported = !g_latency_path.empty() ? "--latency-hist"
+                            : !g_config.cost_profile_path.empty() ? "--cost-profile"
+                            : g_live_stats ? "--live-stats"
+                            : !g_overload_log.empty() ? "--overload-log"
+                            : !g_batch_dir.empty() ? "--batch" : nullptr;
+    if (unsupported) {
+      std::cerr << "Error: " << unsupported << " is not supported with --plan/--shard\n";
+      return 1;
+    }
+    if (g_plan_path.empty()) {
+      std::cerr << "Error: --shard requires --plan FILE\n";
+      return 1;
+    }
+  }
+  if (plan_partitions == 0) {
+    std::cerr << "Error: --partitions must be at least 1\n";
+    return 1;
+  }
+  ShardPlan shard_plan;
+  if (g_shard_id) {
+    std::string err;
+    if (!ShardPlan::load(g_plan_path, shard_plan, err)) {
+      std::cerr << "Error: --plan: " << err << "\n";
+      return 1;
+    }
+    if (g_shard_id > shard_plan.shards.size()) {
+      std::cerr << "Error: --shard " << g_shard_id << ": " << g_plan_path << " has "
+                << shard_plan.shards.size() << " shards\n";
+      return 1;
+    }
+    if (!pcap_files.empty() || !data_dir.empty() || !g_catalog_path.empty()) {
+      std::cerr << "Error: a shard takes its PCAP files from the plan\n";
+      return 1;
+    }
+    if (sim_args != shard_plan.args) {
+      std::cerr << "WARNING: shard options differ from the plan's\n"
+                << "  plan:  " << shard_plan.args << "\n"
+                << "  shard: " << sim_args << "\n";
+    }
+    const ShardSpec& spec = shard_plan.shards[g_shard_id - 1];
+    pcap_files = spec.files;
+    g_shard_partition = spec.partition;
+    g_shard_partitions = spec.partitions;
+    g_shard_channel = spec.channel;
+    if (partial_path.empty()) partial_path = ShardPlan::partial_path(g_plan_path, g_shard_id);
+  }
+  // Basket NAVs need every constituent in the same process
+  if (!g_baskets_path.empty() && (plan_partitions > 1 || plan_by == "channels" ||
+                                  g_shard_partitions > 1 || g_shard_channel)) {
+    std::cerr << "Error: --baskets needs whole-day shards (--plan-by symbols --partitions 1)\n";
+    return 1;
+  }
+
+  if (g_pipeline_heavy > 0) {
+    if (g_pipeline_profile.empty()) {
+      std::cerr << "Error: --pipeline-heavy requires --pipeline-profile FILE "
+                << "(a profile written by --cost-profile)\n";
+      return 1;
+    }
+    CostProfile heavy;
+    std::string err;
+    if (!load_cost_profile(g_pipeline_profile, heavy, err)) {
+      std::cerr << "Error: --pipeline-profile: " << err << "\n";
+      return 1;
+    }
+    heavy.sort_by_cost();
+    for (const auto& e : heavy.entries) {
+      if (g_pipeline_tickers.size() >= g_pipeline_heavy) break;
+      if (!g_filter_ticker.empty() && e.ticker != g_filter_ticker) continue;
+      g_pipeline_tickers.push_back(e.ticker);
+    }
+  }
+
+  if (!g_config.cost_profile_path.empty() && g_config.cost_sample_interval == 0) {
+    g_config.cost_sample_interval = 64;
+  }
+  if (!g_latency_tiers_path.empty()) {
+    std::string err;
+    if (!load_cost_profile(g_latency_tiers_path, g_latency_tier_profile, err)) {
+      std::cerr << "Error: --latency-tiers: " << err << "\n";
+      return 1;
+    }
+  }
+  if (!g_baskets_path.empty()) {
+    std::string err;
+    if (!BasketFile::load(g_baskets_path, g_basket_file, err)) {
+      std::cerr << "Error: --baskets: " << err << "\n";
+      return 1;
+    }
+  }
+  if (!g_plugin_path.empty()) {
+    std::string err;
+    g_plugin = StrategyPlugin::load(g_plugin_path, err);
+    if (!g_plugin) {
+      std::cerr << "Error: --strategy-plugin: " << err << "\n";
+      return 1;
+    }
+  }
+  if (g_latency_interval_s <= 0.0) g_latency_interval_s = 10.0;
+  if (g_config.cost_sample_interval || !g_latency_path.empty()) {
+    g_cycles_per_ns = xdp::cycles_per_ns();
+  }
+
+  // Captures selected from the catalog, grouped by trading date for --batch
+  std::map<int32_t, std::vector<std::string>> batch_days;
+  xdp::CaptureCatalog catalog;
+  if (!g_catalog_path.empty()) {
+    if (!pcap_files.empty() || !data_dir.empty()) {
+      std::cerr << "Error: --catalog replaces PCAP file arguments and --data-dir\n";
+      return 1;
+    }
+    std::string err;
+    if (!xdp::CaptureCatalog::load(g_catalog_path, catalog, err)) {
+      std::cerr << "Error: --catalog: " << err << "\n";
+      return 1;
+    }
+    for (const auto& [date, captures] : catalog.by_date(dates_from, dates_to, venue)) {
+      for (const auto* c : captures) {
+        batch_days[date].push_back(c->path);
+        pcap_files.push_back(c->path);
+      }
+    }
+    if (pcap_files.empty()) {
+      std::cerr << "Error: no captures in " << g_catalog_path << " match --dates/--venue\n";
+      return 1;
+    }
+    std::cerr << "Catalog: " << pcap_files.size() << " PCAP files on " << batch_days.size()
+              << " dates from " << g_catalog_path << "\n";
+  } else if (dates_from || !venue.empty()) {
+    std::cerr << "Error: --dates and --venue select captures from a --catalog\n";
+    return 1;
   }
 
   // If no PCAP files given explicitly, scan data directory for *.pcap
@@ -1204,6 +2843,53 @@ int main(int argc, char *argv[]) {
   // Sort PCAP files by name to ensure chronological order
   std::sort(pcap_files.begin(), pcap_files.end());
 
+  std::vector<int32_t> capture_dates = build_session_calendar(pcap_files, session_opts);
+
+  // Without a catalog, a batch or plan groups the files by the date of their
+  // first packet
+  const bool planning = !g_plan_path.empty() && !g_shard_id;
+  if ((!g_batch_dir.empty() || planning) && batch_days.empty()) {
+    for (const auto& path : pcap_files) {
+      xdp::MmapPcapReader reader;
+      uint64_t ts = reader.open(path) ? reader.first_timestamp_ns() : 0;
+      if (ts) batch_days[xdp::SessionCalendar::local_date(ts)].push_back(path);
+    }
+  }
+
+  if (planning) {
+    if (plan_by == "channels" && g_catalog_path.empty()) {
+      std::cerr << "Error: --plan-by channels needs the channels of a --catalog\n";
+      return 1;
+    }
+    ShardPlan plan = plan_by == "channels"
+                         ? ShardPlan::by_channels(catalog.by_date(dates_from, dates_to, venue))
+                         : ShardPlan::by_symbols(batch_days, plan_partitions);
+    plan.args = sim_args;
+    std::string err;
+    if (plan.shards.empty()) {
+      std::cerr << "Error: no readable captures to plan\n";
+      return 1;
+    }
+    if (!plan.save(g_plan_path, err)) {
+      std::cerr << "Error: --plan: " << err << "\n";
+      return 1;
+    }
+    std::cout << "=== Shard Plan: " << g_plan_path << " ===\n";
+    for (const auto& s : plan.shards) {
+      uint64_t bytes = 0;
+      for (const auto& f : s.files) bytes += get_file_size(f);
+      std::cout << "  Shard " << std::setw(3) << s.id << ": " << std::left << std::setw(26)
+                << ShardPlan::describe(s) << std::right << std::setw(4) << s.files.size()
+                << " files " << std::fixed << std::setprecision(1) << std::setw(9) << bytes / 1e6
+                << " MB\n";
+    }
+    std::cout << "Shards: " << plan.shards.size() << " over " << batch_days.size() << " dates\n"
+              << "Run:    " << argv[0] << " --plan " << g_plan_path << " --shard K"
+              << (sim_args.empty() ? "" : " ") << sim_args << "\n"
+              << "Merge:  " << argv[0] << " merge --plan " << g_plan_path << " -o DIR\n";
+    return 0;
+  }
+
   // Determine number of processes/threads
   size_t num_procs = g_num_threads;
   if (num_procs == 0) {
@@ -1213,10 +2899,16 @@ int main(int argc, char *argv[]) {
 
   // Determine mode string
   std::string mode_str = "SEQUENTIAL";
-  if (g_use_hybrid && g_use_parallel && pcap_files.size() > 1) {
+  if (g_shard_id) {
+    mode_str = "SHARD";
+  } else if (!g_batch_dir.empty()) {
+    mode_str = "BATCH";
+  } else if (g_use_hybrid && g_use_parallel && pcap_files.size() > 1) {
     mode_str = "HYBRID MULTI-PROCESS";
   } else if (g_use_parallel && pcap_files.size() > 1) {
     mode_str = "THREADED";
+    // Pool threads share symbols, so only symbol state is prefetched
+    g_prefetch_orders = false;
   }
 
   // Log execution parameters for reproducibility
@@ -1260,17 +2952,109 @@ int main(int argc, char *argv[]) {
     std::cerr << "Walk-forward: enabled\n"
               << "  Window size: " << g_config.wf_window_minutes << " minutes\n";
   }
+  for (int32_t date : capture_dates) {
+    const xdp::TradingSession* sess = nullptr;
+    for (const auto& cs : g_config.calendar.sessions()) {
+      if (cs.date == date) sess = &cs;
+    }
+    if (!sess) continue;
+    std::cerr << "Session " << xdp::SessionCalendar::format_date(sess->date)
+              << (sess->utc_offset_s == -4 * 3600 ? " EDT" : " EST")
+              << ": open " << xdp::SessionCalendar::format_local(*sess, sess->open_auction_ns)
+              << ", close " << xdp::SessionCalendar::format_local(*sess, sess->close_auction_ns)
+              << (sess->early_close ? " (early)" : "")
+              << ", quoting " << xdp::SessionCalendar::format_local(*sess, sess->trade_start_ns)
+              << "-" << xdp::SessionCalendar::format_local(*sess, sess->trade_end_ns) << "\n";
+    if (!sess->trading_day) {
+      std::cerr << "WARNING: " << xdp::SessionCalendar::format_date(sess->date)
+                << " is not an NYSE trading day\n";
+    }
+  }
+  if (g_config.markout_horizons.count > 0) {
+    std::cerr << "Markout horizons:";
+    for (int h = 0; h < g_config.markout_horizons.count; ++h) {
+      std::cerr << ' ' << MarkoutHorizons::label(g_config.markout_horizons.ns[h]);
+    }
+    std::cerr << "\n";
+  }
   if (!g_filter_ticker.empty()) {
     std::cerr << "Ticker filter: " << g_filter_ticker << "\n";
   }
   if (!g_config.output_dir.empty()) {
     std::cerr << "Output dir: " << g_config.output_dir << "\n";
   }
+  if (g_config.cost_sample_interval) {
+    std::cerr << "Cost sampling: 1/" << g_config.cost_sample_interval << " messages per symbol ("
+              << std::fixed << std::setprecision(2) << g_cycles_per_ns << " cycles/ns)\n";
+    std::cerr.unsetf(std::ios::floatfield);
+    if (!g_config.cost_profile_path.empty()) {
+      std::cerr << "Cost profile: " << g_config.cost_profile_path << "\n";
+    }
+  }
+  if (!g_latency_path.empty()) {
+    std::cerr << "Latency histograms: " << g_latency_path << " (every "
+              << g_latency_interval_s << " s, " << std::fixed << std::setprecision(2)
+              << g_cycles_per_ns << " cycles/ns)\n";
+    std::cerr.unsetf(std::ios::floatfield);
+  }
+  if (g_config.overload.enabled()) {
+    const auto& lags = g_config.overload.enter_lag_ns;
+    std::cerr << "Paced replay: " << g_config.overload.replay_speed << "x, overload lags "
+              << lags[0] / 1000 << '/' << lags[1] / 1000 << '/' << lags[2] / 1000 << '/'
+              << lags[3] / 1000 << " us\n";
+  }
+  if (!g_baskets_path.empty()) {
+    std::cerr << "Baskets: " << g_basket_file.baskets.size() << " from " << g_baskets_path << " ("
+              << g_basket_file.num_components() << " constituent weights, skew "
+              << g_config.basket_skew << ")\n";
+  }
+  if (g_plugin) {
+    std::cerr << "Strategy plugin: " << g_plugin->name() << " from " << g_plugin_path
+              << " (quotes in place of the toxicity strategy"
+              << (g_plugin->wants_features() ? ", with features" : "")
+              << (g_plugin->reads_tops() ? ", reading other symbols' tops" : "") << ")\n";
+  }
+  if (!g_batch_dir.empty()) {
+    std::cerr << "Batch: " << batch_days.size() << " trading days, up to "
+              << (g_batch_jobs ? g_batch_jobs : num_procs) << " concurrent jobs, results in "
+              << g_batch_dir << "\n";
+  }
+  if (g_shard_id) {
+    std::cerr << "Shard: " << g_shard_id << "/" << shard_plan.shards.size() << " of "
+              << g_plan_path << " (" << ShardPlan::describe(shard_plan.shards[g_shard_id - 1])
+              << "), partial result " << partial_path << "\n";
+  }
+  if (!g_config.decision_log_dir.empty()) {
+    std::cerr << "Decision log dir: " << g_config.decision_log_dir << "\n";
+    if (mode_str == "THREADED") {
+      std::cerr << "WARNING: threaded mode processes files out of order; "
+                << "decision log timestamps will not be monotonic\n";
+    }
+  }
+  if (!g_pipeline_tickers.empty()) {
+    std::cerr << "Pipelined symbols:";
+    for (const auto& t : g_pipeline_tickers) std::cerr << ' ' << t;
+    std::cerr << " (from " << g_pipeline_profile << ")\n";
+  }
+  std::cerr << "Prefetch distance: " << g_prefetch_distance
+            << (g_prefetch_distance && !g_prefetch_orders ? " (symbol state only)" : "") << "\n";
   std::cerr << "Processes: " << num_procs << "\n"
             << "============================\n" << std::flush;
 
   auto start_time = std::chrono::high_resolution_clock::now();
 
+  if (!g_batch_dir.empty()) {
+    if (batch_days.empty()) {
+      std::cerr << "Error: no readable captures to batch\n";
+      return 1;
+    }
+    return run_batch(batch_days, symbol_file, g_batch_jobs ? g_batch_jobs : num_procs, start_time);
+  }
+  if (g_shard_id) {
+    return run_shard(shard_plan.shards[g_shard_id - 1], shard_plan.shards.size(), sim_args,
+                     partial_path, symbol_file, start_time);
+  }
+
   // ==========================================================================
   // HYBRID MULTI-PROCESS MODE
   // ==========================================================================
@@ -1299,8 +3083,13 @@ int main(int argc, char *argv[]) {
       return 1;
     }
 
-    // Initialize shared memory
-    std::memset(shared_results, 0, shm_size);
+    // Initialize shared memory (value-initialized: zeroed counters)
+    std::uninitialized_value_construct_n(shared_results, actual_groups);
+
+    // Children inherit the live stats mapping and publish into slot group_idx
+    if (g_live_stats) {
+      open_live_stats(static_cast<uint32_t>(actual_groups), mode_str, pcap_files);
+    }
 
     // Fork child processes
     std::vector<pid_t> children;
@@ -1348,6 +3137,11 @@ int main(int argc, char *argv[]) {
         continue;
       }
 
+      if (g_live.is_open() && !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) {
+        g_live.slot(static_cast<uint32_t>(i)).state.store(
+            static_cast<uint32_t>(LiveSlotState::FAILED), std::memory_order_relaxed);
+      }
+
       if (WIFEXITED(status)) {
         int exit_code = WEXITSTATUS(status);
         if (exit_code == 0) {
@@ -1374,6 +3168,7 @@ int main(int argc, char *argv[]) {
     std::cout << "\nChild processes finished: " << children_completed << " completed, "
               << children_crashed << " failed\n";
     std::cout << "Aggregating results...\n";
+    set_live_run_state(LiveRunState::AGGREGATING);
 
     // Aggregate results from all processes
     double total_baseline_pnl = 0.0, total_toxicity_pnl = 0.0, total_adverse_pnl = 0.0;
@@ -1576,8 +3371,91 @@ int main(int argc, char *argv[]) {
       std::cout << "(Per-window detail in walk_forward_group_*.csv when --output-dir set)\n";
     }
 
+    if (g_config.markout_horizons.count > 0) {
+      MarkoutCurves merged;
+      for (size_t i = 0; i < actual_groups; ++i) {
+        if (shared_results[i].completed) merged.merge(shared_results[i].markouts);
+      }
+      print_markout_table(std::cout, merged, g_config.markout_horizons);
+    }
+
+    // Merge the per-group cost profiles into one
+    if (g_config.cost_sample_interval && !g_config.cost_profile_path.empty()) {
+      CostProfile merged;
+      merged.cycles_per_ns = g_cycles_per_ns;
+      merged.sample_interval = g_config.cost_sample_interval;
+      for (size_t i = 0; i < actual_groups; ++i) {
+        std::string part = g_config.cost_profile_path + ".g" + std::to_string(i + 1);
+        CostProfile partial;
+        std::string err;
+        if (!load_cost_profile(part, partial, err)) {
+          std::cerr << "Warning: cost profile for group " << (i+1) << " missing: " << err << "\n";
+          continue;
+        }
+        merged.merge(partial);
+        std::remove(part.c_str());
+      }
+      merged.sort_by_cost();
+      print_cost_table(std::cout, merged);
+      if (write_cost_profile(g_config.cost_profile_path, merged)) {
+        std::cout << "Cost profile written: " << g_config.cost_profile_path << '\n';
+      } else {
+        std::cerr << "Failed to write cost profile: " << g_config.cost_profile_path << "\n";
+      }
+    }
+
+    // Merge the per-group latency files into one
+    if (!g_latency_path.empty()) {
+      LatencyTable merged;
+      LatencyTiers tiers;
+      double cpn = g_cycles_per_ns;
+      std::vector<std::string> windows;
+      for (size_t i = 0; i < actual_groups; ++i) {
+        std::string part = g_latency_path + ".g" + std::to_string(i + 1);
+        std::string err;
+        if (!load_latency_file(part, cpn, tiers, merged, windows, err)) {
+          std::cerr << "Warning: latency file for group " << (i+1) << " missing: " << err << "\n";
+          continue;
+        }
+        std::remove(part.c_str());
+      }
+      print_latency_table(std::cout, merged, tiers, cpn);
+      std::ofstream out(g_latency_path);
+      if (out.is_open()) {
+        write_latency_header(out, cpn, tiers);
+        for (const auto& row : windows) out << row << '\n';
+        write_latency_rows(out, "total", std::chrono::duration<double>(end_time - start_time).count(),
+                           0, merged, tiers, cpn);
+        write_latency_hists(out, merged, tiers);
+        std::cout << "Latency histograms written: " << g_latency_path << '\n';
+      } else {
+        std::cerr << "Failed to write latency file: " << g_latency_path << "\n";
+      }
+    }
+
+    // Concatenate the per-group overload logs
+    if (g_config.overload.enabled() && !g_overload_log.empty()) {
+      std::ofstream out(g_overload_log);
+      if (!out.is_open()) {
+        std::cerr << "Failed to write overload log: " << g_overload_log << "\n";
+      } else {
+        out << "shard,wall_s,feed_ns,lag_us,from,to\n";
+        for (size_t i = 0; i < actual_groups; ++i) {
+          std::string part = g_overload_log + ".g" + std::to_string(i + 1);
+          std::ifstream in(part);
+          std::string line;
+          std::getline(in, line);  // Header
+          while (std::getline(in, line)) out << line << '\n';
+          in.close();
+          std::remove(part.c_str());
+        }
+        std::cout << "Overload log written: " << g_overload_log << '\n';
+      }
+    }
+
     // Cleanup shared memory
     munmap(shared_results, shm_size);
+    close_live_stats();
 
     return 0;
   }
@@ -1594,6 +3472,25 @@ int main(int argc, char *argv[]) {
   std::cout << "Running baseline and toxicity-aware strategies...\n\n";
 
   (void)xdp::load_symbol_map(symbol_file);
+  init_symbol_filter();
+  init_latency_tiers();
+  init_baskets();
+  {
+    std::string err;
+    if (!init_strategy_plugin(err)) {
+      std::cerr << "Error: --strategy-plugin: " << err << "\n";
+      return 1;
+    }
+  }
+  if (!g_latency_path.empty() && !open_latency_trace(g_latency_path, 0)) {
+    std::cerr << "Error: cannot write latency file " << g_latency_path << "\n";
+    return 1;
+  }
+  if (g_live_stats) {
+    bool threaded = g_use_parallel && pcap_files.size() > 1;
+    uint32_t slots = threaded ? static_cast<uint32_t>(std::min<size_t>(num_procs, LIVE_MAX_SLOTS)) : 1;
+    open_live_stats(slots, mode_str, pcap_files);
+  }
   init_symbol_storage();
 
   if (g_use_parallel && pcap_files.size() > 1) {
@@ -1614,6 +3511,13 @@ int main(int argc, char *argv[]) {
 
       futures.push_back(pool.enqueue([&pcap_file, &progress_mutex,
                                        total_files = pcap_files.size()]() -> size_t {
+        // Pool threads take a live stats slot on first use
+        if (g_live.is_open() && !t_live.slot) {
+          uint32_t slot = g_live_next_slot.fetch_add(1, std::memory_order_relaxed) %
+                          g_live.header().num_slots;
+          live_attach_worker(slot, 0, 0);
+        }
+
         // Use memory-mapped reader for maximum throughput
         xdp::MmapPcapReader reader;
         if (!reader.open(pcap_file)) {
@@ -1626,7 +3530,12 @@ int main(int argc, char *argv[]) {
         // Pre-load file into memory
         reader.preload();
 
+        // Files run concurrently, so each is paced from its own start
+        if (g_config.overload.enabled()) overload_shard().restart_schedule();
+
+        live_begin_file(reader);
         size_t file_packets = reader.process_all(process_packet_callback);
+        live_end_file(reader);
 
         // Report progress
         size_t completed = ++g_files_completed;
@@ -1657,6 +3566,9 @@ int main(int argc, char *argv[]) {
     // SEQUENTIAL PROCESSING MODE (single file or --sequential flag)
     // =====================================================================
     std::cout << "Starting sequential processing...\n";
+    if (g_live.is_open()) {
+      live_attach_worker(0, pcap_files.size(), g_live.header().bytes_total);
+    }
 
     for (size_t file_idx = 0; file_idx < pcap_files.size(); file_idx++) {
       const std::string& pcap_file = pcap_files[file_idx];
@@ -1682,7 +3594,9 @@ int main(int argc, char *argv[]) {
       reader.preload();
 
       uint64_t packets_before = g_total_packets.load();
+      live_begin_file(reader);
       reader.process_all(process_packet_callback);
+      live_end_file(reader);
       uint64_t file_packets = g_total_packets.load() - packets_before;
 
       std::cout << " " << file_packets << " packets";
@@ -1691,6 +3605,10 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  finish_pipelines();
+  if (g_config.overload.enabled()) report_overload(g_overload_log, "t");
+  if (g_baskets) print_basket_summary(std::cerr, *g_baskets);
+
   auto end_time = std::chrono::high_resolution_clock::now();
   auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
   double seconds = duration.count() / 1000.0;
@@ -1707,9 +3625,51 @@ int main(int argc, char *argv[]) {
             << msgs_per_sec << " msgs/sec\n";
   std::cout << "Files processed: " << pcap_files.size() << '\n';
 
+  if (g_live.is_open()) {
+    for (uint32_t i = 0; i < g_live.header().num_slots; ++i) {
+      g_live.slot(i).state.store(static_cast<uint32_t>(LiveSlotState::DONE),
+                                 std::memory_order_relaxed);
+    }
+    set_live_run_state(LiveRunState::AGGREGATING);
+  }
+
+  close_decision_logs();
+  close_strategy_plugin("");
   print_results();
 
+  if (g_config.markout_horizons.count > 0) {
+    print_markout_table(std::cout, collect_markouts(), g_config.markout_horizons);
+    if (!g_config.output_dir.empty()) {
+      std::string mo_path = g_config.output_dir + "/markouts.csv";
+      if (write_markout_fills(mo_path, 0)) {
+        std::cout << "Markout CSV written: " << mo_path << '\n';
+      } else {
+        std::cerr << "Failed to write markout CSV: " << mo_path << "\n";
+      }
+    }
+  }
+
+  if (g_config.cost_sample_interval) {
+    CostProfile profile = collect_cost_profile();
+    profile.sort_by_cost();
+    print_cost_table(std::cout, profile);
+    if (!g_config.cost_profile_path.empty()) {
+      if (write_cost_profile(g_config.cost_profile_path, profile)) {
+        std::cout << "Cost profile written: " << g_config.cost_profile_path << '\n';
+      } else {
+        std::cerr << "Failed to write cost profile: " << g_config.cost_profile_path << "\n";
+      }
+    }
+  }
+
+  if (!g_latency_path.empty()) {
+    auto totals = close_latency_trace();
+    print_latency_table(std::cout, *totals, g_latency_tiers, g_cycles_per_ns);
+    std::cout << "Latency histograms written: " << g_latency_path << '\n';
+  }
+
   cleanup_symbol_storage();
+  close_live_stats();
 
   return 0;
 }
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "common/duration_list.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace mmsim {
+
+// =============================================================================
+// Multi-horizon markouts
+//
+// Every fill is marked to the mid at a fixed set of feed-time horizons after
+// it (default 100us .. 10s). Because a symbol's fills arrive in feed-time
+// order and every fill uses the same horizons, the expiries for one horizon
+// are already sorted: the timer structure is one FIFO cursor per horizon
+// into a shared queue of pending fills, and an expiry is O(1) -- advance the
+// cursor, record the mid. The owner calls expire() only when the feed
+// passes next_due_ns(), so events with nothing due cost one compare.
+//
+// Markouts are signed in the fill's favour: (mid_h - fill_price) for a buy,
+// (fill_price - mid_h) for a sell, per share. Statistics are plain sums so
+// per-symbol, per-group and per-process curves merge by addition.
+// =============================================================================
+
+constexpr int MAX_MARKOUT_HORIZONS = 8;
+constexpr int NUM_MARKOUT_STRATEGIES = 2; // 0 = baseline, 1 = toxicity
+
+inline const char* markout_strategy_name(int s) { return s == 0 ? "baseline" : "toxicity"; }
+
+struct MarkoutHorizons {
+  int count = 0;
+  uint64_t ns[MAX_MARKOUT_HORIZONS] = {};
+
+  static MarkoutHorizons defaults() {
+    MarkoutHorizons h;
+    const uint64_t d[] = {100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+                          1000000000ULL, 10000000000ULL};
+    for (uint64_t v : d) h.ns[h.count++] = v;
+    return h;
+  }
+
+  // "100us" / "1ms" / "10s" / plain nanoseconds
+  static std::string label(uint64_t ns) {
+    if (ns % 1000000000ULL == 0) return std::to_string(ns / 1000000000ULL) + "s";
+    if (ns % 1000000ULL == 0) return std::to_string(ns / 1000000ULL) + "ms";
+    if (ns % 1000ULL == 0) return std::to_string(ns / 1000ULL) + "us";
+    return std::to_string(ns) + "ns";
+  }
+
+  // Comma-separated durations with an ns/us/ms/s suffix, e.g. "1ms,10ms,1s"
+  static bool parse(const std::string& s, MarkoutHorizons& out, std::string& err) {
+    out = MarkoutHorizons{};
+    std::vector<uint64_t> ns;
+    if (!xdp::parse_duration_list(s, ns, err)) return false;
+    if (ns.size() > static_cast<size_t>(MAX_MARKOUT_HORIZONS)) {
+      err = "at most " + std::to_string(MAX_MARKOUT_HORIZONS) + " horizons";
+      return false;
+    }
+    for (uint64_t v : ns) out.ns[out.count++] = v;
+    std::sort(out.ns, out.ns + out.count);
+    out.count = static_cast<int>(std::unique(out.ns, out.ns + out.count) - out.ns);
+    return true;
+  }
+};
+
+// Markout aggregate for one strategy at one horizon. Trivially copyable so
+// hybrid children can return it through shared memory.
+struct MarkoutStats {
+  uint64_t fills = 0;     // Fills marked at this horizon
+  uint64_t adverse = 0;   // ... with a negative markout
+  uint64_t no_mid = 0;    // Horizon reached with a one-sided/empty book
+  double qty = 0.0;       // Shares marked
+  double pnl = 0.0;       // Sum of markout * qty ($)
+  double sum = 0.0;       // Sum of per-share markouts
+  double sum_sq = 0.0;
+
+  void add(double per_share, uint32_t shares) {
+    fills++;
+    if (per_share < 0) adverse++;
+    qty += shares;
+    pnl += per_share * shares;
+    sum += per_share;
+    sum_sq += per_share * per_share;
+  }
+
+  void merge(const MarkoutStats& o) {
+    fills += o.fills;
+    adverse += o.adverse;
+    no_mid += o.no_mid;
+    qty += o.qty;
+    pnl += o.pnl;
+    sum += o.sum;
+    sum_sq += o.sum_sq;
+  }
+
+  [[nodiscard]] double mean() const { return fills ? sum / static_cast<double>(fills) : 0.0; }
+  [[nodiscard]] double stddev() const {
+    if (fills < 2) return 0.0;
+    double n = static_cast<double>(fills);
+    return std::sqrt(std::max(0.0, (sum_sq - sum * sum / n) / (n - 1)));
+  }
+};
+
+// Per-strategy markout curves over the configured horizons
+struct MarkoutCurves {
+  MarkoutStats at[NUM_MARKOUT_STRATEGIES][MAX_MARKOUT_HORIZONS] = {};
+  uint64_t scheduled[NUM_MARKOUT_STRATEGIES] = {}; // Fills entered
+
+  void merge(const MarkoutCurves& o) {
+    for (int s = 0; s < NUM_MARKOUT_STRATEGIES; ++s) {
+      scheduled[s] += o.scheduled[s];
+      for (int h = 0; h < MAX_MARKOUT_HORIZONS; ++h) at[s][h].merge(o.at[s][h]);
+    }
+  }
+};
+
+// One fill with its mid at every horizon (per-fill output)
+struct MarkoutFill {
+  uint64_t fill_time_ns = 0;
+  double fill_price = 0.0;
+  double mid_at_fill = 0.0;
+  double mid[MAX_MARKOUT_HORIZONS] = {};  // 0 = not reached / no mid
+  uint32_t qty = 0;
+  uint8_t strategy = 0;
+  bool is_buy = false;
+};
+
+class MarkoutEngine {
+public:
+  // Horizons must outlive the engine; keep_fills retains every fill for
+  // per-fill output instead of dropping it after its last horizon.
+  void configure(const MarkoutHorizons* horizons, bool keep_fills) {
+    horizons_ = horizons;
+    keep_fills_ = keep_fills;
+  }
+
+  [[nodiscard]] bool enabled() const noexcept { return horizons_ && horizons_->count > 0; }
+
+  // Feed time after which expire() has work to do (UINT64_MAX = none)
+  [[nodiscard]] uint64_t next_due_ns() const noexcept { return next_due_; }
+
+  void schedule(int strategy, uint64_t fill_ns, double fill_price, uint32_t qty,
+                bool is_buy, double mid_at_fill) {
+    if (!enabled()) return;
+    MarkoutFill f;
+    f.fill_time_ns = fill_ns;
+    f.fill_price = fill_price;
+    f.mid_at_fill = mid_at_fill;
+    f.qty = qty;
+    f.strategy = static_cast<uint8_t>(strategy);
+    f.is_buy = is_buy;
+    pending_.push_back(f);
+    curves_.scheduled[strategy]++;
+    // The new fill is at the back, so it is only due first when it is the
+    // sole pending fill for some horizon
+    next_due_ = std::min(next_due_, fill_ns + horizons_->ns[0]);
+  }
+
+  // Record `mid` for every horizon that expired strictly before now_ns.
+  // Call before applying the event stamped now_ns, so `mid` is the book as
+  // of each expiry.
+  void expire(uint64_t now_ns, double mid) {
+    const int nh = horizons_->count;
+    const uint64_t end = base_ + pending_.size();
+    for (int h = 0; h < nh; ++h) {
+      const uint64_t horizon = horizons_->ns[h];
+      uint64_t& c = cursor_[h];
+      while (c < end) {
+        MarkoutFill& f = pending_[c - base_];
+        if (f.fill_time_ns + horizon >= now_ns) break;
+        MarkoutStats& st = curves_.at[f.strategy][h];
+        if (mid > 0) {
+          f.mid[h] = mid;
+          st.add(f.is_buy ? mid - f.fill_price : f.fill_price - mid, f.qty);
+        } else {
+          st.no_mid++;
+        }
+        ++c;
+      }
+    }
+    // Drop fills every horizon is done with (normally the longest horizon's
+    // cursor trails the rest; the min also covers out-of-order fill times)
+    uint64_t done = *std::min_element(cursor_, cursor_ + nh);
+    while (base_ < done) {
+      if (keep_fills_) done_.push_back(pending_.front());
+      pending_.pop_front();
+      ++base_;
+    }
+    next_due_ = UINT64_MAX;
+    for (int h = 0; h < nh; ++h) {
+      if (cursor_[h] < end) {
+        next_due_ = std::min(next_due_, pending_[cursor_[h] - base_].fill_time_ns + horizons_->ns[h]);
+      }
+    }
+  }
+
+  [[nodiscard]] const MarkoutCurves& curves() const noexcept { return curves_; }
+  [[nodiscard]] const MarkoutHorizons* horizons() const noexcept { return horizons_; }
+
+  // Completed fills, then those still waiting on a horizon (kept only when
+  // configured with keep_fills)
+  template <typename F> void for_each_fill(F f) const {
+    for (const auto& x : done_) f(x);
+    if (keep_fills_)
+      for (const auto& x : pending_) f(x);
+  }
+
+private:
+  const MarkoutHorizons* horizons_ = nullptr;
+  bool keep_fills_ = false;
+  std::deque<MarkoutFill> pending_;
+  std::deque<MarkoutFill> done_;
+  uint64_t base_ = 0;                              // Sequence number of pending_.front()
+  uint64_t cursor_[MAX_MARKOUT_HORIZONS] = {};     // Next fill to mark, per horizon
+  uint64_t next_due_ = UINT64_MAX;
+  MarkoutCurves curves_;
+};
+
+// Markout curve table: mean per-share markout, its spread, adverse share and
+// $ markout per horizon for each strategy. Unreached = fills whose horizon
+// fell past the end of the data.
+inline void print_markout_table(std::ostream& os, const MarkoutCurves& c,
+                                const MarkoutHorizons& h) {
+  os << "\n=== MARKOUTS (per share, + = in the fill's favour) ===\n";
+  os << std::left << std::setw(10) << "Strategy" << std::setw(8) << "Horizon" << std::right
+     << std::setw(10) << "Fills" << std::setw(12) << "Mean $/sh" << std::setw(12) << "Std $/sh"
+     << std::setw(10) << "Adverse" << std::setw(14) << "Markout $" << std::setw(11)
+     << "Unreached" << '\n';
+  for (int s = 0; s < NUM_MARKOUT_STRATEGIES; ++s) {
+    for (int i = 0; i < h.count; ++i) {
+      const MarkoutStats& st = c.at[s][i];
+      uint64_t reached = st.fills + st.no_mid;
+      double adverse = st.fills ? 100.0 * static_cast<double>(st.adverse) / static_cast<double>(st.fills) : 0.0;
+      os << std::left << std::setw(10) << markout_strategy_name(s) << std::setw(8)
+         << MarkoutHorizons::label(h.ns[i]) << std::right << std::setw(10) << st.fills
+         << std::fixed << std::setprecision(5) << std::setw(12) << st.mean() << std::setw(12)
+         << st.stddev() << std::setprecision(1) << std::setw(9) << adverse << '%'
+         << std::setprecision(2) << std::setw(14) << st.pnl << std::setw(11)
+         << (c.scheduled[s] > reached ? c.scheduled[s] - reached : 0) << '\n';
+    }
+  }
+  os.unsetf(std::ios::floatfield);
+}
+
+// Per-fill CSV rows: one line per fill with the mid and markout at each horizon
+inline void write_markout_csv_header(std::ostream& os, const MarkoutHorizons& h) {
+  os << "group,symbol_index,ticker,strategy,fill_time_ns,is_buy,qty,fill_price,mid_at_fill";
+  for (int i = 0; i < h.count; ++i) {
+    std::string l = MarkoutHorizons::label(h.ns[i]);
+    os << ",mid_" << l << ",markout_" << l;
+  }
+  os << '\n';
+}
+
+inline void write_markout_csv_row(std::ostream& os, size_t group, uint32_t symbol_index,
+                                  const std::string& ticker, const MarkoutFill& f,
+                                  const MarkoutHorizons& h) {
+  os << group << ',' << symbol_index << ',' << ticker << ',' << markout_strategy_name(f.strategy)
+     << ',' << f.fill_time_ns << ',' << (f.is_buy ? 1 : 0) << ',' << f.qty << ',' << std::fixed
+     << std::setprecision(4) << f.fill_price << ',' << f.mid_at_fill;
+  for (int i = 0; i < h.count; ++i) {
+    if (f.mid[i] > 0) {
+      double mo = f.is_buy ? f.mid[i] - f.fill_price : f.fill_price - f.mid[i];
+      os << ',' << f.mid[i] << ',' << std::setprecision(5) << mo << std::setprecision(4);
+    } else {
+      os << ",,";
+    }
+  }
+  os << '\n';
+  os.unsetf(std::ios::floatfield);
+}
+
+} // namespace mmsim
@@ -0,0 +1,450 @@
+// mmtop.cpp - Terminal monitor for a running market_maker_sim
+// Maps the simulator's live stats segment (market_maker_sim --live-stats)
+// read-only and redraws progress, throughput, fill pipeline counters and the
+// hottest symbols. Reading never blocks or signals the simulation.
+
+#include "live_stats.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace mmsim;
+
+namespace {
+
+enum class SortKey { RATE, PNL, FILLS, INVENTORY };
+
+struct TopConfig {
+  double interval_s = 1.0;
+  size_t rows = 20;
+  SortKey sort = SortKey::RATE;
+  bool once = false;
+};
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void handle_signal(int) { g_stop = 1; }
+
+// Consistent copy of one table entry plus its derived rate
+struct SymbolRow {
+  std::string ticker;
+  uint32_t group = 0;
+  uint32_t flags = 0;
+  uint64_t messages = 0;
+  double rate = 0.0;
+  int64_t toxicity_fills = 0;
+  int64_t baseline_fills = 0;
+  int64_t suppressed = 0;
+  double inventory = 0.0;
+  double toxicity_pnl = 0.0;
+  double baseline_pnl = 0.0;
+};
+
+// Per-slot counters remembered between refreshes for rate computation
+struct SlotSample {
+  uint64_t packets = 0;
+  uint64_t messages = 0;
+  uint64_t feed_ns = 0;
+};
+
+void print_usage(const char *program) {
+  std::cerr << "Usage: " << program << " [options] [PID|NAME]\n\n"
+            << "Watch a market_maker_sim started with --live-stats.\n"
+            << "With no argument, attaches to the newest /dev/shm/mmsim.* segment.\n\n"
+            << "Options:\n"
+            << "  -i SEC          Refresh interval in seconds (default: 1)\n"
+            << "  -n N            Symbols to show (default: 20)\n"
+            << "  --sort KEY      rate, pnl, fills or inv (default: rate)\n"
+            << "  --once          Print one snapshot and exit (rates are run averages)\n"
+            << "  -l, --list      List available segments\n";
+}
+
+// Every mmsim.* entry in /dev/shm, newest first
+std::vector<std::string> list_segments() {
+  namespace fs = std::filesystem;
+  std::vector<std::pair<fs::file_time_type, std::string>> found;
+  std::error_code ec;
+  for (const auto &entry : fs::directory_iterator("/dev/shm", ec)) {
+    const std::string name = entry.path().filename().string();
+    if (name.rfind("mmsim.", 0) == 0) {
+      found.emplace_back(entry.last_write_time(ec), "/" + name);
+    }
+  }
+  std::sort(found.begin(), found.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+  std::vector<std::string> names;
+  for (auto &f : found) names.push_back(f.second);
+  return names;
+}
+
+std::string resolve_name(const std::string &arg) {
+  if (!arg.empty() &&
+      std::all_of(arg.begin(), arg.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+    return live_stats_default_name(static_cast<pid_t>(std::stol(arg)));
+  }
+  return arg[0] == '/' ? arg : "/" + arg;
+}
+
+std::string format_duration(double seconds) {
+  if (seconds < 0 || !std::isfinite(seconds)) return "--:--:--";
+  uint64_t s = static_cast<uint64_t>(seconds);
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%02llu:%02llu:%02llu",
+           static_cast<unsigned long long>(s / 3600),
+           static_cast<unsigned long long>((s / 60) % 60),
+           static_cast<unsigned long long>(s % 60));
+  return buf;
+}
+
+std::string format_feed_time(uint64_t ns) {
+  if (ns == 0) return "--:--:--";
+  time_t secs = static_cast<time_t>(ns / 1000000000ULL);
+  struct tm tm_utc;
+  gmtime_r(&secs, &tm_utc);
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%02d:%02d:%02d", tm_utc.tm_hour, tm_utc.tm_min,
+           tm_utc.tm_sec);
+  return buf;
+}
+
+// 1234567 -> "1.23M"
+std::string human(double v) {
+  const char *suffix = "";
+  if (std::abs(v) >= 1e9) { v /= 1e9; suffix = "G"; }
+  else if (std::abs(v) >= 1e6) { v /= 1e6; suffix = "M"; }
+  else if (std::abs(v) >= 1e3) { v /= 1e3; suffix = "K"; }
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.2f%s", v, suffix);
+  return buf;
+}
+
+const char *run_state_name(uint32_t s) {
+  switch (static_cast<LiveRunState>(s)) {
+  case LiveRunState::STARTING: return "STARTING";
+  case LiveRunState::RUNNING: return "RUNNING";
+  case LiveRunState::AGGREGATING: return "AGGREGATING";
+  case LiveRunState::DONE: return "DONE";
+  }
+  return "?";
+}
+
+const char *slot_state_name(uint32_t s) {
+  switch (static_cast<LiveSlotState>(s)) {
+  case LiveSlotState::IDLE: return "idle";
+  case LiveSlotState::RUNNING: return "run";
+  case LiveSlotState::DONE: return "done";
+  case LiveSlotState::FAILED: return "FAILED";
+  }
+  return "?";
+}
+
+std::string flag_string(uint32_t flags) {
+  std::string f;
+  if (!(flags & LIVE_SYM_ELIGIBLE)) f += " inel";
+  if (flags & LIVE_SYM_HALTED) f += " HALT";
+  if (flags & LIVE_SYM_BLACKLISTED) f += " BL";
+  if (flags & LIVE_SYM_EOD) f += " EOD";
+  return f;
+}
+
+double pct(uint64_t part, uint64_t whole) {
+  return whole > 0 ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+class LiveTop {
+public:
+  LiveTop(const LiveStatsSegment &seg, const TopConfig &config)
+      : seg_(seg), config_(config),
+        prev_slots_(seg.header().num_slots) {}
+
+  void render() {
+    const LiveStatsHeader &h = seg_.header();
+    uint64_t now = live_wall_ns();
+    double elapsed = static_cast<double>(now - h.start_wall_ns) / 1e9;
+    double dt = prev_wall_ns_ ? static_cast<double>(now - prev_wall_ns_) / 1e9 : elapsed;
+    bool have_prev = prev_wall_ns_ != 0;
+    uint32_t run_state = h.run_state.load(std::memory_order_relaxed);
+    bool alive = kill(h.pid, 0) == 0 || errno == EPERM;
+
+    std::string out;
+    char line[512];
+
+    snprintf(line, sizeof(line), "mmtop - %s  pid %d  %s  %s%s  elapsed %s",
+             seg_.name().c_str(), h.pid, h.mode, run_state_name(run_state),
+             (!alive && run_state != static_cast<uint32_t>(LiveRunState::DONE))
+                 ? " (process gone)" : "",
+             format_duration(elapsed).c_str());
+    out += line;
+    if (h.ticker_filter[0]) {
+      out += std::string("  ticker ") + h.ticker_filter;
+    }
+    out += "\n";
+
+    // ---- Progress and throughput ----
+    uint64_t bytes_done = 0, files_done = 0, packets = 0, messages = 0;
+    uint64_t d_packets = 0, d_messages = 0;
+    for (uint32_t i = 0; i < h.num_slots; ++i) {
+      const LiveSlot &s = seg_.slot(i);
+      uint64_t p = s.packets.load(std::memory_order_relaxed);
+      uint64_t m = s.messages.load(std::memory_order_relaxed);
+      bytes_done += s.bytes_done.load(std::memory_order_relaxed);
+      files_done += s.files_done.load(std::memory_order_relaxed);
+      packets += p;
+      messages += m;
+      d_packets += p - std::min(p, prev_slots_[i].packets);
+      d_messages += m - std::min(m, prev_slots_[i].messages);
+    }
+    double run_frac = h.bytes_total > 0
+        ? static_cast<double>(bytes_done) / static_cast<double>(h.bytes_total) : 0.0;
+    double eta = run_frac > 0.001 ? elapsed * (1.0 - run_frac) / run_frac : -1.0;
+    snprintf(line, sizeof(line),
+             "Progress: %sB / %sB (%.1f%%)  files %llu/%llu  ETA %s\n",
+             human(static_cast<double>(bytes_done)).c_str(),
+             human(static_cast<double>(h.bytes_total)).c_str(), 100.0 * run_frac,
+             static_cast<unsigned long long>(files_done),
+             static_cast<unsigned long long>(h.files_total),
+             format_duration(eta).c_str());
+    out += line;
+    snprintf(line, sizeof(line),
+             "Rate: %s msgs/s  %s pkts/s   Total: %s msgs  %s pkts\n\n",
+             human(dt > 0 ? d_messages / dt : 0.0).c_str(),
+             human(dt > 0 ? d_packets / dt : 0.0).c_str(),
+             human(static_cast<double>(messages)).c_str(),
+             human(static_cast<double>(packets)).c_str());
+    out += line;
+
+    // ---- Workers ----
+    out += "Slot  State    PID     Files      Progress  Feed time  Feed x   Msgs/s    Packets  Idle\n";
+    for (uint32_t i = 0; i < h.num_slots; ++i) {
+      const LiveSlot &s = seg_.slot(i);
+      uint32_t state = s.state.load(std::memory_order_relaxed);
+      uint64_t p = s.packets.load(std::memory_order_relaxed);
+      uint64_t m = s.messages.load(std::memory_order_relaxed);
+      uint64_t feed = s.feed_ns.load(std::memory_order_relaxed);
+      uint64_t files_total = s.files_total.load(std::memory_order_relaxed);
+      uint64_t bytes_total = s.bytes_total.load(std::memory_order_relaxed);
+      uint64_t hb = s.heartbeat_ns.load(std::memory_order_relaxed);
+
+      // Feed seconds replayed per wall second since the last refresh
+      double feed_speed = 0.0;
+      if (have_prev && dt > 0 && prev_slots_[i].feed_ns && feed > prev_slots_[i].feed_ns) {
+        feed_speed = static_cast<double>(feed - prev_slots_[i].feed_ns) / 1e9 / dt;
+      }
+      char files_col[24], prog_col[16];
+      if (files_total > 0) {
+        snprintf(files_col, sizeof(files_col), "%llu/%llu",
+                 static_cast<unsigned long long>(s.files_done.load(std::memory_order_relaxed)),
+                 static_cast<unsigned long long>(files_total));
+        snprintf(prog_col, sizeof(prog_col), "%.1f%%",
+                 pct(s.bytes_done.load(std::memory_order_relaxed), bytes_total));
+      } else {
+        snprintf(files_col, sizeof(files_col), "%llu",
+                 static_cast<unsigned long long>(s.files_done.load(std::memory_order_relaxed)));
+        snprintf(prog_col, sizeof(prog_col), "-");
+      }
+      snprintf(line, sizeof(line), "%4u  %-7s  %-6d  %-9s  %8s  %9s  %6.1f  %8s  %9s  %4.0fs\n",
+               i, slot_state_name(state), s.pid.load(std::memory_order_relaxed),
+               files_col, prog_col, format_feed_time(feed).c_str(), feed_speed,
+               human(dt > 0 ? (m - std::min(m, prev_slots_[i].messages)) / dt : 0.0).c_str(),
+               human(static_cast<double>(p)).c_str(),
+               hb ? static_cast<double>(now - std::min(now, hb)) / 1e9 : 0.0);
+      out += line;
+      prev_slots_[i] = {p, m, feed};
+    }
+
+    // ---- Fill pipeline (toxicity strategy) ----
+    uint64_t exec = 0, no_oi = 0, not_elig = 0, tries = 0, halted = 0, not_live = 0;
+    uint64_t latency = 0, price = 0, queue = 0, filled = 0, resets = 0;
+    for (uint32_t i = 0; i < h.num_slots; ++i) {
+      const LiveSlot &s = seg_.slot(i);
+      exec += s.exec_total.load(std::memory_order_relaxed);
+      no_oi += s.exec_no_order_info.load(std::memory_order_relaxed);
+      not_elig += s.exec_not_eligible.load(std::memory_order_relaxed);
+      tries += s.try_fill_calls.load(std::memory_order_relaxed);
+      halted += s.rejected_halted.load(std::memory_order_relaxed);
+      not_live += s.rejected_not_live.load(std::memory_order_relaxed);
+      latency += s.rejected_latency.load(std::memory_order_relaxed);
+      price += s.rejected_price.load(std::memory_order_relaxed);
+      queue += s.rejected_queue.load(std::memory_order_relaxed);
+      filled += s.fill_succeeded.load(std::memory_order_relaxed);
+      resets += s.quote_resets.load(std::memory_order_relaxed);
+    }
+    snprintf(line, sizeof(line),
+             "\nFill pipeline (toxicity): execs %s (no-order %.1f%%, inelig %.1f%%)  "
+             "tries %s  filled %s (%.1f%%)\n"
+             "  rejected: halted %.1f%%  not-live %.1f%%  latency %.1f%%  price %.1f%%  "
+             "queue %.1f%%   quote resets %s\n\n",
+             human(static_cast<double>(exec)).c_str(), pct(no_oi, exec), pct(not_elig, exec),
+             human(static_cast<double>(tries)).c_str(), human(static_cast<double>(filled)).c_str(),
+             pct(filled, tries), pct(halted, tries), pct(not_live, tries), pct(latency, tries),
+             pct(price, tries), pct(queue, tries), human(static_cast<double>(resets)).c_str());
+    out += line;
+
+    // ---- Symbols ----
+    std::vector<SymbolRow> rows;
+    double total_tox = 0.0, total_base = 0.0;
+    int64_t total_fills = 0;
+    std::unordered_map<uint64_t, uint64_t> seen;
+    for (uint32_t i = 0; i < h.symbol_capacity; ++i) {
+      const LiveSymbol &e = seg_.symbol(i);
+      uint64_t key = e.key.load(std::memory_order_acquire);
+      if (key == 0 || !e.ready.load(std::memory_order_acquire)) continue;
+      SymbolRow r;
+      r.ticker.assign(e.ticker, strnlen(e.ticker, sizeof(e.ticker)));
+      r.group = static_cast<uint32_t>(key >> 32) - 1;
+      r.flags = e.flags.load(std::memory_order_relaxed);
+      r.messages = e.messages.load(std::memory_order_relaxed);
+      r.toxicity_fills = e.toxicity_fills.load(std::memory_order_relaxed);
+      r.baseline_fills = e.baseline_fills.load(std::memory_order_relaxed);
+      r.suppressed = e.quotes_suppressed.load(std::memory_order_relaxed);
+      r.inventory = e.inventory.load(std::memory_order_relaxed);
+      r.toxicity_pnl = e.toxicity_pnl.load(std::memory_order_relaxed);
+      r.baseline_pnl = e.baseline_pnl.load(std::memory_order_relaxed);
+      auto it = prev_symbol_msgs_.find(key);
+      if (have_prev && it != prev_symbol_msgs_.end()) {
+        r.rate = dt > 0 ? (r.messages - std::min(r.messages, it->second)) / dt : 0.0;
+      } else {
+        r.rate = elapsed > 0 ? r.messages / elapsed : 0.0;
+      }
+      seen[key] = r.messages;
+      total_tox += r.toxicity_pnl;
+      total_base += r.baseline_pnl;
+      total_fills += r.toxicity_fills;
+      rows.push_back(std::move(r));
+    }
+    prev_symbol_msgs_.swap(seen);
+
+    auto by = [&](const SymbolRow &a, const SymbolRow &b) {
+      switch (config_.sort) {
+      case SortKey::PNL: return std::abs(a.toxicity_pnl) > std::abs(b.toxicity_pnl);
+      case SortKey::FILLS: return a.toxicity_fills > b.toxicity_fills;
+      case SortKey::INVENTORY: return std::abs(a.inventory) > std::abs(b.inventory);
+      case SortKey::RATE: break;
+      }
+      return a.rate > b.rate;
+    };
+    size_t shown = std::min(config_.rows, rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + shown, rows.end(), by);
+
+    uint32_t dropped = h.symbols_dropped.load(std::memory_order_relaxed);
+    snprintf(line, sizeof(line),
+             "Symbols: %zu tracked%s   Toxicity PnL $%.2f  Baseline PnL $%.2f  Fills %lld\n",
+             rows.size(), dropped ? " (table full, some dropped)" : "",
+             total_tox, total_base, static_cast<long long>(total_fills));
+    out += line;
+    out += "Ticker   Grp    Msgs/s    Msgs      Tox PnL     Base PnL   Inventory  Fills  BFills  Supp  Flags\n";
+    for (size_t i = 0; i < shown; ++i) {
+      const SymbolRow &r = rows[i];
+      snprintf(line, sizeof(line),
+               "%-7s  %3u  %8s  %8s  %11.2f  %11.2f  %10.0f  %5lld  %6lld  %4lld %s\n",
+               r.ticker.c_str(), r.group + 1, human(r.rate).c_str(),
+               human(static_cast<double>(r.messages)).c_str(), r.toxicity_pnl,
+               r.baseline_pnl, r.inventory, static_cast<long long>(r.toxicity_fills),
+               static_cast<long long>(r.baseline_fills), static_cast<long long>(r.suppressed),
+               flag_string(r.flags).c_str());
+      out += line;
+    }
+
+    if (!config_.once) {
+      std::fputs("\033[H\033[2J", stdout);  // Home + clear screen
+    }
+    std::fputs(out.c_str(), stdout);
+    std::fflush(stdout);
+    prev_wall_ns_ = now;
+  }
+
+private:
+  const LiveStatsSegment &seg_;
+  const TopConfig &config_;
+  std::vector<SlotSample> prev_slots_;
+  std::unordered_map<uint64_t, uint64_t> prev_symbol_msgs_;
+  uint64_t prev_wall_ns_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  TopConfig config;
+  std::string target;
+  bool list_only = false;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "-i" && i + 1 < argc) {
+      config.interval_s = std::max(0.1, std::stod(argv[++i]));
+    } else if (arg == "-n" && i + 1 < argc) {
+      config.rows = std::stoull(argv[++i]);
+    } else if (arg == "--sort" && i + 1 < argc) {
+      const std::string key = argv[++i];
+      if (key == "pnl") {
+        config.sort = SortKey::PNL;
+      } else if (key == "fills") {
+        config.sort = SortKey::FILLS;
+      } else if (key == "inv") {
+        config.sort = SortKey::INVENTORY;
+      } else {
+        config.sort = SortKey::RATE;
+      }
+    } else if (arg == "--once") {
+      config.once = true;
+    } else if (arg == "-l" || arg == "--list") {
+      list_only = true;
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg[0] != '-') {
+      target = arg;
+    }
+  }
+
+  if (list_only) {
+    for (const auto &name : list_segments()) {
+      std::cout << name << "\n";
+    }
+    return 0;
+  }
+
+  std::string name;
+  if (target.empty()) {
+    auto names = list_segments();
+    if (names.empty()) {
+      std::cerr << "Error: no running simulation found (start market_maker_sim with --live-stats)\n";
+      return 1;
+    }
+    name = names.front();
+  } else {
+    name = resolve_name(target);
+  }
+
+  LiveStatsSegment seg;
+  std::string err;
+  if (!seg.attach(name, err)) {
+    std::cerr << "Error: " << err << "\n";
+    return 1;
+  }
+
+  std::signal(SIGINT, handle_signal);
+  std::signal(SIGTERM, handle_signal);
+
+  LiveTop top(seg, config);
+  auto interval = std::chrono::milliseconds(static_cast<int64_t>(config.interval_s * 1000));
+  while (!g_stop) {
+    top.render();
+    if (config.once ||
+        seg.header().run_state.load(std::memory_order_relaxed) ==
+            static_cast<uint32_t>(LiveRunState::DONE)) {
+      break;
+    }
+    std::this_thread::sleep_for(interval);
+  }
+  return 0;
+}
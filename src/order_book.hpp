@@ -1,7 +1,10 @@
 #pragma once
 
+#include "common/depth_ladder.hpp"
+#include "common/flat_u64_map.hpp"
+
+#include <algorithm>
 #include <atomic>
-#include <chrono>
 #include <cmath>
 #include <map>
 #include <mutex>
@@ -15,7 +18,7 @@ struct Order {
   double price;
   uint32_t volume;
   char side; // 'B' or 'S'
-  std::chrono::system_clock::time_point timestamp;
+  uint64_t timestamp_ns; // Feed time of arrival or last modify (queue priority)
 };
 
 class OrderBook {
@@ -92,6 +95,49 @@ public:
     int ask_levels = 0;
   };
 
+  // Order-age features, maintained per event from feed timestamps
+  struct OrderAgeStats {
+    // Touch resting times in log2 microsecond buckets: bucket 0 is < 1us,
+    // bucket i is [2^(i-1), 2^i) us, the last bucket is open-ended
+    static constexpr int REST_BUCKETS = 32;
+
+    uint64_t cancels = 0;
+    uint64_t fleeting_cancels = 0; // Cancelled within the fleeting threshold
+    uint64_t touch_removals = 0;   // Orders leaving the best bid/ask (cancel or fill)
+    uint64_t touch_rest_hist[REST_BUCKETS] = {};
+    // Volume-weighted age of resting depth as of the last event
+    double bid_depth_age_us = 0.0;
+    double ask_depth_age_us = 0.0;
+
+    [[nodiscard]] double fleeting_ratio() const noexcept {
+      return cancels > 0 ? static_cast<double>(fleeting_cancels) / static_cast<double>(cancels) : 0.0;
+    }
+
+    // Upper edge of the bucket holding quantile q of touch resting times
+    [[nodiscard]] double touch_rest_quantile_us(double q) const noexcept {
+      if (touch_removals == 0)
+        return 0.0;
+      const double target = q * static_cast<double>(touch_removals);
+      uint64_t seen = 0;
+      for (int i = 0; i < REST_BUCKETS; ++i) {
+        seen += touch_rest_hist[i];
+        if (static_cast<double>(seen) >= target)
+          return std::ldexp(1.0, i);
+      }
+      return std::ldexp(1.0, REST_BUCKETS - 1);
+    }
+
+    static int rest_bucket(uint64_t age_ns) noexcept {
+      uint64_t us = age_ns / 1000;
+      int b = 0;
+      while (us > 0 && b < REST_BUCKETS - 1) {
+        us >>= 1;
+        ++b;
+      }
+      return b;
+    }
+  };
+
   // Lightweight snapshot for strategy quote updates - captures only
   // what the market-making strategies need in a single lock acquisition.
   struct BookSnapshot {
@@ -108,6 +154,7 @@ public:
     Level ask_levels[MAX_LEVELS] = {};
     int num_bid_levels = 0;
     int num_ask_levels = 0;
+    OrderAgeStats age;
   };
 
   [[nodiscard]] BookSnapshot get_snapshot() const {
@@ -137,10 +184,110 @@ public:
       }
     }
     snap.num_ask_levels = i;
+    snap.age = age_stats_locked();
 
     return snap;
   }
 
+  // Read-only copy of everything the strategy layer reads from the book:
+  // the strategy snapshot, full toxicity metrics of its top levels, and the
+  // first MAX_DEPTH levels per side for queue-position estimates, plus (on
+  // request) the near-book depth and fill cost from the tick ladders.
+  // `version` counts book mutations, so two views of the same book compare
+  // by age.
+  struct BookView {
+    static constexpr int MAX_DEPTH = 32;
+    // Near-book window and order size of the ladder queries below
+    static constexpr int NEAR_TICKS = 10;
+    static constexpr uint64_t IMPACT_QTY = 1000;
+    struct DepthLevel {
+      double price;
+      uint32_t qty;
+    };
+    uint64_t version = 0;
+    BookSnapshot snapshot;
+    ToxicityMetrics bid_metrics[BookSnapshot::MAX_LEVELS];
+    ToxicityMetrics ask_metrics[BookSnapshot::MAX_LEVELS];
+    DepthLevel bid_depth[MAX_DEPTH];
+    DepthLevel ask_depth[MAX_DEPTH];
+    int num_bid_depth = 0;
+    int num_ask_depth = 0;
+    // Depth within NEAR_TICKS of each touch, and the VWAP of taking
+    // IMPACT_QTY (or what the side holds) from it; 0 for an empty side, and
+    // all 0 unless published with `near_book`
+    uint64_t bid_near_qty = 0;
+    uint64_t ask_near_qty = 0;
+    double buy_vwap = 0.0;
+    double sell_vwap = 0.0;
+
+    // Visible quantity at `price`; `known` is false when the price lies past
+    // the last copied level of a side that has more levels than were copied
+    [[nodiscard]] uint32_t depth_at(double price, char side, bool &known) const {
+      const bool bid = side == 'B';
+      const DepthLevel *lv = bid ? bid_depth : ask_depth;
+      const int n = bid ? num_bid_depth : num_ask_depth;
+      known = true;
+      if (price <= 0.0)
+        return 0;
+      for (int i = 0; i < n; ++i) {
+        if (lv[i].price == price)
+          return lv[i].qty;
+        if (bid ? lv[i].price < price : lv[i].price > price)
+          return 0;
+      }
+      const int total = bid ? snapshot.stats.bid_levels : snapshot.stats.ask_levels;
+      known = n >= total;
+      return 0;
+    }
+  };
+
+  // Fill `view` under one lock; copies at most `depth` levels per side.
+  // `near_book` also runs the near-book ladder queries (O(log n) each, and
+  // the first one builds the ladders).
+  void publish_view(BookView &view, int depth = BookView::MAX_DEPTH,
+                    bool near_book = false) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    view.version = version_;
+    BookSnapshot &snap = view.snapshot;
+    snap.stats = stats_;
+    snap.last_traded_price = last_traded_price_;
+    snap.age = age_stats_locked();
+
+    auto fill_side = [depth](const auto &levels, const auto &toxicity,
+                             BookSnapshot::Level *top, int &num_top,
+                             ToxicityMetrics *metrics, BookView::DepthLevel *out,
+                             int &num_out) {
+      int i = 0;
+      for (auto it = levels.begin(); it != levels.end() && i < BookSnapshot::MAX_LEVELS; ++it, ++i) {
+        top[i].price = it->first;
+        top[i].qty = it->second;
+        auto tox_it = toxicity.find(it->first);
+        metrics[i] = tox_it != toxicity.end() ? tox_it->second : ToxicityMetrics();
+        top[i].toxicity_score = metrics[i].get_toxicity_score();
+      }
+      num_top = i;
+      i = 0;
+      const int limit = std::min(depth, BookView::MAX_DEPTH);
+      for (auto it = levels.begin(); it != levels.end() && i < limit; ++it, ++i) {
+        out[i] = {it->first, it->second};
+      }
+      num_out = i;
+    };
+    fill_side(bids_, bid_toxicity_, snap.bid_levels, snap.num_bid_levels,
+              view.bid_metrics, view.bid_depth, view.num_bid_depth);
+    fill_side(asks_, ask_toxicity_, snap.ask_levels, snap.num_ask_levels,
+              view.ask_metrics, view.ask_depth, view.num_ask_depth);
+    if (!near_book) {
+      view.bid_near_qty = view.ask_near_qty = 0;
+      view.buy_vwap = view.sell_vwap = 0.0;
+      return;
+    }
+    view.bid_near_qty = depth_within_ticks_locked('B', BookView::NEAR_TICKS);
+    view.ask_near_qty = depth_within_ticks_locked('S', BookView::NEAR_TICKS);
+    view.buy_vwap = estimate_fill_locked('S', BookView::IMPACT_QTY).vwap;
+    view.sell_vwap = estimate_fill_locked('B', BookView::IMPACT_QTY).vwap;
+  }
+
   OrderBook() = default;
 
   void clear() {
@@ -154,35 +301,49 @@ public:
     last_traded_volume_ = 0;
     total_bid_volume_ = 0;
     total_ask_volume_ = 0;
-    update_stats();
+    age_ = OrderAgeStats();
+    bid_age_ = SideAge();
+    ask_age_ = SideAge();
+    bid_ladder_ = xdp::DepthLadder(true);
+    ask_ladder_ = xdp::DepthLadder(false);
+    tick_micros_ = 0;
+    last_update_ns_ = 0;
+    update_stats(0);
   }
 
-  void add_order(uint64_t order_id, double price, uint32_t volume, char side) {
+  // Mutators take the event's feed timestamp (ns since epoch); order ages
+  // and the last-update time are measured in feed time, never wall time.
+  void add_order(uint64_t order_id, double price, uint32_t volume, char side,
+                 uint64_t ts_ns) {
     std::lock_guard<std::mutex> lock(mtx_);
 
     if (side == 'B') {
       bids_[price] += volume;
       total_bid_volume_ += volume;
-      update_toxicity_on_add(bid_toxicity_[price], price, volume);
+      if (tracks_level(side, price))
+        update_toxicity_on_add(bid_toxicity_[price], price, volume);
     } else {
       asks_[price] += volume;
       total_ask_volume_ += volume;
-      update_toxicity_on_add(ask_toxicity_[price], price, volume);
+      if (tracks_level(side, price))
+        update_toxicity_on_add(ask_toxicity_[price], price, volume);
     }
+    ladder_add(side, price, volume);
 
-    active_orders_[order_id] = {order_id, price, volume, side,
-                                std::chrono::system_clock::now()};
-    update_stats();
+    active_orders_[order_id] = {order_id, price, volume, side, ts_ns};
+    side_age(side).add(volume, ts_ns);
+    update_stats(ts_ns);
   }
 
-  void modify_order(uint64_t order_id, double new_price, uint32_t new_volume) {
+  void modify_order(uint64_t order_id, double new_price, uint32_t new_volume,
+                    uint64_t ts_ns) {
     std::lock_guard<std::mutex> lock(mtx_);
 
-    auto it = active_orders_.find(order_id);
-    if (it == active_orders_.end())
+    Order *found = active_orders_.find(order_id);
+    if (!found)
       return;
 
-    Order &order = it->second;
+    Order &order = *found;
 
     // Remove from old price level (remove_volume_from_* updates running totals)
     if (order.side == 'B') {
@@ -194,49 +355,65 @@ public:
       asks_[new_price] += new_volume;
       total_ask_volume_ += new_volume;
     }
+    ladder_add(order.side, new_price, new_volume);
 
-    // Update order
+    // Update order (a modify resets its queue priority, and so its age)
+    side_age(order.side).remove(order.volume, order.timestamp_ns);
+    side_age(order.side).add(new_volume, ts_ns);
     order.price = new_price;
     order.volume = new_volume;
-    order.timestamp = std::chrono::system_clock::now();
+    order.timestamp_ns = ts_ns;
 
-    update_stats();
+    update_stats(ts_ns);
   }
 
-  void delete_order(uint64_t order_id) {
+  void delete_order(uint64_t order_id, uint64_t ts_ns) {
     std::lock_guard<std::mutex> lock(mtx_);
 
-    auto it = active_orders_.find(order_id);
-    if (it == active_orders_.end())
+    const Order *found = active_orders_.find(order_id);
+    if (!found)
       return;
 
-    const Order &order = it->second;
+    const Order &order = *found;
+
+    const uint64_t age_ns = ts_ns > order.timestamp_ns ? ts_ns - order.timestamp_ns : 0;
+    age_.cancels++;
+    if (age_ns < fleeting_threshold_ns_)
+      age_.fleeting_cancels++;
+    record_leave(order, age_ns);
 
+    const bool tracked = tracks_level(order.side, order.price);
     if (order.side == 'B') {
-      bid_toxicity_[order.price].cancels++;
-      bid_toxicity_[order.price].total_volume_cancelled += order.volume;
+      if (tracked) {
+        bid_toxicity_[order.price].cancels++;
+        bid_toxicity_[order.price].total_volume_cancelled += order.volume;
+      }
       remove_volume_from_bids(order.price, order.volume);
     } else {
-      ask_toxicity_[order.price].cancels++;
-      ask_toxicity_[order.price].total_volume_cancelled += order.volume;
+      if (tracked) {
+        ask_toxicity_[order.price].cancels++;
+        ask_toxicity_[order.price].total_volume_cancelled += order.volume;
+      }
       remove_volume_from_asks(order.price, order.volume);
     }
 
-    active_orders_.erase(it);
-    update_stats();
+    active_orders_.erase(order_id);
+    update_stats(ts_ns);
   }
 
-  void execute_order(uint64_t order_id, uint32_t executed_qty, double trade_price) {
+  void execute_order(uint64_t order_id, uint32_t executed_qty, double trade_price,
+                     uint64_t ts_ns) {
     std::lock_guard<std::mutex> lock(mtx_);
 
-    auto it = active_orders_.find(order_id);
-    if (it == active_orders_.end())
+    Order *found = active_orders_.find(order_id);
+    if (!found)
       return;
 
-    Order &order = it->second;
+    Order &order = *found;
 
     if (order.volume > executed_qty) {
       // Partial fill
+      side_age(order.side).remove(executed_qty, order.timestamp_ns);
       order.volume -= executed_qty;
       if (order.side == 'B') {
         bids_[order.price] -= executed_qty;
@@ -245,19 +422,21 @@ public:
         asks_[order.price] -= executed_qty;
         total_ask_volume_ -= executed_qty;
       }
+      ladder_add(order.side, order.price, -static_cast<int64_t>(executed_qty));
     } else {
       // Full fill (remove_volume_from_* updates running totals)
+      record_leave(order, ts_ns > order.timestamp_ns ? ts_ns - order.timestamp_ns : 0);
       if (order.side == 'B') {
         remove_volume_from_bids(order.price, order.volume);
       } else {
         remove_volume_from_asks(order.price, order.volume);
       }
-      active_orders_.erase(it);
+      active_orders_.erase(order_id);
     }
 
     last_traded_price_ = trade_price;
     last_traded_volume_ = executed_qty;
-    update_stats();
+    update_stats(ts_ns);
   }
 
   // Atomic snapshot - captures all state in a single lock acquisition for consistent rendering
@@ -276,7 +455,10 @@ public:
     snapshot.stats = stats_;
     snapshot.bids = bids_;
     snapshot.asks = asks_;
-    snapshot.active_orders = active_orders_;
+    snapshot.active_orders.reserve(active_orders_.size());
+    active_orders_.for_each([&](uint64_t id, const Order &order) {
+      snapshot.active_orders.emplace(id, order);
+    });
     snapshot.last_traded_price = last_traded_price_;
     snapshot.last_traded_volume = last_traded_volume_;
     return snapshot;
@@ -289,16 +471,31 @@ public:
     std::lock_guard<std::mutex> lock(mtx_);
     bids_ = bids;
     asks_ = asks;
-    active_orders_ = active_orders;
-    // Clear toxicity metrics since we're restoring from checkpoint
+    active_orders_.clear();
+    active_orders_.reserve(active_orders.size());
+    bid_age_ = SideAge();
+    ask_age_ = SideAge();
+    uint64_t latest_ns = 0;
+    for (const auto &[id, order] : active_orders) {
+      active_orders_[id] = order;
+      side_age(order.side).add(order.volume, order.timestamp_ns);
+      latest_ns = std::max(latest_ns, order.timestamp_ns);
+    }
+    // Clear toxicity and event-history metrics since we're restoring from checkpoint
     bid_toxicity_.clear();
     ask_toxicity_.clear();
+    age_ = OrderAgeStats();
     // Recompute running totals from restored state
     total_bid_volume_ = 0;
     for (const auto& [p, v] : bids_) total_bid_volume_ += v;
     total_ask_volume_ = 0;
     for (const auto& [p, v] : asks_) total_ask_volume_ += v;
-    update_stats();
+    bid_ladder_ = xdp::DepthLadder(true);
+    ask_ladder_ = xdp::DepthLadder(false);
+    tick_micros_ = 0;
+    // update_stats only moves the last-update time forward
+    last_update_ns_ = 0;
+    update_stats(latest_ns);
   }
 
   // Thread-safe getters that return copies (snapshots) to avoid race conditions
@@ -317,11 +514,156 @@ public:
     return asks_;
   }
 
+  // Copy at most max_levels price levels per side (best first) without
+  // copying the whole ladder. Used for periodic depth sampling.
+  void get_top_levels(size_t max_levels,
+                      std::vector<std::pair<double, uint32_t>> &bids,
+                      std::vector<std::pair<double, uint32_t>> &asks) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    bids.clear();
+    asks.clear();
+    for (auto it = bids_.begin(); it != bids_.end() && bids.size() < max_levels; ++it) {
+      bids.emplace_back(it->first, it->second);
+    }
+    for (auto it = asks_.begin(); it != asks_.end() && asks.size() < max_levels; ++it) {
+      asks.emplace_back(it->first, it->second);
+    }
+  }
+
+  // Pull the order-table slot for order_id into cache ahead of a message
+  // that will touch it. Caller must own the book (no concurrent writers).
+  void prefetch_order(uint64_t order_id) const noexcept {
+    active_orders_.prefetch(order_id);
+  }
+
+  // Visible quantity resting at one price level (0 if the level is empty)
+  [[nodiscard]] uint32_t get_depth_at(double price, char side) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (side == 'B') {
+      auto it = bids_.find(price);
+      return it != bids_.end() ? it->second : 0;
+    }
+    auto it = asks_.find(price);
+    return it != asks_.end() ? it->second : 0;
+  }
+
+  // Visible quantity on one side within `ticks` ticks of its best price
+  // (0 = the touch only). O(log n) via the tick ladder.
+  [[nodiscard]] uint64_t depth_within_ticks(char side, int ticks) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return depth_within_ticks_locked(side, ticks);
+  }
+
+  // Visible quantity on one side priced within `bps` basis points of the mid
+  // (of the side's best price when the book is one-sided)
+  [[nodiscard]] uint64_t depth_within_bps(char side, double bps) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const double best_bid = best_bid_locked();
+    const double best_ask = best_ask_locked();
+    const double best = side == 'B' ? best_bid : best_ask;
+    if (best <= 0.0 || bps < 0.0) return 0;
+    const int64_t touch = touch_tick(best);
+    const xdp::DepthLadder &ladder = ladder_for(side, touch);
+    const double ref = (best_bid > 0.0 && best_ask > 0.0) ? (best_bid + best_ask) / 2.0 : best;
+    const double tick = static_cast<double>(tick_micros_);
+    int64_t n_ticks;
+    if (side == 'B') {
+      const double limit = ref * (1.0 - bps / 10000.0) * 1e6;
+      n_ticks = touch - static_cast<int64_t>(std::ceil(limit / tick - 1e-9));
+    } else {
+      const double limit = ref * (1.0 + bps / 10000.0) * 1e6;
+      n_ticks = static_cast<int64_t>(std::floor(limit / tick + 1e-9)) - touch;
+    }
+    if (n_ticks < 0) return 0;
+    return static_cast<uint64_t>(volume_out(side, ladder, touch, n_ticks));
+  }
+
+  // Cost of taking `qty` shares from one resting side ('S' for a buy,
+  // 'B' for a sell), walking levels outward from the touch
+  struct FillEstimate {
+    uint64_t filled = 0;      // Shares available, at most qty
+    double vwap = 0.0;        // Volume-weighted fill price (0 if none)
+    double worst_price = 0.0; // Furthest tick reached
+  };
+
+  [[nodiscard]] FillEstimate estimate_fill(char side, uint64_t qty) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return estimate_fill_locked(side, qty);
+  }
+
+  // Order-age features as of the last event (O(1), fixed-size copy)
+  [[nodiscard]] OrderAgeStats get_age_stats() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return age_stats_locked();
+  }
+
+  // Overload shedding: while set, per-level toxicity metrics are only
+  // updated for events at the best price of their side. Levels and every
+  // other statistic are unaffected.
+  void set_touch_analytics_only(bool on) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    touch_analytics_only_ = on;
+  }
+
+  // Cancels of orders younger than this count as fleeting (default 500us)
+  void set_fleeting_threshold_us(double us) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    fleeting_threshold_ns_ = static_cast<uint64_t>(us * 1000.0);
+  }
+
+  // Feed time of the most recent event applied to the book
+  [[nodiscard]] uint64_t last_update_ns() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return last_update_ns_;
+  }
+
   [[nodiscard]] double get_last_trade() const {
     std::lock_guard<std::mutex> lock(mtx_);
     return last_traded_price_;
   }
 
+  // Best levels, last trade and touch features (cross-symbol BBO table)
+  struct TopOfBook {
+    double bid = 0.0;
+    double ask = 0.0;
+    uint32_t bid_qty = 0;
+    uint32_t ask_qty = 0;
+    double last_price = 0.0;
+    uint32_t last_qty = 0;
+    double imbalance = 0.0;    // Whole-book depth imbalance
+    double bid_toxicity = 0.0; // Toxicity score of the best levels
+    double ask_toxicity = 0.0;
+  };
+
+  // Refresh `top` under one lock. Returns false, leaving it untouched, when
+  // the best prices, their sizes and the last trade are unchanged.
+  bool update_top(TopOfBook &top) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const double bid = best_bid_locked();
+    const double ask = best_ask_locked();
+    const uint32_t bid_qty = bids_.empty() ? 0 : bids_.begin()->second;
+    const uint32_t ask_qty = asks_.empty() ? 0 : asks_.begin()->second;
+    if (bid == top.bid && ask == top.ask && bid_qty == top.bid_qty && ask_qty == top.ask_qty &&
+        last_traded_price_ == top.last_price && last_traded_volume_ == top.last_qty) {
+      return false;
+    }
+    top.bid = bid;
+    top.ask = ask;
+    top.bid_qty = bid_qty;
+    top.ask_qty = ask_qty;
+    top.last_price = last_traded_price_;
+    top.last_qty = last_traded_volume_;
+    const double depth = static_cast<double>(total_bid_volume_) + static_cast<double>(total_ask_volume_);
+    top.imbalance = depth > 0.0 ? (static_cast<double>(total_bid_volume_) -
+                                   static_cast<double>(total_ask_volume_)) / depth
+                                : 0.0;
+    auto bt = bid_toxicity_.find(bid);
+    top.bid_toxicity = bt != bid_toxicity_.end() ? bt->second.get_toxicity_score() : 0.0;
+    auto at = ask_toxicity_.find(ask);
+    top.ask_toxicity = at != ask_toxicity_.end() ? at->second.get_toxicity_score() : 0.0;
+    return true;
+  }
+
   // Get toxicity score for a price level (0.0 to 1.0)
   [[nodiscard]] double get_toxicity(double price, char side) const {
     std::lock_guard<std::mutex> lock(mtx_);
@@ -374,26 +716,95 @@ public:
 private:
   std::map<double, uint32_t, std::greater<double>> bids_; // Price descending
   std::map<double, uint32_t, std::less<double>> asks_;    // Price ascending
-  std::unordered_map<uint64_t, Order> active_orders_;
+  xdp::FlatU64Map<Order> active_orders_;
   mutable std::mutex mtx_;
 
   double last_traded_price_ = 0.0;
   uint32_t last_traded_volume_ = 0;
-  std::chrono::system_clock::time_point last_update_;
+  uint64_t last_update_ns_ = 0; // Feed time of the last event
+
+  // Order-age state. Per side, resting volume and the sum of volume x
+  // arrival time (microseconds, mod 2^64: the difference now*V - sum is the
+  // exact volume-weighted age, which always fits) give the depth age in O(1).
+  struct SideAge {
+    uint64_t volume = 0;
+    uint64_t volume_time_us = 0;
+    void add(uint32_t v, uint64_t ts_ns) {
+      volume += v;
+      volume_time_us += static_cast<uint64_t>(v) * (ts_ns / 1000);
+    }
+    void remove(uint32_t v, uint64_t ts_ns) {
+      volume -= v;
+      volume_time_us -= static_cast<uint64_t>(v) * (ts_ns / 1000);
+    }
+    double mean_age_us(uint64_t now_ns) const {
+      if (volume == 0)
+        return 0.0;
+      const uint64_t weighted = volume * (now_ns / 1000) - volume_time_us;
+      return static_cast<double>(weighted) / static_cast<double>(volume);
+    }
+  };
+  SideAge bid_age_;
+  SideAge ask_age_;
+  OrderAgeStats age_;
+  uint64_t fleeting_threshold_ns_ = 500000;
+
+  SideAge &side_age(char side) { return side == 'B' ? bid_age_ : ask_age_; }
+
+  bool touch_analytics_only_ = false;
+
+  // Whether toxicity metrics are kept for an event at `price` (the level is
+  // already in the book)
+  bool tracks_level(char side, double price) const {
+    if (!touch_analytics_only_)
+      return true;
+    return side == 'B' ? bids_.begin()->first == price : asks_.begin()->first == price;
+  }
+
+  // An order leaves the book by cancel or full fill: drop its depth age and,
+  // if it rested at the touch, record how long it stayed
+  void record_leave(const Order &order, uint64_t age_ns) {
+    side_age(order.side).remove(order.volume, order.timestamp_ns);
+    const bool at_touch = order.side == 'B'
+        ? (!bids_.empty() && bids_.begin()->first == order.price)
+        : (!asks_.empty() && asks_.begin()->first == order.price);
+    if (at_touch) {
+      age_.touch_removals++;
+      age_.touch_rest_hist[OrderAgeStats::rest_bucket(age_ns)]++;
+    }
+  }
+
+  OrderAgeStats age_stats_locked() const {
+    OrderAgeStats a = age_;
+    a.bid_depth_age_us = bid_age_.mean_age_us(last_update_ns_);
+    a.ask_depth_age_us = ask_age_.mean_age_us(last_update_ns_);
+    return a;
+  }
 
   std::map<double, ToxicityMetrics, std::greater<double>> bid_toxicity_;
   std::map<double, ToxicityMetrics, std::less<double>> ask_toxicity_;
 
   BookStats stats_;
+  uint64_t version_ = 0; // Mutations applied (BookView::version)
 
   // Running totals for O(1) volume/level queries
   uint32_t total_bid_volume_ = 0;
   uint32_t total_ask_volume_ = 0;
 
+  // Per-tick volume/notional trees for O(log n) depth-at-distance queries,
+  // built lazily by the first query on each side. A ladder covers at most
+  // LADDER_SPAN_TICKS outward from the touch it was built at; levels beyond
+  // are read from the level map.
+  static constexpr int64_t LADDER_SPAN_TICKS = 2048;
+  mutable xdp::DepthLadder bid_ladder_{true};
+  mutable xdp::DepthLadder ask_ladder_{false};
+  mutable int64_t tick_micros_ = 0; // Ladder tick in 1e-6 price units (0 = unset)
+
   // Helper to remove volume from bids (updates running totals)
   void remove_volume_from_bids(double price, uint32_t volume) {
     auto it = bids_.find(price);
     if (it != bids_.end()) {
+      const uint32_t removed = std::min(it->second, volume);
       if (it->second <= volume) {
         total_bid_volume_ -= it->second;
         bids_.erase(it);
@@ -401,6 +812,7 @@ private:
         it->second -= volume;
         total_bid_volume_ -= volume;
       }
+      ladder_add('B', price, -static_cast<int64_t>(removed));
     }
   }
 
@@ -408,6 +820,7 @@ private:
   void remove_volume_from_asks(double price, uint32_t volume) {
     auto it = asks_.find(price);
     if (it != asks_.end()) {
+      const uint32_t removed = std::min(it->second, volume);
       if (it->second <= volume) {
         total_ask_volume_ -= it->second;
         asks_.erase(it);
@@ -415,6 +828,147 @@ private:
         it->second -= volume;
         total_ask_volume_ -= volume;
       }
+      ladder_add('S', price, -static_cast<int64_t>(removed));
+    }
+  }
+
+  // --- Tick ladder maintenance (caller holds mtx_) ---
+
+  double best_bid_locked() const { return bids_.empty() ? 0.0 : bids_.begin()->first; }
+  double best_ask_locked() const { return asks_.empty() ? 0.0 : asks_.begin()->first; }
+
+  static int64_t price_micros(double price) { return std::llround(price * 1e6); }
+
+  int64_t to_tick(double price) const {
+    return (price_micros(price) + tick_micros_ / 2) / tick_micros_;
+  }
+
+  // Mirror a level change into the side's ladder. The level map has already
+  // been updated. A tick past the window's far end stays in the map only; one
+  // on the touch side of the window is handled by a rebuild.
+  // Ladders are built on first query; until then this is a single branch.
+  void ladder_add(char side, double price, int64_t volume) {
+    xdp::DepthLadder &ladder = side == 'B' ? bid_ladder_ : ask_ladder_;
+    if (ladder.empty_window()) return;
+    const int64_t tick = to_tick(price);
+    if (!ladder.add(tick, volume, price_micros(price) * volume) && !ladder.past_far_end(tick)) {
+      rebuild_ladder(side);
+    }
+  }
+
+  // The side's ladder, (re)built from its level map unless it is active and
+  // covers the touch
+  const xdp::DepthLadder &ladder_for(char side, int64_t touch) const {
+    xdp::DepthLadder &ladder = side == 'B' ? bid_ladder_ : ask_ladder_;
+    if (!ladder.covers(touch)) rebuild_ladder(side);
+    return ladder;
+  }
+
+  // Volume from `touch` n_ticks outward: the ladder's share plus any levels
+  // past its far end
+  int64_t volume_out(char side, const xdp::DepthLadder &ladder, int64_t touch,
+                     int64_t n_ticks) const {
+    int64_t volume = ladder.volume_out(touch, n_ticks);
+    const int64_t limit = side == 'B' ? touch - n_ticks : touch + n_ticks;
+    if (!ladder.past_far_end(limit)) return volume;
+    auto add = [&](int64_t tick, double, uint32_t v) {
+      if (side == 'B' ? tick < limit : tick > limit) return false;
+      volume += v;
+      return true;
+    };
+    if (side == 'B') {
+      for_each_past_ladder(bids_, ladder, add);
+    } else {
+      for_each_past_ladder(asks_, ladder, add);
+    }
+    return volume;
+  }
+
+  // Slow path: visit levels past the ladder's far end, nearest first, while
+  // fn(tick, price, volume) returns true
+  template <typename Map, typename Fn>
+  void for_each_past_ladder(const Map &levels, const xdp::DepthLadder &ladder, Fn &&fn) const {
+    const double far_price = static_cast<double>(ladder.far_tick() * tick_micros_) * 1e-6;
+    for (auto it = levels.lower_bound(far_price); it != levels.end(); ++it) {
+      const int64_t tick = to_tick(it->first);
+      if (!ladder.past_far_end(tick)) continue;
+      if (!fn(tick, it->first, it->second)) return;
+    }
+  }
+
+  // Window from the touch out to the furthest level, capped at
+  // LADDER_SPAN_TICKS so a stub quote far from the market cannot size it
+  template <typename Map> void rebuild_ladder_from(xdp::DepthLadder &ladder, const Map &levels,
+                                                   bool descending) const {
+    if (levels.empty()) return;
+    const int64_t touch = to_tick(levels.begin()->first);
+    const int64_t furthest = to_tick(levels.rbegin()->first);
+    if (descending) {
+      ladder.reset(std::max(furthest, touch - LADDER_SPAN_TICKS + 1), touch);
+    } else {
+      ladder.reset(touch, std::min(furthest, touch + LADDER_SPAN_TICKS - 1));
+    }
+    for (const auto &[p, v] : levels) {
+      const int64_t tick = to_tick(p);
+      if (ladder.past_far_end(tick)) break;
+      ladder.add(tick, v, price_micros(p) * static_cast<int64_t>(v));
+    }
+  }
+
+  // Bodies of depth_within_ticks() and estimate_fill(), shared with publish_view()
+  uint64_t depth_within_ticks_locked(char side, int ticks) const {
+    const double best = side == 'B' ? best_bid_locked() : best_ask_locked();
+    if (best <= 0.0 || ticks < 0) return 0;
+    const int64_t touch = touch_tick(best);
+    return static_cast<uint64_t>(volume_out(side, ladder_for(side, touch), touch, ticks));
+  }
+
+  FillEstimate estimate_fill_locked(char side, uint64_t qty) const {
+    FillEstimate est;
+    const double best = side == 'B' ? best_bid_locked() : best_ask_locked();
+    if (best <= 0.0 || qty == 0) return est;
+    const int64_t touch = touch_tick(best);
+    const xdp::DepthLadder &ladder = ladder_for(side, touch);
+    const int64_t want = static_cast<int64_t>(qty);
+    auto w = ladder.walk(touch, want);
+    if (w.filled < want) {
+      // The rest lies past the ladder's window
+      auto take = [&](int64_t tick, double price, uint32_t volume) {
+        const int64_t n = std::min<int64_t>(volume, want - w.filled);
+        w.filled += n;
+        w.notional += price_micros(price) * n;
+        w.last_tick = tick;
+        return w.filled < want;
+      };
+      if (side == 'B') {
+        for_each_past_ladder(bids_, ladder, take);
+      } else {
+        for_each_past_ladder(asks_, ladder, take);
+      }
+    }
+    if (w.filled <= 0) return est;
+    est.filled = static_cast<uint64_t>(w.filled);
+    est.vwap = static_cast<double>(w.notional) / static_cast<double>(w.filled) * 1e-6;
+    est.worst_price = static_cast<double>(w.last_tick * tick_micros_) * 1e-6;
+    return est;
+  }
+
+  // Tick of a side's best price; the first ladder query fixes the tick size
+  int64_t touch_tick(double best) const {
+    if (tick_micros_ == 0) {
+      // Reg NMS tick: $0.01, or $0.0001 below $1.00
+      const double first = !bids_.empty() ? bids_.begin()->first
+                         : !asks_.empty() ? asks_.begin()->first : 1.0;
+      tick_micros_ = first < 1.0 ? 100 : 10000;
+    }
+    return to_tick(best);
+  }
+
+  void rebuild_ladder(char side) const {
+    if (side == 'B') {
+      rebuild_ladder_from(bid_ladder_, bids_, true);
+    } else {
+      rebuild_ladder_from(ask_ladder_, asks_, false);
     }
   }
 
@@ -449,7 +1003,11 @@ private:
     }
   }
 
-  void update_stats() {
+  void update_stats(uint64_t ts_ns) {
+    ++version_;
+    if (ts_ns > last_update_ns_)
+      last_update_ns_ = ts_ns;
+
     // Level counts and volumes from running totals (O(1))
     stats_.bid_levels = static_cast<int>(bids_.size());
     stats_.ask_levels = static_cast<int>(asks_.size());
@@ -467,7 +1025,5 @@ private:
       stats_.spread = 0.0;
       stats_.mid_price = 0.0;
     }
-
-    last_update_ = std::chrono::system_clock::now();
   }
 };
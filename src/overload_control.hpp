@@ -0,0 +1,231 @@
+#pragma once
+
+#include "common/duration_list.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mmsim {
+
+// =============================================================================
+// Overload control for paced replay (--replay-speed)
+//
+// Each worker (hybrid group, pool thread or the sequential loop) is one
+// shard. Its lag is how far behind the replay schedule it handles a packet:
+// wall time now minus the time the packet was due. Past configurable lag
+// thresholds the shard moves down the levels below (straight to the deepest
+// one whose threshold is crossed), shedding analytics work only. Book events
+// are always applied in full and in order.
+//
+//   NORMAL         everything runs
+//   SKIP_FEATURES  keep the last toxicity prediction; trade flow, spread and
+//                  momentum trackers stop updating
+//   CONFLATE       per-level toxicity analytics only at or inside the touch
+//   THROTTLE       quote updates at 1/throttle_factor of the normal rate
+//   HALT           virtual quotes pulled; fills and PnL accounting continue
+//
+// Recovery is one level at a time: a level is left once lag falls below
+// exit_ratio of its threshold and the shard has spent min_dwell in it, so a
+// noisy lag does not flap.
+// =============================================================================
+
+enum class DegradeLevel : uint8_t {
+  NORMAL = 0,
+  SKIP_FEATURES = 1,
+  CONFLATE = 2,
+  THROTTLE = 3,
+  HALT = 4,
+};
+
+constexpr size_t NUM_DEGRADE_LEVELS = 5;
+
+inline const char *degrade_level_name(DegradeLevel l) {
+  switch (l) {
+  case DegradeLevel::NORMAL: return "normal";
+  case DegradeLevel::SKIP_FEATURES: return "skip_features";
+  case DegradeLevel::CONFLATE: return "conflate";
+  case DegradeLevel::THROTTLE: return "throttle";
+  case DegradeLevel::HALT: return "halt";
+  }
+  return "?";
+}
+
+struct OverloadConfig {
+  double replay_speed = 0.0;  // Feed seconds per wall second (0 = unpaced, no control)
+  // Lag that enters SKIP_FEATURES, CONFLATE, THROTTLE and HALT
+  std::array<uint64_t, NUM_DEGRADE_LEVELS - 1> enter_lag_ns = {
+      1000000ULL, 5000000ULL, 20000000ULL, 100000000ULL};
+  double exit_ratio = 0.5;
+  uint64_t min_dwell_ns = 50000000ULL;  // 50 ms wall
+  uint32_t throttle_factor = 10;
+
+  [[nodiscard]] bool enabled() const { return replay_speed > 0.0; }
+
+  // Four increasing lags, e.g. 1ms,5ms,20ms,100ms
+  static bool parse_lags(const std::string &s, OverloadConfig &out, std::string &err) {
+    std::vector<uint64_t> lags;
+    if (!xdp::parse_duration_list(s, lags, err)) return false;
+    if (lags.size() != out.enter_lag_ns.size()) {
+      err = "want exactly " + std::to_string(out.enter_lag_ns.size()) + " lags";
+      return false;
+    }
+    for (size_t n = 0; n < lags.size(); ++n) {
+      if (n > 0 && lags[n] <= lags[n - 1]) {
+        err = "lags must increase";
+        return false;
+      }
+      out.enter_lag_ns[n] = lags[n];
+    }
+    return true;
+  }
+};
+
+struct ModeChange {
+  uint64_t wall_ns;  // Since the shard started
+  uint64_t feed_ns;  // Feed timestamp of the packet that triggered it
+  int64_t lag_ns;
+  DegradeLevel from;
+  DegradeLevel to;
+};
+
+// Paces one shard's packets to the replay schedule and runs its level state
+// machine. Owned by a single thread.
+class OverloadController {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit OverloadController(const OverloadConfig &config) : config_(&config) {}
+
+  // Forget the schedule (threaded mode: each file starts its own)
+  void restart_schedule() { scheduled_ = false; }
+
+  // Called once per packet before it is processed. Sleeps while the shard is
+  // ahead of schedule; returns the level to apply to the packet's messages.
+  DegradeLevel on_packet(uint64_t feed_ns) {
+    auto now = Clock::now();
+    if (!started_) {
+      started_ = true;
+      start_ = now;
+      level_since_ = now;
+    }
+    if (!scheduled_) {
+      scheduled_ = true;
+      base_wall_ = now;
+      base_feed_ = feed_ns;
+    }
+    const double feed_offset =
+        feed_ns > base_feed_ ? static_cast<double>(feed_ns - base_feed_) : 0.0;
+    const auto due = base_wall_ + std::chrono::nanoseconds(
+                                      static_cast<int64_t>(feed_offset / config_->replay_speed));
+    int64_t lag = std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count();
+    if (lag < -static_cast<int64_t>(SLEEP_SLACK_NS)) {
+      std::this_thread::sleep_until(due);
+      now = Clock::now();  // Dwell and mode changes are timed after the wait
+      lag = 0;
+    }
+    lag = std::max<int64_t>(lag, 0);
+    max_lag_ns_ = std::max(max_lag_ns_, static_cast<uint64_t>(lag));
+    step(now, feed_ns, lag);
+    packets_[static_cast<size_t>(level_)]++;
+    return level_;
+  }
+
+  [[nodiscard]] DegradeLevel level() const { return level_; }
+  [[nodiscard]] const std::vector<ModeChange> &changes() const { return changes_; }
+  [[nodiscard]] uint64_t max_lag_ns() const { return max_lag_ns_; }
+
+  // Packets handled at each level and wall time spent in each
+  [[nodiscard]] uint64_t packets_at(DegradeLevel l) const {
+    return packets_[static_cast<size_t>(l)];
+  }
+  [[nodiscard]] uint64_t wall_ns_at(DegradeLevel l) const {
+    uint64_t t = wall_at_[static_cast<size_t>(l)];
+    if (l == level_ && started_) {
+      t += static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - level_since_).count());
+    }
+    return t;
+  }
+
+private:
+  static constexpr uint64_t SLEEP_SLACK_NS = 200000;  // Ignore being <200us early
+
+  void step(Clock::time_point now, uint64_t feed_ns, int64_t lag) {
+    const auto cur = static_cast<size_t>(level_);
+    size_t next = cur;
+    // Escalate straight to the deepest level whose threshold is crossed
+    while (next + 1 < NUM_DEGRADE_LEVELS &&
+           static_cast<uint64_t>(lag) >= config_->enter_lag_ns[next]) {
+      ++next;
+    }
+    if (next == cur && cur > 0) {
+      const auto dwell = now - level_since_;
+      const double exit_lag = static_cast<double>(config_->enter_lag_ns[cur - 1]) * config_->exit_ratio;
+      if (static_cast<double>(lag) < exit_lag &&
+          dwell >= std::chrono::nanoseconds(config_->min_dwell_ns)) {
+        next = cur - 1;
+      }
+    }
+    if (next == cur) return;
+
+    wall_at_[cur] += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - level_since_).count());
+    level_since_ = now;
+    const auto to = static_cast<DegradeLevel>(next);
+    changes_.push_back(
+        {static_cast<uint64_t>(
+             std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_).count()),
+         feed_ns, lag, level_, to});
+    level_ = to;
+  }
+
+  const OverloadConfig *config_;
+  bool started_ = false;
+  bool scheduled_ = false;
+  Clock::time_point start_;
+  Clock::time_point base_wall_;
+  uint64_t base_feed_ = 0;
+  DegradeLevel level_ = DegradeLevel::NORMAL;
+  Clock::time_point level_since_;
+  std::vector<ModeChange> changes_;
+  std::array<uint64_t, NUM_DEGRADE_LEVELS> packets_{};
+  std::array<uint64_t, NUM_DEGRADE_LEVELS> wall_at_{};
+  uint64_t max_lag_ns_ = 0;
+};
+
+// One line per level: packets, wall time and entries
+inline void print_overload_summary(std::ostream &os, const OverloadController &c) {
+  std::array<uint64_t, NUM_DEGRADE_LEVELS> entries{};
+  for (const auto &m : c.changes()) entries[static_cast<size_t>(m.to)]++;
+  os << "  mode changes: " << c.changes().size() << ", max lag " << std::fixed
+     << std::setprecision(3) << static_cast<double>(c.max_lag_ns()) / 1e6 << " ms\n";
+  for (size_t l = 0; l < NUM_DEGRADE_LEVELS; ++l) {
+    const auto level = static_cast<DegradeLevel>(l);
+    os << "    " << std::left << std::setw(14) << degrade_level_name(level) << std::right
+       << std::setw(12) << c.packets_at(level) << " pkts " << std::setw(10)
+       << std::setprecision(3) << static_cast<double>(c.wall_ns_at(level)) / 1e9 << " s  "
+       << entries[l] << " entries\n";
+  }
+  os.unsetf(std::ios::floatfield);
+}
+
+// CSV rows: shard,wall_s,feed_ns,lag_us,from,to
+inline void write_overload_changes(std::ostream &out, const std::string &shard,
+                                   const OverloadController &c) {
+  for (const auto &m : c.changes()) {
+    out << shard << ',' << std::fixed << std::setprecision(6)
+        << static_cast<double>(m.wall_ns) / 1e9 << ',' << m.feed_ns << ','
+        << std::setprecision(1) << static_cast<double>(m.lag_ns) / 1e3 << ','
+        << degrade_level_name(m.from) << ',' << degrade_level_name(m.to) << '\n';
+    out.unsetf(std::ios::floatfield);
+  }
+}
+
+} // namespace mmsim
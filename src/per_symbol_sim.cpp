@@ -1,9 +1,11 @@
 #include "per_symbol_sim.hpp"
 
 #include "common/symbol_map.hpp"
+#include "symbol_pipeline.hpp"
 
 #include <algorithm>
 #include <cmath>
+#include <iostream>
 
 namespace mmsim {
 
@@ -46,6 +48,11 @@ void PerSymbolSim::ensure_init(uint32_t idx, const SimConfig& config) {
   mm_toxicity.set_ablation_mode(config.ablation_mode);
   mm_toxicity.set_epsilon_min(config.epsilon_min);
 
+  if (config.baskets) {
+    basket = config.baskets->basket_of_etf(idx);
+    if (basket >= 0) mm_toxicity.set_basket_skew(config.basket_skew);
+  }
+
   // Initialize online learning model with CLI params
   if (config.online_learning) {
     online_model = OnlineToxicityModel(config.learning_rate, config.warmup_fills);
@@ -55,6 +62,45 @@ void PerSymbolSim::ensure_init(uint32_t idx, const SimConfig& config) {
   if (config.filter_type == FilterType::EWMA) {
     ewma_filter = EWMAFilter(config.ewma_alpha, config.ewma_threshold_k, config.ewma_min_obs);
   }
+
+  if (config.plugin) {
+    plugin.symbol = config.plugin->open_symbol(idx, cached_ticker);
+    plugin.open = true;
+    plugin.events.reserve(PluginFeed::MAX_EVENTS);
+    mm_toxicity.set_external_quoting(true);
+  }
+
+  if (config.markout_horizons.count > 0) {
+    markouts.configure(&config.markout_horizons, !config.output_dir.empty());
+  }
+
+  if (!config.decision_log_dir.empty() && !cached_ticker.empty()) {
+    std::string path = config.decision_log_dir + "/" + cached_ticker;
+    if (config.decision_log_group > 0) {
+      path += ".g" + std::to_string(config.decision_log_group);
+    }
+    path += ".mmlog";
+    decision_log = std::make_unique<DecisionLogWriter>();
+    if (!decision_log->open(path, idx, cached_ticker, config.decision_log_group)) {
+      std::cerr << "Warning: cannot create decision log " << path << "\n";
+      decision_log.reset();
+    }
+  }
+}
+
+void PerSymbolSim::close_decision_log() {
+  if (decision_log) {
+    decision_log->close();
+  }
+}
+
+void PerSymbolSim::close_plugin() {
+  if (!plugin.open) return;
+  // Deliver what is still buffered (the last fills and trades)
+  if (!plugin.events.empty()) flush_plugin(plugin.events.back().ts_ns, false);
+  config_->plugin->close_symbol(plugin.symbol);
+  plugin.symbol = nullptr;
+  plugin.open = false;
 }
 
 uint64_t PerSymbolSim::sample_latency_ns() {
@@ -65,14 +111,12 @@ uint64_t PerSymbolSim::sample_latency_ns() {
 
 uint32_t PerSymbolSim::calculate_queue_position(double price, char side) {
   uint32_t visible_depth = 0;
-  if (side == 'B') {
-    auto bids = order_book.get_bids();
-    auto it = bids.find(price);
-    if (it != bids.end()) visible_depth = it->second;
+  if (book_view) {
+    bool known = true;
+    visible_depth = book_view->depth_at(price, side, known);
+    if (!known) view_depth_misses++;
   } else {
-    auto asks = order_book.get_asks();
-    auto it = asks.find(price);
-    if (it != asks.end()) visible_depth = it->second;
+    visible_depth = order_book.get_depth_at(price, side);
   }
 
   if (visible_depth == 0) return 0;
@@ -86,7 +130,7 @@ uint32_t PerSymbolSim::calculate_queue_position(double price, char side) {
 }
 
 bool PerSymbolSim::check_eligibility() const {
-  auto stats = order_book.get_stats();
+  auto stats = book_stats();
 
   // Need valid BBO
   if (stats.best_bid <= 0 || stats.best_ask <= 0) return false;
@@ -114,46 +158,33 @@ bool PerSymbolSim::check_risk_limits(SymbolRiskState& risk) const {
 ToxicityFeatureVector PerSymbolSim::build_feature_vector() const {
   ToxicityFeatureVector fv;
 
+  // Top levels and their metrics in one lock acquisition (or from the
+  // published view on a pipelined symbol)
+  OrderBook::BookView local;
+  if (!book_view) order_book.publish_view(local, 0);
+  const OrderBook::BookView& view = book_view ? *book_view : local;
+  const OrderBook::BookSnapshot& snap = view.snapshot;
+
   // Average the 5 order-book features across top 3 bid + 3 ask levels
-  constexpr int levels = 3;
   int count = 0;
-  auto bids = order_book.get_bids();
-  auto asks = order_book.get_asks();
 
   // Also accumulate cancel volume intensity across levels
   double total_vol_cancelled = 0.0;
   double total_vol_added = 0.0;
 
-  int bid_levels = 0;
-  for (const auto& [price, qty] : bids) {
-    if (bid_levels >= levels) break;
-    auto fr = order_book.get_feature_ratios(price, 'B');
+  auto add_level = [&](const OrderBook::ToxicityMetrics& tm) {
+    auto fr = tm.get_feature_ratios();
     fv.features[0] += fr.cancel_ratio;
     fv.features[1] += fr.ping_ratio;
     fv.features[2] += fr.odd_lot_ratio;
     fv.features[3] += fr.precision_ratio;
     fv.features[4] += fr.resistance_ratio;
-    auto tm = order_book.get_toxicity_metrics(price, 'B');
     total_vol_cancelled += tm.total_volume_cancelled;
     total_vol_added += tm.total_volume_added;
     count++;
-    bid_levels++;
-  }
-  int ask_levels = 0;
-  for (const auto& [price, qty] : asks) {
-    if (ask_levels >= levels) break;
-    auto fr = order_book.get_feature_ratios(price, 'S');
-    fv.features[0] += fr.cancel_ratio;
-    fv.features[1] += fr.ping_ratio;
-    fv.features[2] += fr.odd_lot_ratio;
-    fv.features[3] += fr.precision_ratio;
-    fv.features[4] += fr.resistance_ratio;
-    auto tm = order_book.get_toxicity_metrics(price, 'S');
-    total_vol_cancelled += tm.total_volume_cancelled;
-    total_vol_added += tm.total_volume_added;
-    count++;
-    ask_levels++;
-  }
+  };
+  for (int i = 0; i < snap.num_bid_levels; i++) add_level(view.bid_metrics[i]);
+  for (int i = 0; i < snap.num_ask_levels; i++) add_level(view.ask_metrics[i]);
   if (count > 0) {
     for (int i = 0; i < 5; i++) fv.features[i] /= count;
   }
@@ -164,7 +195,7 @@ ToxicityFeatureVector PerSymbolSim::build_feature_vector() const {
   fv.features[7] = momentum_tracker.get_momentum();
 
   // --- Structural features (book-wide) ---
-  auto stats = order_book.get_stats();
+  const auto& stats = snap.stats;
 
   // [8] Cancel volume intensity: volume_cancelled / volume_added
   fv.features[8] = (total_vol_added > 0)
@@ -172,11 +203,11 @@ ToxicityFeatureVector PerSymbolSim::build_feature_vector() const {
       : 0.0;
 
   // [9] Top-of-book concentration: avg fraction of total depth at best level
-  double bid_conc = (stats.total_bid_qty > 0 && !bids.empty())
-      ? static_cast<double>(bids.begin()->second) / static_cast<double>(stats.total_bid_qty)
+  double bid_conc = (stats.total_bid_qty > 0 && snap.num_bid_levels > 0)
+      ? static_cast<double>(snap.bid_levels[0].qty) / static_cast<double>(stats.total_bid_qty)
       : 0.0;
-  double ask_conc = (stats.total_ask_qty > 0 && !asks.empty())
-      ? static_cast<double>(asks.begin()->second) / static_cast<double>(stats.total_ask_qty)
+  double ask_conc = (stats.total_ask_qty > 0 && snap.num_ask_levels > 0)
+      ? static_cast<double>(snap.ask_levels[0].qty) / static_cast<double>(stats.total_ask_qty)
       : 0.0;
   fv.features[9] = (bid_conc + ask_conc) / 2.0;
 
@@ -198,23 +229,13 @@ ToxicityFeatureVector PerSymbolSim::build_feature_vector() const {
   // [13] Large order ratio: large_order_count / total_events across top levels
   double total_large = 0.0;
   double total_events_all = 0.0;
-  {
-    int lvl = 0;
-    for (const auto& [price, qty] : bids) {
-      if (lvl >= 3) break;
-      auto tm = order_book.get_toxicity_metrics(price, 'B');
-      total_large += tm.large_order_count;
-      total_events_all += tm.adds + tm.cancels;
-      lvl++;
-    }
-    lvl = 0;
-    for (const auto& [price, qty] : asks) {
-      if (lvl >= 3) break;
-      auto tm = order_book.get_toxicity_metrics(price, 'S');
-      total_large += tm.large_order_count;
-      total_events_all += tm.adds + tm.cancels;
-      lvl++;
-    }
+  for (int i = 0; i < snap.num_bid_levels; i++) {
+    total_large += view.bid_metrics[i].large_order_count;
+    total_events_all += view.bid_metrics[i].adds + view.bid_metrics[i].cancels;
+  }
+  for (int i = 0; i < snap.num_ask_levels; i++) {
+    total_large += view.ask_metrics[i].large_order_count;
+    total_events_all += view.ask_metrics[i].adds + view.ask_metrics[i].cancels;
   }
   fv.features[13] = (total_events_all > 0) ? total_large / total_events_all : 0.0;
 
@@ -226,11 +247,39 @@ ToxicityFeatureVector PerSymbolSim::build_feature_vector() const {
   return fv;
 }
 
+void PerSymbolSim::build_depth_features(double* out) const {
+  OrderBook::BookView local;
+  if (!book_view) order_book.publish_view(local, 0, true);
+  const OrderBook::BookView& view = book_view ? *book_view : local;
+  const OrderBook::BookSnapshot& snap = view.snapshot;
+  const double bid_near = static_cast<double>(view.bid_near_qty);
+  const double ask_near = static_cast<double>(view.ask_near_qty);
+
+  // [15] Top-of-book concentration over the near book
+  double bid_conc = (bid_near > 0 && snap.num_bid_levels > 0)
+      ? static_cast<double>(snap.bid_levels[0].qty) / bid_near
+      : 0.0;
+  double ask_conc = (ask_near > 0 && snap.num_ask_levels > 0)
+      ? static_cast<double>(snap.ask_levels[0].qty) / ask_near
+      : 0.0;
+  out[0] = (bid_conc + ask_conc) / 2.0;
+
+  // [16] Depth imbalance over the near book
+  out[1] = (bid_near + ask_near > 0) ? (bid_near - ask_near) / (bid_near + ask_near) : 0.0;
+
+  // [17] Round-trip cost of BookView::IMPACT_QTY shares / mid_price
+  const double mid = snap.stats.mid_price;
+  out[2] = (mid > 0 && view.buy_vwap > 0 && view.sell_vwap > 0)
+      ? (view.buy_vwap - view.sell_vwap) / mid
+      : 0.0;
+}
+
 void PerSymbolSim::measure_adverse_selection(std::vector<FillRecord>& fills,
                                               std::vector<FillRecord>* completed,
                                               SymbolRiskState& risk,
-                                              uint64_t now_ns) {
-  auto stats = order_book.get_stats();
+                                              uint64_t now_ns,
+                                              DecisionLogWriter* log) {
+  auto stats = book_stats();
   double current_mid = stats.mid_price;
 
   for (auto& fill : fills) {
@@ -260,6 +309,9 @@ void PerSymbolSim::measure_adverse_selection(std::vector<FillRecord>& fills,
       risk.total_adverse_pnl += fill.adverse_pnl;
       risk.adverse_fills++;
     }
+    if (log && fill.decision_record != UINT64_MAX) {
+      log->mark_fill_measured(fill.decision_record, fill.adverse_pnl);
+    }
 
     // Train online model: label = was there meaningful adverse selection?
     // Only train SGD for logistic filter; EWMA updates in update_quotes() instead.
@@ -327,36 +379,45 @@ void PerSymbolSim::update_virtual_order(VirtualOrder& vo, double price,
 
 void PerSymbolSim::update_quotes(uint64_t now_ns) {
   uint64_t quote_interval_ns = config_->exec.quote_update_interval_us * 1000;
+  if (degrade >= DegradeLevel::THROTTLE)
+    quote_interval_ns *= config_->overload.throttle_factor;
   if (now_ns - last_quote_update_ns < quote_interval_ns)
     return;
   last_quote_update_ns = now_ns;
 
+  CostScope strategy_scope(cost_sampling, CostBucket::STRATEGY);
+
   // Measure adverse selection on any pending fills
   // Pass completed vectors for CSV output when output directory is set
   auto* bc = config_->output_dir.empty() ? nullptr : &baseline_completed_fills;
   auto* tc = config_->output_dir.empty() ? nullptr : &toxicity_completed_fills;
   measure_adverse_selection(baseline_pending_fills, bc, baseline_risk, now_ns);
-  measure_adverse_selection(toxicity_pending_fills, tc, toxicity_risk, now_ns);
+  measure_adverse_selection(toxicity_pending_fills, tc, toxicity_risk, now_ns,
+                            decision_log.get());
 
   // Update spread and momentum trackers
-  {
-    auto book_stats = order_book.get_stats();
-    if (book_stats.spread > 0) spread_tracker.record_spread(book_stats.spread);
-    if (book_stats.mid_price > 0) momentum_tracker.record_mid(book_stats.mid_price);
+  if (degrade < DegradeLevel::SKIP_FEATURES) {
+    CostScope feature_scope(cost_sampling, CostBucket::FEATURE);
+    auto stats = book_stats();
+    if (stats.spread > 0) spread_tracker.record_spread(stats.spread);
+    if (stats.mid_price > 0) momentum_tracker.record_mid(stats.mid_price);
   }
 
   // End-of-day liquidation: MUST come before eligibility check.
   // By 15:50 ET, book depth thins out and symbols may fail eligibility —
-  // but we still need to force-close any open positions.
-  // Uses gmtime_r (UTC) since PCAP timestamps are Unix epoch.
-  // Aug 22 2023 is EDT: NYSE 15:50 ET = 19:50 UTC = 71400 seconds into UTC day
+  // but we still need to force-close any open positions. The cutoff
+  // (trade_end_ns) is the session's EOD time or --to, whichever is first;
+  // quoting resumes at trade_start_ns of the next session.
+  if (!session || now_ns >= session->day_end_ns || now_ns < session->day_start_ns) {
+    session = config_->calendar.find(now_ns);
+    eod_liquidated = false;
+  }
+  if (!session || now_ns < session->trade_start_ns) {
+    eligible_to_trade = false;
+    return;
+  }
   if (!eod_liquidated) {
-    uint64_t now_sec = now_ns / 1000000000ULL;
-    time_t t = static_cast<time_t>(now_sec);
-    struct tm tm_utc;
-    gmtime_r(&t, &tm_utc);
-    int seconds_into_utc_day = tm_utc.tm_hour * 3600 + tm_utc.tm_min * 60 + tm_utc.tm_sec;
-    if (seconds_into_utc_day >= 71400) {
+    if (now_ns >= session->trade_end_ns) {
       mm_baseline.force_close_position();
       mm_toxicity.force_close_position();
       eod_liquidated = true;
@@ -368,6 +429,13 @@ void PerSymbolSim::update_quotes(uint64_t now_ns) {
     return;
   }
 
+  // Overloaded shard: pull our quotes until it catches up
+  if (degrade == DegradeLevel::HALT) {
+    baseline_state.bid.live = baseline_state.ask.live = false;
+    toxicity_state.bid.live = toxicity_state.ask.live = false;
+    return;
+  }
+
   // Check eligibility and risk limits
   eligible_to_trade = check_eligibility();
   if (!eligible_to_trade) return;
@@ -399,13 +467,16 @@ void PerSymbolSim::update_quotes(uint64_t now_ns) {
   if (config_->walk_forward && config_->online_learning) {
     if (!wf_initialized) {
       wf_window_duration_ns = static_cast<uint64_t>(config_->wf_window_minutes) * 60ULL * 1000000000ULL;
-      wf_window_start_ns = now_ns;
+      current_wf_window = config_->calendar.bin_index(now_ns, wf_window_duration_ns);
+      wf_next_window_ns = config_->calendar.next_bin_ns(now_ns, wf_window_duration_ns);
       wf_initialized = true;
-      current_wf_window = 0;
     }
 
-    uint64_t elapsed = now_ns - wf_window_start_ns;
-    int new_window = static_cast<int>(elapsed / wf_window_duration_ns);
+    int new_window = current_wf_window;
+    if (now_ns >= wf_next_window_ns) {
+      new_window = config_->calendar.bin_index(now_ns, wf_window_duration_ns);
+      wf_next_window_ns = config_->calendar.next_bin_ns(now_ns, wf_window_duration_ns);
+    }
 
     if (new_window > current_wf_window) {
       // Snapshot current window's PnL before transition
@@ -433,7 +504,11 @@ void PerSymbolSim::update_quotes(uint64_t now_ns) {
   }
 
   // Feed toxicity prediction to toxicity strategy based on filter type
-  if (config_->filter_type == FilterType::EWMA) {
+  // (an overloaded shard keeps the last prediction)
+  CostScope feature_scope(cost_sampling, CostBucket::FEATURE);
+  if (degrade >= DegradeLevel::SKIP_FEATURES) {
+    // Skip feature recomputation
+  } else if (config_->filter_type == FilterType::EWMA) {
     auto fv = build_feature_vector();
     double cancel_ratio = fv.features[0];  // cancel_ratio is feature[0]
 
@@ -461,6 +536,16 @@ void PerSymbolSim::update_quotes(uint64_t now_ns) {
     double predicted_toxicity = online_model.predict_frozen(fv);
     mm_toxicity.set_override_toxicity(predicted_toxicity);
   }
+  feature_scope.end();
+
+  if (plugin.open) flush_plugin(now_ns, true);
+
+  double premium_bps = 0.0;
+  if (basket_premium_bps(premium_bps)) {
+    mm_toxicity.set_basket_premium(premium_bps);
+  } else if (basket >= 0) {
+    mm_toxicity.clear_basket_premium();
+  }
 
   mm_baseline.update_market_data();
   mm_toxicity.update_market_data();
@@ -472,6 +557,19 @@ void PerSymbolSim::update_quotes(uint64_t now_ns) {
   const MarketMakerQuote q_base = mm_baseline.get_current_quotes();
   const MarketMakerQuote q_tox = mm_toxicity.get_current_quotes();
 
+  if (decision_log) {
+    const QuoteDecision d = mm_toxicity.get_last_decision();
+    const double inventory = mm_toxicity.get_inventory();
+    if (d.suppressed) {
+      decision_log->log_suppress(now_ns, static_cast<SuppressReason>(d.reason),
+                                 d.expected_pnl, d.toxicity, inventory);
+    } else if (d.quoted) {
+      decision_log->log_quote(now_ns, q_tox.bid_price, q_tox.ask_price,
+                              q_tox.bid_size, q_tox.ask_size, d.toxicity,
+                              inventory);
+    }
+  }
+
   // Track queue resets: check if virtual order will change before updating
   auto check_reset = [](const VirtualOrder& vo, double price, uint32_t size) -> bool {
     return vo.live && (vo.price != price || vo.size != size);
@@ -494,12 +592,135 @@ void PerSymbolSim::update_quotes(uint64_t now_ns) {
                        'B', now_ns);
   update_virtual_order(toxicity_state.ask, q_tox.ask_price, q_tox.ask_size,
                        'S', now_ns);
+  if (latency) latency->quoted = xdp::read_cycles();
+}
+
+void PerSymbolSim::plugin_push_top(uint64_t now_ns) {
+  const auto stats = book_stats();
+  auto depth = [this](double price, char side) -> uint32_t {
+    if (price <= 0.0) return 0;
+    bool known = true;
+    return book_view ? book_view->depth_at(price, side, known)
+                     : order_book.get_depth_at(price, side);
+  };
+  const uint32_t bid_qty = depth(stats.best_bid, 'B');
+  const uint32_t ask_qty = depth(stats.best_ask, 'S');
+  if (stats.best_bid != plugin.bid || stats.best_ask != plugin.ask ||
+      bid_qty != plugin.bid_qty || ask_qty != plugin.ask_qty) {
+    plugin.bid = stats.best_bid;
+    plugin.ask = stats.best_ask;
+    plugin.bid_qty = bid_qty;
+    plugin.ask_qty = ask_qty;
+    mmsim_event& top = plugin.push(MMSIM_EVENT_TOP, now_ns);
+    top.bid = stats.best_bid;
+    top.ask = stats.best_ask;
+    top.bid_qty = bid_qty;
+    top.ask_qty = ask_qty;
+  }
+}
+
+void PerSymbolSim::plugin_on_trade(char resting_side, uint32_t exec_qty,
+                                   double exec_price, uint64_t now_ns) {
+  plugin_push_top(now_ns);
+  mmsim_event& trade = plugin.push(MMSIM_EVENT_TRADE, now_ns);
+  trade.price = exec_price;
+  trade.qty = exec_qty;
+  trade.side = resting_side;
+  if (plugin.full()) flush_plugin(now_ns, false);
+}
+
+void PerSymbolSim::plugin_on_fill(bool is_buy, double price, uint32_t qty,
+                                  uint64_t now_ns) {
+  mmsim_event& fill = plugin.push(MMSIM_EVENT_FILL, now_ns);
+  fill.price = price;
+  fill.qty = qty;
+  fill.side = is_buy ? 'B' : 'S';
+  if (plugin.full()) flush_plugin(now_ns, false);
+}
+
+void PerSymbolSim::flush_plugin(uint64_t now_ns, bool quoting) {
+  static_assert(N_TOXICITY_FEATURES + 3 == MMSIM_NUM_FEATURES,
+                "plugin features are ToxicityFeatureVector plus the depth features");
+
+  // A quoting batch always ends with the touch the intent will be worked
+  // against (adds, modifies and deletes only move it between batches)
+  if (quoting) plugin_push_top(now_ns);
+
+  const auto stats = mm_toxicity.get_stats();
+  mmsim_batch batch{};
+  batch.now_ns = now_ns;
+  batch.symbol_index = symbol_index;
+  batch.num_events = static_cast<uint32_t>(plugin.events.size());
+  batch.events = plugin.events.data();
+  batch.inventory = mm_toxicity.get_inventory();
+  batch.realized_pnl = stats.realized_pnl;
+  batch.unrealized_pnl = stats.unrealized_pnl;
+  batch.quoting = quoting;
+  batch.host = config_->plugin->host();
+
+  std::array<double, MMSIM_NUM_FEATURES> features{};
+  if (quoting && config_->plugin->wants_features() &&
+      degrade < DegradeLevel::SKIP_FEATURES) {
+    CostScope feature_scope(cost_sampling, CostBucket::FEATURE);
+    const ToxicityFeatureVector fv = build_feature_vector();
+    std::copy(fv.features.begin(), fv.features.end(), features.begin());
+    if (config_->plugin->wants_depth_features()) {
+      build_depth_features(features.data() + N_TOXICITY_FEATURES);
+    }
+    batch.features = features.data();
+  }
+
+  mmsim_quote_intent intent{};
+  const bool requote = config_->plugin->on_batch(plugin.symbol, batch, intent);
+  plugin.batches++;
+  plugin.events_delivered += plugin.events.size();
+  plugin.events.clear();
+  if (!quoting || !requote) return;
+
+  // Same validation a venue would apply: a side needs a positive price and
+  // size, and a crossed pair is rejected outright
+  MarketMakerQuote q;
+  if (std::isfinite(intent.bid_price) && intent.bid_price > 0.0 && intent.bid_size > 0) {
+    q.bid_price = intent.bid_price;
+    q.bid_size = intent.bid_size;
+  }
+  if (std::isfinite(intent.ask_price) && intent.ask_price > 0.0 && intent.ask_size > 0) {
+    q.ask_price = intent.ask_price;
+    q.ask_size = intent.ask_size;
+  }
+  if (q.bid_size > 0 && q.ask_size > 0 && q.bid_price >= q.ask_price) {
+    q = MarketMakerQuote{};
+    plugin.intents_rejected++;
+  }
+  plugin.intents++;
+  mm_toxicity.set_external_quotes(q);
+}
+
+void PerSymbolSim::publish_top(uint64_t now_ns) {
+  if (!order_book.update_top(published_top)) return;
+  if (config_->baskets && published_top.bid > 0.0 && published_top.ask > 0.0) {
+    config_->baskets->on_mid(symbol_index, (published_top.bid + published_top.ask) / 2.0);
+  }
+  if (!config_->bbo_table) return;
+  BboQuote q;
+  q.ts_ns = now_ns;
+  q.bid = published_top.bid;
+  q.ask = published_top.ask;
+  q.last_price = published_top.last_price;
+  q.bid_qty = published_top.bid_qty;
+  q.ask_qty = published_top.ask_qty;
+  q.last_qty = published_top.last_qty;
+  q.imbalance = static_cast<float>(published_top.imbalance);
+  q.bid_toxicity = static_cast<float>(published_top.bid_toxicity);
+  q.ask_toxicity = static_cast<float>(published_top.ask_toxicity);
+  config_->bbo_table->publish(symbol_index, q);
 }
 
 void PerSymbolSim::on_add(uint64_t order_id, double price, uint32_t volume,
                            char side, uint64_t now_ns) {
+  CostScope book_scope(book_cost_sampling, CostBucket::BOOK);
   order_info[order_id] = {side, price, volume, now_ns};
-  order_book.add_order(order_id, price, volume, side);
+  order_book.add_order(order_id, price, volume, side, now_ns);
 
   // Periodic cleanup of stale orders (every 60 seconds of market time)
   constexpr uint64_t CLEANUP_INTERVAL_NS = 60ULL * 1000000000ULL;  // 60 seconds
@@ -507,27 +728,29 @@ void PerSymbolSim::on_add(uint64_t order_id, double price, uint32_t volume,
   if (now_ns - last_cleanup_ns > CLEANUP_INTERVAL_NS) {
     last_cleanup_ns = now_ns;
     // Remove orders older than MAX_ORDER_AGE_NS
-    for (auto it = order_info.begin(); it != order_info.end(); ) {
-      if (now_ns - it->second.add_time_ns > MAX_ORDER_AGE_NS) {
-        it = order_info.erase(it);
-      } else {
-        ++it;
-      }
-    }
+    order_info.erase_if([&](uint64_t, const OrderInfo& info) {
+      return now_ns - info.add_time_ns > MAX_ORDER_AGE_NS;
+    });
   }
 }
 
-void PerSymbolSim::on_modify(uint64_t order_id, double price, uint32_t volume) {
-  auto it = order_info.find(order_id);
-  if (it != order_info.end()) {
+void PerSymbolSim::on_modify(uint64_t order_id, double price, uint32_t volume,
+                             uint64_t now_ns) {
+  CostScope book_scope(book_cost_sampling, CostBucket::BOOK);
+  OrderInfo* info = order_info.find(order_id);
+  if (info) {
     // If price changed, treat old price level as cancel for queue purposes
-    if (std::abs(it->second.price - price) > 0.0001) {
-      update_queue_on_cancel(it->second.price, it->second.volume, it->second.side);
+    if (std::abs(info->price - price) > 0.0001) {
+      if (pipeline) {
+        pipeline->publish_cancel(info->price, info->volume, info->side);
+      } else {
+        update_queue_on_cancel(info->price, info->volume, info->side);
+      }
     }
-    it->second.price = price;
-    it->second.volume = volume;
+    info->price = price;
+    info->volume = volume;
   }
-  order_book.modify_order(order_id, price, volume);
+  order_book.modify_order(order_id, price, volume, now_ns);
 }
 
 void PerSymbolSim::update_queue_on_cancel(double price, uint32_t volume, char side) {
@@ -548,29 +771,39 @@ void PerSymbolSim::update_queue_on_cancel(double price, uint32_t volume, char si
   update_vo(toxicity_state.ask, false);
 }
 
-void PerSymbolSim::on_delete(uint64_t order_id) {
-  auto it = order_info.find(order_id);
-  if (it != order_info.end()) {
+void PerSymbolSim::on_delete(uint64_t order_id, uint64_t now_ns) {
+  CostScope book_scope(book_cost_sampling, CostBucket::BOOK);
+  const OrderInfo* info = order_info.find(order_id);
+  if (info) {
     // Update queue positions before removing order info
-    update_queue_on_cancel(it->second.price, it->second.volume, it->second.side);
-    order_info.erase(it);
+    if (pipeline) {
+      pipeline->publish_cancel(info->price, info->volume, info->side);
+    } else {
+      update_queue_on_cancel(info->price, info->volume, info->side);
+    }
+    order_info.erase(order_id);
   }
-  order_book.delete_order(order_id);
+  order_book.delete_order(order_id, now_ns);
 }
 
 void PerSymbolSim::on_replace(uint64_t old_order_id, uint64_t new_order_id,
                                double price, uint32_t volume, char side,
                                uint64_t now_ns) {
-  auto it = order_info.find(old_order_id);
-  if (it != order_info.end()) {
+  CostScope book_scope(book_cost_sampling, CostBucket::BOOK);
+  const OrderInfo* info = order_info.find(old_order_id);
+  if (info) {
     // Old order leaving queue - update queue positions
-    update_queue_on_cancel(it->second.price, it->second.volume, it->second.side);
-    order_info.erase(it);
+    if (pipeline) {
+      pipeline->publish_cancel(info->price, info->volume, info->side);
+    } else {
+      update_queue_on_cancel(info->price, info->volume, info->side);
+    }
+    order_info.erase(old_order_id);
   }
   order_info[new_order_id] = {side, price, volume, now_ns};
 
-  order_book.delete_order(old_order_id);
-  order_book.add_order(new_order_id, price, volume, side);
+  order_book.delete_order(old_order_id, now_ns);
+  order_book.add_order(new_order_id, price, volume, side, now_ns);
 }
 
 void PerSymbolSim::try_fill_one(MarketMakerStrategy& mm, StrategyExecState& st,
@@ -636,9 +869,10 @@ void PerSymbolSim::try_fill_one(MarketMakerStrategy& mm, StrategyExecState& st,
 
   // Track inventory variance for hypothesis testing H3
   risk.update_inventory_variance(mm.get_inventory());
+  risk.fill_bins.add(session, now_ns, fill_qty);
 
   // Record fill for adverse selection measurement
-  auto stats = order_book.get_stats();
+  auto stats = book_stats();
   FillRecord record;
   record.fill_time_ns = now_ns;
   record.fill_price = vo.price;
@@ -661,11 +895,25 @@ void PerSymbolSim::try_fill_one(MarketMakerStrategy& mm, StrategyExecState& st,
   auto mm_stats = mm.get_stats();
   record.cumulative_pnl = mm_stats.realized_pnl + mm_stats.unrealized_pnl + risk.total_adverse_pnl;
 
+  if (decision_log && &mm == &mm_toxicity) {
+    record.decision_record = decision_log->log_fill(
+        now_ns, is_bid_side, vo.price, fill_qty, stats.mid_price,
+        record.toxicity_at_fill, mm.get_inventory());
+  }
+
+  markouts.schedule(&mm == &mm_toxicity ? 1 : 0, now_ns, vo.price, fill_qty,
+                    is_bid_side, stats.mid_price);
   pending_fills.push_back(record);
+
+  if (plugin.open && &mm == &mm_toxicity) {
+    plugin_on_fill(is_bid_side, vo.price, fill_qty, now_ns);
+  }
 }
 
 void PerSymbolSim::maybe_fill_on_execution(char resting_side, double exec_price,
                                             uint32_t exec_qty, uint64_t now_ns) {
+  CostScope strategy_scope(cost_sampling, CostBucket::STRATEGY);
+
   // Try fills with EXISTING virtual orders first (before updating them).
   // In real trading, resting orders are already on the exchange when an
   // execution happens — the fill check should use the current state.
@@ -691,25 +939,22 @@ void PerSymbolSim::maybe_fill_on_execution(char resting_side, double exec_price,
   update_quotes(now_ns);
 }
 
-void PerSymbolSim::on_execute(uint64_t order_id, uint32_t exec_qty,
-                               double exec_price, uint64_t now_ns) {
+void PerSymbolSim::strategy_on_execute(char resting_side, uint32_t exec_qty,
+                                       double exec_price, uint64_t now_ns) {
   diag_baseline.exec_total++;
   diag_toxicity.exec_total++;
 
-  auto it = order_info.find(order_id);
-  if (it != order_info.end()) {
-    // Feed trade flow tracker with execution side
-    bool is_buy = (it->second.side == 'B');
-    trade_flow.record_trade(is_buy, exec_qty);
-
-    maybe_fill_on_execution(it->second.side, exec_price, exec_qty, now_ns);
+  if (plugin.open) plugin_on_trade(resting_side, exec_qty, exec_price, now_ns);
 
-    // Update volume tracking (partial fills reduce remaining volume)
-    if (it->second.volume > exec_qty) {
-      it->second.volume -= exec_qty;
-    } else {
-      order_info.erase(it);
+  if (resting_side) {
+    // Feed trade flow tracker with execution side
+    bool is_buy = (resting_side == 'B');
+    if (degrade < DegradeLevel::SKIP_FEATURES) {
+      CostScope feature_scope(cost_sampling, CostBucket::FEATURE);
+      trade_flow.record_trade(is_buy, exec_qty);
     }
+
+    maybe_fill_on_execution(resting_side, exec_price, exec_qty, now_ns);
   } else {
     diag_baseline.exec_no_order_info++;
     diag_toxicity.exec_no_order_info++;
@@ -719,8 +964,31 @@ void PerSymbolSim::on_execute(uint64_t order_id, uint32_t exec_qty,
     maybe_fill_on_execution('B', exec_price, exec_qty, now_ns);
     maybe_fill_on_execution('S', exec_price, exec_qty, now_ns);
   }
+}
+
+void PerSymbolSim::on_execute(uint64_t order_id, uint32_t exec_qty,
+                               double exec_price, uint64_t now_ns) {
+  CostScope book_scope(book_cost_sampling, CostBucket::BOOK);
+
+  // Strategy work sees the book before the execution is applied
+  OrderInfo* info = order_info.find(order_id);
+  const char resting_side = info ? info->side : 0;
+  if (pipeline) {
+    pipeline->publish_execution(resting_side, exec_qty, exec_price, now_ns);
+  } else {
+    strategy_on_execute(resting_side, exec_qty, exec_price, now_ns);
+  }
+
+  if (info) {
+    // Update volume tracking (partial fills reduce remaining volume)
+    if (info->volume > exec_qty) {
+      info->volume -= exec_qty;
+    } else {
+      order_info.erase(order_id);
+    }
+  }
 
-  order_book.execute_order(order_id, exec_qty, exec_price);
+  order_book.execute_order(order_id, exec_qty, exec_price, now_ns);
 }
 
 } // namespace mmsim
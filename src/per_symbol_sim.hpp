@@ -1,19 +1,27 @@
 #pragma once
 
+#include "common/flat_u64_map.hpp"
+#include "cost_profile.hpp"
+#include "decision_log.hpp"
 #include "execution_model.hpp"
 #include "feature_trackers.hpp"
+#include "latency_trace.hpp"
 #include "market_maker.hpp"
+#include "markout.hpp"
 #include "order_book.hpp"
 #include "sim_types.hpp"
+#include "strategy_plugin.hpp"
 
 #include <cstdint>
+#include <memory>
 #include <random>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace mmsim {
 
+class SymbolPipeline;
+
 // Per-symbol simulation state: shared order book, dual strategies,
 // feature trackers, risk tracking, and fill management.
 struct PerSymbolSim {
@@ -28,7 +36,7 @@ struct PerSymbolSim {
     uint32_t volume;
     uint64_t add_time_ns;  // Track when order was added for cleanup
   };
-  std::unordered_map<uint64_t, OrderInfo> order_info;
+  xdp::FlatU64Map<OrderInfo> order_info;
   uint64_t last_cleanup_ns = 0;
 
   bool initialized = false;
@@ -55,6 +63,9 @@ struct PerSymbolSim {
   std::vector<FillRecord> baseline_completed_fills;
   std::vector<FillRecord> toxicity_completed_fills;
 
+  // Multi-horizon markouts of both strategies' fills (--markouts)
+  MarkoutEngine markouts;
+
   // Online learning feature trackers and model
   OnlineToxicityModel online_model;
   EWMAFilter ewma_filter;
@@ -62,10 +73,11 @@ struct PerSymbolSim {
   SpreadTracker spread_tracker;
   MomentumTracker momentum_tracker;
 
-  // Walk-forward analysis state (per-symbol window tracking)
+  // Walk-forward analysis state (per-symbol window tracking). Windows are
+  // calendar bins anchored at the session open (SessionCalendar::bin_index).
   int current_wf_window = 0;
-  uint64_t wf_window_start_ns = 0;
   uint64_t wf_window_duration_ns = 0;
+  uint64_t wf_next_window_ns = 0;  // Start of the window after current_wf_window
   bool wf_initialized = false;
 
   // Per-window metrics for walk-forward reporting
@@ -95,18 +107,93 @@ struct PerSymbolSim {
   FillDiagnostics diag_baseline;
   FillDiagnostics diag_toxicity;
 
-  // End-of-day liquidation state
+  // Session the last quote update fell in (config_->calendar) and its
+  // end-of-day liquidation state. Rolling into the next session re-arms it.
+  const xdp::TradingSession* session = nullptr;
   bool eod_liquidated = false;
 
   // Per-symbol blacklisting: stop trading after persistent losses
   bool blacklisted = false;
   int64_t blacklist_check_fills = 0;  // Fills at last blacklist check
 
+  // Toxicity strategy decision log (only when --decision-log is set)
+  std::unique_ptr<DecisionLogWriter> decision_log;
+
+  // Sampled CPU cost accounting. `cost_sampling` points at `cost` while the
+  // dispatcher is timing the current message and is null otherwise. Book
+  // handlers time into `book_cost_sampling` instead: the two only differ for
+  // pipelined symbols, whose strategy code runs on the pipeline's thread.
+  SymbolCost cost;
+  SymbolCost* cost_sampling = nullptr;
+  SymbolCost* book_cost_sampling = nullptr;
+
+  // Stamps of the message being latency traced (--latency-hist), else null
+  LatencyTrace* latency = nullptr;
+
+  // Overload level of the shard processing this symbol (--replay-speed)
+  DegradeLevel degrade = DegradeLevel::NORMAL;
+
+  // Top of book last published to config_->bbo_table and config_->baskets
+  OrderBook::TopOfBook published_top;
+
+  // Basket this symbol is the ETF of (config_->baskets), else -1
+  int32_t basket = -1;
+
+  // Events for the strategy plugin (config_->plugin), which quotes in
+  // mm_toxicity's place when loaded
+  PluginFeed plugin;
+
   // Pointer to runtime configuration (set during ensure_init)
   const SimConfig* config_ = nullptr;
 
+  // Two-stage pipeline (symbol_pipeline.hpp). When set, book handlers only
+  // mutate the book and hand strategy work to the pipeline's strategy
+  // thread, which reads the book through `book_view` instead of the live
+  // order_book. `view_depth_misses` counts queue-position lookups at prices
+  // deeper than the view kept (treated as an empty level).
+  SymbolPipeline* pipeline = nullptr;
+  const OrderBook::BookView* book_view = nullptr;
+  uint64_t view_depth_misses = 0;
+
   PerSymbolSim();
 
+  // Hint the order-table slots a message for order_id will touch into cache.
+  // Only valid while no other thread can mutate this symbol.
+  void prefetch_order(uint64_t order_id) const {
+    order_info.prefetch(order_id);
+    order_book.prefetch_order(order_id);
+  }
+
+  // Apply the shard's overload level before a message is dispatched
+  void set_degrade(DegradeLevel level) {
+    if (level == degrade) return;
+    degrade = level;
+    order_book.set_touch_analytics_only(level >= DegradeLevel::CONFLATE);
+  }
+
+  // A plugin takes features 15-17, so published views must carry the
+  // near-book queries
+  bool wants_depth_features() const {
+    return config_ && config_->plugin && config_->plugin->wants_depth_features();
+  }
+
+  // Point strategy-side book reads at a published view (nullptr = live book)
+  void set_book_view(const OrderBook::BookView* view) {
+    book_view = view;
+    mm_baseline.set_book_view(view ? &view->snapshot : nullptr);
+    mm_toxicity.set_book_view(view ? &view->snapshot : nullptr);
+  }
+
+  OrderBook::BookStats book_stats() const {
+    return book_view ? book_view->snapshot.stats : order_book.get_stats();
+  }
+
+  // Mark fills whose markout horizons the feed has passed. Called before
+  // each event is applied (pipelined symbols: see SymbolPipeline MARK).
+  void advance_markouts(uint64_t now_ns) {
+    if (now_ns > markouts.next_due_ns()) markouts.expire(now_ns, book_stats().mid_price);
+  }
+
   // Initialize simulation state for a given symbol index
   void ensure_init(uint32_t idx, const SimConfig& config);
 
@@ -125,11 +212,18 @@ struct PerSymbolSim {
   // Build current feature vector from order book and trackers
   ToxicityFeatureVector build_feature_vector() const;
 
+  // Plugin features 15-17 (strategy_plugin.h) from the book's tick ladders
+  void build_depth_features(double* out) const;
+
   // Measure adverse selection on pending fills
   void measure_adverse_selection(std::vector<FillRecord>& fills,
                                   std::vector<FillRecord>* completed,
                                   SymbolRiskState& risk,
-                                  uint64_t now_ns);
+                                  uint64_t now_ns,
+                                  DecisionLogWriter* log = nullptr);
+
+  // Flush and close the decision log (explicit: forked workers _exit)
+  void close_decision_log();
 
   // Check if a fill is eligible at the given price
   bool eligible_for_fill(double quote_px, double exec_px,
@@ -139,14 +233,42 @@ struct PerSymbolSim {
   void update_virtual_order(VirtualOrder& vo, double price, uint32_t size,
                             char side, uint64_t now_ns);
 
+  // Publish the top of book to the cross-symbol table and the mid to the
+  // basket engine if it changed. Called by whoever applies this symbol's
+  // book events.
+  void publish_top(uint64_t now_ns);
+
+  // Premium of this ETF to its basket NAV; false if it is not an ETF or the
+  // basket is not fully priced yet
+  bool basket_premium_bps(double& out) const {
+    return basket >= 0 && config_->baskets->etf_premium_bps(symbol_index, out);
+  }
+
   // Periodic quote update and adverse selection measurement
   void update_quotes(uint64_t now_ns);
 
+  // Strategy plugin events: a TOP event if the best prices or sizes moved
+  // since the last one (before each execution and each quoting batch), a
+  // feed execution and a plugin fill
+  void plugin_push_top(uint64_t now_ns);
+  void plugin_on_trade(char resting_side, uint32_t exec_qty, double exec_price,
+                       uint64_t now_ns);
+  void plugin_on_fill(bool is_buy, double price, uint32_t qty, uint64_t now_ns);
+
+  // Hand the buffered events to the plugin. With `quoting` its intent
+  // becomes mm_toxicity's quotes.
+  void flush_plugin(uint64_t now_ns, bool quoting);
+
+  // Deliver buffered events in a last non-quoting batch and release the
+  // plugin's per-symbol state (explicit: forked workers _exit)
+  void close_plugin();
+
   // Order book event handlers
   void on_add(uint64_t order_id, double price, uint32_t volume, char side,
               uint64_t now_ns);
-  void on_modify(uint64_t order_id, double price, uint32_t volume);
-  void on_delete(uint64_t order_id);
+  void on_modify(uint64_t order_id, double price, uint32_t volume,
+                 uint64_t now_ns);
+  void on_delete(uint64_t order_id, uint64_t now_ns);
   void on_replace(uint64_t old_order_id, uint64_t new_order_id, double price,
                   uint32_t volume, char side, uint64_t now_ns);
   void on_execute(uint64_t order_id, uint32_t exec_qty, double exec_price,
@@ -155,6 +277,11 @@ struct PerSymbolSim {
   // Helper to update queue positions when orders at our quote price cancel
   void update_queue_on_cancel(double price, uint32_t volume, char side);
 
+  // Strategy half of an execution: trade flow, fills and quote update.
+  // `resting_side` is 0 when the executed order is not tracked.
+  void strategy_on_execute(char resting_side, uint32_t exec_qty,
+                           double exec_price, uint64_t now_ns);
+
   // Attempt to fill one side of a strategy
   void try_fill_one(MarketMakerStrategy& mm, StrategyExecState& st,
                     std::vector<FillRecord>& pending_fills,
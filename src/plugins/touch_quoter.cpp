@@ -0,0 +1,123 @@
+// touch_quoter.cpp - Example market_maker_sim strategy plugin
+// Joins the best bid and offer, stops adding to a position past a limit, and
+// steps back from the touch while the book's cancel ratio is high. With
+// lead=TICKER it also leans one tick in the direction the lead symbol's mid
+// moved since the previous quote, read through mmsim_batch.host. Built as a
+// shared object against strategy_plugin.h only; load it with
+//   market_maker_sim --strategy-plugin libtouch_quoter.so
+//                    --plugin-args "size=200,max_position=600,max_cancel_ratio=0.8"
+
+#include "strategy_plugin.h"
+
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+struct Params {
+  uint32_t size = 200;             // Shares per side
+  double max_position = 600.0;     // Stop adding beyond this many shares
+  double max_cancel_ratio = 0.8;   // Back off one tick above this
+  double tick = 0.01;
+  std::string lead;                // Ticker to lean with (empty = off)
+};
+
+struct SymbolState {
+  const Params *params;  // Shared, read-only after create()
+  double bid = 0.0;
+  double ask = 0.0;
+  uint32_t lead_index = 0;  // Resolved at the first batch
+  double lead_mid = 0.0;    // At the previous quoting batch
+};
+
+// "key=value,key=value"; unknown keys are ignored
+void parse_args(const char *args, Params &p) {
+  std::string s = args ? args : "";
+  size_t pos = 0;
+  while (pos < s.size()) {
+    size_t end = s.find(',', pos);
+    if (end == std::string::npos) end = s.size();
+    const std::string item = s.substr(pos, end - pos);
+    const size_t eq = item.find('=');
+    if (eq != std::string::npos) {
+      const std::string key = item.substr(0, eq);
+      const char *value = item.c_str() + eq + 1;
+      if (key == "size") p.size = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+      else if (key == "max_position") p.max_position = std::strtod(value, nullptr);
+      else if (key == "max_cancel_ratio") p.max_cancel_ratio = std::strtod(value, nullptr);
+      else if (key == "tick") p.tick = std::strtod(value, nullptr);
+      else if (key == "lead") p.lead = value;
+    }
+    pos = end + 1;
+  }
+}
+
+void *create(const char *args) {
+  auto *p = new Params;
+  parse_args(args, *p);
+  return p;
+}
+
+void destroy(void *plugin) { delete static_cast<Params *>(plugin); }
+
+void *open_symbol(void *plugin, uint32_t, const char *) {
+  return new SymbolState{static_cast<const Params *>(plugin)};
+}
+
+void close_symbol(void *, void *symbol) { delete static_cast<SymbolState *>(symbol); }
+
+int on_batch(void *symbol, const mmsim_batch *batch, mmsim_quote_intent *intent) {
+  auto *st = static_cast<SymbolState *>(symbol);
+  for (uint32_t i = 0; i < batch->num_events; ++i) {
+    const mmsim_event &ev = batch->events[i];
+    if (ev.type == MMSIM_EVENT_TOP) {
+      st->bid = ev.bid;
+      st->ask = ev.ask;
+    }
+  }
+  if (!batch->quoting || st->bid <= 0.0 || st->ask <= 0.0) return MMSIM_KEEP_QUOTES;
+
+  const Params &p = *st->params;
+  double bid = st->bid;
+  double ask = st->ask;
+  if (batch->features && batch->features[0] > p.max_cancel_ratio) {
+    bid -= p.tick;
+    ask += p.tick;
+  }
+  if (batch->host && !p.lead.empty()) {
+    if (st->lead_index == 0) st->lead_index = batch->host->symbol_index(p.lead.c_str());
+    mmsim_top top;
+    if (st->lead_index && st->lead_index != batch->symbol_index &&
+        batch->host->read_top(st->lead_index, &top) && top.bid > 0.0 && top.ask > 0.0) {
+      const double mid = (top.bid + top.ask) / 2.0;
+      if (st->lead_mid > 0.0 && mid != st->lead_mid) {
+        const double lean = mid > st->lead_mid ? p.tick : -p.tick;
+        bid += lean;
+        ask += lean;
+      }
+      st->lead_mid = mid;
+    }
+  }
+  intent->bid_price = bid;
+  intent->ask_price = ask;
+  intent->bid_size = batch->inventory < p.max_position ? p.size : 0;
+  intent->ask_size = batch->inventory > -p.max_position ? p.size : 0;
+  return MMSIM_NEW_QUOTES;
+}
+
+const mmsim_strategy_plugin PLUGIN = {
+    MMSIM_PLUGIN_ABI_VERSION,
+    MMSIM_PLUGIN_WANTS_FEATURES | MMSIM_PLUGIN_READS_TOPS,
+    "touch_quoter",
+    create,
+    destroy,
+    open_symbol,
+    close_symbol,
+    on_batch,
+};
+
+} // namespace
+
+extern "C" __attribute__((visibility("default"))) const mmsim_strategy_plugin *mmsim_plugin_entry(void) {
+  return &PLUGIN;
+}
@@ -0,0 +1,306 @@
+#pragma once
+
+#include "markout.hpp"
+#include "sim_types.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace mmsim {
+
+// =============================================================================
+// Run results
+//
+// ProcessResults is what one simulator process (a hybrid group, one day of a
+// --batch run or one --shard) reports back: summed PnL, fills and diagnostics
+// over its eligible symbols, pooled inventory moments, fills per half hour
+// and merged markout curves. Hybrid children write it into shared memory;
+// batch days and shards also save it as a "<name> <value>" text file so runs
+// can be re-aggregated or merged later without rerunning.
+//
+// Every field is a sum except three per-symbol averages (the inventory
+// variances and the final |inventory|), which merge weighted by the symbols
+// behind them, and the inventory moments, which merge with the pairwise
+// Welford update. Merging the same results in the same order always gives
+// the same bits.
+// =============================================================================
+
+// Welford mean and M2 of inventory samples, mergeable across symbols and runs
+struct InventoryMoments {
+  int64_t n = 0;
+  double mean = 0.0;
+  double m2 = 0.0;
+
+  void merge(int64_t on, double omean, double om2) {
+    if (on == 0) return;
+    const int64_t total = n + on;
+    const double delta = omean - mean;
+    mean += delta * static_cast<double>(on) / static_cast<double>(total);
+    m2 += om2 + delta * delta * static_cast<double>(n) * static_cast<double>(on) /
+                    static_cast<double>(total);
+    n = total;
+  }
+  void merge(const InventoryMoments& o) { merge(o.n, o.mean, o.m2); }
+
+  [[nodiscard]] double variance() const { return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0; }
+};
+
+// Shared memory structure for inter-process result aggregation
+struct ProcessResults {
+  double baseline_pnl;
+  double toxicity_pnl;
+  double adverse_pnl;
+  double baseline_adverse_pnl;  // For hypothesis testing H2
+  double baseline_inv_variance; // For hypothesis testing H3
+  double toxicity_inv_variance; // For hypothesis testing H3
+  int64_t baseline_fills;
+  int64_t toxicity_fills;
+  int64_t quotes_suppressed;
+  int64_t adverse_fills;
+  int64_t baseline_adverse_fills;  // For hypothesis testing H2
+  uint64_t packets_processed;
+  uint64_t messages_processed;
+  uint64_t symbols_active;
+  // Unwind stats
+  int64_t baseline_unwind_crosses;
+  int64_t toxicity_unwind_crosses;
+  double baseline_unwind_cost;
+  double toxicity_unwind_cost;
+  // PnL decomposition
+  double toxicity_realized_pnl;
+  double toxicity_unrealized_pnl;
+  double baseline_realized_pnl;
+  double baseline_unrealized_pnl;
+  // Symbol-level diagnostics
+  int64_t symbols_eod_liquidated;
+  int64_t symbols_blacklisted;
+  int64_t symbols_one_sided;         // Only buys or only sells
+  int64_t symbols_with_fills;
+  int64_t toxicity_buy_fills;
+  int64_t toxicity_sell_fills;
+  int64_t baseline_buy_fills;
+  int64_t baseline_sell_fills;
+  double avg_final_abs_inventory;
+  // Fill pipeline diagnostics (toxicity strategy)
+  uint64_t diag_exec_total;
+  uint64_t diag_exec_no_order_info;
+  uint64_t diag_exec_not_eligible;
+  uint64_t diag_try_fill_calls;
+  uint64_t diag_rejected_halted;
+  uint64_t diag_rejected_not_live;
+  uint64_t diag_rejected_latency;
+  uint64_t diag_rejected_price;
+  uint64_t diag_rejected_queue;
+  uint64_t diag_fill_succeeded;
+  uint64_t diag_quote_resets;
+  // Symbols behind the inventory variance averages
+  int64_t inv_variance_symbols;
+  // Every inventory sample of every symbol, pooled
+  InventoryMoments baseline_inventory;
+  InventoryMoments toxicity_inventory;
+  FillTimeBins baseline_fill_bins;
+  FillTimeBins toxicity_fill_bins;
+  // Markout curves (--markouts)
+  MarkoutHorizons markout_horizons;
+  MarkoutCurves markouts;
+  bool completed;
+  char padding[7];  // Align to 8 bytes
+};
+
+// Calls f(name, field of each rs...) for every scalar field, in file order;
+// each R is ProcessResults or const ProcessResults.
+template <typename F, typename... R>
+void for_each_result_field(F&& f, R&... rs) {
+  f("baseline_pnl", rs.baseline_pnl...);
+  f("toxicity_pnl", rs.toxicity_pnl...);
+  f("adverse_pnl", rs.adverse_pnl...);
+  f("baseline_adverse_pnl", rs.baseline_adverse_pnl...);
+  f("baseline_inv_variance", rs.baseline_inv_variance...);
+  f("toxicity_inv_variance", rs.toxicity_inv_variance...);
+  f("baseline_fills", rs.baseline_fills...);
+  f("toxicity_fills", rs.toxicity_fills...);
+  f("quotes_suppressed", rs.quotes_suppressed...);
+  f("adverse_fills", rs.adverse_fills...);
+  f("baseline_adverse_fills", rs.baseline_adverse_fills...);
+  f("packets_processed", rs.packets_processed...);
+  f("messages_processed", rs.messages_processed...);
+  f("symbols_active", rs.symbols_active...);
+  f("baseline_unwind_crosses", rs.baseline_unwind_crosses...);
+  f("toxicity_unwind_crosses", rs.toxicity_unwind_crosses...);
+  f("baseline_unwind_cost", rs.baseline_unwind_cost...);
+  f("toxicity_unwind_cost", rs.toxicity_unwind_cost...);
+  f("toxicity_realized_pnl", rs.toxicity_realized_pnl...);
+  f("toxicity_unrealized_pnl", rs.toxicity_unrealized_pnl...);
+  f("baseline_realized_pnl", rs.baseline_realized_pnl...);
+  f("baseline_unrealized_pnl", rs.baseline_unrealized_pnl...);
+  f("symbols_eod_liquidated", rs.symbols_eod_liquidated...);
+  f("symbols_blacklisted", rs.symbols_blacklisted...);
+  f("symbols_one_sided", rs.symbols_one_sided...);
+  f("symbols_with_fills", rs.symbols_with_fills...);
+  f("toxicity_buy_fills", rs.toxicity_buy_fills...);
+  f("toxicity_sell_fills", rs.toxicity_sell_fills...);
+  f("baseline_buy_fills", rs.baseline_buy_fills...);
+  f("baseline_sell_fills", rs.baseline_sell_fills...);
+  f("avg_final_abs_inventory", rs.avg_final_abs_inventory...);
+  f("diag_exec_total", rs.diag_exec_total...);
+  f("diag_exec_no_order_info", rs.diag_exec_no_order_info...);
+  f("diag_exec_not_eligible", rs.diag_exec_not_eligible...);
+  f("diag_try_fill_calls", rs.diag_try_fill_calls...);
+  f("diag_rejected_halted", rs.diag_rejected_halted...);
+  f("diag_rejected_not_live", rs.diag_rejected_not_live...);
+  f("diag_rejected_latency", rs.diag_rejected_latency...);
+  f("diag_rejected_price", rs.diag_rejected_price...);
+  f("diag_rejected_queue", rs.diag_rejected_queue...);
+  f("diag_fill_succeeded", rs.diag_fill_succeeded...);
+  f("diag_quote_resets", rs.diag_quote_resets...);
+  f("inv_variance_symbols", rs.inv_variance_symbols...);
+}
+
+inline void merge_results(ProcessResults& into, const ProcessResults& r) {
+  auto weighted = [](double a, int64_t na, double b, int64_t nb) {
+    return na + nb > 0 ? (a * static_cast<double>(na) + b * static_cast<double>(nb)) /
+                             static_cast<double>(na + nb)
+                       : 0.0;
+  };
+  const double baseline_var = weighted(into.baseline_inv_variance, into.inv_variance_symbols,
+                                       r.baseline_inv_variance, r.inv_variance_symbols);
+  const double toxicity_var = weighted(into.toxicity_inv_variance, into.inv_variance_symbols,
+                                       r.toxicity_inv_variance, r.inv_variance_symbols);
+  const double final_inv = weighted(into.avg_final_abs_inventory, into.symbols_with_fills,
+                                    r.avg_final_abs_inventory, r.symbols_with_fills);
+  for_each_result_field([](const char*, auto& d, const auto& v) { d += v; }, into, r);
+  into.baseline_inv_variance = baseline_var;
+  into.toxicity_inv_variance = toxicity_var;
+  into.avg_final_abs_inventory = final_inv;
+
+  into.baseline_inventory.merge(r.baseline_inventory);
+  into.toxicity_inventory.merge(r.toxicity_inventory);
+  into.baseline_fill_bins.merge(r.baseline_fill_bins);
+  into.toxicity_fill_bins.merge(r.toxicity_fill_bins);
+  if (into.markout_horizons.count == 0) into.markout_horizons = r.markout_horizons;
+  into.markouts.merge(r.markouts);
+}
+
+// "<name> <value>" lines for the scalar fields, then per strategy (0 =
+// baseline, 1 = toxicity) "inventory <s> <n> <mean> <m2>", "fill_bin <s>
+// <bin> <fills> <shares>" for every non-empty bin, "markout_scheduled <s>
+// <n>" and "markout <s> <horizon> <stats...>" for every horizon with data,
+// and finally "markout_horizon <h> <ns>". Doubles are written with %.17g so
+// a read-back merge is exact.
+inline bool write_results(const std::string& path, const ProcessResults& r,
+                          const std::string& header = "") {
+  std::ofstream out(path);
+  if (!out.is_open()) return false;
+  if (!header.empty()) out << header;
+  char buf[64];
+  auto put = [&](const char* name, const auto& v) {
+    if constexpr (std::is_floating_point_v<std::decay_t<decltype(v)>>) {
+      std::snprintf(buf, sizeof(buf), "%.17g", v);
+      out << name << ' ' << buf << '\n';
+    } else {
+      out << name << ' ' << v << '\n';
+    }
+  };
+  for_each_result_field(put, r);
+  for (int s = 0; s < NUM_MARKOUT_STRATEGIES; ++s) {
+    const InventoryMoments& inv = s == 0 ? r.baseline_inventory : r.toxicity_inventory;
+    out << "inventory " << s << ' ' << inv.n;
+    for (double v : {inv.mean, inv.m2}) {
+      std::snprintf(buf, sizeof(buf), "%.17g", v);
+      out << ' ' << buf;
+    }
+    out << '\n';
+    const FillTimeBins& bins = s == 0 ? r.baseline_fill_bins : r.toxicity_fill_bins;
+    for (int b = 0; b < FillTimeBins::COUNT; ++b) {
+      if (bins.fills[b] == 0) continue;
+      out << "fill_bin " << s << ' ' << b << ' ' << bins.fills[b] << ' ' << bins.shares[b] << '\n';
+    }
+    out << "markout_scheduled " << s << ' ' << r.markouts.scheduled[s] << '\n';
+    for (int h = 0; h < MAX_MARKOUT_HORIZONS; ++h) {
+      const MarkoutStats& m = r.markouts.at[s][h];
+      if (m.fills == 0 && m.no_mid == 0) continue;
+      out << "markout " << s << ' ' << h << ' ' << m.fills << ' ' << m.adverse << ' ' << m.no_mid;
+      for (double v : {m.qty, m.pnl, m.sum, m.sum_sq}) {
+        std::snprintf(buf, sizeof(buf), "%.17g", v);
+        out << ' ' << buf;
+      }
+      out << '\n';
+    }
+  }
+  for (int h = 0; h < r.markout_horizons.count; ++h) {
+    out << "markout_horizon " << h << ' ' << r.markout_horizons.ns[h] << '\n';
+  }
+  return static_cast<bool>(out);
+}
+
+// Reads a write_results() file; lines starting with '#' and unknown names
+// are skipped so files can carry extra context.
+inline bool read_results(const std::string& path, ProcessResults& r, std::string& err) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    err = "cannot open " + path;
+    return false;
+  }
+  r = ProcessResults{};
+  std::string line;
+  size_t line_no = 0;
+  while (std::getline(in, line)) {
+    ++line_no;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream ss(line);
+    std::string name;
+    ss >> name;
+    bool ok = true;
+    if (name == "inventory") {
+      int s = -1;
+      ss >> s;
+      if (s < 0 || s >= NUM_MARKOUT_STRATEGIES) ok = false;
+      InventoryMoments& inv = s == 0 ? r.baseline_inventory : r.toxicity_inventory;
+      if (ok) ss >> inv.n >> inv.mean >> inv.m2;
+    } else if (name == "fill_bin") {
+      int s = -1, b = -1;
+      ss >> s >> b;
+      if (s < 0 || s >= NUM_MARKOUT_STRATEGIES || b < 0 || b >= FillTimeBins::COUNT) {
+        ok = false;
+      } else {
+        FillTimeBins& bins = s == 0 ? r.baseline_fill_bins : r.toxicity_fill_bins;
+        ss >> bins.fills[b] >> bins.shares[b];
+      }
+    } else if (name == "markout_horizon") {
+      int h = -1;
+      ss >> h;
+      if (h != r.markout_horizons.count || h >= MAX_MARKOUT_HORIZONS) ok = false;
+      else ss >> r.markout_horizons.ns[r.markout_horizons.count++];
+    } else if (name == "markout_scheduled") {
+      int s = -1;
+      ss >> s;
+      if (s < 0 || s >= NUM_MARKOUT_STRATEGIES) ok = false;
+      else ss >> r.markouts.scheduled[s];
+    } else if (name == "markout") {
+      int s = -1, h = -1;
+      ss >> s >> h;
+      if (s < 0 || s >= NUM_MARKOUT_STRATEGIES || h < 0 || h >= MAX_MARKOUT_HORIZONS) {
+        ok = false;
+      } else {
+        MarkoutStats& m = r.markouts.at[s][h];
+        ss >> m.fills >> m.adverse >> m.no_mid >> m.qty >> m.pnl >> m.sum >> m.sum_sq;
+      }
+    } else {
+      for_each_result_field([&](const char* n, auto& v) {
+        if (name == n) ss >> v;
+      }, r);
+    }
+    if (!ok || ss.fail()) {
+      err = path + ":" + std::to_string(line_no) + ": bad line '" + line + "'";
+      return false;
+    }
+  }
+  r.completed = true;
+  return true;
+}
+
+} // namespace mmsim
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "run_results.hpp"
+
+#include "common/capture_catalog.hpp"
+#include "common/session_calendar.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mmsim {
+
+// =============================================================================
+// Shard manifests (--plan, --shard)
+//
+// A plan splits a study into shards that share nothing: one trading date
+// times either one symbol partition (symbol index mod N) or one UDP channel.
+// Each shard is run by `market_maker_sim --plan FILE --shard K` on any node
+// that sees the same paths, and writes a partial result file
+// (run_results.hpp); `market_maker_sim merge` combines the partials.
+//
+// A partial is a write_results() file whose '#' header names its shard, so
+// merge can place it without the manifest.
+//
+// The manifest is CSV with '#' comment lines. The "# args" line records the
+// simulation options the plan was made with, so each shard can check that
+// it is run with the same ones. Shards are numbered from 1.
+// =============================================================================
+
+struct ShardSpec {
+  uint32_t id = 0;
+  int32_t date = 0;         // YYYYMMDD
+  uint32_t partition = 0;   // Symbols with index % partitions == partition
+  uint32_t partitions = 1;
+  uint16_t channel = 0;     // UDP destination port, 0 = every packet
+  std::vector<std::string> files;  // In replay order
+};
+
+class ShardPlan {
+public:
+  static constexpr const char *HEADER = "shard,date,partition,partitions,channel,files";
+
+  std::string args;
+  std::vector<ShardSpec> shards;
+
+  // Each date's files split into `partitions` symbol partitions
+  static ShardPlan by_symbols(const std::map<int32_t, std::vector<std::string>> &days,
+                              uint32_t partitions) {
+    ShardPlan plan;
+    for (const auto &[date, files] : days) {
+      for (uint32_t p = 0; p < partitions; ++p) {
+        ShardSpec s;
+        s.id = static_cast<uint32_t>(plan.shards.size() + 1);
+        s.date = date;
+        s.partition = p;
+        s.partitions = partitions;
+        s.files = files;
+        plan.shards.push_back(std::move(s));
+      }
+    }
+    return plan;
+  }
+
+  // One shard per date and channel, with the files that carry the channel
+  static ShardPlan by_channels(
+      const std::map<int32_t, std::vector<const xdp::CaptureInfo *>> &days) {
+    ShardPlan plan;
+    for (const auto &[date, captures] : days) {
+      std::map<uint16_t, std::vector<std::string>> channels;
+      for (const auto *c : captures) {
+        std::stringstream ss(c->channels);
+        std::string port;
+        while (std::getline(ss, port, ';')) {
+          if (!port.empty()) channels[static_cast<uint16_t>(std::stoul(port))].push_back(c->path);
+        }
+      }
+      for (auto &[channel, files] : channels) {
+        ShardSpec s;
+        s.id = static_cast<uint32_t>(plan.shards.size() + 1);
+        s.date = date;
+        s.channel = channel;
+        s.files = std::move(files);
+        plan.shards.push_back(std::move(s));
+      }
+    }
+    return plan;
+  }
+
+  bool save(const std::string &path, std::string &err) const {
+    for (const auto &s : shards) {
+      for (const auto &f : s.files) {
+        if (f.find_first_of(",;\n") != std::string::npos) {
+          err = "file path with ',' or ';' cannot go in a manifest: " + f;
+          return false;
+        }
+      }
+    }
+    std::ofstream out(path);
+    if (!out.is_open()) {
+      err = "cannot write " + path;
+      return false;
+    }
+    out << "# market_maker_sim shard plan: " << shards.size() << " shards\n"
+        << "# args" << (args.empty() ? "" : " ") << args << '\n'
+        << HEADER << '\n';
+    for (const auto &s : shards) {
+      out << s.id << ',' << s.date << ',' << s.partition << ',' << s.partitions << ','
+          << s.channel << ',';
+      for (size_t i = 0; i < s.files.size(); ++i) out << (i ? ";" : "") << s.files[i];
+      out << '\n';
+    }
+    if (!out) err = "write failed: " + path;
+    return static_cast<bool>(out);
+  }
+
+  static bool load(const std::string &path, ShardPlan &out, std::string &err) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+      err = "cannot open " + path;
+      return false;
+    }
+    out = ShardPlan{};
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+      ++line_no;
+      if (line.rfind("# args", 0) == 0) {
+        out.args = line.size() > 7 ? line.substr(7) : "";
+        continue;
+      }
+      if (line.empty() || line[0] == '#' || line == HEADER) continue;
+      std::vector<std::string> f;
+      std::stringstream ss(line);
+      std::string tok;
+      while (std::getline(ss, tok, ',')) f.push_back(tok);
+      if (f.size() != 6) {
+        err = path + ":" + std::to_string(line_no) + ": expected 6 fields";
+        return false;
+      }
+      ShardSpec s;
+      try {
+        s.id = static_cast<uint32_t>(std::stoul(f[0]));
+        s.date = std::stoi(f[1]);
+        s.partition = static_cast<uint32_t>(std::stoul(f[2]));
+        s.partitions = static_cast<uint32_t>(std::stoul(f[3]));
+        s.channel = static_cast<uint16_t>(std::stoul(f[4]));
+      } catch (const std::exception &) {
+        err = path + ":" + std::to_string(line_no) + ": bad number";
+        return false;
+      }
+      std::stringstream files(f[5]);
+      while (std::getline(files, tok, ';')) {
+        if (!tok.empty()) s.files.push_back(tok);
+      }
+      if (s.id != out.shards.size() + 1 || s.partitions == 0 || s.partition >= s.partitions ||
+          s.files.empty()) {
+        err = path + ":" + std::to_string(line_no) + ": bad shard " + f[0];
+        return false;
+      }
+      out.shards.push_back(std::move(s));
+    }
+    if (out.shards.empty()) {
+      err = path + ": no shards";
+      return false;
+    }
+    return true;
+  }
+
+  // "2023-08-22 symbols 2/4" or "2023-08-22 channel 11001"
+  static std::string describe(const ShardSpec &s) {
+    std::string d = xdp::SessionCalendar::format_date(s.date);
+    if (s.channel) return d + " channel " + std::to_string(s.channel);
+    if (s.partitions > 1) {
+      return d + " symbols " + std::to_string(s.partition + 1) + "/" + std::to_string(s.partitions);
+    }
+    return d;
+  }
+
+  // Default partial result file of shard K: next to the manifest
+  static std::string partial_path(const std::string &plan_path, uint32_t id) {
+    return plan_path + "." + std::to_string(id) + ".part";
+  }
+};
+
+// A shard's results with the header that identifies it
+inline bool write_partial(const std::string &path, const ShardSpec &s, size_t num_shards,
+                          const std::string &args, const ProcessResults &r) {
+  std::ostringstream header;
+  header << "# shard " << s.id << '/' << num_shards << '\n'
+         << "# date " << xdp::SessionCalendar::format_date(s.date) << '\n'
+         << "# partition " << s.partition << '/' << s.partitions << '\n'
+         << "# channel " << s.channel << '\n'
+         << "# args" << (args.empty() ? "" : " ") << args << '\n';
+  return write_results(path, r, header.str());
+}
+
+// Reads a write_partial() file; `s` gets the shard's id, date, partition and
+// channel (not its files), `num_shards` the size of its plan (0 in partials
+// that predate it), `args` the options it ran with
+inline bool read_partial(const std::string &path, ShardSpec &s, size_t &num_shards,
+                         std::string &args, ProcessResults &r, std::string &err) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    err = "cannot open " + path;
+    return false;
+  }
+  s = ShardSpec{};
+  num_shards = 0;
+  args.clear();
+  std::string line;
+  while (std::getline(in, line) && !line.empty() && line[0] == '#') {
+    std::istringstream ss(line.substr(1));
+    std::string key;
+    ss >> key;
+    char slash = 0;
+    if (key == "shard") {
+      ss >> s.id >> slash >> num_shards;
+    } else if (key == "date") {
+      std::string date;
+      ss >> date;
+      xdp::SessionCalendar::Bound b;
+      std::string date_err;
+      if (xdp::SessionCalendar::parse_bound(date, b, date_err)) s.date = b.date;
+    } else if (key == "partition") {
+      ss >> s.partition >> slash >> s.partitions;
+    } else if (key == "channel") {
+      ss >> s.channel;
+    } else if (key == "args") {
+      args = line.size() > 7 ? line.substr(7) : "";
+    }
+  }
+  if (s.id == 0 || s.date == 0 || s.partitions == 0) {
+    err = path + ": not a shard partial (missing '# shard' or '# date')";
+    return false;
+  }
+  return read_results(path, r, err);
+}
+
+} // namespace mmsim
@@ -32,6 +32,36 @@ struct FillRecord {
   double adverse_pnl = 0.0;
   double cumulative_pnl = 0.0;    // Strategy PnL snapshot at fill time (realized + unrealized + adverse)
   ToxicityFeatureVector features;  // Per-fill feature vector for online learning
+  uint64_t decision_record = UINT64_MAX;  // FILL record in the decision log, if any
+};
+
+// Fills per half hour of the regular session, 09:30 to 16:00. Fills before
+// the open count in the first bin and after the close in the last.
+struct FillTimeBins {
+  static constexpr int COUNT = 13;
+  static constexpr uint64_t BIN_NS = 30ULL * 60 * 1000000000ULL;
+
+  int64_t fills[COUNT] = {};
+  int64_t shares[COUNT] = {};
+
+  static int bin_of(const xdp::TradingSession* s, uint64_t now_ns) {
+    if (!s || now_ns < s->open_auction_ns) return 0;
+    const uint64_t bin = (now_ns - s->open_auction_ns) / BIN_NS;
+    return bin < static_cast<uint64_t>(COUNT) ? static_cast<int>(bin) : COUNT - 1;
+  }
+
+  void add(const xdp::TradingSession* s, uint64_t now_ns, uint32_t qty) {
+    const int b = bin_of(s, now_ns);
+    fills[b]++;
+    shares[b] += qty;
+  }
+
+  void merge(const FillTimeBins& o) {
+    for (int b = 0; b < COUNT; ++b) {
+      fills[b] += o.fills[b];
+      shares[b] += o.shares[b];
+    }
+  }
 };
 
 // Per-symbol risk state with Welford's online inventory variance tracking
@@ -48,6 +78,8 @@ struct SymbolRiskState {
   double inv_m2 = 0.0;   // Sum of squared differences from mean
   int64_t inv_count = 0;  // Number of inventory samples
 
+  FillTimeBins fill_bins;
+
   void update_inventory_variance(double inventory) {
     inv_count++;
     double delta = inventory - inv_mean;
@@ -0,0 +1,169 @@
+/*
+ * Strategy plugin ABI for market_maker_sim (--strategy-plugin)
+ *
+ * A plugin is a shared object exporting mmsim_plugin_entry(), which returns
+ * a static table of callbacks. This header is plain C so plugins can be
+ * built by any compiler without the simulator's sources; it is the only
+ * file a plugin needs.
+ *
+ * The simulator calls the plugin once per symbol quote update with a batch:
+ * every event for that symbol since its previous batch (top-of-book changes,
+ * feed executions and the plugin's own fills), the position, and optionally
+ * the toxicity feature vector. The plugin answers with a quote intent, which
+ * the simulator works exactly like a built-in strategy's quotes: latency,
+ * queue position, fills, adverse selection, risk limits and EOD liquidation
+ * all apply. A loaded plugin takes the place of the toxicity strategy, so its
+ * results are reported under "Toxicity" next to the baseline.
+ *
+ * Threading: create() and destroy() run once per simulator process (hybrid
+ * groups are separate processes). open_symbol(), close_symbol() and
+ * on_batch() may run concurrently for different symbols, but calls for one
+ * symbol never overlap and arrive in feed order.
+ *
+ * Prices are dollars and times are feed nanoseconds since the epoch.
+ */
+
+#ifndef MMSIM_STRATEGY_PLUGIN_H
+#define MMSIM_STRATEGY_PLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change to the structs or callbacks below */
+#define MMSIM_PLUGIN_ABI_VERSION 3
+
+/* Name of the exported entry point */
+#define MMSIM_PLUGIN_ENTRY "mmsim_plugin_entry"
+
+/* Values in mmsim_batch.features, in this order:
+ *   0 cancel_ratio          5 trade_flow_imbalance  10 depth_imbalance
+ *   1 ping_ratio            6 spread_change_rate    11 level_asymmetry
+ *   2 odd_lot_ratio         7 price_momentum        12 abs_trade_imbalance
+ *   3 precision_ratio       8 cancel_vol_intensity  13 large_order_ratio
+ *   4 resistance_ratio      9 top_of_book_conc      14 normalized_spread
+ * 0-14 are the toxicity model's inputs. 15-17 come from the book's tick
+ * ladders and are 0 unless the plugin sets MMSIM_PLUGIN_WANTS_DEPTH_FEATURES:
+ *  15 near_top_of_book_conc  Best-level qty / qty within 10 ticks of the
+ *                            touch (average of both sides)
+ *  16 near_depth_imbalance   (bid - ask) / total qty within 10 ticks
+ *  17 impact_spread          (VWAP to buy 1000 - VWAP to sell 1000) / mid */
+#define MMSIM_NUM_FEATURES 18
+
+enum mmsim_event_type {
+  MMSIM_EVENT_TOP = 1,   /* Best bid/ask or their sizes changed since the
+                            last TOP; sent before each TRADE and at the end of
+                            each quoting batch, so a quoting batch's latest
+                            TOP is the current touch */
+  MMSIM_EVENT_TRADE = 2, /* Execution on the feed (book as of just before it) */
+  MMSIM_EVENT_FILL = 3   /* The plugin's own quote was filled */
+};
+
+typedef struct mmsim_event {
+  uint64_t ts_ns;
+  uint32_t type;    /* enum mmsim_event_type */
+  uint32_t qty;     /* TRADE: shares executed; FILL: shares filled */
+  double price;     /* TRADE / FILL price */
+  double bid;       /* TOP: best bid (0 = side empty) */
+  double ask;       /* TOP: best ask (0 = side empty) */
+  uint32_t bid_qty; /* TOP: shares at the best bid */
+  uint32_t ask_qty; /* TOP: shares at the best ask */
+  char side;        /* TRADE: resting side 'B'/'S' (0 = unknown)
+                       FILL: 'B' the plugin bought, 'S' it sold */
+  uint8_t reserved[7];
+} mmsim_event;
+
+/* Another symbol's latest top of book (mmsim_host.read_top) */
+typedef struct mmsim_top {
+  uint64_t ts_ns;     /* Feed time it was published at */
+  double bid;         /* 0 = side empty */
+  double ask;
+  double last_price;  /* Last execution (0 = none yet) */
+  uint32_t bid_qty;
+  uint32_t ask_qty;
+  uint32_t last_qty;
+  uint32_t reserved;
+} mmsim_top;
+
+/* Read access to the other symbols this process simulates, passed in
+ * quoting and non-quoting batches of plugins that set MMSIM_PLUGIN_READS_TOPS.
+ * Both calls are lock-free and may be made from on_batch() only. Workers run
+ * at their own pace (hybrid groups are separate processes over different
+ * files), so compare mmsim_top.ts_ns with the batch's now_ns before trusting
+ * another symbol's quote. */
+typedef struct mmsim_host {
+  /* Symbol index of a ticker, 0 if unknown */
+  uint32_t (*symbol_index)(const char *ticker);
+  /* 1 and *out filled if the symbol has a published top of book, else 0 */
+  int (*read_top)(uint32_t symbol_index, mmsim_top *out);
+} mmsim_host;
+
+typedef struct mmsim_batch {
+  uint64_t now_ns;
+  uint32_t symbol_index;
+  uint32_t num_events;
+  const mmsim_event *events;  /* Valid for the duration of the call */
+  const double *features;     /* MMSIM_NUM_FEATURES values, or NULL */
+  double inventory;           /* Shares, after the batch's fills */
+  double realized_pnl;
+  double unrealized_pnl;
+  int32_t quoting;            /* 0: the symbol cannot quote now (ineligible,
+                                 halted, outside the session or the batch
+                                 buffer filled up); the intent is ignored */
+  uint32_t reserved;
+  const mmsim_host *host;     /* NULL unless MMSIM_PLUGIN_READS_TOPS */
+} mmsim_batch;
+
+/* Quotes to rest. A side with size 0 or price <= 0 is pulled; a crossed
+ * intent pulls both sides. */
+typedef struct mmsim_quote_intent {
+  double bid_price;
+  double ask_price;
+  uint32_t bid_size;
+  uint32_t ask_size;
+} mmsim_quote_intent;
+
+/* on_batch() results */
+#define MMSIM_KEEP_QUOTES 0 /* Leave the current quotes in place */
+#define MMSIM_NEW_QUOTES 1  /* Replace them with *intent */
+
+/* Set in mmsim_strategy_plugin.flags to receive mmsim_batch.features on
+ * quoting batches (costs a feature vector build per quote update) */
+#define MMSIM_PLUGIN_WANTS_FEATURES 0x1u
+
+/* Set in mmsim_strategy_plugin.flags to read other symbols' top of book
+ * through mmsim_batch.host (the simulator then keeps a cross-symbol table,
+ * published on every top-of-book change) */
+#define MMSIM_PLUGIN_READS_TOPS 0x2u
+
+/* Set in mmsim_strategy_plugin.flags, with MMSIM_PLUGIN_WANTS_FEATURES, to
+ * also receive features 15-17 (a few O(log n) depth queries per quote update) */
+#define MMSIM_PLUGIN_WANTS_DEPTH_FEATURES 0x4u
+
+typedef struct mmsim_strategy_plugin {
+  uint32_t abi_version; /* MMSIM_PLUGIN_ABI_VERSION the plugin was built with */
+  uint32_t flags;
+  const char *name;
+
+  /* Plugin-wide state from the --plugin-args string ("" if none); NULL fails the run */
+  void *(*create)(const char *args);
+  void (*destroy)(void *plugin);
+
+  /* Per-symbol state (NULL is allowed and passed back as is) */
+  void *(*open_symbol)(void *plugin, uint32_t symbol_index, const char *ticker);
+  void (*close_symbol)(void *plugin, void *symbol);
+
+  /* One batch of events; writes *intent and returns MMSIM_NEW_QUOTES to requote */
+  int (*on_batch)(void *symbol, const mmsim_batch *batch, mmsim_quote_intent *intent);
+} mmsim_strategy_plugin;
+
+typedef const mmsim_strategy_plugin *(*mmsim_plugin_entry_fn)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMSIM_STRATEGY_PLUGIN_H */
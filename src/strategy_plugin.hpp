@@ -0,0 +1,141 @@
+#pragma once
+
+#include "strategy_plugin.h"
+
+#include <dlfcn.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mmsim {
+
+// =============================================================================
+// Shared-object strategies (--strategy-plugin, ABI in strategy_plugin.h)
+//
+// StrategyPlugin owns the dlopen handle and the plugin-wide instance. Each
+// PerSymbolSim keeps a PluginFeed: the events its strategy side has seen
+// since the last batch. Events are appended where the built-in strategies
+// consume them (executions, fills, the book as the strategy sees it) and
+// handed over in one on_batch() call at the symbol's next quote update, so a
+// plugin pays one indirect call per quote update rather than one per event.
+// A feed that fills up without a quote update is flushed as a non-quoting
+// batch.
+//
+// The library is opened once in main so a bad path or ABI mismatch fails
+// before any work starts; create() runs per process, after hybrid groups
+// have forked.
+// =============================================================================
+
+static_assert(sizeof(mmsim_event) == 56, "mmsim_event layout is part of the plugin ABI");
+static_assert(sizeof(mmsim_batch) == 72, "mmsim_batch layout is part of the plugin ABI");
+static_assert(sizeof(mmsim_top) == 48, "mmsim_top layout is part of the plugin ABI");
+
+class StrategyPlugin {
+public:
+  static std::unique_ptr<StrategyPlugin> load(const std::string &path, std::string &err) {
+    void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+      const char *msg = dlerror();
+      err = msg ? msg : "dlopen failed";
+      return nullptr;
+    }
+    auto entry = reinterpret_cast<mmsim_plugin_entry_fn>(dlsym(handle, MMSIM_PLUGIN_ENTRY));
+    const mmsim_strategy_plugin *api = entry ? entry() : nullptr;
+    if (!api) {
+      err = path + ": no " MMSIM_PLUGIN_ENTRY "() or it returned NULL";
+    } else if (api->abi_version != MMSIM_PLUGIN_ABI_VERSION) {
+      err = path + ": built for plugin ABI " + std::to_string(api->abi_version) +
+            ", simulator has " + std::to_string(MMSIM_PLUGIN_ABI_VERSION);
+    } else if (!api->create || !api->destroy || !api->on_batch) {
+      err = path + ": create, destroy and on_batch are required";
+    } else {
+      return std::unique_ptr<StrategyPlugin>(new StrategyPlugin(handle, api));
+    }
+    dlclose(handle);
+    return nullptr;
+  }
+
+  ~StrategyPlugin() {
+    destroy();
+    dlclose(handle_);
+  }
+
+  StrategyPlugin(const StrategyPlugin &) = delete;
+  StrategyPlugin &operator=(const StrategyPlugin &) = delete;
+
+  // Plugin-wide state for this process
+  bool create(const std::string &args, std::string &err) {
+    destroy();
+    instance_ = api_->create(args.c_str());
+    if (!instance_) err = name() + ": create() failed";
+    return instance_ != nullptr;
+  }
+
+  void destroy() {
+    if (instance_) api_->destroy(instance_);
+    instance_ = nullptr;
+  }
+
+  [[nodiscard]] std::string name() const { return api_->name ? api_->name : "unnamed"; }
+  [[nodiscard]] bool wants_features() const { return api_->flags & MMSIM_PLUGIN_WANTS_FEATURES; }
+  [[nodiscard]] bool wants_depth_features() const {
+    return wants_features() && (api_->flags & MMSIM_PLUGIN_WANTS_DEPTH_FEATURES);
+  }
+  [[nodiscard]] bool reads_tops() const { return api_->flags & MMSIM_PLUGIN_READS_TOPS; }
+
+  // Cross-symbol reads handed to the plugin in every batch (reads_tops() only)
+  void set_host(const mmsim_host *host) { host_ = reads_tops() ? host : nullptr; }
+  [[nodiscard]] const mmsim_host *host() const { return host_; }
+
+  void *open_symbol(uint32_t symbol_index, const std::string &ticker) const {
+    return api_->open_symbol ? api_->open_symbol(instance_, symbol_index, ticker.c_str()) : nullptr;
+  }
+  void close_symbol(void *symbol) const {
+    if (api_->close_symbol) api_->close_symbol(instance_, symbol);
+  }
+
+  bool on_batch(void *symbol, const mmsim_batch &batch, mmsim_quote_intent &intent) const {
+    return api_->on_batch(symbol, &batch, &intent) == MMSIM_NEW_QUOTES;
+  }
+
+private:
+  StrategyPlugin(void *handle, const mmsim_strategy_plugin *api) : handle_(handle), api_(api) {}
+
+  void *handle_;
+  const mmsim_strategy_plugin *api_;
+  void *instance_ = nullptr;
+  const mmsim_host *host_ = nullptr;
+};
+
+// One symbol's events awaiting the next batch
+struct PluginFeed {
+  static constexpr size_t MAX_EVENTS = 256;
+
+  void *symbol = nullptr;  // open_symbol() state
+  bool open = false;
+  std::vector<mmsim_event> events;
+
+  // Top of book last reported in a TOP event
+  double bid = 0.0;
+  double ask = 0.0;
+  uint32_t bid_qty = 0;
+  uint32_t ask_qty = 0;
+
+  uint64_t batches = 0;
+  uint64_t events_delivered = 0;
+  uint64_t intents = 0;
+  uint64_t intents_rejected = 0;  // Crossed intents (both sides pulled)
+
+  mmsim_event &push(uint32_t type, uint64_t ts_ns) {
+    mmsim_event &ev = events.emplace_back();
+    ev = mmsim_event{};
+    ev.ts_ns = ts_ns;
+    ev.type = type;
+    return ev;
+  }
+  [[nodiscard]] bool full() const { return events.size() >= MAX_EVENTS; }
+};
+
+} // namespace mmsim
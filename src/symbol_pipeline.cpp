@@ -0,0 +1,125 @@
+#include "symbol_pipeline.hpp"
+
+#include "per_symbol_sim.hpp"
+
+namespace mmsim {
+
+SymbolPipeline::SymbolPipeline(PerSymbolSim& sim, const PipelineHooks& hooks, size_t capacity)
+    : sim_(sim), hooks_(hooks), ring_(capacity) {
+  sim_.pipeline = this;
+  worker_ = std::thread([this] { run(); });
+}
+
+SymbolPipeline::~SymbolPipeline() { finish(); }
+
+void SymbolPipeline::begin_message(uint64_t now_ns, DegradeLevel degrade, bool sampled,
+                                   uint64_t origin) {
+  // The book half of the overload level applies here; the strategy half
+  // travels with the events
+  if (degrade != book_degrade_) {
+    book_degrade_ = degrade;
+    sim_.order_book.set_touch_analytics_only(degrade >= DegradeLevel::CONFLATE);
+  }
+  degrade_ = degrade;
+  sampled_ = sampled;
+  origin_ = origin;
+  // A serial run marks due horizons before each message at the mid left by
+  // the previous one. Only the last such mark before the mid moves changes
+  // anything, so it is sent once the mid does (or at finish).
+  mark_ns_ = now_ns;
+  mark_mid_ = mid_;
+  mark_pending_ = true;
+  messages_++;
+}
+
+void SymbolPipeline::end_message() {
+  mid_ = sim_.order_book.get_stats().mid_price;
+  if (mid_ != mark_mid_) publish_mark();
+}
+
+PipelineEvent& SymbolPipeline::acquire(PipelineEvent::Kind kind) {
+  PipelineEvent& ev = ring_.acquire();
+  ev.kind = kind;
+  ev.degrade = degrade_;
+  ev.sampled = sampled_;
+  ev.origin = origin_;
+  ev.messages = messages_;
+  messages_ = 0;
+  return ev;
+}
+
+void SymbolPipeline::publish_mark() {
+  PipelineEvent& ev = acquire(PipelineEvent::Kind::MARK);
+  ev.price = mark_mid_;
+  ev.now_ns = mark_ns_;
+  ring_.commit();
+  mark_pending_ = false;
+  events_++;
+  marks_++;
+}
+
+void SymbolPipeline::publish_cancel(double price, uint32_t volume, char side) {
+  PipelineEvent& ev = acquire(PipelineEvent::Kind::QUEUE_CANCEL);
+  ev.side = side;
+  ev.qty = volume;
+  ev.price = price;
+  ring_.commit();
+  events_++;
+}
+
+void SymbolPipeline::publish_execution(char resting_side, uint32_t exec_qty,
+                                       double exec_price, uint64_t now_ns) {
+  PipelineEvent& ev = acquire(PipelineEvent::Kind::EXECUTION);
+  ev.side = resting_side;
+  ev.qty = exec_qty;
+  ev.price = exec_price;
+  ev.now_ns = now_ns;
+  sim_.order_book.publish_view(ev.view, OrderBook::BookView::MAX_DEPTH,
+                               sim_.wants_depth_features());
+  ring_.commit();
+  events_++;
+  executions_++;
+}
+
+void SymbolPipeline::finish() {
+  if (!worker_.joinable()) return;
+  if (mark_pending_) publish_mark();
+  acquire(PipelineEvent::Kind::STOP);
+  ring_.commit();
+  worker_.join();
+  sim_.pipeline = nullptr;
+  for (size_t i = 0; i < NUM_COST_BUCKETS; ++i) sim_.cost.cycles[i] += strategy_cost.cycles[i];
+}
+
+void SymbolPipeline::run() {
+  if (hooks_.start) hooks_.start(hooks_.context);
+  for (;;) {
+    PipelineEvent& ev = ring_.front();
+    if (ev.kind == PipelineEvent::Kind::STOP) {
+      ring_.pop();
+      return;
+    }
+    sim_.degrade = ev.degrade;
+    if (hooks_.begin) hooks_.begin(sim_, ev);
+    switch (ev.kind) {
+    case PipelineEvent::Kind::QUEUE_CANCEL:
+      sim_.update_queue_on_cancel(ev.price, ev.qty, ev.side);
+      break;
+    case PipelineEvent::Kind::EXECUTION:
+      sim_.set_book_view(&ev.view);
+      sim_.advance_markouts(ev.now_ns);
+      sim_.strategy_on_execute(ev.side, ev.qty, ev.price, ev.now_ns);
+      sim_.set_book_view(nullptr);
+      break;
+    case PipelineEvent::Kind::MARK:
+      if (ev.now_ns > sim_.markouts.next_due_ns()) sim_.markouts.expire(ev.now_ns, ev.price);
+      break;
+    case PipelineEvent::Kind::STOP:
+      break;
+    }
+    if (hooks_.end) hooks_.end(sim_, ev);
+    ring_.pop();
+  }
+}
+
+} // namespace mmsim
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "common/spsc_ring.hpp"
+#include "cost_profile.hpp"
+#include "order_book.hpp"
+#include "overload_control.hpp"
+
+#include <cstdint>
+#include <thread>
+
+namespace mmsim {
+
+struct PerSymbolSim;
+
+// =============================================================================
+// Two-stage pipeline for one heavy symbol
+//
+// Stage 1 runs on whichever thread feeds the symbol its messages: it applies
+// every event to the order book and order table, and passes the strategy
+// only what the strategy consumes -- cancels that may advance a virtual
+// order's queue position, executions together with a BookView of the book
+// as it stood just before the fill, and a MARK whenever a message moves the
+// mid so markout horizons are marked at the same mid as in a serial run.
+// Stage 2 is a dedicated thread that runs the fill, quoting and feature
+// logic (PerSymbolSim::strategy_on_execute) against those views.
+//
+// Events cross a bounded SPSC ring in feed order, so stage 2 sees exactly the
+// sequence a serial run would and the result does not depend on thread
+// timing. Each event carries the shard's overload level and the cost-sample
+// and latency stamps of the message that produced it; PipelineHooks let the
+// simulator account them on the strategy thread. The one modelled
+// difference: queue positions for quotes deeper than BookView::MAX_DEPTH
+// levels see an empty level (counted in PerSymbolSim::view_depth_misses).
+// =============================================================================
+
+struct PipelineEvent {
+  enum class Kind : uint8_t { QUEUE_CANCEL, EXECUTION, MARK, STOP };
+  Kind kind = Kind::STOP;
+  char side = 0;        // Cancelled order's side / resting side (0 = unknown)
+  DegradeLevel degrade = DegradeLevel::NORMAL;  // Shard level at publish
+  bool sampled = false; // Cost sampling picked the message (--cost-profile)
+  uint32_t qty = 0;
+  uint32_t messages = 0;  // Book messages applied since the previous event
+  double price = 0.0;   // MARK: mid before the message at now_ns
+  uint64_t now_ns = 0;
+  uint64_t origin = 0;  // Latency trace packet receipt (0 = not traced)
+  OrderBook::BookView view;  // EXECUTION only
+};
+
+// Instrumentation the strategy thread runs around every event, so cost,
+// latency and live stats cover pipelined symbols. `start` runs once on the
+// strategy thread with `context` before the first event. Any may be null.
+struct PipelineHooks {
+  void (*start)(void* context) = nullptr;
+  void (*begin)(PerSymbolSim& sim, const PipelineEvent& ev) = nullptr;
+  void (*end)(PerSymbolSim& sim, const PipelineEvent& ev) = nullptr;
+  void* context = nullptr;
+};
+
+class SymbolPipeline {
+public:
+  static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+  // Attaches to `sim` and starts the strategy thread
+  explicit SymbolPipeline(PerSymbolSim& sim, const PipelineHooks& hooks = {},
+                          size_t capacity = DEFAULT_CAPACITY);
+  ~SymbolPipeline();
+
+  SymbolPipeline(const SymbolPipeline&) = delete;
+  SymbolPipeline& operator=(const SymbolPipeline&) = delete;
+
+  // Stage 1 (caller owns the symbol's book). Every message is bracketed by
+  // begin_message/end_message; events published in between carry its stamps.
+  void begin_message(uint64_t now_ns, DegradeLevel degrade, bool sampled, uint64_t origin);
+  void end_message();
+  void publish_cancel(double price, uint32_t volume, char side);
+  void publish_execution(char resting_side, uint32_t exec_qty, double exec_price,
+                         uint64_t now_ns);
+
+  // Drain queued events, join the strategy thread and detach from the sim.
+  // Must be called before strategy state is read. Idempotent.
+  void finish();
+
+  // Strategy-thread cycles of sampled messages; added to the sim's cost by
+  // finish(). Only the hooks touch it while the pipeline runs.
+  SymbolCost strategy_cost;
+
+  [[nodiscard]] uint64_t events() const noexcept { return events_; }
+  [[nodiscard]] uint64_t executions() const noexcept { return executions_; }
+  [[nodiscard]] uint64_t marks() const noexcept { return marks_; }
+  // Times stage 1 waited on a full ring (stage 2 is the bottleneck)
+  [[nodiscard]] uint64_t producer_waits() const noexcept { return ring_.full_waits(); }
+  [[nodiscard]] const PerSymbolSim& sim() const noexcept { return sim_; }
+
+private:
+  PipelineEvent& acquire(PipelineEvent::Kind kind);
+  void publish_mark();
+  void run();
+
+  PerSymbolSim& sim_;
+  PipelineHooks hooks_;
+  xdp::SpscRing<PipelineEvent> ring_;
+  std::thread worker_;
+  uint64_t events_ = 0;
+  uint64_t executions_ = 0;
+  uint64_t marks_ = 0;
+
+  // Stage 1 state of the message in flight
+  DegradeLevel degrade_ = DegradeLevel::NORMAL;
+  DegradeLevel book_degrade_ = DegradeLevel::NORMAL;  // Applied to the book
+  bool sampled_ = false;
+  uint64_t origin_ = 0;
+  uint64_t mark_ns_ = 0;     // Message time of the MARK not yet sent
+  double mark_mid_ = 0.0;    // Mid before that message
+  double mid_ = 0.0;         // Mid after the last message
+  bool mark_pending_ = false;
+  uint32_t messages_ = 0;    // Messages since the last event
+};
+
+} // namespace mmsim
@@ -10,10 +10,12 @@
 #include <GL/gl.h>
 #endif
 
+#include "common/mmap_pcap_reader.hpp"
 #include "common/pcap_reader.hpp"
 #include "common/symbol_map.hpp"
 #include "common/xdp_types.hpp"
 #include "common/xdp_utils.hpp"
+#include "decision_log.hpp"
 #include "order_book.hpp"
 
 #include <algorithm>
@@ -21,6 +23,8 @@
 #include <atomic>
 #include <chrono>
 #include <cstring>
+#include <deque>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <mutex>
@@ -47,14 +51,76 @@ std::atomic<uint64_t> packets_processed(0);
 std::atomic<uint64_t> messages_processed(0);
 std::string filter_ticker = "";
 
-// Message entry for live feed
-struct MessageEntry {
-  std::string text;
-  bool is_buy;
-  bool is_exec = false;
-  double price;
-  uint32_t volume;
-  std::chrono::steady_clock::time_point timestamp;
+// Compact binary record for the live message feed. Text is only produced
+// at draw time for the rows that are actually visible.
+enum class FeedKind : uint8_t { ADD = 0, EXEC = 1 };
+
+struct FeedRecord {
+  double price = 0.0;
+  uint32_t volume = 0;
+  FeedKind kind = FeedKind::ADD;
+  char side = '?'; // 'B' / 'S' for ADD; executions carry no side
+  uint64_t seq = 0;
+};
+
+// Fixed-size overwrite ring for the message feed.
+// Single producer (the ingest thread while streaming, the UI thread during
+// playback - never both at once) and a single UI reader. Each slot is a
+// small seqlock so the reader can copy records without taking a lock and
+// simply drop any slot the producer lapped while it was being read.
+class FeedRing {
+public:
+  static constexpr size_t CAPACITY = 4096; // Power of two
+
+  void push(FeedKind kind, char side, double price, uint32_t volume) {
+    uint64_t seq = head_.load(std::memory_order_relaxed);
+    Slot &slot = slots_[seq & (CAPACITY - 1)];
+    uint64_t price_bits;
+    std::memcpy(&price_bits, &price, sizeof(price_bits));
+    uint64_t meta = (static_cast<uint64_t>(volume) << 32) |
+                    (static_cast<uint64_t>(static_cast<uint8_t>(kind)) << 8) |
+                    static_cast<uint8_t>(side);
+
+    slot.seq.store(0, std::memory_order_relaxed); // Mark in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.price_bits.store(price_bits, std::memory_order_relaxed);
+    slot.meta.store(meta, std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_release);
+    head_.store(seq + 1, std::memory_order_release);
+  }
+
+  // Total number of records ever pushed
+  [[nodiscard]] uint64_t head() const {
+    return head_.load(std::memory_order_acquire);
+  }
+
+  // Copy record `seq` into `out`; false if it was overwritten or is in flight
+  bool read(uint64_t seq, FeedRecord &out) const {
+    const Slot &slot = slots_[seq & (CAPACITY - 1)];
+    if (slot.seq.load(std::memory_order_acquire) != seq + 1)
+      return false;
+    uint64_t price_bits = slot.price_bits.load(std::memory_order_relaxed);
+    uint64_t meta = slot.meta.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq + 1)
+      return false;
+
+    std::memcpy(&out.price, &price_bits, sizeof(price_bits));
+    out.volume = static_cast<uint32_t>(meta >> 32);
+    out.kind = static_cast<FeedKind>((meta >> 8) & 0xFF);
+    out.side = static_cast<char>(meta & 0xFF);
+    out.seq = seq;
+    return true;
+  }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> seq{0}; // seq + 1 of the stored record, 0 = empty
+    std::atomic<uint64_t> price_bits{0};
+    std::atomic<uint64_t> meta{0}; // volume << 32 | kind << 8 | side
+  };
+  Slot slots_[CAPACITY];
+  std::atomic<uint64_t> head_{0};
 };
 
 // Trade execution marker for visualization
@@ -74,6 +140,7 @@ struct OrderBookUpdate {
   double price;
   uint32_t volume;
   char side;
+  uint64_t timestamp_ns; // Packet capture time (feed time)
 };
 
 std::queue<OrderBookUpdate> update_queue;
@@ -146,7 +213,7 @@ private:
 
 // Checkpoint for fast seek operations
 struct OrderBookCheckpoint {
-  size_t update_index; // Index in playback buffer where this checkpoint was taken
+  uint64_t update_seq; // Updates applied before it, counted from the first ever stored
   std::map<double, uint32_t, std::greater<double>> bids_snapshot;
   std::map<double, uint32_t, std::less<double>> asks_snapshot;
   std::unordered_map<uint64_t, Order> active_orders_snapshot;
@@ -156,7 +223,10 @@ struct OrderBookCheckpoint {
 constexpr size_t MAX_PLAYBACK_UPDATES = 500000; // ~500K updates max
 constexpr size_t CHECKPOINT_INTERVAL = 10000;   // Checkpoint every 10K updates
 RingBuffer<OrderBookUpdate> playback_buffer(MAX_PLAYBACK_UPDATES);
-std::vector<OrderBookCheckpoint> checkpoints;
+// Updates ever stored; playback_buffer[0] is number total_updates - size()
+uint64_t total_updates = 0;
+// Oldest first; only those whose replay start is still in playback_buffer
+std::deque<OrderBookCheckpoint> checkpoints;
 std::mutex playback_mutex;
 size_t playback_index = 0;
 
@@ -180,16 +250,25 @@ private:
   ImVec4 spread_color = ImVec4(1.0f, 1.0f, 0.0f, 1.0f);
 
   // Message feed
-  std::vector<MessageEntry> message_feed;
-  std::mutex feed_mutex;
-  size_t max_feed_entries = 200;
+  FeedRing feed_ring;
+  uint64_t feed_cleared_at = 0; // Records before this seq are hidden
+  std::vector<FeedRecord> feed_visible; // Filtered rows, rebuilt per frame
   bool auto_scroll_feed = true;
+  int feed_side_filter = 0; // 0 = all, 1 = buy, 2 = sell
+  bool feed_show_adds = true;
+  bool feed_show_execs = true;
+  double feed_min_price = 0.0; // 0 = no bound
+  double feed_max_price = 0.0;
 
   // Playback controls
   bool is_playing = false;
-  float playback_speed = 0.5f; // Baseline speed is now 0.5x (half speed)
+  float playback_speed = 1.0f; // Multiple of market (feed) time
   bool stream_finished = false;
   std::chrono::steady_clock::time_point last_playback_time;
+  double playback_clock_ns = 0.0; // Feed-time clock driving playback
+  std::vector<OrderBookUpdate> playback_batch; // Updates due this frame
+  const size_t MAX_PLAYBACK_BATCH = 250000;    // Per-frame apply budget
+  const double MAX_PLAYBACK_FRAME_NS = 250e6;  // Clamp for stalled frames
 
   // Trade execution markers
   std::vector<TradeMarker> trade_markers;
@@ -213,6 +292,12 @@ private:
   const int TOXICITY_SAMPLE_INTERVAL_MS =
       50; // Sample every 50ms for smooth graph
 
+  // Simulated strategy overlay (market_maker_sim --decision-log output)
+  std::vector<mmsim::DecisionLogReader> decision_logs;
+  bool show_decisions = true;
+  uint64_t playhead_ns = 0; // Feed time of the last applied update
+  const uint64_t FILL_MARKER_WINDOW_NS = 2000000000ULL; // Fills stay 2s (feed time)
+
 public:
   OrderBookVisualizer(OrderBook &ob) : order_book(ob), window(nullptr) {}
 
@@ -224,19 +309,24 @@ public:
   void render_order_book_graph();
   void render_toxicity_over_time();
   void render_message_feed();
-  void add_message(const std::string &text, bool is_buy, double price,
-                   uint32_t volume, bool is_exec = false);
+  void add_message(FeedKind kind, char side, double price, uint32_t volume);
+  void clear_message_feed() { feed_cleared_at = feed_ring.head(); }
   void add_trade_marker(double price, uint32_t volume);
   void record_toxicity_sample(double price, char side,
                               bool force_sample = false);
   void apply_playback_to_index(size_t idx);
   void set_stream_finished(bool finished) { stream_finished = finished; }
+  void set_playhead(uint64_t ts_ns) { playhead_ns = ts_ns; }
+  bool load_decision_log(const std::string &path);
+  void render_decision_overlay(ImDrawList *draw_list, ImVec2 plot_pos,
+                               ImVec2 plot_size, double min_price,
+                               double max_price);
   void process_playback();
 };
 
 // Process XDP message and queue update (non-blocking)
 void process_xdp_message(const uint8_t *data, size_t max_len,
-                         uint16_t msg_type) {
+                         uint16_t msg_type, uint64_t timestamp_ns) {
   // Need at least 4 bytes for message header
   if (max_len < 4)
     return;
@@ -273,6 +363,7 @@ void process_xdp_message(const uint8_t *data, size_t max_len,
 
   // Queue update instead of applying immediately
   OrderBookUpdate update;
+  update.timestamp_ns = timestamp_ns;
 
   switch (msg_type) {
   case 100: { // Add Order
@@ -286,11 +377,7 @@ void process_xdp_message(const uint8_t *data, size_t max_len,
 
       // Add to message feed
       if (g_visualizer) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "ADD %s $%.2f x %u",
-                 update.side == 'B' ? "BUY" : "SELL", update.price,
-                 update.volume);
-        g_visualizer->add_message(msg, update.side == 'B', update.price,
+        g_visualizer->add_message(FeedKind::ADD, update.side, update.price,
                                   update.volume);
       }
 
@@ -335,11 +422,8 @@ void process_xdp_message(const uint8_t *data, size_t max_len,
 
       // Add to message feed (executions are important)
       if (g_visualizer) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "EXEC $%.2f x %u", update.price,
-                 update.volume);
-        // Mark execution messages specially (blue)
-        g_visualizer->add_message(msg, true, update.price, update.volume, true);
+        g_visualizer->add_message(FeedKind::EXEC, '?', update.price,
+                                  update.volume);
         // Add visual trade marker
         g_visualizer->add_trade_marker(update.price, update.volume);
       }
@@ -368,12 +452,13 @@ void process_xdp_message(const uint8_t *data, size_t max_len,
   }
 }
 
-// Create a checkpoint of current order book state
-void create_checkpoint(size_t update_index) {
+// Create a checkpoint of current order book state, which has the first
+// `update_seq` updates applied
+void create_checkpoint(uint64_t update_seq) {
   auto snapshot = order_book.get_atomic_snapshot();
 
   OrderBookCheckpoint checkpoint;
-  checkpoint.update_index = update_index;
+  checkpoint.update_seq = update_seq;
   checkpoint.bids_snapshot = snapshot.bids;
   checkpoint.asks_snapshot = snapshot.asks;
   checkpoint.active_orders_snapshot = snapshot.active_orders;
@@ -404,51 +489,55 @@ void apply_batched_updates() {
   // mutex)
   if (!batch.empty()) {
     for (const auto &update : batch) {
-      size_t current_index = 0;
-      // Store update in ring buffer for playback
+      uint64_t update_seq = 0;
+      // Store update in ring buffer for playback. The interval test uses the
+      // absolute count: size() stops growing once the ring is full.
       {
         std::lock_guard<std::mutex> lock(playback_mutex);
+        update_seq = total_updates++;
         playback_buffer.push_back(update);
-        current_index = playback_buffer.size();
-
-        // Create checkpoint at regular intervals
-        if (current_index > 0 && current_index % CHECKPOINT_INTERVAL == 0) {
-          // Release lock before creating checkpoint (checkpoint acquires its own lock)
+        // A checkpoint is only useful while its replay start is in the ring
+        const uint64_t oldest = total_updates - playback_buffer.size();
+        while (!checkpoints.empty() && checkpoints.front().update_seq < oldest) {
+          checkpoints.pop_front();
         }
       }
 
-      // Create checkpoint outside of playback_mutex to avoid deadlock
-      if (current_index > 0 && current_index % CHECKPOINT_INTERVAL == 0) {
-        create_checkpoint(current_index);
+      // Checkpoint the book before this update is applied, outside of
+      // playback_mutex to avoid deadlock (checkpoint acquires its own lock)
+      if (update_seq > 0 && update_seq % CHECKPOINT_INTERVAL == 0) {
+        create_checkpoint(update_seq);
       }
 
       // Apply update
       switch (update.type) {
       case UpdateType::ADD:
         order_book.add_order(update.order_id, update.price, update.volume,
-                             update.side);
+                             update.side, update.timestamp_ns);
         // Record toxicity sample
         if (g_visualizer) {
           g_visualizer->record_toxicity_sample(update.price, update.side);
         }
         break;
       case UpdateType::MODIFY:
-        order_book.modify_order(update.order_id, update.price, update.volume);
+        order_book.modify_order(update.order_id, update.price, update.volume,
+                                update.timestamp_ns);
         break;
       case UpdateType::DELETE:
-        order_book.delete_order(update.order_id);
+        order_book.delete_order(update.order_id, update.timestamp_ns);
         // Record toxicity sample when order is cancelled
         if (g_visualizer) {
           g_visualizer->record_toxicity_sample(update.price, update.side);
         }
         break;
       case UpdateType::EXECUTE:
-        order_book.execute_order(update.order_id, update.volume, update.price);
+        order_book.execute_order(update.order_id, update.volume, update.price,
+                                 update.timestamp_ns);
         break;
       case UpdateType::REPLACE:
-        order_book.delete_order(update.order_id);
+        order_book.delete_order(update.order_id, update.timestamp_ns);
         order_book.add_order(update.new_order_id, update.price, update.volume,
-                             update.side);
+                             update.side, update.timestamp_ns);
         // Record toxicity sample
         if (g_visualizer) {
           g_visualizer->record_toxicity_sample(update.price, update.side);
@@ -456,11 +545,16 @@ void apply_batched_updates() {
         break;
       }
     }
+
+    if (g_visualizer) {
+      g_visualizer->set_playhead(batch.back().timestamp_ns);
+    }
   }
 }
 
 // Parse XDP packet
-void parse_xdp_packet(const uint8_t *data, size_t length) {
+void parse_xdp_packet(const uint8_t *data, size_t length,
+                      uint64_t timestamp_ns) {
   if (length < 16)
     return;
 
@@ -482,103 +576,115 @@ void parse_xdp_packet(const uint8_t *data, size_t length) {
 
     uint16_t msg_type = read_le16(data + offset + 2);
     messages_parsed++;
-    process_xdp_message(data + offset, msg_size, msg_type);
+    process_xdp_message(data + offset, msg_size, msg_type, timestamp_ns);
 
     offset += msg_size;
   }
 
 }
 
-// PCAP packet handler
-void packet_handler(u_char *user_data, const struct pcap_pkthdr *pkthdr,
-                    const u_char *packet) {
-  (void)user_data;
-  packets_processed++;
+// Debug counters (declared here, used in parse_xdp_packet)
+std::atomic<uint64_t> packets_parsed(0);
+std::atomic<uint64_t> messages_parsed(0);
 
-  if (should_stop.load()) {
-    return;
+// Expand the command-line inputs (PCAP files, directories of *.pcap, and
+// --file-list files with one path per line) and order them by the capture
+// time of their first packet so a trading day streams in feed order
+bool collect_pcap_inputs(const std::vector<std::string> &inputs,
+                         const std::vector<std::string> &list_files,
+                         std::vector<std::string> &pcap_files) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> paths;
+  for (const auto &list : list_files) {
+    std::ifstream in(list);
+    if (!in.is_open()) {
+      std::cerr << "Error: cannot open file list " << list << std::endl;
+      return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+      if (!line.empty() && line[0] != '#')
+        paths.push_back(line);
+    }
   }
-
-  if (pkthdr->caplen < 14)
-    return;
-
-  // Parse Ethernet header
-  uint16_t eth_type = ntohs(*(uint16_t *)(packet + 12));
-  size_t eth_header_len = 14;
-
-  // Skip VLAN tag if present
-  if (eth_type == 0x8100 || eth_type == 0x88A8) {
-    if (pkthdr->caplen < 18)
-      return;
-    eth_type = ntohs(*(uint16_t *)(packet + 16));
-    eth_header_len = 18;
+  for (const auto &input : inputs) {
+    if (fs::is_directory(input)) {
+      std::error_code ec;
+      for (const auto &entry : fs::directory_iterator(input, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".pcap") {
+          paths.push_back(entry.path().string());
+        }
+      }
+    } else {
+      paths.push_back(input);
+    }
   }
 
-  // Only process IPv4
-  if (eth_type != 0x0800)
-    return;
-
-  // Parse IP header
-  if (pkthdr->caplen < eth_header_len + 20)
-    return;
-  const uint8_t *ip_header = packet + eth_header_len;
-  uint8_t ip_ver_ihl = ip_header[0];
-  uint8_t ip_header_len = (ip_ver_ihl & 0x0F) * 4;
-  uint8_t protocol = ip_header[9];
-
-  // Check for UDP
-  if (protocol != 17)
-    return;
-
-  // Parse UDP header
-  size_t udp_offset = eth_header_len + ip_header_len;
-  if (pkthdr->caplen < udp_offset + 8)
-    return;
-
-  const uint8_t *udp_header = packet + udp_offset;
-  uint16_t udp_len = ntohs(*(uint16_t *)(udp_header + 4));
-
-  // Extract UDP payload (XDP data)
-  const uint8_t *udp_payload = udp_header + 8;
-  size_t payload_len = udp_len - 8;
-
-  if (payload_len > pkthdr->caplen - udp_offset - 8) {
-    payload_len = pkthdr->caplen - udp_offset - 8;
+  std::vector<std::pair<uint64_t, std::string>> ordered;
+  for (const auto &path : paths) {
+    xdp::MmapPcapReader reader;
+    if (!reader.open(path)) {
+      std::cerr << "Error: " << reader.error() << std::endl;
+      return false;
+    }
+    ordered.emplace_back(reader.first_timestamp_ns(), path);
   }
+  std::sort(ordered.begin(), ordered.end());
 
-  if (payload_len < 16)
-    return;
-
-  parse_xdp_packet(udp_payload, payload_len);
+  pcap_files.clear();
+  for (auto &entry : ordered) {
+    pcap_files.push_back(std::move(entry.second));
+  }
+  return !pcap_files.empty();
 }
 
-// Debug counters (declared here, used in parse_xdp_packet)
-std::atomic<uint64_t> packets_parsed(0);
-std::atomic<uint64_t> messages_parsed(0);
-
-// PCAP reading thread function
-void pcap_thread_func(const std::string &pcap_file) {
-  char errbuf[PCAP_ERRBUF_SIZE];
-  pcap_t *handle = pcap_open_offline(pcap_file.c_str(), errbuf);
-
-  if (!handle) {
-    std::cerr << "Error opening PCAP file: " << errbuf << std::endl;
+// PCAP reading thread function. Files are streamed back to back into the
+// same order book, so state carries across file boundaries; the next file
+// is paged in on a helper thread while the current one is parsed.
+void pcap_thread_func(const std::vector<std::string> &pcap_files) {
+  xdp::MmapPcapReader current;
+  if (!current.open(pcap_files[0])) {
+    std::cerr << "Error opening PCAP file: " << current.error() << std::endl;
     should_stop.store(true);
     return;
   }
 
-  std::cout << "Reading PCAP file: " << pcap_file << std::endl;
+  for (size_t i = 0; i < pcap_files.size() && !should_stop.load(); ++i) {
+    xdp::MmapPcapReader next;
+    std::thread prefetcher;
+    if (i + 1 < pcap_files.size()) {
+      if (next.open(pcap_files[i + 1])) {
+        next.prefetch();
+        prefetcher = std::thread([&next]() { next.preload(); });
+      } else {
+        std::cerr << "Warning: skipping " << pcap_files[i + 1] << ": "
+                  << next.error() << std::endl;
+      }
+    }
 
-  // Use pcap_loop for better performance (it's optimized internally)
-  // Process in batches to allow UI updates
-  pcap_loop(handle, -1, packet_handler, nullptr);
+    if (current.is_open()) {
+      std::cout << "Reading PCAP file " << (i + 1) << "/" << pcap_files.size()
+                << ": " << pcap_files[i] << std::endl;
+      current.process_all([](const uint8_t *payload, size_t payload_len,
+                             uint64_t, const xdp::NetworkPacketInfo &info) {
+        packets_processed++;
+        if (should_stop.load(std::memory_order_relaxed) || payload_len < 16)
+          return;
+        parse_xdp_packet(payload, payload_len, info.timestamp_ns);
+      });
+    }
 
-  pcap_close(handle);
+    if (prefetcher.joinable())
+      prefetcher.join();
+    current = std::move(next);
+  }
 
-  std::cout << "Finished reading PCAP file. Processed "
-            << packets_processed.load() << " packets, "
-            << messages_processed.load() << " messages matched filter"
-            << std::endl;
+  std::cout << "Finished reading " << pcap_files.size()
+            << " PCAP file(s). Processed " << packets_processed.load()
+            << " packets, " << messages_processed.load()
+            << " messages matched filter" << std::endl;
 
   // Print debug stats
   std::cout << "Debug: Parsed " << packets_parsed.load() << " XDP packets, "
@@ -723,119 +829,134 @@ void OrderBookVisualizer::render() {
   SDL_GL_SwapWindow(window);
 }
 
+// Advance the feed-time clock by wall time x speed and apply every buffered
+// update at or before it in one batch, so playback keeps pace with the market
+// no matter how many events a frame covers.
 void OrderBookVisualizer::process_playback() {
   if (!is_playing || !stream_finished)
     return;
 
-  size_t buffer_size = 0;
+  auto now = std::chrono::steady_clock::now();
+  double wall_ns =
+      std::chrono::duration<double, std::nano>(now - last_playback_time)
+          .count();
+  last_playback_time = now;
+  // A stalled frame (window drag, seek) should not turn into a jump
+  wall_ns = std::min(wall_ns, MAX_PLAYBACK_FRAME_NS);
+
+  playback_batch.clear();
   {
     std::lock_guard<std::mutex> lock(playback_mutex);
-    buffer_size = playback_buffer.size();
-  }
-
-  if (buffer_size == 0 || playback_index >= buffer_size) {
-    is_playing = false; // Reached end
-    playback_index = 0; // Reset for next play
-    return;
-  }
+    size_t buffer_size = playback_buffer.size();
+    if (playback_index >= buffer_size) {
+      is_playing = false; // Reached end
+      playback_index = 0; // Reset for next play
+      playback_clock_ns = 0;
+      return;
+    }
 
-  auto now = std::chrono::steady_clock::now();
-  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                     now - last_playback_time)
-                     .count();
+    playback_clock_ns += wall_ns * playback_speed;
 
-  // Calculate delay based on playback speed (default: 1 update per 20ms at 0.5x
-  // speed) At 0.5x speed, delay is 20ms, so at 1x it's 10ms
-  int delay_ms = (int)(20.0f / playback_speed);
+    // Skip idle stretches (and the initial jump from 0) that would take more
+    // than a second of wall time at the current speed
+    double next_ts = (double)playback_buffer[playback_index].timestamp_ns;
+    if (next_ts > playback_clock_ns + 1e9 * playback_speed)
+      playback_clock_ns = next_ts;
 
-  if (elapsed >= delay_ms) {
-    // Get the update to apply
-    OrderBookUpdate update;
-    {
-      std::lock_guard<std::mutex> lock(playback_mutex);
-      if (playback_index >= playback_buffer.size())
-        return;
-      update = playback_buffer[playback_index];
+    while (playback_index < buffer_size &&
+           playback_batch.size() < MAX_PLAYBACK_BATCH &&
+           (double)playback_buffer[playback_index].timestamp_ns <=
+               playback_clock_ns) {
+      playback_batch.push_back(playback_buffer[playback_index]);
+      playback_index++;
     }
 
-    // Apply update
+    // Frame budget exhausted: hold the clock at what was actually applied
+    if (playback_batch.size() == MAX_PLAYBACK_BATCH)
+      playback_clock_ns = (double)playback_batch.back().timestamp_ns;
+  }
+
+  // Toxicity is sampled at most every TOXICITY_SAMPLE_INTERVAL_MS, so one
+  // sample from the last book-changing update of the batch is enough
+  const OrderBookUpdate *sample_update = nullptr;
+  for (const auto &update : playback_batch) {
     switch (update.type) {
     case UpdateType::ADD:
       order_book.add_order(update.order_id, update.price, update.volume,
-                           update.side);
-      // Record toxicity sample during playback
-      record_toxicity_sample(update.price, update.side);
-      // Add to message feed
-      {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "ADD %s $%.2f x %u",
-                 update.side == 'B' ? "BUY" : "SELL", update.price,
-                 update.volume);
-        add_message(msg, update.side == 'B', update.price, update.volume);
-      }
+                           update.side, update.timestamp_ns);
+      add_message(FeedKind::ADD, update.side, update.price, update.volume);
+      sample_update = &update;
       break;
     case UpdateType::MODIFY:
-      order_book.modify_order(update.order_id, update.price, update.volume);
+      order_book.modify_order(update.order_id, update.price, update.volume,
+                              update.timestamp_ns);
       break;
     case UpdateType::DELETE:
-      order_book.delete_order(update.order_id);
-      // Record toxicity sample during playback
-      record_toxicity_sample(update.price, update.side);
+      order_book.delete_order(update.order_id, update.timestamp_ns);
+      sample_update = &update;
       break;
     case UpdateType::EXECUTE:
-      order_book.execute_order(update.order_id, update.volume, update.price);
-      // Add to message feed
-      {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "EXEC $%.2f x %u", update.price,
-                 update.volume);
-        add_message(msg, true, update.price, update.volume, true);
-      }
-      // Add visual trade marker
+      order_book.execute_order(update.order_id, update.volume, update.price,
+                               update.timestamp_ns);
+      add_message(FeedKind::EXEC, '?', update.price, update.volume);
       add_trade_marker(update.price, update.volume);
       break;
     case UpdateType::REPLACE:
-      order_book.delete_order(update.order_id);
+      order_book.delete_order(update.order_id, update.timestamp_ns);
       order_book.add_order(update.new_order_id, update.price, update.volume,
-                           update.side);
-      // Record toxicity sample during playback
-      record_toxicity_sample(update.price, update.side);
+                           update.side, update.timestamp_ns);
+      sample_update = &update;
       break;
     }
-
-    {
-      std::lock_guard<std::mutex> lock(playback_mutex);
-      playback_index++;
-    }
-    last_playback_time = now;
   }
+  if (sample_update)
+    record_toxicity_sample(sample_update->price, sample_update->side);
+
+  playhead_ns = (uint64_t)playback_clock_ns;
 }
 
 void OrderBookVisualizer::apply_playback_to_index(size_t idx) {
-  // Find the nearest checkpoint before the target index for fast seeking
+  // Seek from the nearest checkpoint before the target index. The checkpoint
+  // and the updates after it are copied under one lock: the ingest thread
+  // may evict both as the ring wraps.
   size_t start_from = 0;
-  const OrderBookCheckpoint *nearest_checkpoint = nullptr;
+  OrderBookCheckpoint nearest_checkpoint;
+  bool have_checkpoint = false;
+  std::vector<OrderBookUpdate> updates_to_replay;
 
   {
     std::lock_guard<std::mutex> lock(playback_mutex);
     if (idx > playback_buffer.size())
       idx = playback_buffer.size();
 
-    // Find nearest checkpoint before target index
+    // Find nearest checkpoint before target index (checkpoints count updates
+    // from the first ever stored, the ring from its oldest)
+    const uint64_t oldest = total_updates - playback_buffer.size();
     for (auto it = checkpoints.rbegin(); it != checkpoints.rend(); ++it) {
-      if (it->update_index <= idx) {
-        nearest_checkpoint = &(*it);
-        start_from = it->update_index;
+      if (it->update_seq >= oldest && it->update_seq - oldest <= idx) {
+        nearest_checkpoint = *it;
+        have_checkpoint = true;
+        start_from = static_cast<size_t>(it->update_seq - oldest);
         break;
       }
     }
+    // Once the ring has wrapped, the book before its first checkpoint can't
+    // be rebuilt; stop at that checkpoint instead
+    if (!have_checkpoint && oldest > 0 && !checkpoints.empty()) {
+      nearest_checkpoint = checkpoints.front();
+      have_checkpoint = true;
+      start_from = idx = static_cast<size_t>(nearest_checkpoint.update_seq - oldest);
+    }
+
+    // Collect updates to replay from checkpoint to target
+    updates_to_replay.reserve(idx - start_from);
+    for (size_t i = start_from; i < idx; ++i) {
+      updates_to_replay.push_back(playback_buffer[i]);
+    }
   }
 
   // Clear UI state
-  {
-    std::lock_guard<std::mutex> lock(feed_mutex);
-    message_feed.clear();
-  }
+  clear_message_feed();
   {
     std::lock_guard<std::mutex> lock(markers_mutex);
     trade_markers.clear();
@@ -847,23 +968,12 @@ void OrderBookVisualizer::apply_playback_to_index(size_t idx) {
   }
 
   // Restore from checkpoint or clear order book
-  if (nearest_checkpoint) {
-    order_book.restore_from_snapshot(nearest_checkpoint->bids_snapshot,
-                                     nearest_checkpoint->asks_snapshot,
-                                     nearest_checkpoint->active_orders_snapshot);
+  if (have_checkpoint) {
+    order_book.restore_from_snapshot(nearest_checkpoint.bids_snapshot,
+                                     nearest_checkpoint.asks_snapshot,
+                                     nearest_checkpoint.active_orders_snapshot);
   } else {
     order_book.clear();
-    start_from = 0;
-  }
-
-  // Collect updates to replay from checkpoint to target
-  std::vector<OrderBookUpdate> updates_to_replay;
-  {
-    std::lock_guard<std::mutex> lock(playback_mutex);
-    updates_to_replay.reserve(idx - start_from);
-    for (size_t i = start_from; i < idx; ++i) {
-      updates_to_replay.push_back(playback_buffer[i]);
-    }
   }
 
   // Reset start time for toxicity tracking
@@ -881,7 +991,7 @@ void OrderBookVisualizer::apply_playback_to_index(size_t idx) {
     switch (update.type) {
     case UpdateType::ADD:
       order_book.add_order(update.order_id, update.price, update.volume,
-                           update.side);
+                           update.side, update.timestamp_ns);
       if (sample_count % 10 == 0) { // Sample every 10th update during replay
         record_toxicity_sample(update.price, update.side, true);
         {
@@ -893,10 +1003,11 @@ void OrderBookVisualizer::apply_playback_to_index(size_t idx) {
       sample_count++;
       break;
     case UpdateType::MODIFY:
-      order_book.modify_order(update.order_id, update.price, update.volume);
+      order_book.modify_order(update.order_id, update.price, update.volume,
+                              update.timestamp_ns);
       break;
     case UpdateType::DELETE:
-      order_book.delete_order(update.order_id);
+      order_book.delete_order(update.order_id, update.timestamp_ns);
       if (sample_count % 10 == 0) {
         record_toxicity_sample(update.price, update.side, true);
         {
@@ -908,12 +1019,13 @@ void OrderBookVisualizer::apply_playback_to_index(size_t idx) {
       sample_count++;
       break;
     case UpdateType::EXECUTE:
-      order_book.execute_order(update.order_id, update.volume, update.price);
+      order_book.execute_order(update.order_id, update.volume, update.price,
+                               update.timestamp_ns);
       break;
     case UpdateType::REPLACE:
-      order_book.delete_order(update.order_id);
+      order_book.delete_order(update.order_id, update.timestamp_ns);
       order_book.add_order(update.new_order_id, update.price, update.volume,
-                           update.side);
+                           update.side, update.timestamp_ns);
       if (sample_count % 10 == 0) {
         record_toxicity_sample(update.price, update.side, true);
         {
@@ -927,11 +1039,14 @@ void OrderBookVisualizer::apply_playback_to_index(size_t idx) {
     }
   }
 
-  // Update playback index
+  // Update playback index and feed-time playhead
   {
     std::lock_guard<std::mutex> lock(playback_mutex);
     playback_index = idx;
+    playhead_ns = idx > 0 ? playback_buffer[idx - 1].timestamp_ns : 0;
   }
+  playback_clock_ns = (double)playhead_ns;
+  last_playback_time = std::chrono::steady_clock::now();
 }
 
 void OrderBookVisualizer::render_controls() {
@@ -977,13 +1092,14 @@ void OrderBookVisualizer::render_controls() {
         std::lock_guard<std::mutex> lock(playback_mutex);
         if (playback_index >= playback_buffer.size()) {
           playback_index = 0; // Reset to beginning
+          playback_clock_ns = 0;
         }
       }
     }
     ImGui::SameLine();
     if (ImGui::Button("Reset")) {
       is_playing = false;
-      playback_speed = 0.5f; // Reset to half speed
+      playback_speed = 1.0f; // Reset to real time
 
       // Clear order book
       order_book.clear();
@@ -996,10 +1112,7 @@ void OrderBookVisualizer::render_controls() {
       }
 
       // Clear message feed
-      {
-        std::lock_guard<std::mutex> lock(feed_mutex);
-        message_feed.clear();
-      }
+      clear_message_feed();
 
       // Clear trade markers
       {
@@ -1012,6 +1125,8 @@ void OrderBookVisualizer::render_controls() {
         std::lock_guard<std::mutex> lock(playback_mutex);
         playback_index = 0;
       }
+      playhead_ns = 0;
+      playback_clock_ns = 0;
 
       // Start playback automatically
       is_playing = true;
@@ -1055,7 +1170,11 @@ void OrderBookVisualizer::render_controls() {
 
     if (is_playing) {
       ImGui::SameLine();
-      ImGui::SliderFloat("Speed", &playback_speed, 0.1f, 5.0f);
+      ImGui::SetNextItemWidth(160);
+      ImGui::SliderFloat("Speed", &playback_speed, 0.01f, 1000.0f,
+                         "%.2fx market",
+                         ImGuiSliderFlags_Logarithmic |
+                             ImGuiSliderFlags_AlwaysClamp);
       std::lock_guard<std::mutex> lock(playback_mutex);
       ImGui::SameLine();
       ImGui::Text("(%zu/%zu)", playback_index, playback_buffer.size());
@@ -1072,9 +1191,28 @@ void OrderBookVisualizer::render_controls() {
               stats.best_bid, stats.best_ask, stats.spread, stats.mid_price);
   ImGui::Text("Bid Qty: %u | Ask Qty: %u | Levels: %d/%d", stats.total_bid_qty,
               stats.total_ask_qty, stats.bid_levels, stats.ask_levels);
+  auto age = order_book.get_age_stats();
+  ImGui::Text("Fleeting cancels: %.1f%% | Touch rest p50/p90: %.0f/%.0f us | "
+              "Depth age B/S: %.1f/%.1f ms",
+              100.0 * age.fleeting_ratio(), age.touch_rest_quantile_us(0.5),
+              age.touch_rest_quantile_us(0.9), age.bid_depth_age_us / 1000.0,
+              age.ask_depth_age_us / 1000.0);
+  const auto buy_1k = order_book.estimate_fill('S', 1000);
+  const auto sell_1k = order_book.estimate_fill('B', 1000);
+  ImGui::Text("Depth +-5 ticks B/S: %llu/%llu | +-10 bps B/S: %llu/%llu | "
+              "1000 sh VWAP buy/sell: $%.4f/$%.4f",
+              (unsigned long long)order_book.depth_within_ticks('B', 5),
+              (unsigned long long)order_book.depth_within_ticks('S', 5),
+              (unsigned long long)order_book.depth_within_bps('B', 10.0),
+              (unsigned long long)order_book.depth_within_bps('S', 10.0),
+              buy_1k.vwap, sell_1k.vwap);
   ImGui::Text("Packets: %llu | Messages: %llu",
               (unsigned long long)packets_processed.load(),
               (unsigned long long)messages_processed.load());
+  if (!decision_logs.empty()) {
+    ImGui::SameLine();
+    ImGui::Checkbox("Strategy overlay", &show_decisions);
+  }
 }
 
 void OrderBookVisualizer::render_message_feed() {
@@ -1084,54 +1222,88 @@ void OrderBookVisualizer::render_message_feed() {
   ImGui::Checkbox("Auto-scroll", &auto_scroll_feed);
   ImGui::SameLine();
   if (ImGui::Button("Clear")) {
-    std::lock_guard<std::mutex> lock(feed_mutex);
-    message_feed.clear();
+    clear_message_feed();
+  }
+
+  // Column filters (evaluated on the binary records, not on text)
+  ImGui::Checkbox("ADD", &feed_show_adds);
+  ImGui::SameLine();
+  ImGui::Checkbox("EXEC", &feed_show_execs);
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(-1);
+  ImGui::Combo("##side", &feed_side_filter, "All sides\0Buy\0Sell\0");
+  ImGui::SetNextItemWidth(120);
+  ImGui::InputDouble("Min $", &feed_min_price, 0.0, 0.0, "%.2f");
+  ImGui::SetNextItemWidth(120);
+  ImGui::InputDouble("Max $", &feed_max_price, 0.0, 0.0, "%.2f");
+
+  // Snapshot the ring into the filtered row list
+  uint64_t head = feed_ring.head();
+  uint64_t first = head > FeedRing::CAPACITY ? head - FeedRing::CAPACITY : 0;
+  first = std::max(first, feed_cleared_at);
+  char side_wanted = feed_side_filter == 1 ? 'B'
+                     : feed_side_filter == 2 ? 'S'
+                                             : 0;
+
+  feed_visible.clear();
+  FeedRecord rec;
+  for (uint64_t seq = first; seq < head; ++seq) {
+    if (!feed_ring.read(seq, rec))
+      continue;
+    if (rec.kind == FeedKind::ADD ? !feed_show_adds : !feed_show_execs)
+      continue;
+    // Executions carry no side and are only hidden by the EXEC toggle
+    if (side_wanted && rec.kind == FeedKind::ADD && rec.side != side_wanted)
+      continue;
+    if (feed_min_price > 0.0 && rec.price < feed_min_price)
+      continue;
+    if (feed_max_price > 0.0 && rec.price > feed_max_price)
+      continue;
+    feed_visible.push_back(rec);
   }
 
+  ImGui::Text("%zu shown / %llu total", feed_visible.size(),
+              (unsigned long long)(head - feed_cleared_at));
   ImGui::Separator();
 
   // Message list
   ImGui::BeginChild("FeedList", ImVec2(0, 0), true);
 
-  std::lock_guard<std::mutex> lock(feed_mutex);
-  for (const auto &entry : message_feed) {
-    ImVec4 color;
-    if (entry.is_exec) {
-      color = ImVec4(0.2f, 0.6f, 1.0f, 1.0f); // Blue for executions
-    } else {
-      color = entry.is_buy ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f)
-                           : ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
+  ImGuiListClipper clipper;
+  clipper.Begin((int)feed_visible.size());
+  while (clipper.Step()) {
+    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+      const FeedRecord &entry = feed_visible[row];
+      char text[64];
+      ImVec4 color;
+      if (entry.kind == FeedKind::EXEC) {
+        snprintf(text, sizeof(text), "EXEC $%.2f x %u", entry.price,
+                 entry.volume);
+        color = ImVec4(0.2f, 0.6f, 1.0f, 1.0f); // Blue for executions
+      } else {
+        bool is_buy = entry.side == 'B';
+        snprintf(text, sizeof(text), "ADD %s $%.2f x %u",
+                 is_buy ? "BUY" : "SELL", entry.price, entry.volume);
+        color = is_buy ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f)
+                       : ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
+      }
+      ImGui::PushStyleColor(ImGuiCol_Text, color);
+      ImGui::TextUnformatted(text);
+      ImGui::PopStyleColor();
     }
-    ImGui::PushStyleColor(ImGuiCol_Text, color);
-    ImGui::TextWrapped("%s", entry.text.c_str());
-    ImGui::PopStyleColor();
   }
+  clipper.End();
 
-  if (auto_scroll_feed && !message_feed.empty()) {
+  if (auto_scroll_feed && !feed_visible.empty()) {
     ImGui::SetScrollHereY(1.0f);
   }
 
   ImGui::EndChild();
 }
 
-void OrderBookVisualizer::add_message(const std::string &text, bool is_buy,
-                                      double price, uint32_t volume,
-                                      bool is_exec) {
-  std::lock_guard<std::mutex> lock(feed_mutex);
-  MessageEntry entry;
-  entry.text = text;
-  entry.is_buy = is_buy;
-  entry.is_exec = is_exec;
-  entry.price = price;
-  entry.volume = volume;
-  entry.timestamp = std::chrono::steady_clock::now();
-
-  message_feed.push_back(entry);
-
-  // Limit feed size
-  if (message_feed.size() > max_feed_entries) {
-    message_feed.erase(message_feed.begin());
-  }
+void OrderBookVisualizer::add_message(FeedKind kind, char side, double price,
+                                      uint32_t volume) {
+  feed_ring.push(kind, side, price, volume);
 }
 
 void OrderBookVisualizer::add_trade_marker(double price, uint32_t volume) {
@@ -1149,6 +1321,145 @@ void OrderBookVisualizer::add_trade_marker(double price, uint32_t volume) {
   }
 }
 
+bool OrderBookVisualizer::load_decision_log(const std::string &path) {
+  mmsim::DecisionLogReader reader;
+  std::string error;
+  if (!reader.open(path, error)) {
+    std::cerr << "Error loading decision log: " << error << std::endl;
+    return false;
+  }
+  const auto &hdr = reader.header();
+  std::cout << "Loaded decision log " << path << ": " << reader.size()
+            << " records for " << hdr.ticker;
+  if (hdr.group > 0) {
+    std::cout << " (group " << hdr.group << ")";
+  }
+  std::cout << std::endl;
+  if (!filter_ticker.empty() && filter_ticker != hdr.ticker) {
+    std::cerr << "Warning: decision log is for " << hdr.ticker
+              << " but the visualizer is filtering " << filter_ticker
+              << std::endl;
+  }
+  decision_logs.push_back(std::move(reader));
+  return true;
+}
+
+// Draw the simulated strategy's state as of the playhead: its live quotes
+// (or suppression), and fills from the last FILL_MARKER_WINDOW_NS of feed time
+void OrderBookVisualizer::render_decision_overlay(ImDrawList *draw_list,
+                                                  ImVec2 plot_pos,
+                                                  ImVec2 plot_size,
+                                                  double min_price,
+                                                  double max_price) {
+  if (playhead_ns == 0)
+    return;
+
+  auto price_to_x = [&](double price) {
+    return plot_pos.x +
+           (float)((price - min_price) / (max_price - min_price)) * plot_size.x;
+  };
+
+  // Latest QUOTE/SUPPRESS at or before the playhead across all logs
+  // (hybrid runs produce one log per time-slice group)
+  const mmsim::DecisionRecord *state = nullptr;
+  for (const auto &log : decision_logs) {
+    size_t pos = log.lower_bound(playhead_ns + 1);
+    size_t floor = pos > 4096 ? pos - 4096 : 0;
+    while (pos > floor) {
+      const auto &rec = log[--pos];
+      if (rec.kind() == mmsim::DecisionType::QUOTE ||
+          rec.kind() == mmsim::DecisionType::SUPPRESS) {
+        if (!state || rec.ts_ns > state->ts_ns)
+          state = &rec;
+        break;
+      }
+    }
+  }
+
+  const ImU32 quote_color = IM_COL32(255, 0, 255, 220); // Magenta
+  char label[128];
+  if (state && state->kind() == mmsim::DecisionType::QUOTE) {
+    auto draw_quote = [&](double price, uint32_t size, const char *name,
+                          float label_y) {
+      if (size == 0 || price < min_price || price > max_price)
+        return;
+      float x = price_to_x(price);
+      // Dashed vertical line so it does not hide the real BBO lines
+      for (float y = plot_pos.y; y < plot_pos.y + plot_size.y; y += 12.0f) {
+        draw_list->AddLine(
+            ImVec2(x, y),
+            ImVec2(x, std::min(y + 6.0f, plot_pos.y + plot_size.y)),
+            quote_color, 2.0f);
+      }
+      snprintf(label, sizeof(label), "MM %s %u @ $%.2f", name, size, price);
+      draw_list->AddText(ImVec2(x + 4, label_y), quote_color, label);
+    };
+    draw_quote(state->price_a(), state->qty_a, "bid", plot_pos.y + 4);
+    draw_quote(state->price_b(), state->qty_b, "ask", plot_pos.y + 20);
+  } else if (state && state->kind() == mmsim::DecisionType::SUPPRESS) {
+    const char *reason =
+        state->flags ==
+                static_cast<uint8_t>(mmsim::SuppressReason::TOXICITY_THRESHOLD)
+            ? "toxicity threshold"
+            : "E[PnL] filter";
+    snprintf(label, sizeof(label),
+             "MM SUPPRESSED (%s)  tox=%.3f  E[PnL]=%.5f  inv=%d", reason,
+             state->f0, state->f1, state->inventory);
+    draw_list->AddText(ImVec2(plot_pos.x + 10, plot_pos.y + 4),
+                       IM_COL32(255, 120, 0, 255), label);
+  }
+
+  // Fills: triangles along the top edge, fading with feed-time age.
+  // Green = no adverse move, red = adverse, grey = outcome not yet measured.
+  uint64_t window_start =
+      playhead_ns > FILL_MARKER_WINDOW_NS ? playhead_ns - FILL_MARKER_WINDOW_NS
+                                          : 0;
+  int drawn = 0;
+  for (const auto &log : decision_logs) {
+    size_t end = log.lower_bound(playhead_ns + 1);
+    for (size_t i = log.lower_bound(window_start); i < end && drawn < 256;
+         ++i) {
+      const auto &rec = log[i];
+      if (rec.kind() != mmsim::DecisionType::FILL)
+        continue;
+      double price = rec.price_a();
+      if (price < min_price || price > max_price)
+        continue;
+
+      float age = (float)(playhead_ns - rec.ts_ns) / FILL_MARKER_WINDOW_NS;
+      int alpha = std::max(60, (int)(255 * (1.0f - age)));
+      ImU32 color = !(rec.flags & mmsim::FILL_FLAG_MEASURED)
+                        ? IM_COL32(180, 180, 180, alpha)
+                    : (rec.flags & mmsim::FILL_FLAG_ADVERSE)
+                        ? IM_COL32(255, 60, 60, alpha)
+                        : IM_COL32(60, 255, 60, alpha);
+
+      float x = price_to_x(price);
+      float y = plot_pos.y + 44.0f;
+      if (rec.side == 'B') { // Our bid was hit: triangle pointing up
+        draw_list->AddTriangleFilled(ImVec2(x, y - 7), ImVec2(x - 7, y + 7),
+                                     ImVec2(x + 7, y + 7), color);
+      } else {
+        draw_list->AddTriangleFilled(ImVec2(x, y + 7), ImVec2(x - 7, y - 7),
+                                     ImVec2(x + 7, y - 7), color);
+      }
+      snprintf(label, sizeof(label), "%u", rec.qty_a);
+      draw_list->AddText(ImVec2(x + 9, y - 7), color, label);
+      drawn++;
+    }
+  }
+
+  // Feed-time clock for the playhead (UTC)
+  time_t secs = static_cast<time_t>(playhead_ns / 1000000000ULL);
+  struct tm tm_utc;
+  gmtime_r(&secs, &tm_utc);
+  snprintf(label, sizeof(label), "Feed %02d:%02d:%02d.%03d UTC", tm_utc.tm_hour,
+           tm_utc.tm_min, tm_utc.tm_sec,
+           (int)((playhead_ns / 1000000ULL) % 1000));
+  draw_list->AddText(ImVec2(plot_pos.x + 10, plot_pos.y + plot_size.y - 20),
+                     IM_COL32(200, 200, 200, 255), label);
+}
+
 void OrderBookVisualizer::render_order_book_graph() {
   // Get snapshots of the data (thread-safe copies)
   auto stats = order_book.get_stats();
@@ -1448,6 +1759,11 @@ void OrderBookVisualizer::render_order_book_graph() {
     }
   }
 
+  if (show_decisions && !decision_logs.empty()) {
+    render_decision_overlay(draw_list, plot_pos, plot_size, min_price,
+                            max_price);
+  }
+
   // Draw price labels on x-axis
   int num_price_labels = 10;
   for (int i = 0; i <= num_price_labels; i++) {
@@ -1750,8 +2066,10 @@ bool OrderBookVisualizer::should_close() {
 }
 
 int main(int argc, char *argv[]) {
-  std::string pcap_file;
+  std::vector<std::string> inputs;
+  std::vector<std::string> list_files;
   std::string symbol_file = "data/symbol_nyse_parsed.csv";
+  std::vector<std::string> decision_log_files;
 
   // Parse command line arguments
   for (int i = 1; i < argc; i++) {
@@ -1759,21 +2077,41 @@ int main(int argc, char *argv[]) {
       filter_ticker = argv[++i];
     } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
       symbol_file = argv[++i];
-    } else if (pcap_file.empty()) {
-      pcap_file = argv[i];
+    } else if (strcmp(argv[i], "--decision-log") == 0 && i + 1 < argc) {
+      decision_log_files.push_back(argv[++i]);
+    } else if (strcmp(argv[i], "--file-list") == 0 && i + 1 < argc) {
+      list_files.push_back(argv[++i]);
+    } else {
+      inputs.push_back(argv[i]);
     }
   }
 
-  if (pcap_file.empty()) {
+  if (inputs.empty() && list_files.empty()) {
     std::cerr << "Usage: " << argv[0]
-              << " <pcap_file> [-t ticker] [-s symbol_file]" << std::endl;
+              << " <pcap_file|pcap_dir> [more files...] [-t ticker]"
+              << " [-s symbol_file] [--file-list FILE]"
+              << " [--decision-log FILE.mmlog ...]" << std::endl;
     std::cerr << "Example: " << argv[0]
               << " data/ny4-xnys-pillar-a-20230822T133000.pcap -t AAPL"
               << std::endl;
+    std::cerr << "Multiple files, directories and --file-list entries are "
+                 "replayed in first-packet timestamp order into one book"
+              << std::endl;
     std::cerr << "Default symbol file: data/symbol_nyse_parsed.csv" << std::endl;
     return 1;
   }
 
+  std::vector<std::string> pcap_files;
+  if (!collect_pcap_inputs(inputs, list_files, pcap_files)) {
+    std::cerr << "Error: no readable PCAP files in the given inputs"
+              << std::endl;
+    return 1;
+  }
+  if (pcap_files.size() > 1) {
+    std::cout << "Streaming " << pcap_files.size()
+              << " PCAP files in timestamp order" << std::endl;
+  }
+
   // Load symbol mapping
   size_t symbols_loaded = xdp::load_symbol_map(symbol_file);
 
@@ -1791,13 +2129,19 @@ int main(int argc, char *argv[]) {
   OrderBookVisualizer visualizer(order_book);
   g_visualizer = &visualizer;
 
+  for (const auto &path : decision_log_files) {
+    if (!visualizer.load_decision_log(path)) {
+      return 1;
+    }
+  }
+
   if (!visualizer.init()) {
     std::cerr << "Failed to initialize visualizer" << std::endl;
     return 1;
   }
 
   // Start PCAP reading in a separate thread
-  std::thread pcap_thread(pcap_thread_func, pcap_file);
+  std::thread pcap_thread(pcap_thread_func, std::cref(pcap_files));
 
   // Main render loop - optimized for high FPS
   bool running = true;
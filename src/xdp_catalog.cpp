@@ -0,0 +1,208 @@
+// xdp_catalog.cpp - Capture catalog builder
+// Scans PCAP storage once and writes captures.csv (capture_catalog.hpp): one
+// row per file with its trading date, venue, channels, time range, size and
+// message counts. market_maker_sim --catalog selects multi-day batches from
+// it without touching the files again.
+//
+// Files are scanned in parallel (-j); --update keeps the rows of files whose
+// size and modification time are unchanged and scans only the rest.
+
+#include "common/capture_catalog.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+void print_usage(const char *program) {
+  std::cerr << "Capture catalog builder\n\n"
+            << "Usage: " << program << " [options] <dir|pcap>...\n\n"
+            << "Directories are searched recursively for *.pcap.\n\n"
+            << "Options:\n"
+            << "  -o FILE        Catalog to write (default: captures.csv)\n"
+            << "  --update       Reuse the rows of unchanged files already in the catalog\n"
+            << "  -j N           Files scanned in parallel (default: hardware threads)\n\n"
+            << "Example:\n"
+            << "  " << program << " -o captures.csv /data/xnys /data/arcx\n"
+            << "  market_maker_sim --catalog captures.csv --dates 2023-08-01:2023-08-31 --batch out\n";
+}
+
+int64_t file_mtime(const std::string &path) {
+  struct stat st{};
+  return stat(path.c_str(), &st) == 0 ? static_cast<int64_t>(st.st_mtime) : 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string out_path = "captures.csv";
+  std::vector<std::string> roots;
+  bool update = false;
+  size_t jobs = std::thread::hardware_concurrency();
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "-o" && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (arg == "--update") {
+      update = true;
+    } else if (arg == "-j" && i + 1 < argc) {
+      jobs = std::stoull(argv[++i]);
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg[0] != '-') {
+      roots.push_back(arg);
+    } else {
+      std::cerr << "Error: unknown option " << arg << "\n";
+      return 1;
+    }
+  }
+  if (roots.empty()) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  if (jobs == 0) jobs = 4;
+
+  namespace fs = std::filesystem;
+  std::vector<std::string> files;
+  for (const auto &root : roots) {
+    std::error_code ec;
+    if (fs::is_directory(root, ec)) {
+      for (auto it = fs::recursive_directory_iterator(root, ec);
+           !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file() && it->path().extension() == ".pcap") {
+          files.push_back(it->path().string());
+        }
+      }
+    } else if (fs::is_regular_file(root, ec)) {
+      files.push_back(root);
+    } else {
+      std::cerr << "Error: " << root << " is not a file or directory\n";
+      return 1;
+    }
+  }
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  // Skipped up front so one odd name does not cost the whole scan at save
+  files.erase(std::remove_if(files.begin(), files.end(),
+                             [](const std::string &path) {
+                               if (xdp::CaptureCatalog::storable(path)) return false;
+                               std::cerr << "Warning: skipping " << path
+                                         << ": ',' in a path cannot go in the catalog\n";
+                               return true;
+                             }),
+              files.end());
+
+  std::string err;
+  std::unordered_map<std::string, xdp::CaptureInfo> previous;
+  if (update && fs::exists(out_path)) {
+    xdp::CaptureCatalog old;
+    if (!xdp::CaptureCatalog::load(out_path, old, err)) {
+      std::cerr << "Error: " << err << "\n";
+      return 1;
+    }
+    for (auto &c : old.entries) previous.emplace(c.path, std::move(c));
+  }
+
+  // Unchanged files keep their rows; the rest are scanned
+  xdp::CaptureCatalog catalog;
+  std::vector<std::string> to_scan;
+  for (const auto &path : files) {
+    auto it = previous.find(path);
+    std::error_code ec;
+    const uint64_t bytes = fs::file_size(path, ec);
+    if (it != previous.end() && !ec && it->second.bytes == bytes &&
+        it->second.mtime == file_mtime(path)) {
+      catalog.entries.push_back(it->second);
+    } else {
+      to_scan.push_back(path);
+    }
+  }
+  const size_t reused = catalog.entries.size();
+
+  std::cerr << "Cataloguing " << files.size() << " files (" << to_scan.size() << " to scan, "
+            << reused << " unchanged) with " << std::min(jobs, std::max<size_t>(1, to_scan.size()))
+            << " threads\n";
+
+  auto start_time = std::chrono::steady_clock::now();
+  std::vector<xdp::CaptureInfo> scanned(to_scan.size());
+  std::vector<char> ok(to_scan.size(), 0);  // Not vector<bool>: written from several threads
+  std::atomic<size_t> next{0};
+  std::mutex err_mutex;
+  auto worker = [&] {
+    for (size_t i = next++; i < to_scan.size(); i = next++) {
+      std::string scan_err;
+      ok[i] = xdp::scan_capture(to_scan[i], scanned[i], scan_err);
+      if (ok[i]) {
+        scanned[i].mtime = file_mtime(to_scan[i]);
+      } else {
+        std::lock_guard<std::mutex> lock(err_mutex);
+        std::cerr << "Warning: skipping " << scan_err << "\n";
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < std::min(jobs, to_scan.size()); ++t) threads.emplace_back(worker);
+  for (auto &t : threads) t.join();
+  for (size_t i = 0; i < scanned.size(); ++i) {
+    if (ok[i]) catalog.entries.push_back(std::move(scanned[i]));
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  if (!catalog.save(out_path, err)) {
+    std::cerr << "Error: " << err << "\n";
+    return 1;
+  }
+
+  // Per date and venue
+  struct DayTotals {
+    size_t files = 0;
+    uint64_t bytes = 0;
+    uint64_t packets = 0;
+    uint64_t messages = 0;
+  };
+  std::map<std::pair<int32_t, std::string>, DayTotals> days;
+  uint64_t scanned_bytes = 0;
+  for (const auto &c : catalog.entries) {
+    DayTotals &d = days[{c.date, c.venue}];
+    d.files++;
+    d.bytes += c.bytes;
+    d.packets += c.packets;
+    d.messages += c.messages;
+  }
+  for (size_t i = 0; i < scanned.size(); ++i) {
+    if (ok[i]) scanned_bytes += scanned[i].bytes;
+  }
+
+  std::cout << "=== Capture Catalog: " << out_path << " ===\n"
+            << std::left << std::setw(12) << "Date" << std::setw(8) << "Venue" << std::right
+            << std::setw(7) << "Files" << std::setw(12) << "MB" << std::setw(14) << "Packets"
+            << std::setw(15) << "Messages" << "\n";
+  for (const auto &[key, d] : days) {
+    const std::string date = key.first ? xdp::SessionCalendar::format_date(key.first) : "(empty)";
+    std::cout << std::left << std::setw(12) << date
+              << std::setw(8) << (key.second.empty() ? "-" : key.second) << std::right
+              << std::setw(7) << d.files << std::setw(12) << std::fixed << std::setprecision(1)
+              << d.bytes / 1e6 << std::setw(14) << d.packets << std::setw(15) << d.messages
+              << "\n";
+  }
+  std::cout << "Files: " << catalog.entries.size() << " (" << catalog.entries.size() - reused
+            << " scanned in " << std::setprecision(2) << seconds << " s, "
+            << std::setprecision(1) << (seconds > 0 ? scanned_bytes / 1e6 / seconds : 0.0)
+            << " MB/s)\n";
+  return 0;
+}
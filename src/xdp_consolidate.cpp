@@ -0,0 +1,641 @@
+// xdp_consolidate.cpp - Multi-venue consolidated book
+// Replays captures of several NYSE-family XDP feeds (NYSE, Arca, American,
+// National, ...), each with its own symbol map and channel set, and builds a
+// consolidated book and BBO per security across them.
+//
+// Pipeline (consolidated_book.hpp):
+//   venue threads   one per feed: decode its files in order, keep its order
+//                   table, emit level updates tagged with the unified id
+//   merge thread    k-way merge of the venue streams by feed time
+//   apply threads   securities sharded by id: per-venue and consolidated
+//                   levels, BBO changes, locked/crossed accounting
+// Venue threads do the per-order work in parallel; the merge only moves
+// 24-byte level updates, so a run costs about as much as the largest feed.
+
+#include "consolidated_book.hpp"
+
+#include "common/mmap_pcap_reader.hpp"
+#include "common/spsc_ring.hpp"
+#include "common/symbol_map.hpp"
+#include "common/xdp_book_messages.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+constexpr size_t BATCH_UPDATES = 512;
+constexpr size_t RING_BATCHES = 64;
+constexpr uint32_t NO_SECURITY = UINT32_MAX;
+
+// Ring slot: a run of level updates from one venue (or for one apply shard)
+struct UpdateBatch {
+  uint32_t count = 0;
+  bool done = false;  // Producer finished; count may be 0
+  xdp::LevelUpdate updates[BATCH_UPDATES];
+};
+
+struct VenueSpec {
+  std::string name;
+  std::string symbol_file;
+  std::vector<std::pair<uint16_t, uint16_t>> ports;  // Channel ranges (empty = all)
+  std::vector<std::string> files;
+};
+
+struct VenueStats {
+  uint64_t packets = 0;
+  uint64_t skipped_packets = 0;   // Outside the venue's channel set
+  uint64_t book_messages = 0;
+  uint64_t unmapped_messages = 0; // Symbol index not in the venue's map
+  uint64_t level_updates = 0;
+  uint64_t time_regressions = 0;  // Packets stamped before the previous one
+  size_t orders = 0;
+  size_t levels = 0;
+  double seconds = 0.0;
+};
+
+struct ShardStats {
+  uint64_t updates = 0;
+  uint64_t bbo_changes = 0;
+  uint64_t locked = 0;  // Times the consolidated BBO became locked
+  uint64_t crossed = 0;
+  uint64_t locked_ns = 0;
+  uint64_t crossed_ns = 0;
+  size_t securities = 0;
+};
+
+// "14310,14320-14339"
+bool parse_ports(const std::string &s, std::vector<std::pair<uint16_t, uint16_t>> &out,
+                 std::string &err) {
+  std::stringstream ss(s);
+  std::string tok;
+  while (std::getline(ss, tok, ',')) {
+    const size_t dash = tok.find('-');
+    try {
+      const unsigned long lo = std::stoul(tok.substr(0, dash));
+      const unsigned long hi = dash == std::string::npos ? lo : std::stoul(tok.substr(dash + 1));
+      if (lo > hi || hi > 65535) throw std::out_of_range(tok);
+      out.emplace_back(static_cast<uint16_t>(lo), static_cast<uint16_t>(hi));
+    } catch (const std::exception &) {
+      err = "bad port range '" + tok + "'";
+      return false;
+    }
+  }
+  return true;
+}
+
+// One feed: decode, track orders, emit level updates into its ring
+class VenueWorker {
+public:
+  VenueWorker(const VenueSpec &spec, uint8_t venue, std::vector<uint32_t> to_unified)
+      : spec_(spec), venue_(venue), to_unified_(std::move(to_unified)), ring_(RING_BATCHES) {}
+
+  xdp::SpscRing<UpdateBatch> &ring() { return ring_; }
+  const VenueStats &stats() const { return stats_; }
+
+  void run() {
+    const auto t0 = std::chrono::steady_clock::now();
+    batch_ = &ring_.acquire();
+    batch_->count = 0;
+    batch_->done = false;
+    xdp::BookMessage msg;
+    for (const auto &path : spec_.files) {
+      xdp::MmapPcapReader reader;
+      if (!reader.open(path)) {
+        std::cerr << "[" << spec_.name << "] " << reader.error() << "\n";
+        continue;
+      }
+      reader.preload();
+      reader.process_all([&](const uint8_t *data, size_t len, uint64_t,
+                             const xdp::NetworkPacketInfo &info) {
+        if (!in_channels(info.dst_port)) {
+          stats_.skipped_packets++;
+          return;
+        }
+        stats_.packets++;
+        if (info.timestamp_ns < ts_) {
+          stats_.time_regressions++;  // Keep the stream ordered
+        } else {
+          ts_ = info.timestamp_ns;
+        }
+        xdp::for_each_message(data, len, [&](const uint8_t *m, size_t msg_len, uint16_t type) {
+          if (!xdp::decode_book_message(m, msg_len, type, msg)) return;
+          stats_.book_messages++;
+          const uint32_t security =
+              msg.symbol_index < to_unified_.size() ? to_unified_[msg.symbol_index] : NO_SECURITY;
+          if (security == NO_SECURITY) {
+            stats_.unmapped_messages++;
+            return;
+          }
+          const uint64_t before = stats_.level_updates;
+          levels_.apply(msg, security, [&](uint32_t sec, char side, uint32_t price, uint32_t qty) {
+            emit(sec, side, price, qty);
+          });
+          if (stats_.level_updates != before) batch_->updates[batch_->count - 1].last = 1;
+        });
+      });
+    }
+    batch_->done = true;
+    ring_.commit();
+    stats_.orders = levels_.orders();
+    stats_.levels = levels_.levels();
+    stats_.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  }
+
+private:
+  bool in_channels(uint16_t port) const {
+    if (spec_.ports.empty()) return true;
+    for (const auto &[lo, hi] : spec_.ports) {
+      if (port >= lo && port <= hi) return true;
+    }
+    return false;
+  }
+
+  // A full batch is committed only when the next update needs room, so the
+  // last update of a message is still writable after apply() returns
+  void emit(uint32_t security, char side, uint32_t price, uint32_t qty) {
+    if (batch_->count == BATCH_UPDATES) {
+      ring_.commit();
+      batch_ = &ring_.acquire();
+      batch_->count = 0;
+      batch_->done = false;
+    }
+    batch_->updates[batch_->count++] = {ts_, security, price, qty, venue_, side, 0, 0};
+    stats_.level_updates++;
+  }
+
+  const VenueSpec &spec_;
+  uint8_t venue_;
+  std::vector<uint32_t> to_unified_;  // Venue symbol index -> unified id
+  xdp::VenueLevels levels_;
+  xdp::SpscRing<UpdateBatch> ring_;
+  UpdateBatch *batch_ = nullptr;
+  uint64_t ts_ = 0;
+  VenueStats stats_;
+};
+
+// Securities with id % num_shards == shard: consolidated books and BBOs
+class ApplyShard {
+public:
+  ApplyShard(size_t shard, size_t num_shards, const xdp::SecurityMaster &master,
+             const std::vector<std::string> &venue_names,
+             const std::unordered_set<uint32_t> &selected, std::ostream *bbo_out)
+      : shard_(shard), num_shards_(num_shards), master_(master), venue_names_(venue_names),
+        selected_(selected), bbo_out_(bbo_out), ring_(RING_BATCHES),
+        securities_((master.size() + num_shards - 1 - shard) / num_shards) {}
+
+  xdp::SpscRing<UpdateBatch> &ring() { return ring_; }
+  const ShardStats &stats() const { return stats_; }
+
+  void run() {
+    for (;;) {
+      UpdateBatch &batch = ring_.front();
+      for (uint32_t i = 0; i < batch.count; ++i) apply(batch.updates[i]);
+      const bool done = batch.done;
+      ring_.pop();
+      if (done) break;
+    }
+    for (const auto &s : securities_) {
+      if (!s) continue;
+      stats_.securities++;
+      account(*s, s->last_ts);
+    }
+  }
+
+  const xdp::ConsolidatedBook *book(uint32_t security) const {
+    const auto &s = securities_[security / num_shards_];
+    return s ? &s->book : nullptr;
+  }
+
+private:
+  struct Security {
+    xdp::ConsolidatedBook book;
+    xdp::ConsolidatedBbo bbo;
+    uint64_t since_ts = 0;  // Time of the last BBO change
+    uint64_t last_ts = 0;
+  };
+
+  enum class Touch { NORMAL, LOCKED, CROSSED };
+
+  static Touch touch(const xdp::ConsolidatedBbo &b) {
+    return b.crossed() ? Touch::CROSSED : b.locked() ? Touch::LOCKED : Touch::NORMAL;
+  }
+
+  // Charge the time since the last BBO change to its locked/crossed state
+  void account(const Security &s, uint64_t now_ns) {
+    const uint64_t held = now_ns > s.since_ts ? now_ns - s.since_ts : 0;
+    if (touch(s.bbo) == Touch::LOCKED) stats_.locked_ns += held;
+    if (touch(s.bbo) == Touch::CROSSED) stats_.crossed_ns += held;
+  }
+
+  void apply(const xdp::LevelUpdate &u) {
+    stats_.updates++;
+    auto &slot = securities_[u.security / num_shards_];
+    if (!slot) slot = std::make_unique<Security>();
+    Security &s = *slot;
+    s.book.apply(u);
+    s.last_ts = u.ts_ns;
+    if (!u.last) return;
+    const xdp::ConsolidatedBbo bbo = s.book.bbo();
+    if (bbo == s.bbo) return;
+    stats_.bbo_changes++;
+    account(s, u.ts_ns);
+    const Touch now = touch(bbo);
+    if (now != touch(s.bbo)) {
+      if (now == Touch::LOCKED) stats_.locked++;
+      if (now == Touch::CROSSED) stats_.crossed++;
+    }
+    s.bbo = bbo;
+    s.since_ts = u.ts_ns;
+    if (bbo_out_ && (selected_.empty() || selected_.count(u.security))) write_bbo(u, bbo);
+  }
+
+  std::string venues(uint8_t mask) const {
+    std::string out;
+    for (size_t v = 0; v < venue_names_.size(); ++v) {
+      if (mask & (1u << v)) out += (out.empty() ? "" : "|") + venue_names_[v];
+    }
+    return out;
+  }
+
+  void write_bbo(const xdp::LevelUpdate &u, const xdp::ConsolidatedBbo &b) {
+    *bbo_out_ << u.ts_ns << ',' << master_.ticker(u.security) << ',' << std::fixed
+              << std::setprecision(4) << xdp::parse_price(b.bid) << ',' << b.bid_qty << ','
+              << venues(b.bid_venues) << ',' << xdp::parse_price(b.ask) << ',' << b.ask_qty
+              << ',' << venues(b.ask_venues) << '\n';
+    bbo_out_->unsetf(std::ios::floatfield);
+  }
+
+  size_t shard_;
+  size_t num_shards_;
+  const xdp::SecurityMaster &master_;
+  const std::vector<std::string> &venue_names_;
+  const std::unordered_set<uint32_t> &selected_;
+  std::ostream *bbo_out_;
+  xdp::SpscRing<UpdateBatch> ring_;
+  std::vector<std::unique_ptr<Security>> securities_;
+  ShardStats stats_;
+};
+
+// k-way merge of the venue streams by (feed time, venue), fanned out to the
+// apply shards. Each venue's updates of one message stay contiguous.
+uint64_t merge_venues(std::vector<std::unique_ptr<VenueWorker>> &venues,
+                      std::vector<std::unique_ptr<ApplyShard>> &shards) {
+  struct Cursor {
+    UpdateBatch *batch = nullptr;
+    uint32_t pos = 0;
+    bool live = true;
+  };
+  std::vector<Cursor> cursors(venues.size());
+  std::vector<UpdateBatch *> out(shards.size());
+  for (size_t s = 0; s < shards.size(); ++s) {
+    out[s] = &shards[s]->ring().acquire();
+    out[s]->count = 0;
+    out[s]->done = false;
+  }
+
+  // Next update of venue v, or false once the venue is finished
+  auto ready = [&](size_t v) {
+    Cursor &c = cursors[v];
+    while (c.live && (!c.batch || c.pos == c.batch->count)) {
+      if (c.batch) {
+        const bool done = c.batch->done;
+        venues[v]->ring().pop();
+        c.batch = nullptr;
+        if (done) {
+          c.live = false;
+          break;
+        }
+      }
+      c.batch = &venues[v]->ring().front();
+      c.pos = 0;
+      if (c.batch->count == 0 && c.batch->done) {
+        venues[v]->ring().pop();
+        c.batch = nullptr;
+        c.live = false;
+      }
+    }
+    return c.live;
+  };
+
+  uint64_t merged = 0;
+  for (;;) {
+    // Venue with the earliest next update, and the runner-up's time
+    size_t best = venues.size();
+    uint64_t best_ts = UINT64_MAX, next_ts = UINT64_MAX;
+    size_t next = venues.size();
+    for (size_t v = 0; v < venues.size(); ++v) {
+      if (!ready(v)) continue;
+      const uint64_t ts = cursors[v].batch->updates[cursors[v].pos].ts_ns;
+      if (ts < best_ts) {
+        next_ts = best_ts;
+        next = best;
+        best_ts = ts;
+        best = v;
+      } else if (ts < next_ts) {
+        next_ts = ts;
+        next = v;
+      }
+    }
+    if (best == venues.size()) break;
+
+    // Take the run that stays ahead of the runner-up; ties go to the lower
+    // venue, and a message is never split
+    Cursor &c = cursors[best];
+    do {
+      const xdp::LevelUpdate &u = c.batch->updates[c.pos++];
+      const size_t s = u.security % shards.size();
+      if (out[s]->count == BATCH_UPDATES) {
+        shards[s]->ring().commit();
+        out[s] = &shards[s]->ring().acquire();
+        out[s]->count = 0;
+        out[s]->done = false;
+      }
+      out[s]->updates[out[s]->count++] = u;
+      ++merged;
+      if (!u.last) continue;
+      if (!ready(best)) break;
+      const uint64_t ts = c.batch->updates[c.pos].ts_ns;
+      if (ts > next_ts || (ts == next_ts && next < best)) break;
+    } while (c.pos < c.batch->count || ready(best));
+  }
+
+  for (size_t s = 0; s < shards.size(); ++s) {
+    out[s]->done = true;
+    shards[s]->ring().commit();
+  }
+  return merged;
+}
+
+void print_book(std::ostream &os, const std::string &ticker, const xdp::ConsolidatedBook &book,
+                const std::vector<std::string> &venue_names, size_t depth) {
+  std::vector<std::pair<uint32_t, xdp::ConsolidatedBook::Level>> bids, asks;
+  book.top_levels(depth, bids, asks);
+  os << "\n" << ticker << " consolidated book (shares per venue)\n";
+  os << "  " << std::setw(12) << "BID" << std::setw(10) << "TOTAL";
+  for (const auto &n : venue_names) os << std::setw(9) << n;
+  os << "  |  " << std::left << std::setw(12) << "ASK" << std::right << std::setw(10) << "TOTAL";
+  for (const auto &n : venue_names) os << std::setw(9) << n;
+  os << "\n" << std::fixed << std::setprecision(4);
+  const size_t rows = std::max(bids.size(), asks.size());
+  for (size_t i = 0; i < rows; ++i) {
+    os << "  ";
+    if (i < bids.size()) {
+      os << std::setw(12) << xdp::parse_price(bids[i].first) << std::setw(10) << bids[i].second.total;
+      for (size_t v = 0; v < venue_names.size(); ++v) os << std::setw(9) << bids[i].second.venue_qty[v];
+    } else {
+      os << std::setw(static_cast<int>(22 + 9 * venue_names.size())) << "";
+    }
+    os << "  |  ";
+    if (i < asks.size()) {
+      os << std::left << std::setw(12) << xdp::parse_price(asks[i].first) << std::right
+         << std::setw(10) << asks[i].second.total;
+      for (size_t v = 0; v < venue_names.size(); ++v) os << std::setw(9) << asks[i].second.venue_qty[v];
+    }
+    os << "\n";
+  }
+  os << "  Venue BBO:";
+  for (size_t v = 0; v < venue_names.size(); ++v) {
+    os << "  " << venue_names[v] << " " << xdp::parse_price(book.venue_best(v, 'B')) << "/"
+       << xdp::parse_price(book.venue_best(v, 'S'));
+  }
+  os << "\n";
+  os.unsetf(std::ios::floatfield);
+}
+
+void print_usage(const char *program) {
+  std::cerr << "Multi-venue consolidated book from several XDP feeds\n\n"
+            << "Usage: " << program
+            << " --venue NAME [-s SYMBOLS] [--channels PORTS] FILE... [--venue NAME ...] [options]\n\n"
+            << "Each --venue starts a feed; the symbol map, channel set and PCAP files\n"
+            << "that follow belong to it. Securities are matched across venues by ticker.\n\n"
+            << "Venue options:\n"
+            << "  --venue NAME          Start a venue (e.g. N, P, A, C; at most 8)\n"
+            << "  -s, --symbols FILE    The venue's symbol map (default: data/symbol_nyse_parsed.csv)\n"
+            << "  --channels PORTS      UDP destination ports of its channels, e.g.\n"
+            << "                        14310,14320-14339 (default: every packet)\n\n"
+            << "Options:\n"
+            << "  --apply-threads N     Consolidated book shards (default: 1)\n"
+            << "  --bbo-out FILE        Write every consolidated BBO change as CSV\n"
+            << "  -t TICKER             Restrict --bbo-out to these tickers and print their\n"
+            << "                        final consolidated books (comma list or repeatable)\n"
+            << "  --depth N             Levels per side in printed books (default: 5)\n\n"
+            << "Example:\n"
+            << "  " << program << " --venue N -s nyse_symbols.csv nyse/*.pcap \\\n"
+            << "      --venue P -s arca_symbols.csv arca/*.pcap -t SPY --bbo-out spy_bbo.csv\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::vector<VenueSpec> specs;
+  std::vector<std::string> tickers;
+  std::string bbo_path;
+  size_t apply_threads = 1;
+  size_t depth = 5;
+  std::string err;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--venue" && i + 1 < argc) {
+      specs.push_back({argv[++i], "data/symbol_nyse_parsed.csv", {}, {}});
+    } else if ((arg == "-s" || arg == "--symbols") && i + 1 < argc) {
+      if (specs.empty()) {
+        std::cerr << "Error: " << arg << " before --venue\n";
+        return 1;
+      }
+      specs.back().symbol_file = argv[++i];
+    } else if (arg == "--channels" && i + 1 < argc) {
+      if (specs.empty() || !parse_ports(argv[++i], specs.back().ports, err)) {
+        std::cerr << "Error: --channels: " << (specs.empty() ? "before --venue" : err) << "\n";
+        return 1;
+      }
+    } else if (arg == "--apply-threads" && i + 1 < argc) {
+      apply_threads = std::max<size_t>(1, std::stoull(argv[++i]));
+    } else if (arg == "--bbo-out" && i + 1 < argc) {
+      bbo_path = argv[++i];
+    } else if (arg == "-t" && i + 1 < argc) {
+      std::stringstream ss(argv[++i]);
+      std::string t;
+      while (std::getline(ss, t, ',')) {
+        if (!t.empty()) tickers.push_back(t);
+      }
+    } else if (arg == "--depth" && i + 1 < argc) {
+      depth = std::max<size_t>(1, std::stoull(argv[++i]));
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg[0] != '-') {
+      if (specs.empty()) {
+        std::cerr << "Error: " << arg << " before --venue\n";
+        return 1;
+      }
+      specs.back().files.push_back(arg);
+    } else {
+      std::cerr << "Error: unknown option " << arg << "\n";
+      return 1;
+    }
+  }
+  if (specs.empty() || specs.size() > xdp::MAX_VENUES ||
+      std::any_of(specs.begin(), specs.end(), [](const VenueSpec &v) { return v.files.empty(); })) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  // Unified ids: every venue's tickers, in venue then symbol index order
+  xdp::SecurityMaster master;
+  std::vector<std::vector<uint32_t>> to_unified(specs.size());
+  std::vector<std::string> venue_names;
+  for (size_t v = 0; v < specs.size(); ++v) {
+    VenueSpec &spec = specs[v];
+    std::sort(spec.files.begin(), spec.files.end());
+    venue_names.push_back(spec.name);
+    xdp::SymbolMap map;
+    if (!map.load(spec.symbol_file)) {
+      std::cerr << "Error: [" << spec.name << "] cannot load symbol map " << spec.symbol_file << "\n";
+      return 1;
+    }
+    std::vector<std::pair<uint32_t, std::string>> symbols;
+    for (const auto &[idx, info] : map.get_map()) symbols.emplace_back(idx, info.symbol);
+    std::sort(symbols.begin(), symbols.end());
+    to_unified[v].assign(symbols.empty() ? 0 : symbols.back().first + 1, NO_SECURITY);
+    for (const auto &[idx, ticker] : symbols) to_unified[v][idx] = master.intern(ticker);
+  }
+
+  std::unordered_set<uint32_t> selected;
+  for (const auto &t : tickers) {
+    const uint32_t *id = master.find(t);
+    if (!id) {
+      std::cerr << "Warning: " << t << " is in no venue's symbol map\n";
+      continue;
+    }
+    selected.insert(*id);
+  }
+
+  std::cerr << "=== Consolidated Book ===\n";
+  for (const auto &spec : specs) {
+    std::cerr << "Venue " << spec.name << ": " << spec.files.size() << " files, symbols "
+              << spec.symbol_file << ", channels ";
+    if (spec.ports.empty()) std::cerr << "all";
+    for (size_t i = 0; i < spec.ports.size(); ++i) {
+      std::cerr << (i ? "," : "") << spec.ports[i].first;
+      if (spec.ports[i].second != spec.ports[i].first) std::cerr << '-' << spec.ports[i].second;
+    }
+    std::cerr << "\n";
+  }
+  std::cerr << "Securities: " << master.size() << " unified\n"
+            << "Apply threads: " << apply_threads << "\n"
+            << "=========================\n" << std::flush;
+
+  // One BBO file per shard, concatenated at the end
+  std::vector<std::unique_ptr<std::ofstream>> bbo_parts;
+  for (size_t s = 0; !bbo_path.empty() && s < apply_threads; ++s) {
+    const std::string part = apply_threads == 1 ? bbo_path : bbo_path + ".s" + std::to_string(s + 1);
+    bbo_parts.push_back(std::make_unique<std::ofstream>(part));
+    if (!bbo_parts.back()->is_open()) {
+      std::cerr << "Error: cannot write " << part << "\n";
+      return 1;
+    }
+    if (apply_threads == 1) {
+      *bbo_parts.back() << "ts_ns,ticker,bid,bid_qty,bid_venues,ask,ask_qty,ask_venues\n";
+    }
+  }
+
+  auto start_time = std::chrono::steady_clock::now();
+
+  std::vector<std::unique_ptr<VenueWorker>> venues;
+  for (size_t v = 0; v < specs.size(); ++v) {
+    venues.push_back(std::make_unique<VenueWorker>(specs[v], static_cast<uint8_t>(v),
+                                                   std::move(to_unified[v])));
+  }
+  std::vector<std::unique_ptr<ApplyShard>> shards;
+  for (size_t s = 0; s < apply_threads; ++s) {
+    shards.push_back(std::make_unique<ApplyShard>(s, apply_threads, master, venue_names, selected,
+                                                  bbo_parts.empty() ? nullptr : bbo_parts[s].get()));
+  }
+
+  std::vector<std::thread> threads;
+  for (auto &shard : shards) threads.emplace_back([&shard] { shard->run(); });
+  for (auto &venue : venues) threads.emplace_back([&venue] { venue->run(); });
+  const uint64_t merged = merge_venues(venues, shards);
+  for (auto &t : threads) t.join();
+
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  if (!bbo_path.empty() && apply_threads > 1) {
+    std::ofstream out(bbo_path);
+    out << "ts_ns,ticker,bid,bid_qty,bid_venues,ask,ask_qty,ask_venues\n";
+    for (size_t s = 0; s < apply_threads; ++s) {
+      const std::string part = bbo_path + ".s" + std::to_string(s + 1);
+      bbo_parts[s]->close();
+      std::ifstream in(part);
+      out << in.rdbuf();
+      in.close();
+      std::remove(part.c_str());
+    }
+  }
+
+  std::cout << "=== Venues ===\n"
+            << std::left << std::setw(8) << "Venue" << std::right << std::setw(12) << "Packets"
+            << std::setw(12) << "Skipped" << std::setw(14) << "Book msgs" << std::setw(12)
+            << "Unmapped" << std::setw(14) << "Level upds" << std::setw(11) << "Orders"
+            << std::setw(10) << "Decode s" << "\n";
+  for (size_t v = 0; v < venues.size(); ++v) {
+    const VenueStats &st = venues[v]->stats();
+    std::cout << std::left << std::setw(8) << specs[v].name << std::right << std::setw(12)
+              << st.packets << std::setw(12) << st.skipped_packets << std::setw(14)
+              << st.book_messages << std::setw(12) << st.unmapped_messages << std::setw(14)
+              << st.level_updates << std::setw(11) << st.orders << std::setw(10) << std::fixed
+              << std::setprecision(2) << st.seconds << "\n";
+    std::cout.unsetf(std::ios::floatfield);
+    if (st.time_regressions) {
+      std::cerr << "Warning: " << specs[v].name << ": " << st.time_regressions
+                << " packets stamped before their predecessor (merged at the later time)\n";
+    }
+  }
+
+  ShardStats total;
+  for (const auto &shard : shards) {
+    const ShardStats &st = shard->stats();
+    total.updates += st.updates;
+    total.bbo_changes += st.bbo_changes;
+    total.locked += st.locked;
+    total.crossed += st.crossed;
+    total.locked_ns += st.locked_ns;
+    total.crossed_ns += st.crossed_ns;
+    total.securities += st.securities;
+  }
+  std::cout << "\n=== Consolidated ===\n"
+            << "Securities with updates: " << total.securities << "\n"
+            << "Level updates merged: " << merged << "\n"
+            << "BBO changes: " << total.bbo_changes << "\n"
+            << "Locked: " << total.locked << " times, " << std::fixed << std::setprecision(3)
+            << static_cast<double>(total.locked_ns) / 1e9 << " s\n"
+            << "Crossed: " << total.crossed << " times, "
+            << static_cast<double>(total.crossed_ns) / 1e9 << " s\n"
+            << "Total time: " << std::setprecision(2) << seconds << " seconds\n";
+  std::cout.unsetf(std::ios::floatfield);
+  if (!bbo_path.empty()) std::cout << "BBO changes written: " << bbo_path << "\n";
+
+  for (const uint32_t id : selected) {
+    const xdp::ConsolidatedBook *book = shards[id % shards.size()]->book(id);
+    if (!book) {
+      std::cout << "\n" << master.ticker(id) << ": no book updates\n";
+      continue;
+    }
+    print_book(std::cout, master.ticker(id), *book, venue_names, depth);
+  }
+  return 0;
+}
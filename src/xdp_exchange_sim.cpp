@@ -0,0 +1,763 @@
+// xdp_exchange_sim.cpp - Local matching-engine stand-in
+// Replays XDP captures as the exchange clock, keeps a price-time priority
+// book per symbol that merges client orders into the replayed queues, and
+// serves an OUCH-style order entry protocol (src/common/order_entry.hpp) on
+// loopback TCP and/or Unix sockets. The replayed packets can be republished
+// over UDP so a strategy process sees the same feed it trades against.
+//
+// Single-threaded and deterministic for a given input order: the event loop
+// alternates socket I/O with feed packets. Gateway latency is modelled in
+// feed time: an order received while the replay clock reads T reaches the
+// book at T + latency, and its reports are released at book time + latency.
+
+#include "exchange_book.hpp"
+
+#include "common/mmap_pcap_reader.hpp"
+#include "common/order_entry.hpp"
+#include "common/symbol_map.hpp"
+#include "common/xdp_book_messages.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t MAX_SYMBOLS = 100000;
+
+volatile std::sig_atomic_t g_stop = 0;
+void on_signal(int) { g_stop = 1; }
+
+struct ExchangeConfig {
+  std::vector<std::string> listen = {"tcp:127.0.0.1:9001"};
+  std::string feed_udp;               // HOST:PORT, empty = no republish
+  double speed = 1.0;                 // Feed seconds per wall second, 0 = max
+  size_t wait_clients = 1;
+  double gateway_latency_us = 20.0;   // One-way, each direction
+  double gateway_jitter_us = 5.0;
+  uint64_t seed = 42;
+  uint64_t linger_ms = 1000;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// One order entry session
+struct Session {
+  int fd = -1;
+  uint32_t id = 0;
+  std::vector<uint8_t> rx;
+  std::vector<uint8_t> tx;
+  uint64_t last_release_ns = 0;       // Keeps reports in order under jitter
+  std::unordered_map<uint64_t, uint64_t> token_to_ref;
+  uint64_t orders = 0, fills = 0, shares = 0;
+};
+
+// Our order as known to the gateway
+struct OwnOrder {
+  uint32_t session = 0;
+  uint64_t token = 0;
+  uint32_t symbol_index = 0;
+};
+
+// An inbound message waiting out its gateway latency
+struct Inbound {
+  uint64_t effective_ns;
+  uint64_t seq;
+  uint32_t session;
+  std::vector<uint8_t> body;
+  bool operator>(const Inbound &o) const {
+    return effective_ns != o.effective_ns ? effective_ns > o.effective_ns : seq > o.seq;
+  }
+};
+
+// A report waiting to be released to its session
+struct Outbound {
+  uint64_t release_ns;
+  uint64_t seq;
+  uint32_t session;
+  std::vector<uint8_t> frame;
+  bool operator>(const Outbound &o) const {
+    return release_ns != o.release_ns ? release_ns > o.release_ns : seq > o.seq;
+  }
+};
+
+class ExchangeSim {
+public:
+  explicit ExchangeSim(const ExchangeConfig &config)
+      : config_(config), rng_(config.seed),
+        latency_us_(config.gateway_latency_us, config.gateway_jitter_us),
+        books_(MAX_SYMBOLS + 1) {}
+
+  ~ExchangeSim() {
+    for (auto &[id, s] : sessions_) ::close(s.fd);
+    for (int fd : listen_fds_) ::close(fd);
+    if (udp_fd_ >= 0) ::close(udp_fd_);
+    for (const auto &ep : listen_eps_) {
+      if (ep.is_unix) ::unlink(ep.path.c_str());
+    }
+  }
+
+  void set_allowed(std::vector<uint8_t> allowed) { allowed_ = std::move(allowed); }
+
+  bool start(std::string &err) {
+    for (const auto &text : config_.listen) {
+      xdp::oe::Endpoint ep;
+      if (!xdp::oe::Endpoint::parse(text, ep, err)) return false;
+      int fd = xdp::oe::listen_endpoint(ep, err);
+      if (fd < 0) return false;
+      listen_fds_.push_back(fd);
+      listen_eps_.push_back(ep);
+    }
+    if (!config_.feed_udp.empty()) {
+      xdp::oe::Endpoint ep;
+      if (!xdp::oe::Endpoint::parse(config_.feed_udp, ep, err) || ep.is_unix ||
+          !xdp::oe::detail::fill_inet(ep, udp_addr_, err)) {
+        if (err.empty()) err = "--feed-udp needs HOST:PORT";
+        return false;
+      }
+      udp_fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+      if (udp_fd_ < 0) {
+        err = "cannot create UDP socket";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Serve connections until enough clients are in (or a signal arrives)
+  void wait_for_clients() {
+    while (!g_stop && sessions_.size() < config_.wait_clients) service_io(100);
+  }
+
+  void begin_replay(uint64_t first_ns) {
+    clock_ns_ = first_ns;
+    wall0_ = Clock::now();
+    feed0_ns_ = first_ns;
+    xdp::oe::SystemEvent ev;
+    ev.ts_ns = first_ns;
+    ev.event = 'S';
+    for (auto &[id, s] : sessions_) queue_report(s, first_ns, ev);
+    replaying_ = true;
+  }
+
+  // One captured packet at feed time ts_ns
+  void on_packet(const uint8_t *data, size_t len, uint64_t ts_ns) {
+    ts_ns = std::max(ts_ns, clock_ns_);
+    pace_to(ts_ns);
+    run_inbound(ts_ns);
+    clock_ns_ = ts_ns;
+
+    xdp::for_each_message(data, len, [&](const uint8_t *m, size_t msg_len, uint16_t msg_type) {
+      if (!xdp::decode_book_message(m, msg_len, msg_type, msg_)) return;
+      if (msg_.symbol_index == 0 || msg_.symbol_index > MAX_SYMBOLS) return;
+      if (!allowed_.empty() && !allowed_[msg_.symbol_index]) return;
+      apply_feed(msg_, ts_ns);
+    });
+    packets_++;
+
+    if (udp_fd_ >= 0) {
+      (void)::sendto(udp_fd_, data, len, 0, reinterpret_cast<sockaddr *>(&udp_addr_),
+                     sizeof(udp_addr_));
+    }
+    release_reports(ts_ns);
+    if (config_.speed <= 0.0 && (packets_ & 63) == 0) service_io(0);
+  }
+
+  // Cancel what is left, announce the end and flush every report
+  void end_replay() {
+    run_inbound(UINT64_MAX);
+    replaying_ = false;
+    for (uint32_t idx = 0; idx <= MAX_SYMBOLS; ++idx) {
+      if (!books_[idx]) continue;
+      for (uint64_t ref : books_[idx]->own_refs()) cancel_ref(ref, 'E', clock_ns_);
+    }
+    xdp::oe::SystemEvent ev;
+    ev.ts_ns = clock_ns_;
+    ev.event = 'E';
+    for (auto &[id, s] : sessions_) queue_report(s, clock_ns_, ev);
+    release_reports(UINT64_MAX);
+
+    auto until = Clock::now() + std::chrono::milliseconds(config_.linger_ms);
+    while (!g_stop && Clock::now() < until) {
+      service_io(10);
+      if (sessions_.empty()) break;
+    }
+  }
+
+  void print_summary(std::ostream &out, double seconds) const {
+    uint64_t orders = orders_, fills = 0, shares = 0;
+    for (const auto &[id, s] : closed_stats_) {
+      fills += s.first;
+      shares += s.second;
+    }
+    for (const auto &[id, s] : sessions_) {
+      fills += s.fills;
+      shares += s.shares;
+    }
+    out << "Packets replayed: " << packets_ << "\n"
+        << "Sessions: " << next_session_id_ - 1 << "\n"
+        << "Orders: " << orders << " (rejected " << rejects_ << ")\n"
+        << "Fills: " << fills << " (" << shares << " shares)\n"
+        << "Replay time: " << std::fixed << std::setprecision(2) << seconds << " seconds\n";
+  }
+
+  [[nodiscard]] bool stopped() const { return g_stop != 0; }
+
+private:
+  // --- Feed ---
+
+  xdp::ExchangeBook &book(uint32_t idx) {
+    auto &slot = books_[idx];
+    if (!slot) slot = std::make_unique<xdp::ExchangeBook>();
+    return *slot;
+  }
+
+  void apply_feed(const xdp::BookMessage &m, uint64_t ts_ns) {
+    xdp::ExchangeBook &b = book(m.symbol_index);
+    fills_.clear();
+    switch (m.msg_type) {
+    case static_cast<uint16_t>(xdp::MessageType::ADD_ORDER):
+      b.feed_add(m.order_id, m.side, m.price_raw, m.volume, fills_);
+      break;
+    case static_cast<uint16_t>(xdp::MessageType::MODIFY_ORDER):
+      b.feed_modify(m.order_id, m.price_raw, m.volume, fills_);
+      break;
+    case static_cast<uint16_t>(xdp::MessageType::DELETE_ORDER):
+      b.feed_delete(m.order_id);
+      break;
+    case static_cast<uint16_t>(xdp::MessageType::EXECUTE_ORDER):
+      b.feed_execute(m.order_id, m.volume, fills_);
+      break;
+    case static_cast<uint16_t>(xdp::MessageType::REPLACE_ORDER):
+      b.feed_delete(m.order_id);
+      b.feed_add(m.new_order_id, m.side, m.price_raw, m.volume, fills_);
+      break;
+    default:
+      break;
+    }
+    report_fills(ts_ns);
+  }
+
+  // --- Order entry ---
+
+  void run_inbound(uint64_t up_to_ns) {
+    while (!inbound_.empty() && inbound_.top().effective_ns <= up_to_ns) {
+      Inbound in = inbound_.top();
+      inbound_.pop();
+      auto it = sessions_.find(in.session);
+      if (it == sessions_.end()) continue;
+      handle(it->second, in.body.data(), in.body.size(), std::max(in.effective_ns, clock_ns_));
+    }
+  }
+
+  void handle(Session &s, const uint8_t *body, size_t len, uint64_t now_ns) {
+    switch (body[0]) {
+    case 'O': {
+      xdp::oe::EnterOrder m;
+      if (xdp::oe::read_message(body, len, m)) enter(s, m, now_ns);
+      break;
+    }
+    case 'X': {
+      xdp::oe::CancelOrder m;
+      if (!xdp::oe::read_message(body, len, m)) break;
+      auto it = s.token_to_ref.find(m.token);
+      if (it == s.token_to_ref.end()) {
+        reject(s, m.token, 'T', now_ns);
+      } else {
+        cancel_ref(it->second, 'U', now_ns);
+      }
+      break;
+    }
+    case 'U': {
+      xdp::oe::ReplaceOrder m;
+      if (xdp::oe::read_message(body, len, m)) replace(s, m, now_ns);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  void enter(Session &s, const xdp::oe::EnterOrder &m, uint64_t now_ns) {
+    orders_++;
+    s.orders++;
+    if (!replaying_) return reject(s, m.token, 'C', now_ns);
+    if (s.token_to_ref.count(m.token)) return reject(s, m.token, 'D', now_ns);
+    if ((m.side != 'B' && m.side != 'S') || (m.tif != 'D' && m.tif != 'I') || m.qty == 0 ||
+        m.price_raw == 0) {
+      return reject(s, m.token, 'P', now_ns);
+    }
+    const auto idx = xdp::get_global_symbol_map().find_index(xdp::oe::symbol_of(m.symbol));
+    if (!idx || *idx == 0 || *idx > MAX_SYMBOLS || (!allowed_.empty() && !allowed_[*idx])) {
+      return reject(s, m.token, 'S', now_ns);
+    }
+
+    const uint64_t ref = next_ref_++;
+    own_[ref] = {s.id, m.token, *idx};
+    s.token_to_ref[m.token] = ref;
+
+    xdp::oe::Accepted ack;
+    ack.ts_ns = now_ns;
+    ack.token = m.token;
+    ack.order_ref = ref;
+    std::memcpy(ack.symbol, m.symbol, sizeof(ack.symbol));
+    ack.side = m.side;
+    ack.tif = m.tif;
+    ack.qty = m.qty;
+    ack.price_raw = m.price_raw;
+    queue_report(s, now_ns, ack);
+
+    fills_.clear();
+    const uint32_t rested = book(*idx).enter(ref, m.side, m.price_raw, m.qty, m.tif == 'I', fills_);
+    uint32_t filled = 0;
+    for (const auto &f : fills_) filled += f.qty;
+    report_fills(now_ns);
+    if (rested == 0 && filled < m.qty) {
+      xdp::oe::Canceled c;
+      c.ts_ns = now_ns;
+      c.token = m.token;
+      c.qty = m.qty - filled;
+      c.reason = 'I';
+      queue_report(s, now_ns, c);
+      forget(ref);
+    }
+  }
+
+  void replace(Session &s, const xdp::oe::ReplaceOrder &m, uint64_t now_ns) {
+    auto it = s.token_to_ref.find(m.token);
+    if (it == s.token_to_ref.end()) return reject(s, m.new_token, 'T', now_ns);
+    if (m.new_token != m.token && s.token_to_ref.count(m.new_token)) {
+      return reject(s, m.new_token, 'D', now_ns);
+    }
+    if (m.qty == 0 || m.price_raw == 0) return reject(s, m.new_token, 'P', now_ns);
+
+    const uint64_t old_ref = it->second;
+    const OwnOrder own = own_[old_ref];
+    xdp::ExchangeBook &b = book(own.symbol_index);
+    char side;
+    uint32_t price, open;
+    if (!b.resting(old_ref, side, price, open)) return reject(s, m.new_token, 'T', now_ns);
+
+    const uint64_t ref = next_ref_++;
+    s.token_to_ref.erase(m.token);
+    own_.erase(old_ref);
+    own_[ref] = {s.id, m.new_token, own.symbol_index};
+    s.token_to_ref[m.new_token] = ref;
+
+    xdp::oe::Replaced r;
+    r.ts_ns = now_ns;
+    r.token = m.new_token;
+    r.old_token = m.token;
+    r.order_ref = ref;
+    r.qty = m.qty;
+    r.price_raw = m.price_raw;
+
+    // Same price and no larger: keep the queue position
+    if (m.price_raw == price && b.reduce(old_ref, ref, m.qty)) {
+      queue_report(s, now_ns, r);
+      return;
+    }
+    b.cancel(old_ref);
+    queue_report(s, now_ns, r);
+    fills_.clear();
+    const uint32_t rested = b.enter(ref, side, m.price_raw, m.qty, false, fills_);
+    report_fills(now_ns);
+    // Nothing rests: fully filled (report_fills forgot it already) or gone
+    if (rested == 0) forget(ref);
+  }
+
+  void cancel_ref(uint64_t ref, char reason, uint64_t now_ns) {
+    auto it = own_.find(ref);
+    if (it == own_.end()) return;
+    const OwnOrder own = it->second;
+    const uint32_t open = book(own.symbol_index).cancel(ref);
+    auto sit = sessions_.find(own.session);
+    if (sit != sessions_.end()) {
+      xdp::oe::Canceled c;
+      c.ts_ns = now_ns;
+      c.token = own.token;
+      c.qty = open;
+      c.reason = reason;
+      queue_report(sit->second, now_ns, c);
+    }
+    forget(ref);
+  }
+
+  void reject(Session &s, uint64_t token, char reason, uint64_t now_ns) {
+    rejects_++;
+    xdp::oe::Rejected r;
+    r.ts_ns = now_ns;
+    r.token = token;
+    r.reason = reason;
+    queue_report(s, now_ns, r);
+  }
+
+  void forget(uint64_t ref) {
+    auto it = own_.find(ref);
+    if (it == own_.end()) return;
+    auto sit = sessions_.find(it->second.session);
+    if (sit != sessions_.end()) sit->second.token_to_ref.erase(it->second.token);
+    own_.erase(it);
+  }
+
+  void report_fills(uint64_t now_ns) {
+    for (const auto &f : fills_) {
+      auto it = own_.find(f.ref);
+      if (it == own_.end()) continue;
+      auto sit = sessions_.find(it->second.session);
+      if (sit != sessions_.end()) {
+        Session &s = sit->second;
+        xdp::oe::Executed e;
+        e.ts_ns = now_ns;
+        e.token = it->second.token;
+        e.qty = f.qty;
+        e.price_raw = f.price_raw;
+        e.match_number = next_match_++;
+        e.liquidity = f.liquidity;
+        queue_report(s, now_ns, e);
+        s.fills++;
+        s.shares += f.qty;
+      }
+      if (f.done) forget(f.ref);
+    }
+    fills_.clear();
+  }
+
+  uint64_t draw_latency_ns() {
+    return static_cast<uint64_t>(std::max(0.0, latency_us_(rng_)) * 1000.0);
+  }
+
+  template <typename Msg> void queue_report(Session &s, uint64_t now_ns, const Msg &msg) {
+    Outbound out;
+    out.release_ns = std::max(now_ns + draw_latency_ns(), s.last_release_ns);
+    s.last_release_ns = out.release_ns;
+    out.seq = next_seq_++;
+    out.session = s.id;
+    xdp::oe::append_message(out.frame, msg);
+    outbound_.push(std::move(out));
+  }
+
+  void release_reports(uint64_t up_to_ns) {
+    bool any = false;
+    while (!outbound_.empty() && outbound_.top().release_ns <= up_to_ns) {
+      const Outbound &out = outbound_.top();
+      auto it = sessions_.find(out.session);
+      if (it != sessions_.end()) {
+        it->second.tx.insert(it->second.tx.end(), out.frame.begin(), out.frame.end());
+        any = true;
+      }
+      outbound_.pop();
+    }
+    if (any) flush_all();
+  }
+
+  // --- Pacing and sockets ---
+
+  void pace_to(uint64_t ts_ns) {
+    if (config_.speed <= 0.0) return;
+    const auto target = wall0_ + std::chrono::nanoseconds(static_cast<int64_t>(
+                                     static_cast<double>(ts_ns - feed0_ns_) / config_.speed));
+    for (;;) {
+      const auto now = Clock::now();
+      if (now >= target) {
+        service_io(0);
+        return;
+      }
+      const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(target - now).count();
+      service_io(static_cast<int>(std::min<int64_t>(ms, 100)));
+      if (ms == 0) return;
+    }
+  }
+
+  void service_io(int timeout_ms) {
+    fds_.clear();
+    for (int fd : listen_fds_) fds_.push_back({fd, POLLIN, 0});
+    poll_ids_.clear();
+    for (auto &[id, s] : sessions_) {
+      fds_.push_back({s.fd, static_cast<short>(POLLIN | (s.tx.empty() ? 0 : POLLOUT)), 0});
+      poll_ids_.push_back(id);
+    }
+    if (::poll(fds_.data(), fds_.size(), timeout_ms) <= 0) return;
+
+    for (size_t i = 0; i < listen_fds_.size(); ++i) {
+      if (fds_[i].revents & POLLIN) accept_on(listen_fds_[i], listen_eps_[i]);
+    }
+    for (size_t i = 0; i < poll_ids_.size(); ++i) {
+      const short rev = fds_[listen_fds_.size() + i].revents;
+      auto it = sessions_.find(poll_ids_[i]);
+      if (it == sessions_.end() || rev == 0) continue;
+      Session &s = it->second;
+      bool alive = true;
+      if (rev & (POLLIN | POLLHUP | POLLERR)) alive = read_from(s);
+      if (alive && (rev & POLLOUT)) alive = flush(s);
+      if (!alive) disconnect(s.id);
+    }
+  }
+
+  void accept_on(int listen_fd, const xdp::oe::Endpoint &ep) {
+    for (;;) {
+      int fd = ::accept(listen_fd, nullptr, nullptr);
+      if (fd < 0) return;
+      (void)::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+      if (!ep.is_unix) {
+        int one = 1;
+        (void)::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      }
+      Session s;
+      s.fd = fd;
+      s.id = next_session_id_++;
+      std::cerr << "Session " << s.id << " connected on " << ep.to_string() << "\n";
+      if (replaying_) {
+        xdp::oe::SystemEvent ev;
+        ev.ts_ns = clock_ns_;
+        ev.event = 'S';
+        queue_report(s, clock_ns_, ev);
+      }
+      sessions_.emplace(s.id, std::move(s));
+    }
+  }
+
+  bool read_from(Session &s) {
+    uint8_t buf[65536];
+    for (;;) {
+      ssize_t n = ::recv(s.fd, buf, sizeof(buf), 0);
+      if (n == 0) return false;
+      if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+      s.rx.insert(s.rx.end(), buf, buf + n);
+      xdp::oe::drain_frames(s.rx, [&](const uint8_t *body, size_t len) {
+        Inbound in;
+        in.effective_ns = clock_ns_ + draw_latency_ns();
+        in.seq = next_seq_++;
+        in.session = s.id;
+        in.body.assign(body, body + len);
+        inbound_.push(std::move(in));
+      });
+    }
+  }
+
+  bool flush(Session &s) {
+    size_t off = 0;
+    while (off < s.tx.size()) {
+      ssize_t n = ::send(s.fd, s.tx.data() + off, s.tx.size() - off, MSG_NOSIGNAL);
+      if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+        return false;
+      }
+      off += static_cast<size_t>(n);
+    }
+    s.tx.erase(s.tx.begin(), s.tx.begin() + static_cast<std::ptrdiff_t>(off));
+    return true;
+  }
+
+  void flush_all() {
+    std::vector<uint32_t> dead;
+    for (auto &[id, s] : sessions_) {
+      if (!s.tx.empty() && !flush(s)) dead.push_back(id);
+    }
+    for (uint32_t id : dead) disconnect(id);
+  }
+
+  // Cancel-on-disconnect, then drop the session
+  void disconnect(uint32_t id) {
+    auto it = sessions_.find(id);
+    if (it == sessions_.end()) return;
+    std::vector<uint64_t> refs;
+    for (const auto &[token, ref] : it->second.token_to_ref) refs.push_back(ref);
+    for (uint64_t ref : refs) cancel_ref(ref, 'D', clock_ns_);
+    std::cerr << "Session " << id << " disconnected (" << it->second.orders << " orders, "
+              << it->second.fills << " fills)\n";
+    closed_stats_[id] = {it->second.fills, it->second.shares};
+    ::close(it->second.fd);
+    sessions_.erase(it);
+  }
+
+  const ExchangeConfig &config_;
+  std::mt19937_64 rng_;
+  std::normal_distribution<double> latency_us_;
+  std::vector<std::unique_ptr<xdp::ExchangeBook>> books_;
+  std::vector<uint8_t> allowed_;
+  std::unordered_map<uint64_t, OwnOrder> own_;
+  std::map<uint32_t, Session> sessions_;
+  std::map<uint32_t, std::pair<uint64_t, uint64_t>> closed_stats_;
+  std::priority_queue<Inbound, std::vector<Inbound>, std::greater<Inbound>> inbound_;
+  std::priority_queue<Outbound, std::vector<Outbound>, std::greater<Outbound>> outbound_;
+  std::vector<xdp::ExchangeFill> fills_;
+  xdp::BookMessage msg_;
+
+  std::vector<int> listen_fds_;
+  std::vector<xdp::oe::Endpoint> listen_eps_;
+  std::vector<pollfd> fds_;
+  std::vector<uint32_t> poll_ids_;
+  int udp_fd_ = -1;
+  sockaddr_in udp_addr_{};
+
+  bool replaying_ = false;
+  uint64_t clock_ns_ = 0;
+  uint64_t feed0_ns_ = 0;
+  Clock::time_point wall0_;
+  uint64_t packets_ = 0;
+  uint64_t orders_ = 0;
+  uint64_t rejects_ = 0;
+  uint64_t next_ref_ = 1;
+  uint64_t next_match_ = 1;
+  uint64_t next_seq_ = 0;
+  uint32_t next_session_id_ = 1;
+};
+
+void print_usage(const char *program) {
+  std::cerr << "Local matching-engine stand-in\n\n"
+            << "Usage: " << program << " <pcap_file(s)> [options]\n\n"
+            << "Replays PCAP files as the exchange clock and matches client orders\n"
+            << "against the replayed queues with price-time priority. Clients speak\n"
+            << "the order entry protocol in src/common/order_entry.hpp.\n\n"
+            << "Options:\n"
+            << "  --listen EP             tcp:HOST:PORT or unix:PATH (repeatable;\n"
+            << "                          default: tcp:127.0.0.1:9001)\n"
+            << "  --feed-udp HOST:PORT    Republish replayed packets as UDP datagrams\n"
+            << "  --speed X               Feed seconds per wall second, 0 = as fast as\n"
+            << "                          possible (default: 1)\n"
+            << "  --wait-clients N        Start the replay once N clients are connected\n"
+            << "                          (default: 1)\n"
+            << "  --gateway-latency-us M  Mean one-way order entry latency (default: 20)\n"
+            << "  --gateway-jitter-us J   Latency standard deviation (default: 5)\n"
+            << "  --seed N                Latency RNG seed (default: 42)\n"
+            << "  --linger-ms N           Keep sessions open after the replay (default: 1000)\n"
+            << "  -t TICKER[,TICKER]      Symbols open for trading (default: all)\n"
+            << "  -s, --symbols FILE      Symbol map file (default: data/symbol_nyse_parsed.csv)\n\n"
+            << "Examples:\n"
+            << "  " << program << " data/day/*.pcap --listen unix:/tmp/xdpx.sock --feed-udp 127.0.0.1:9100\n"
+            << "  " << program << " data/day/*.pcap -t AAPL,MSFT --speed 0 --wait-clients 2\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> pcap_files;
+  std::vector<std::string> tickers;
+  std::vector<std::string> listen;
+  std::string symbol_file = "data/symbol_nyse_parsed.csv";
+  ExchangeConfig config;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--listen" && i + 1 < argc) {
+      listen.push_back(argv[++i]);
+    } else if (arg == "--feed-udp" && i + 1 < argc) {
+      config.feed_udp = argv[++i];
+    } else if (arg == "--speed" && i + 1 < argc) {
+      config.speed = std::max(0.0, std::stod(argv[++i]));
+    } else if (arg == "--wait-clients" && i + 1 < argc) {
+      config.wait_clients = std::stoull(argv[++i]);
+    } else if (arg == "--gateway-latency-us" && i + 1 < argc) {
+      config.gateway_latency_us = std::stod(argv[++i]);
+    } else if (arg == "--gateway-jitter-us" && i + 1 < argc) {
+      config.gateway_jitter_us = std::max(0.0, std::stod(argv[++i]));
+    } else if (arg == "--seed" && i + 1 < argc) {
+      config.seed = std::stoull(argv[++i]);
+    } else if (arg == "--linger-ms" && i + 1 < argc) {
+      config.linger_ms = std::stoull(argv[++i]);
+    } else if (arg == "-t" && i + 1 < argc) {
+      std::stringstream ss(argv[++i]);
+      std::string t;
+      while (std::getline(ss, t, ',')) {
+        if (!t.empty()) tickers.push_back(t);
+      }
+    } else if ((arg == "-s" || arg == "--symbols") && i + 1 < argc) {
+      symbol_file = argv[++i];
+    } else if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return 0;
+    } else if (arg[0] != '-') {
+      pcap_files.push_back(arg);
+    }
+  }
+  if (!listen.empty()) config.listen = listen;
+
+  if (pcap_files.empty()) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  // Sort PCAP files by name to ensure chronological order
+  std::sort(pcap_files.begin(), pcap_files.end());
+
+  if (!xdp::load_symbol_map(symbol_file)) {
+    std::cerr << "Warning: Could not load symbol file: " << symbol_file
+              << " (orders can only be entered for known symbols)\n";
+  }
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  ExchangeSim sim(config);
+  if (!tickers.empty()) {
+    std::vector<uint8_t> allowed(MAX_SYMBOLS + 1, 0);
+    for (const auto &t : tickers) {
+      auto idx = xdp::get_global_symbol_map().find_index(t);
+      if (!idx || *idx > MAX_SYMBOLS) {
+        std::cerr << "Warning: Unknown ticker " << t << ", skipping\n";
+        continue;
+      }
+      allowed[*idx] = 1;
+    }
+    sim.set_allowed(std::move(allowed));
+  }
+
+  std::string err;
+  if (!sim.start(err)) {
+    std::cerr << "Error: " << err << "\n";
+    return 1;
+  }
+
+  std::cerr << "=== XDP Exchange Sim ===\n"
+            << "PCAP files: " << pcap_files.size() << "\n"
+            << "Listening: ";
+  for (size_t i = 0; i < config.listen.size(); ++i) std::cerr << (i ? ", " : "") << config.listen[i];
+  std::cerr << "\n"
+            << "Feed republish: " << (config.feed_udp.empty() ? "off" : config.feed_udp) << "\n"
+            << "Speed: " << (config.speed > 0.0 ? std::to_string(config.speed) + "x" : "max") << "\n"
+            << "Gateway latency: " << config.gateway_latency_us << " +/- "
+            << config.gateway_jitter_us << " us\n"
+            << "Symbols: " << (tickers.empty() ? std::string("all") : std::to_string(tickers.size())) << "\n"
+            << "Waiting for " << config.wait_clients << " client(s)...\n"
+            << "========================\n" << std::flush;
+
+  sim.wait_for_clients();
+  if (sim.stopped()) return 0;
+
+  auto start_time = Clock::now();
+  bool started = false;
+  for (const auto &path : pcap_files) {
+    if (sim.stopped()) break;
+    xdp::MmapPcapReader reader;
+    if (!reader.open(path)) {
+      std::cerr << reader.error() << "\n";
+      continue;
+    }
+    if (!started) {
+      sim.begin_replay(reader.first_timestamp_ns());
+      started = true;
+    }
+    reader.process_all([&](const uint8_t *data, size_t len, uint64_t, const xdp::NetworkPacketInfo &info) {
+      if (!sim.stopped()) sim.on_packet(data, len, info.timestamp_ns);
+    });
+  }
+  if (started) sim.end_replay();
+
+  double seconds = std::chrono::duration<double>(Clock::now() - start_time).count();
+  sim.print_summary(std::cout, seconds);
+  return 0;
+}